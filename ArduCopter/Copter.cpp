@@ -243,11 +243,32 @@ void Copter::fast_loop()
     // update INS immediately to get current gyro data populated
     ins.update();
 
-    // run low level rate controllers that only require IMU data
-    attitude_control->rate_controller_run();
+    update_arming_delay();
 
-    // send outputs to the motors library immediately
-    motors_output();
+    {
+#if FAST_RATE_THREAD_ENABLED
+        WITH_SEMAPHORE(rate_thread_sem);
+#endif
+        if (using_rate_thread) {
+            // the rate thread runs the rate controller and drives the
+            // motors on each gyro sample, the failsafe and servo
+            // housekeeping stays here
+            motors_output(false);
+        } else {
+#if AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED
+            start_latency_trace();
+#endif
+
+            // run low level rate controllers that only require IMU data
+            attitude_control->rate_controller_run();
+#if AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED
+            ins.latency_trace.stage(AP_InertialSensor::LatencyTrace::Stage::RATE_CONTROL);
+#endif
+
+            // send outputs to the motors library immediately
+            motors_output();
+        }
+    }
 
     // run EKF state estimator (expensive)
     // --------------------
@@ -264,11 +285,23 @@ void Copter::fast_loop()
     // --------------------
     read_inertia();
 
-    // check if ekf has reset target heading or position
-    check_ekf_reset();
+    {
+#if FAST_RATE_THREAD_ENABLED
+        // keep the rate thread from seeing half updated rate targets
+        // and throttle
+        WITH_SEMAPHORE(rate_thread_sem);
+
+        // follow the AHRS primary gyro and its bias estimate
+        ins.set_rate_loop_gyro(ahrs.get_primary_gyro_index());
+        rate_thread_gyro_drift = ahrs.get_gyro_drift();
+#endif
 
-    // run the attitude controllers
-    update_flight_mode();
+        // check if ekf has reset target heading or position
+        check_ekf_reset();
+
+        // run the attitude controllers
+        update_flight_mode();
+    }
 
     // update home from EKF if necessary
     update_home_from_EKF();
@@ -364,6 +364,21 @@ private:
 
     ap_t ap;
 
+    // true once the rate controller and motors output have moved from
+    // fast_loop() to the rate thread
+    bool using_rate_thread;
+#if FAST_RATE_THREAD_ENABLED
+    // held by the rate thread while it runs the rate controller and
+    // outputs to the motors, and by the main loop while it updates the
+    // rate targets and throttle or does the output housekeeping
+    HAL_Semaphore rate_thread_sem;
+    // false while the main loop drives the motors itself (motor test)
+    // or the advanced failsafe has stopped them
+    bool rate_thread_output_enabled;
+    // AHRS gyro bias, added to the samples the rate thread runs on
+    Vector3f rate_thread_gyro_drift;
+#endif
+
     AirMode air_mode; // air mode is 0 = not-configured ; 1 = disabled; 2 = enabled
 
     static_assert(sizeof(uint32_t) == sizeof(ap), "ap_t must be uint32_t");
@@ -802,6 +817,10 @@ private:
     void Log_Write_SysID_Data(float waveform_time, float waveform_sample, float waveform_freq, float angle_x, float angle_y, float angle_z, float accel_x, float accel_y, float accel_z);
     void Log_Write_Vehicle_Startup_Messages();
     void log_init(void);
+#if AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED
+    void start_latency_trace(uint64_t sample_us, uint64_t filtered_us);
+    void start_latency_trace();
+#endif
 
     // mode.cpp
     bool set_mode(Mode::Number mode, ModeReason reason);
@@ -826,7 +845,8 @@ private:
     // motors.cpp
     void arm_motors_check();
     void auto_disarm_check();
-    void motors_output();
+    void update_arming_delay();
+    void motors_output(bool drive_motors = true);
     void lost_vehicle_check();
 
     // navigation.cpp
@@ -845,6 +865,13 @@ private:
     void init_precland();
     void update_precland();
 
+    // rate_thread.cpp
+#if FAST_RATE_THREAD_ENABLED
+    void rate_thread_init();
+    void rate_controller_thread();
+    void rate_thread_motors_output();
+#endif
+
     // radio.cpp
     void default_dead_zones();
     void init_rc_in();
@@ -567,6 +567,25 @@ void Copter::log_init(void)
     logger.Init(log_structure, ARRAY_SIZE(log_structure));
 }
 
+#if AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED
+// trace the gyro sample the rate controller is about to run on
+// through to the motor outputs
+void Copter::start_latency_trace(uint64_t sample_us, uint64_t filtered_us)
+{
+    if (should_log(MASK_LOG_LATENCY)) {
+        ins.latency_trace.start(sample_us, filtered_us);
+    }
+}
+
+// trace the latest gyro sample, as used by the main loop
+void Copter::start_latency_trace()
+{
+    uint64_t sample_us, filtered_us;
+    ins.get_gyro_sample_times(sample_us, filtered_us);
+    start_latency_trace(sample_us, filtered_us);
+}
+#endif
+
 #else // LOGGING_ENABLED
 
 void Copter::Log_Write_Control_Tuning() {}
@@ -591,4 +610,9 @@ void Copter::Log_Write_Heli() {}
 
 void Copter::log_init(void) {}
 
+#if AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED
+void Copter::start_latency_trace(uint64_t sample_us, uint64_t filtered_us) {}
+void Copter::start_latency_trace() {}
+#endif
+
 #endif // LOGGING_ENABLED
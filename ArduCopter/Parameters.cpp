@@ -322,7 +322,7 @@ const AP_Param::Info Copter::var_info[] = {
     // @Param: LOG_BITMASK
     // @DisplayName: Log bitmask
     // @Description: 4 byte bitmap of log types to enable
-    // @Bitmask: 0:ATTITUDE_FAST,1:ATTITUDE_MED,2:GPS,3:PM,4:CTUN,5:NTUN,6:RCIN,7:IMU,8:CMD,9:CURRENT,10:RCOUT,11:OPTFLOW,12:PID,13:COMPASS,14:INAV,15:CAMERA,17:MOTBATT,18:IMU_FAST,19:IMU_RAW,20:VideoStabilization
+    // @Bitmask: 0:ATTITUDE_FAST,1:ATTITUDE_MED,2:GPS,3:PM,4:CTUN,5:NTUN,6:RCIN,7:IMU,8:CMD,9:CURRENT,10:RCOUT,11:OPTFLOW,12:PID,13:COMPASS,14:INAV,15:CAMERA,17:MOTBATT,18:IMU_FAST,19:IMU_RAW,20:VideoStabilization,21:Latency
     // @User: Standard
     GSCALAR(log_bitmask,    "LOG_BITMASK",          DEFAULT_LOG_BITMASK),
 
@@ -1111,6 +1111,24 @@ const AP_Param::GroupInfo ParametersG2::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO("SURFTRAK_MODE", 51, ParametersG2, surftrak_mode, (uint8_t)Copter::SurfaceTracking::Surface::GROUND),
 
+#if FAST_RATE_THREAD_ENABLED
+    // @Param: FSTRATE_ENABLE
+    // @DisplayName: Enable the rate thread
+    // @Description: Run the rate controller and motors output in a separate thread on each sample from the primary gyro, rather than in the main loop at SCHED_LOOP_RATE
+    // @Values: 0:Disabled,1:Enabled
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("FSTRATE_ENABLE", 52, ParametersG2, fast_rate_enable, 0),
+
+    // @Param: FSTRATE_DIV
+    // @DisplayName: Rate thread divisor
+    // @Description: The rate thread runs the rate controller and motors output on every FSTRATE_DIV samples from the primary gyro. The motors output rate is the gyro rate divided by this, and should not be more than the ESCs accept
+    // @Range: 1 10
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("FSTRATE_DIV", 53, ParametersG2, fast_rate_div, 1),
+#endif
+
     AP_GROUPEND
 };
 
@@ -667,6 +667,11 @@ public:
     AP_Float                pilot_y_rate;
     AP_Float                pilot_y_expo;
     AP_Int8                 surftrak_mode;
+
+#if FAST_RATE_THREAD_ENABLED
+    AP_Int8                 fast_rate_enable;
+    AP_Int8                 fast_rate_div;
+#endif
 };
 
 extern const AP_Param::Info        var_info[];
@@ -714,6 +714,12 @@
   #error Toy mode is not available on Helicopters
 #endif
 
+//////////////////////////////////////////////////////////////////////////////
+// Rate controller and motors output in their own thread at the gyro rate
+#ifndef FAST_RATE_THREAD_ENABLED
+ # define FAST_RATE_THREAD_ENABLED (AP_INERTIALSENSOR_RATE_LOOP_BUFFER_ENABLED && FRAME_CONFIG != HELI_FRAME)
+#endif
+
 #ifndef STATS_ENABLED
  # define STATS_ENABLED ENABLED
 #endif
@@ -131,9 +131,23 @@ void Copter::auto_disarm_check()
     }
 }
 
+// update_arming_delay - clear the arming delay once it has passed, called from the main loop
+void Copter::update_arming_delay()
+{
+    if (ap.in_arming_delay && (!motors->armed() || millis()-arm_time_ms > ARMING_DELAY_SEC*1.0e3f || flightmode->mode_number() == Mode::Number::THROW)) {
+        ap.in_arming_delay = false;
+    }
+}
+
 // motors_output - send output to motors library which will adjust and send to ESCs and servos
-void Copter::motors_output()
+// drive_motors is false when the rate thread drives the motors, leaving only the
+// failsafe, servo and interlock housekeeping to be done here
+void Copter::motors_output(bool drive_motors)
 {
+#if FAST_RATE_THREAD_ENABLED
+    rate_thread_output_enabled = false;
+#endif
+
 #if ADVANCED_FAILSAFE == ENABLED
     // this is to allow the failsafe module to deliberately crash
     // the vehicle. Only used in extreme circumstances to meet the
@@ -147,11 +161,6 @@ void Copter::motors_output()
     }
 #endif
 
-    // Update arming delay state
-    if (ap.in_arming_delay && (!motors->armed() || millis()-arm_time_ms > ARMING_DELAY_SEC*1.0e3f || flightmode->mode_number() == Mode::Number::THROW)) {
-        ap.in_arming_delay = false;
-    }
-
     // output any servo channels
     SRV_Channels::calc_pwm();
 
@@ -174,12 +183,25 @@ void Copter::motors_output()
             AP::logger().Write_Event(LogEvent::MOTORS_INTERLOCK_DISABLED);
         }
 
+#if FAST_RATE_THREAD_ENABLED
+        rate_thread_output_enabled = true;
+#endif
         // send output signals to motors
-        flightmode->output_to_motors();
+        if (drive_motors) {
+            flightmode->output_to_motors();
+#if AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED
+            ins.latency_trace.stage(AP_InertialSensor::LatencyTrace::Stage::MIXER);
+#endif
+        }
     }
 
     // push all channels
     SRV_Channels::push();
+#if AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED
+    if (drive_motors) {
+        ins.latency_trace.stage(AP_InertialSensor::LatencyTrace::Stage::OUTPUT);
+    }
+#endif
 }
 
 // check for pilot stick input to trigger lost vehicle alarm
@@ -0,0 +1,122 @@
+#include "Copter.h"
+
+#if FAST_RATE_THREAD_ENABLED
+
+/*
+  run the rate controller and motors output in their own thread on
+  each sample from the primary gyro, rather than once per main loop
+  on the latest gyro. This takes the main loop scheduling out of the
+  time from a gyro sample to the motors responding to it.
+
+  The thread is only started at boot so the main loop never hands
+  the rate controller over while flying.
+
+  The main loop keeps the flight modes, advanced failsafe, motor test
+  and servo housekeeping. rate_thread_sem is the handoff between the
+  two: fast_loop() holds it while the mode updates the rate targets and
+  throttle and while it does the output housekeeping, and this thread
+  holds it while it runs the rate controller and outputs to the motors.
+ */
+void Copter::rate_thread_init()
+{
+    if (g2.fast_rate_enable == 0) {
+        return;
+    }
+    ins.set_rate_loop_gyro(ahrs.get_primary_gyro_index());
+    if (!ins.enable_rate_loop_buffer()) {
+        gcs().send_text(MAV_SEVERITY_WARNING, "Rate thread: no buffer");
+        return;
+    }
+    if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&Copter::rate_controller_thread, void),
+                                      "rate", 4096, AP_HAL::Scheduler::PRIORITY_MAIN, 1)) {
+        ins.disable_rate_loop_buffer();
+        gcs().send_text(MAV_SEVERITY_WARNING, "Rate thread: failed to start");
+        return;
+    }
+}
+
+void Copter::rate_controller_thread()
+{
+    const uint8_t div = constrain_int16(g2.fast_rate_div, 1, 10);
+    const uint16_t loop_rate_hz = scheduler.get_loop_rate_hz();
+    {
+        WITH_SEMAPHORE(rate_thread_sem);
+        const uint16_t gyro_rate_hz = ins.get_gyro_rate_hz(ahrs.get_primary_gyro_index());
+        motors->set_loop_rate(MAX(gyro_rate_hz / div, loop_rate_hz));
+        rate_thread_gyro_drift = ahrs.get_gyro_drift();
+        using_rate_thread = true;
+    }
+
+    // if the samples stop we fall back to running on the latest gyro
+    // once every two main loop periods
+    const uint32_t timeout_us = 2 * scheduler.get_loop_period_us();
+
+    uint8_t count = 0;
+    float dt_sum = 0;
+    while (true) {
+        AP_InertialSensor::GyroSample sample;
+        if (!ins.get_next_gyro_sample(sample, timeout_us)) {
+            count = 0;
+            dt_sum = 0;
+            if (!ap.compass_mot) {
+                WITH_SEMAPHORE(rate_thread_sem);
+#if AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED
+                start_latency_trace();
+#endif
+                attitude_control->rate_controller_run_dt(ahrs.get_gyro_latest(), timeout_us * 1.0e-6f);
+#if AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED
+                ins.latency_trace.stage(AP_InertialSensor::LatencyTrace::Stage::RATE_CONTROL);
+#endif
+                rate_thread_motors_output();
+            }
+            continue;
+        }
+        dt_sum += sample.dt;
+        if (++count < div) {
+            continue;
+        }
+        const float dt = dt_sum;
+        count = 0;
+        dt_sum = 0;
+        // compassmot drives the motors itself
+        if (ap.compass_mot || !is_positive(dt)) {
+            continue;
+        }
+        WITH_SEMAPHORE(rate_thread_sem);
+#if AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED
+        start_latency_trace(sample.sample_us, sample.filtered_us);
+#endif
+        // correct for the gyro bias as get_gyro_latest() does
+        attitude_control->rate_controller_run_dt(sample.gyro + rate_thread_gyro_drift, dt);
+#if AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED
+        ins.latency_trace.stage(AP_InertialSensor::LatencyTrace::Stage::RATE_CONTROL);
+#endif
+        rate_thread_motors_output();
+    }
+}
+
+/*
+  send the rate controller output to the motors. Only the motor
+  channels are pushed here, motors_output() on the main loop does the
+  rest of the servo outputs. Must be called with rate_thread_sem held
+ */
+void Copter::rate_thread_motors_output()
+{
+    if (!rate_thread_output_enabled) {
+        return;
+    }
+
+    SRV_Channels::cork();
+
+    flightmode->output_to_motors();
+#if AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED
+    ins.latency_trace.stage(AP_InertialSensor::LatencyTrace::Stage::MIXER);
+#endif
+
+    hal.rcout->push();
+#if AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED
+    ins.latency_trace.stage(AP_InertialSensor::LatencyTrace::Stage::OUTPUT);
+#endif
+}
+
+#endif  // FAST_RATE_THREAD_ENABLED
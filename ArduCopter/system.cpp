@@ -202,6 +202,10 @@ void Copter::init_ardupilot()
         enable_motor_output();
     }
 
+#if FAST_RATE_THREAD_ENABLED
+    rate_thread_init();
+#endif
+
     // attempt to set the intial_mode, else set to STABILIZE
     if (!set_mode((enum Mode::Number)g.initial_mode.get(), ModeReason::INITIALISED)) {
         // set mode to STABILIZE will trigger mode change notification to pilot
@@ -9,6 +9,11 @@
 #include <time.h>
 #include <cinttypes>
 
+#if AP_LOGGERFILEREADER_MMAP_ENABLED
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #ifndef PRIu64
 #define PRIu64 "llu"
 #endif
@@ -18,7 +23,18 @@ AP_LoggerFileReader::AP_LoggerFileReader()
 
 AP_LoggerFileReader::~AP_LoggerFileReader()
 {
+    const double elapsed = (AP_HAL::micros64() - start_micros) * 1.0e-6;
     ::printf("Replay counts: %" PRIu64 " bytes  %u entries\n", bytes_read, message_count);
+    if (elapsed > 0) {
+        ::printf("Replay rate: %.1f MB/s  %.0f entries/s  (%.2fs)\n",
+                 bytes_read / (elapsed * 1.0e6), message_count / elapsed, elapsed);
+    }
+#if AP_LOGGERFILEREADER_MMAP_ENABLED
+    if (mapped != nullptr) {
+        munmap(mapped, data_len);
+    }
+#endif
+    delete[] buffer;
 }
 
 bool AP_LoggerFileReader::open_log(const char *logfile)
@@ -27,14 +43,72 @@ bool AP_LoggerFileReader::open_log(const char *logfile)
     if (fd == -1) {
         return false;
     }
+    start_micros = AP_HAL::micros64();
+
+#if AP_LOGGERFILEREADER_MMAP_ENABLED
+    /*
+      map the whole log. The mapping is private and writable so any
+      handler which modifies a message in place gets its own copy of
+      the page rather than failing
+     */
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0 && uint64_t(st.st_size) <= SIZE_MAX) {
+        void *ptr = mmap(nullptr, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (ptr != MAP_FAILED) {
+            madvise(ptr, st.st_size, MADV_SEQUENTIAL);
+            mapped = (uint8_t *)ptr;
+            data = mapped;
+            data_len = st.st_size;
+            return true;
+        }
+    }
+#endif
+
+    // fall back to reading in large blocks
+    buffer = new uint8_t[AP_LOGGERFILEREADER_BUFFER_SIZE];
+    if (buffer == nullptr) {
+        return false;
+    }
+    data = buffer;
     return true;
 }
 
-ssize_t AP_LoggerFileReader::read_input(void *buffer, const size_t count)
+/*
+  move the unconsumed data to the start of the buffer and top it up
+  until at least count bytes are available
+ */
+bool AP_LoggerFileReader::fill_buffer(size_t count)
 {
-    uint64_t ret = AP::FS().read(fd, buffer, count);
-    bytes_read += ret;
-    return ret;
+    if (buffer == nullptr) {
+        // the whole log is mapped, there is no more data
+        return false;
+    }
+    const size_t remaining = data_len - data_ofs;
+    memmove(buffer, &buffer[data_ofs], remaining);
+    data_ofs = 0;
+    data_len = remaining;
+    while (data_len < count) {
+        const int32_t ret = AP::FS().read(fd, &buffer[data_len], AP_LOGGERFILEREADER_BUFFER_SIZE - data_len);
+        if (ret <= 0) {
+            return false;
+        }
+        data_len += ret;
+    }
+    return true;
+}
+
+uint8_t *AP_LoggerFileReader::peek_input(size_t count)
+{
+    if (data_len - data_ofs < count && !fill_buffer(count)) {
+        return nullptr;
+    }
+    return &data[data_ofs];
+}
+
+void AP_LoggerFileReader::consume_input(size_t count)
+{
+    data_ofs += count;
+    bytes_read += count;
 }
 
 void AP_LoggerFileReader::format_type(uint16_t type, char dest[5])
@@ -53,8 +127,8 @@ void AP_LoggerFileReader::get_packet_counts(uint64_t dest[])
 
 bool AP_LoggerFileReader::update()
 {
-    uint8_t hdr[3];
-    if (read_input(hdr, 3) != 3) {
+    const uint8_t *hdr = peek_input(3);
+    if (hdr == nullptr) {
         return false;
     }
     if (hdr[0] != HEAD_BYTE1 || hdr[1] != HEAD_BYTE2) {
@@ -68,35 +142,44 @@ bool AP_LoggerFileReader::update()
         ::printf("line %u pkt 0x%02x t=%u\n", message_count, hdr[2], AP_HAL::millis());
     }
 #endif
-    packet_counts[hdr[2]]++;
+    const uint8_t type = hdr[2];
+    packet_counts[type]++;
 
-    if (hdr[2] == LOG_FORMAT_MSG) {
+    if (type == LOG_FORMAT_MSG) {
         struct log_Format f;
-        memcpy(&f, hdr, 3);
-        if (read_input(&f.type, sizeof(f)-3) != sizeof(f)-3) {
+        const uint8_t *msg = peek_input(sizeof(f));
+        if (msg == nullptr) {
             return false;
         }
+        memcpy(&f, msg, sizeof(f));
+        consume_input(sizeof(f));
         memcpy(&formats[f.type], &f, sizeof(formats[f.type]));
 
         message_count++;
+        if (skip_handlers) {
+            return true;
+        }
         return handle_log_format_msg(f);
     }
 
-    const struct log_Format &f = formats[hdr[2]];
+    const struct log_Format &f = formats[type];
     if (f.length == 0) {
         // can't just throw these away as the format specifies the
         // number of bytes in the message
-        ::printf("No format defined for type (%d)\n", hdr[2]);
+        ::printf("No format defined for type (%d)\n", type);
         exit(1);
     }
 
-    uint8_t msg[f.length];
-
-    memcpy(msg, hdr, 3);
-    if (read_input(&msg[3], f.length-3) != f.length-3) {
+    // handlers are given the message in place, it is not copied
+    uint8_t *msg = peek_input(f.length);
+    if (msg == nullptr) {
         return false;
     }
+    consume_input(f.length);
 
     message_count++;
+    if (skip_handlers) {
+        return true;
+    }
     return handle_msg(f, msg);
 }
@@ -4,6 +4,26 @@
 
 #define LOGREADER_MAX_FORMATS 255 // must be >= highest MESSAGE
 
+/*
+  on posix boards the whole log is mapped into memory and handlers are
+  given pointers directly into the mapping. Elsewhere, or if the map
+  fails, the log is read through AP::FS() in large blocks
+ */
+#ifndef AP_LOGGERFILEREADER_MMAP_ENABLED
+#define AP_LOGGERFILEREADER_MMAP_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
+#ifndef AP_LOGGERFILEREADER_BUFFER_SIZE
+#if CONFIG_HAL_BOARD == HAL_BOARD_CHIBIOS
+#define AP_LOGGERFILEREADER_BUFFER_SIZE 4096
+#else
+#define AP_LOGGERFILEREADER_BUFFER_SIZE 65536
+#endif
+#endif
+
+// the buffer must hold the largest message
+static_assert(AP_LOGGERFILEREADER_BUFFER_SIZE >= 256, "Log reader buffer too small");
+
 class AP_LoggerFileReader
 {
 public:
@@ -20,17 +40,35 @@ public:
     void format_type(uint16_t type, char dest[5]);
     void get_packet_counts(uint64_t dest[]);
 
+    // parse messages without passing them to the handlers, for
+    // measuring reader throughput
+    void set_skip_handlers(bool skip) { skip_handlers = skip; }
+
 protected:
     int fd = -1;
 
     struct log_Format formats[LOGREADER_MAX_FORMATS] {};
 
 private:
-    ssize_t read_input(void *buf, size_t count);
+    // return a pointer to the next count bytes of the log without
+    // consuming them, or nullptr at the end of the log
+    uint8_t *peek_input(size_t count);
+    void consume_input(size_t count);
+    bool fill_buffer(size_t count);
+
+    // log data, either the mapped file or buffer
+    uint8_t *data = nullptr;
+    size_t data_len = 0;
+    size_t data_ofs = 0;
+
+    uint8_t *mapped = nullptr;
+    uint8_t *buffer = nullptr;
+
+    bool skip_handlers = false;
 
     uint64_t bytes_read = 0;
     uint32_t message_count = 0;
-    uint64_t start_micros;
+    uint64_t start_micros = 0;
 
     uint64_t packet_counts[LOGREADER_MAX_FORMATS] = {};
 };
@@ -1,6 +1,7 @@
 #include "LR_MsgHandler.h"
 #include "LogReader.h"
 #include "Replay.h"
+#include "ReplayCheckpoint.h"
 
 #include <AP_DAL/AP_DAL.h>
 
@@ -20,6 +21,12 @@ void LR_MsgHandler_RFRH::process_message(uint8_t *msgbytes)
     AP::dal().handle_message(msg);
 }
 
+void LR_MsgHandler_RFRD::process_message(uint8_t *msgbytes)
+{
+    MSG_CREATE(RFRD, msgbytes);
+    AP::dal().handle_message(msg);
+}
+
 void LR_MsgHandler_RFRF::process_message(uint8_t *msgbytes)
 {
     MSG_CREATE(RFRF, msgbytes);
@@ -38,7 +45,9 @@ void LR_MsgHandler_RFRF::process_message(uint8_t *msgbytes)
         MAP_FLAG(AP_DAL::FrameType::LogWriteEKF2, AP_DAL::FrameType::LogWriteEKF3);
     }
 #undef MAP_FLAG
+    replay_checkpoint.frame_start();
     AP::dal().handle_message(msg, ekf2, ekf3);
+    replay_checkpoint.frame_end(ekf3);
 }
 
 void LR_MsgHandler_RFRN::process_message(uint8_t *msgbytes)
@@ -176,6 +185,11 @@ void LR_MsgHandler_RISI::process_message(uint8_t *msgbytes)
     MSG_CREATE(RISI, msgbytes);
     AP::dal().handle_message(msg);
 }
+void LR_MsgHandler_RISJ::process_message(uint8_t *msgbytes)
+{
+    MSG_CREATE(RISJ, msgbytes);
+    AP::dal().handle_message(msg);
+}
 
 void LR_MsgHandler_RASH::process_message(uint8_t *msgbytes)
 {
@@ -16,6 +16,7 @@
 #include "Replay.h"
 
 #include "LogReader.h"
+#include "ReplayCheckpoint.h"
 
 #include <stdio.h>
 #include <AP_HAL/utility/getopt_cpp.h>
@@ -38,6 +39,10 @@ static ReplayVehicle replayvehicle;
 user_parameter *user_parameters;
 bool replay_force_ekf2;
 bool replay_force_ekf3;
+bool replay_read_benchmark;
+static const char *checkpoint_filename;
+static float checkpoint_interval;
+static float seek_time = -1;
 
 #define GSCALAR(v, name, def) { replayvehicle.g.v.vtype, name, Parameters::k_param_ ## v, &replayvehicle.g.v, {def_value : def} }
 #define GOBJECT(v, name, class) { AP_PARAM_GROUP, name, Parameters::k_param_ ## v, &replayvehicle.v, {group_info : class::var_info} }
@@ -133,11 +138,19 @@ void Replay::usage(void)
     ::printf("\t--param-file FILENAME  load parameters from a file\n");
     ::printf("\t--force-ekf2 force enable EKF2\n");
     ::printf("\t--force-ekf3 force enable EKF3\n");
+    ::printf("\t--read-benchmark read the log without replaying it to measure reader throughput\n");
+    ::printf("\t--checkpoint FILENAME  EKF3 checkpoint file to write or seek from\n");
+    ::printf("\t--checkpoint-interval SECONDS  write an EKF3 checkpoint every SECONDS of log time\n");
+    ::printf("\t--seek SECONDS  start replaying EKF3 from the last checkpoint before SECONDS of log time\n");
 }
 
 enum param_key : uint8_t {
     FORCE_EKF2 = 1,
     FORCE_EKF3,
+    READ_BENCHMARK,
+    CHECKPOINT,
+    CHECKPOINT_INTERVAL,
+    SEEK,
 };
 
 void Replay::_parse_command_line(uint8_t argc, char * const argv[])
@@ -149,6 +162,10 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
         {"param-file",      true,   0, 'F'},
         {"force-ekf2",      false,  0, param_key::FORCE_EKF2},
         {"force-ekf3",      false,  0, param_key::FORCE_EKF3},
+        {"read-benchmark",  false,  0, param_key::READ_BENCHMARK},
+        {"checkpoint",      true,   0, param_key::CHECKPOINT},
+        {"checkpoint-interval", true, 0, param_key::CHECKPOINT_INTERVAL},
+        {"seek",            true,   0, param_key::SEEK},
         {"help",            false,  0, 'h'},
         {0, false, 0, 0}
     };
@@ -184,6 +201,22 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
             replay_force_ekf3 = true;
             break;
 
+        case param_key::READ_BENCHMARK:
+            replay_read_benchmark = true;
+            break;
+
+        case param_key::CHECKPOINT:
+            checkpoint_filename = gopt.optarg;
+            break;
+
+        case param_key::CHECKPOINT_INTERVAL:
+            checkpoint_interval = atof(gopt.optarg);
+            break;
+
+        case param_key::SEEK:
+            seek_time = atof(gopt.optarg);
+            break;
+
         case 'h':
         default:
             usage();
@@ -242,6 +275,26 @@ void Replay::setup()
         ::printf("open(%s): %m\n", filename);
         exit(1);
     }
+    reader.set_skip_handlers(replay_read_benchmark);
+
+    if (checkpoint_filename != nullptr) {
+        if (is_positive(checkpoint_interval) == (seek_time >= 0)) {
+            ::printf("--checkpoint needs one of --checkpoint-interval or --seek\n");
+            exit(1);
+        }
+        if (seek_time >= 0) {
+            if (!replay_checkpoint.open_seek(checkpoint_filename, seek_time)) {
+                ::printf("Failed to seek to %.3fs in %s\n", seek_time, checkpoint_filename);
+                exit(1);
+            }
+        } else if (!replay_checkpoint.open_write(checkpoint_filename, checkpoint_interval)) {
+            ::printf("open(%s): %m\n", checkpoint_filename);
+            exit(1);
+        }
+    } else if (seek_time >= 0 || is_positive(checkpoint_interval)) {
+        ::printf("--seek and --checkpoint-interval need --checkpoint\n");
+        exit(1);
+    }
 }
 
 void Replay::loop()
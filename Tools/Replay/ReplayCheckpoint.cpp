@@ -0,0 +1,162 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ReplayCheckpoint.h"
+
+#include <AP_DAL/AP_DAL.h>
+
+#define RECORD_MAGIC 0x52504b43 // "CKPR"
+
+ReplayCheckpoint replay_checkpoint;
+
+/*
+  open a checkpoint file for writing
+ */
+bool ReplayCheckpoint::open_write(const char *filename, float interval_s)
+{
+    if (!is_positive(interval_s)) {
+        return false;
+    }
+    file = fopen(filename, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    interval_us = interval_s * 1.0e6f;
+    next_write_us = 0;
+    return true;
+}
+
+/*
+  find the last checkpoint at or before the seek time and load it
+ */
+bool ReplayCheckpoint::open_seek(const char *filename, float seek_s)
+{
+    FILE *f = fopen(filename, "rb");
+    if (f == nullptr) {
+        return false;
+    }
+    const uint64_t target_us = seek_s * 1.0e6f;
+    long best_offset = -1;
+    struct record_header best {};
+    long offset = 0;
+    struct record_header hdr;
+    while (fread(&hdr, sizeof(hdr), 1, f) == 1) {
+        if (hdr.magic != RECORD_MAGIC) {
+            ::printf("Bad checkpoint record at offset %ld\n", offset);
+            fclose(f);
+            return false;
+        }
+        offset += sizeof(hdr);
+        if (hdr.time_us <= target_us) {
+            best = hdr;
+            best_offset = offset;
+        }
+        offset += hdr.length;
+        if (fseek(f, offset, SEEK_SET) != 0) {
+            break;
+        }
+    }
+    if (best_offset < 0) {
+        ::printf("No checkpoint before %.3fs\n", seek_s);
+        fclose(f);
+        return false;
+    }
+
+    data = new uint8_t[best.length];
+    if (data == nullptr ||
+        fseek(f, best_offset, SEEK_SET) != 0 ||
+        fread(data, best.length, 1, f) != 1) {
+        fclose(f);
+        return false;
+    }
+    fclose(f);
+
+    length = best.length;
+    seek_time_us = best.time_us;
+    seeking = true;
+    ::printf("Seeking to checkpoint at %.3fs\n", seek_time_us*1.0e-6);
+    return true;
+}
+
+void ReplayCheckpoint::frame_start()
+{
+    AP::dal().set_ekf3_seeking(seeking);
+}
+
+void ReplayCheckpoint::frame_end(NavEKF3 &ekf3)
+{
+    const uint64_t time_us = AP::dal().micros64();
+    if (seeking) {
+        if (time_us >= seek_time_us) {
+            restore(ekf3, time_us);
+        }
+        return;
+    }
+    if (file != nullptr && time_us >= next_write_us) {
+        write(ekf3, time_us);
+    }
+}
+
+/*
+  write the EKF3 state once it has been initialised
+ */
+void ReplayCheckpoint::write(NavEKF3 &ekf3, uint64_t time_us)
+{
+    const uint32_t size = ekf3.checkpoint_size();
+    if (size == 0) {
+        return;
+    }
+    if (size > length) {
+        delete[] data;
+        data = new uint8_t[size];
+        if (data == nullptr) {
+            AP_HAL::panic("checkpoint allocation failed");
+        }
+        length = size;
+    }
+    ekf3.checkpoint_save(data);
+    const struct record_header hdr {
+        magic : RECORD_MAGIC,
+        time_us : time_us,
+        length : size,
+    };
+    if (fwrite(&hdr, sizeof(hdr), 1, file) != 1 ||
+        fwrite(data, size, 1, file) != 1) {
+        AP_HAL::panic("checkpoint write failed");
+    }
+    fflush(file);
+    next_write_us = time_us + interval_us;
+}
+
+/*
+  restore the EKF3 state at the end of the frame the checkpoint was
+  written at. Replay continues normally from the next frame
+ */
+void ReplayCheckpoint::restore(NavEKF3 &ekf3, uint64_t time_us)
+{
+    if (time_us != seek_time_us) {
+        ::printf("Checkpoint frame at %.3fs not found\n", seek_time_us*1.0e-6);
+        exit(1);
+    }
+    if (!ekf3.checkpoint_restore(data, length)) {
+        ::printf("Checkpoint restore failed, it must be written by the same Replay with the same log and parameters\n");
+        exit(1);
+    }
+    seeking = false;
+    AP::dal().set_ekf3_seeking(false);
+    delete[] data;
+    data = nullptr;
+    length = 0;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <AP_NavEKF3/AP_NavEKF3.h>
+#include <AP_Filesystem/posix_compat.h>
+
+/*
+  EKF3 checkpoints for Replay. When writing, the EKF3 state is saved
+  to a checkpoint file at a fixed interval of log time. When seeking,
+  the frames before the chosen checkpoint are read without running
+  EKF3, and the EKF3 state is then restored from the checkpoint.
+
+  Checkpoints are written by Replay itself, and are only valid for
+  the same Replay binary, log and parameters.
+ */
+class ReplayCheckpoint
+{
+public:
+    // write a checkpoint every interval_s seconds of log time
+    bool open_write(const char *filename, float interval_s);
+
+    // load the last checkpoint at or before seek_s seconds of log time
+    bool open_seek(const char *filename, float seek_s);
+
+    // called before and after each replay frame is handled
+    void frame_start();
+    void frame_end(NavEKF3 &ekf3);
+
+private:
+    struct PACKED record_header {
+        uint32_t magic;
+        uint64_t time_us;
+        uint32_t length;
+    };
+
+    FILE *file;
+    uint64_t interval_us;
+    uint64_t next_write_us;
+
+    bool seeking;
+    uint64_t seek_time_us;
+    uint8_t *data;
+    uint32_t length;
+
+    void write(NavEKF3 &ekf3, uint64_t time_us);
+    void restore(NavEKF3 &ekf3, uint64_t time_us);
+};
+
+extern ReplayCheckpoint replay_checkpoint;
@@ -6,8 +6,9 @@ check that replay produced identical results
 
 from __future__ import print_function
 
-def check_log(logfile, progress=print, ekf2_only=False, ekf3_only=False, verbose=False, accuracy=0.0):
-    '''check replay log for matching output'''
+def check_log(logfile, progress=print, ekf2_only=False, ekf3_only=False, verbose=False, accuracy=0.0, start_time=0.0):
+    '''check replay log for matching output. Messages before start_time
+    seconds are not checked, for logs replayed with --seek'''
     from pymavlink import mavutil
     progress("Processing log %s" % logfile)
     failure = 0
@@ -46,9 +47,13 @@ def check_log(logfile, progress=print, ekf2_only=False, ekf3_only=False, verbose
         core = m.C
         if core < 100:
             base[mtype][core] = m
+            if m.TimeUS < start_time * 1.0e6:
+                continue
             base_count += 1
             base_counts[mtype] += 1
             continue
+        if m.TimeUS < start_time * 1.0e6:
+            continue
         mb = base[mtype][core-100]
         count += 1
         counts[mtype] += 1
@@ -91,13 +96,14 @@ if __name__ == '__main__':
     parser.add_argument("--ekf3-only", action='store_true', help="only check EKF3")
     parser.add_argument("--verbose", action='store_true', help="verbose output")
     parser.add_argument("--accuracy", type=float, default=0.0, help="accuracy percentage for match")
+    parser.add_argument("--start-time", type=float, default=0.0, help="ignore messages before this log time in seconds")
     parser.add_argument("logs", metavar="LOG", nargs="+")
 
     args = parser.parse_args()
 
     failed = False
     for filename in args.logs:
-        if not check_log(filename, print, args.ekf2_only, args.ekf3_only, args.verbose, accuracy=args.accuracy):
+        if not check_log(filename, print, args.ekf2_only, args.ekf3_only, args.verbose, accuracy=args.accuracy, start_time=args.start_time):
             failed = True
 
     if failed:
@@ -0,0 +1,274 @@
+#!/usr/bin/env python3
+
+'''
+Replay many logs in parallel and summarise the results
+
+Each log is replayed by its own Replay process in its own working
+directory, so Replay's global state is never shared. A pool of workers
+runs the replays and parses the output logs. A summary line is printed
+for each log, and a JSON summary can be written for further processing.
+
+The summary for each log holds:
+ - innovation RMS and maximum for each replayed EKF core
+ - number of primary lane switches in the replayed output
+ - maximum horizontal and vertical position divergence between the
+   original and replayed output of each core
+ - wall time and log reader throughput
+'''
+
+from __future__ import print_function
+
+import glob
+import json
+import math
+import multiprocessing
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+# message names for each EKF type
+EKF_MESSAGES = {
+    'EKF2': {'pos': 'NKF1', 'innov': 'NKF3', 'status': 'NKF4'},
+    'EKF3': {'pos': 'XKF1', 'innov': 'XKF3', 'status': 'XKF4'},
+}
+
+INNOVATION_FIELDS = ['IVN', 'IVE', 'IVD', 'IPN', 'IPE', 'IPD', 'IMX', 'IMY', 'IMZ', 'IYAW', 'IVT']
+
+
+def find_logs(paths):
+    '''expand directories into the .BIN logs they contain'''
+    logs = []
+    for path in paths:
+        if os.path.isdir(path):
+            for pattern in ['*.BIN', '*.bin']:
+                logs.extend(glob.glob(os.path.join(path, '**', pattern), recursive=True))
+        else:
+            logs.append(path)
+    return sorted(set([os.path.abspath(x) for x in logs]))
+
+
+class Stats(object):
+    '''running RMS and maximum absolute value'''
+    def __init__(self):
+        self.count = 0
+        self.sum_sq = 0.0
+        self.max_abs = 0.0
+
+    def add(self, value):
+        self.count += 1
+        self.sum_sq += value * value
+        self.max_abs = max(self.max_abs, abs(value))
+
+    def result(self):
+        if self.count == 0:
+            return None
+        return {'rms': math.sqrt(self.sum_sq / self.count), 'max': self.max_abs}
+
+
+def summarise_output(logfile):
+    '''summarise EKF behaviour in a Replay output log. Replayed cores
+    are logged with C >= 100, original cores with C < 100'''
+    from pymavlink import DFReader
+
+    types = []
+    msg_ekf = {}
+    for ekf, msgs in EKF_MESSAGES.items():
+        for role, name in msgs.items():
+            types.append(name)
+            msg_ekf[name] = (ekf, role)
+
+    innovations = {}
+    lane_switches = {}
+    last_primary = {}
+    original_pos = {}
+    divergence = {}
+
+    dfreader = DFReader.DFReader_binary(logfile, zero_time_base=True)
+    while True:
+        m = dfreader.recv_match(type=types)
+        if m is None:
+            break
+        if not hasattr(m, 'C'):
+            continue
+        ekf, role = msg_ekf[m.get_type()]
+        core = m.C
+        replayed = core >= 100
+
+        if role == 'pos':
+            if not replayed:
+                original_pos[(ekf, core)] = (m.PN, m.PE, m.PD)
+                continue
+            orig = original_pos.get((ekf, core - 100))
+            if orig is None:
+                continue
+            d = divergence.setdefault(ekf, {'horizontal': 0.0, 'vertical': 0.0})
+            d['horizontal'] = max(d['horizontal'], math.hypot(m.PN - orig[0], m.PE - orig[1]))
+            d['vertical'] = max(d['vertical'], abs(m.PD - orig[2]))
+
+        elif role == 'innov' and replayed:
+            key = "%s_%u" % (ekf, core - 100)
+            core_stats = innovations.setdefault(key, {})
+            for f in INNOVATION_FIELDS:
+                if hasattr(m, f):
+                    core_stats.setdefault(f, Stats()).add(getattr(m, f))
+
+        elif role == 'status' and replayed and hasattr(m, 'PI'):
+            # each core logs the primary index, only count it once
+            if core != 100:
+                continue
+            if ekf in last_primary and last_primary[ekf] != m.PI:
+                lane_switches[ekf] = lane_switches.get(ekf, 0) + 1
+            lane_switches.setdefault(ekf, 0)
+            last_primary[ekf] = m.PI
+
+    innov_result = {}
+    for key, fields in innovations.items():
+        innov_result[key] = dict((f, s.result()) for f, s in fields.items())
+
+    return {
+        'innovations': innov_result,
+        'lane_switches': lane_switches,
+        'max_position_divergence': divergence,
+    }
+
+
+def replay_one(job):
+    '''replay a single log in its own working directory, returning a
+    summary dictionary'''
+    (logfile, replay, replay_args, outdir, keep) = job
+    result = {
+        'log': logfile,
+        'ok': False,
+        'size': os.path.getsize(logfile),
+    }
+    workdir = tempfile.mkdtemp(prefix='replay-', dir=outdir)
+    result['workdir'] = workdir
+    start = time.time()
+    try:
+        p = subprocess.Popen([replay] + replay_args + [logfile],
+                             cwd=workdir,
+                             stdout=subprocess.PIPE,
+                             stderr=subprocess.STDOUT)
+        output = p.communicate()[0].decode('utf-8', 'replace')
+    except OSError as e:
+        result['error'] = str(e)
+        return result
+    result['wall_time'] = time.time() - start
+    result['returncode'] = p.returncode
+    with open(os.path.join(workdir, 'replay.txt'), 'w') as f:
+        f.write(output)
+
+    match = re.search(r"Replay counts: (\d+) bytes\s+(\d+) entries", output)
+    if match is not None:
+        result['bytes'] = int(match.group(1))
+        result['entries'] = int(match.group(2))
+    match = re.search(r"Replay rate: ([\d.]+) MB/s\s+([\d.]+) entries/s", output)
+    if match is not None:
+        result['reader_mb_per_s'] = float(match.group(1))
+
+    outlogs = sorted(glob.glob(os.path.join(workdir, 'logs', '*.BIN')))
+    if p.returncode != 0 or len(outlogs) == 0:
+        result['error'] = "Replay failed (returncode=%d, %u logs)" % (p.returncode, len(outlogs))
+        return result
+    result['output_log'] = outlogs[-1]
+
+    try:
+        result.update(summarise_output(outlogs[-1]))
+        result['ok'] = True
+    except Exception as e:
+        result['error'] = "summary failed: %s" % str(e)
+
+    if result['ok'] and not keep:
+        shutil.rmtree(workdir, ignore_errors=True)
+        del result['workdir']
+        del result['output_log']
+    return result
+
+
+def format_summary(r):
+    '''one line human readable summary of a result'''
+    name = os.path.basename(r['log'])
+    if not r['ok']:
+        return "%s: FAILED %s" % (name, r.get('error', ''))
+    div = ' '.join(["%s div=%.2f/%.2fm" % (ekf, d['horizontal'], d['vertical'])
+                    for ekf, d in sorted(r['max_position_divergence'].items())])
+    switches = ' '.join(["%s switches=%u" % (ekf, n) for ekf, n in sorted(r['lane_switches'].items())])
+    return "%s: OK %.1fs %s %s" % (name, r['wall_time'], div, switches)
+
+
+if __name__ == '__main__':
+    from argparse import ArgumentParser
+    parser = ArgumentParser(description=__doc__)
+    parser.add_argument("--replay", default="build/sitl/tool/Replay", help="Replay binary")
+    parser.add_argument("-j", "--jobs", type=int, default=multiprocessing.cpu_count(), help="number of parallel replays")
+    parser.add_argument("--outdir", default=None, help="directory for Replay working directories")
+    parser.add_argument("--keep", action='store_true', help="keep output logs of successful replays")
+    parser.add_argument("--summary", default=None, help="write JSON summary to this file")
+    parser.add_argument("--parm", action='append', default=[], help="set parameter NAME=VALUE in Replay")
+    parser.add_argument("--param-file", default=None, help="load Replay parameters from a file")
+    parser.add_argument("--force-ekf2", action='store_true', help="force enable EKF2")
+    parser.add_argument("--force-ekf3", action='store_true', help="force enable EKF3")
+    parser.add_argument("logs", metavar="LOG", nargs="+", help="logs or directories of logs")
+    args = parser.parse_args()
+
+    replay = os.path.abspath(args.replay)
+    replay_args = []
+    for p in args.parm:
+        replay_args.extend(["--parm", p])
+    if args.param_file is not None:
+        replay_args.extend(["--param-file", os.path.abspath(args.param_file)])
+    if args.force_ekf2:
+        replay_args.append("--force-ekf2")
+    if args.force_ekf3:
+        replay_args.append("--force-ekf3")
+
+    logs = find_logs(args.logs)
+    if len(logs) == 0:
+        print("No logs found")
+        sys.exit(1)
+
+    outdir = args.outdir
+    if outdir is None:
+        outdir = tempfile.mkdtemp(prefix='replay-batch-')
+    elif not os.path.exists(outdir):
+        os.makedirs(outdir)
+
+    jobs = [(log, replay, replay_args, os.path.abspath(outdir), args.keep) for log in logs]
+    print("Replaying %u logs with %u jobs" % (len(logs), args.jobs))
+
+    start = time.time()
+    results = []
+    pool = multiprocessing.Pool(args.jobs)
+    try:
+        for r in pool.imap_unordered(replay_one, jobs):
+            results.append(r)
+            print("[%u/%u] %s" % (len(results), len(logs), format_summary(r)))
+    finally:
+        pool.close()
+        pool.join()
+    elapsed = time.time() - start
+
+    failed = [r for r in results if not r['ok']]
+    total_bytes = sum([r['size'] for r in results])
+    replay_time = sum([r.get('wall_time', 0) for r in results])
+    print("Replayed %u logs (%u failed) %.1fMB in %.1fs: %.2f logs/s %.1f MB/s, %.1fx speedup over serial" % (
+        len(results), len(failed), total_bytes * 1.0e-6, elapsed,
+        len(results) / elapsed, total_bytes * 1.0e-6 / elapsed,
+        replay_time / elapsed))
+
+    if args.summary is not None:
+        with open(args.summary, 'w') as f:
+            json.dump({
+                'logs': sorted(results, key=lambda r: r['log']),
+                'elapsed': elapsed,
+                'total_bytes': total_bytes,
+                'failed': len(failed),
+            }, f, indent=2)
+
+    if len(failed) != 0:
+        sys.exit(1)
+    sys.exit(0)
@@ -396,7 +396,7 @@ def write_version_header(ctx, tgt):
             print('#define {} {}'.format(k, v), file=f)
 
 @conf
-def ap_find_benchmarks(bld, use=[]):
+def ap_find_benchmarks(bld, use=[], defines=[]):
     if not bld.env.HAS_GBENCHMARK:
         return
 
@@ -417,6 +417,7 @@ def ap_find_benchmarks(bld, use=[]):
             includes=includes,
             source=[f],
             use=use,
+            defines=list(defines),
             program_name=f.change_ext('').name,
             program_groups='benchmarks',
             use_legacy_defines=False,
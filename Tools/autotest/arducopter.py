@@ -7073,6 +7073,9 @@ class AutoTestCopter(AutoTest):
             self.start_subtest("%s" % name)
             self.test_replay_bit(func)
 
+        self.start_subtest("Seek")
+        self.test_replay_seek()
+
     def test_replay_bit(self, bit):
 
         self.context_push()
@@ -7099,6 +7102,53 @@ class AutoTestCopter(AutoTest):
         if not ok:
             raise NotAchievedException("check_replay failed")
 
+    def test_replay_seek(self):
+        '''check that replaying EKF3 from a checkpoint matches a full replay'''
+        self.context_push()
+        current_log_filepath = self.test_replay_gps_bit()
+        self.context_pop()
+
+        checkpoint_filepath = util.reltopdir("replay-checkpoint.bin")
+        seek_time = 60
+        check_replay = util.load_local_module("Tools/Replay/check_replay.py")
+
+        self.progress("Writing checkpoints for (%s)" % current_log_filepath)
+        util.run_cmd(
+            ['build/sitl/tool/Replay',
+             '--checkpoint', checkpoint_filepath,
+             '--checkpoint-interval', '5',
+             current_log_filepath],
+            directory=util.topdir(),
+            checkfail=True,
+            show=True,
+            output=True,
+        )
+        if not check_replay.check_log(self.current_onboard_log_filepath(), self.progress, ekf3_only=True):
+            raise NotAchievedException("check_replay failed writing checkpoints")
+
+        self.progress("Seeking to %us in (%s)" % (seek_time, current_log_filepath))
+        util.run_cmd(
+            ['build/sitl/tool/Replay',
+             '--checkpoint', checkpoint_filepath,
+             '--seek', str(seek_time),
+             current_log_filepath],
+            directory=util.topdir(),
+            checkfail=True,
+            show=True,
+            output=True,
+        )
+        os.unlink(checkpoint_filepath)
+
+        replay_log_filepath = self.current_onboard_log_filepath()
+        self.progress("Replay log path: %s" % str(replay_log_filepath))
+        ok = check_replay.check_log(replay_log_filepath,
+                                    self.progress,
+                                    ekf3_only=True,
+                                    verbose=True,
+                                    start_time=seek_time)
+        if not ok:
+            raise NotAchievedException("check_replay failed after seek")
+
     def DefaultIntervalsFromFiles(self):
         ex = None
         intervals_filepath = util.reltopdir("message-intervals-chan0.txt")
@@ -531,6 +531,8 @@ def run_step(step):
         "logs_dir": buildlogs_dirpath(),
         "sup_binaries": supplementary_binaries,
         "reset_after_every_test": opts.reset_after_every_test,
+        "sitl_profile": opts.sitl_profile,
+        "sitl_record": opts.sitl_record,
     }
     if opts.speedup is not None:
         fly_opts["speedup"] = opts.speedup
@@ -965,7 +967,7 @@ if __name__ == "__main__":
     group_sim.add_option("--speedup",
                          default=None,
                          type='int',
-                         help='speedup to run the simulations at')
+                         help='speedup to run the simulations at, 0 to run as fast as possible')
     group_sim.add_option("--valgrind",
                          default=False,
                          action='store_true',
@@ -982,6 +984,14 @@ if __name__ == "__main__":
                          default=False,
                          action='store_true',
                          help='when running under GDB do NOT start in TUI mode')
+    group_sim.add_option("--sitl-profile",
+                         default=False,
+                         action='store_true',
+                         help='print a wall clock profile when each SITL instance exits')
+    group_sim.add_option("--sitl-record",
+                         default=False,
+                         action='store_true',
+                         help='record simulated sensor data to the buildlogs directory for replay with --replay')
     group_sim.add_option("--gdbserver",
                          default=False,
                          action='store_true',
@@ -1465,7 +1465,9 @@ class AutoTest(ABC):
                  replay=False,
                  sup_binaries=[],
                  reset_after_every_test=False,
-                 sitl_32bit=False):
+                 sitl_32bit=False,
+                 sitl_profile=False,
+                 sitl_record=False):
 
         self.start_time = time.time()
         global __autotest__ # FIXME; make progress a non-staticmethod
@@ -1491,6 +1493,9 @@ class AutoTest(ABC):
         self.sup_binaries = sup_binaries
         self.reset_after_every_test = reset_after_every_test
         self.sitl_32bit = sitl_32bit
+        self.sitl_profile = sitl_profile
+        self.sitl_record = sitl_record
+        self.sitl_record_count = 0
 
         self.mavproxy = None
         self._mavproxy = None  # for auto-cleanup on failed tests
@@ -6705,7 +6710,13 @@ Also, ignores heartbeats not from our target system'''
             "valgrind": self.valgrind,
             "callgrind": self.callgrind,
             "wipe": True,
+            "profile": self.sitl_profile,
         }
+        if self.sitl_record:
+            # SITL is restarted by some tests, keep each recording
+            self.sitl_record_count += 1
+            start_sitl_args["record"] = self.buildlogs_path("%s-sensors-%u.bin" %
+                                                            (self.vehicleinfo_key(), self.sitl_record_count))
         start_sitl_args.update(**sitl_args)
         if ("defaults_filepath" not in start_sitl_args or
                 start_sitl_args["defaults_filepath"] is None):
@@ -320,7 +320,9 @@ def start_SITL(binary,
                customisations=[],
                lldb=False,
                enable_fgview_output=False,
-               supplementary=False):
+               supplementary=False,
+               profile=False,
+               record=None):
 
     if model is None and not supplementary:
         raise ValueError("model must not be None")
@@ -414,6 +416,10 @@ def start_SITL(binary,
                 cmd.extend(['--defaults', defaults_filepath])
         if unhide_parameters:
             cmd.extend(['--unhide-groups'])
+        if profile:
+            cmd.append('--profile')
+        if record is not None:
+            cmd.extend(['--record', record])
         # somewhere for MAVProxy to connect to:
         cmd.append('--uartC=tcp:2')
         if not enable_fgview_output:
@@ -613,6 +613,33 @@ def start_antenna_tracker(opts):
     os.chdir(oldpwd)
 
 
+def start_lockstep(opts):
+    """Start the lockstep coordinator, returning the path of the shared
+    memory file the instances attach to"""
+    path = os.path.join(os.getcwd(), "lockstep.shm")
+    if os.path.exists(path):
+        os.unlink(path)
+    speedup = opts.lockstep_speedup
+    if speedup is None:
+        speedup = opts.speedup
+    cmd = [sys.executable,
+           os.path.join(autotest_dir, "sitl_lockstep.py"),
+           "--file", path,
+           "--instances", ",".join([str(i) for i in instances]),
+           "--step-us", str(opts.lockstep_step_us),
+           "--speedup", str(speedup)]
+    run_in_terminal_window("Lockstep", cmd)
+
+    # the coordinator creates the file once it is initialised
+    tstart = time.time()
+    while not os.path.exists(path):
+        if time.time() - tstart > 10:
+            print("Lockstep coordinator did not start")
+            sys.exit(1)
+        time.sleep(0.1)
+    return path
+
+
 def start_vehicle(binary, opts, stuff, spawns=None):
     """Run the ArduPilot binary"""
 
@@ -673,6 +700,8 @@ def start_vehicle(binary, opts, stuff, spawns=None):
         cmd.extend(["--sysid", str(opts.sysid)])
     if opts.slave is not None:
         cmd.extend(["--slave", str(opts.slave)])
+    if opts.lockstep:
+        cmd.extend(["--lockstep", start_lockstep(opts)])
     if opts.sitl_instance_args:
         # this could be a lot better:
         cmd.extend(opts.sitl_instance_args.split(" "))
@@ -1176,6 +1205,18 @@ group_sim.add_option("", "--slave",
                      type='int',
                      default=0,
                      help="Set the number of JSON slave")
+group_sim.add_option("", "--lockstep",
+                     action='store_true',
+                     default=False,
+                     help="advance the simulation time of all instances together from a shared clock")
+group_sim.add_option("", "--lockstep-step-us",
+                     type='int',
+                     default=2500,
+                     help="simulation time step for --lockstep in microseconds")
+group_sim.add_option("", "--lockstep-speedup",
+                     type='float',
+                     default=None,
+                     help="wall clock speedup for --lockstep, 0 to run as fast as possible (default --speedup)")
 group_sim.add_option("", "--auto-sysid",
                      default=False,
                      action='store_true',
@@ -0,0 +1,229 @@
+#!/usr/bin/env python3
+
+'''
+Lockstep coordinator for many SITL instances
+
+Creates the shared memory file used by SITL instances started with
+--lockstep FILE and advances their common simulation time in fixed
+steps. A step is granted only once every instance has reached the end
+of the previous one, so a swarm of vehicles stays in step regardless
+of how the OS schedules the processes, and the run is CPU-bound rather
+than paced by per-process wall clock sleeps.
+
+The layout of the file must match libraries/SITL/SIM_Lockstep.h
+'''
+
+from __future__ import print_function
+
+import errno
+import mmap
+import os
+import signal
+import struct
+import sys
+import time
+
+MAGIC = 0x54534b4c
+VERSION = 1
+MAX_VEHICLES = 256
+HEADER_SIZE = 64
+SLOT_SIZE = 64
+FILE_SIZE = HEADER_SIZE + MAX_VEHICLES * SLOT_SIZE
+
+# offsets of 64 bit words in the file
+STEP_END_WORD = 1
+
+
+class Lockstep(object):
+    '''shared memory lockstep clock'''
+
+    def __init__(self, path, step_us):
+        self.path = path
+        self.step_us = step_us
+
+        # build the file under a temporary name so that instances
+        # never see a partially initialised header
+        tmp = path + ".tmp"
+        with open(tmp, 'wb') as f:
+            f.write(bytearray(FILE_SIZE))
+            f.seek(0)
+            f.write(struct.pack('<IHHQII', MAGIC, VERSION, MAX_VEHICLES, 0, step_us, 0))
+        os.rename(tmp, path)
+
+        self.fd = os.open(path, os.O_RDWR)
+        self.mm = mmap.mmap(self.fd, FILE_SIZE)
+        self.words = memoryview(self.mm).cast('Q')
+        self.step_end_us = 0
+
+    def close(self):
+        self.words.release()
+        self.mm.close()
+        os.close(self.fd)
+        try:
+            os.unlink(self.path)
+        except OSError:
+            pass
+
+    def slot_offset(self, instance):
+        return HEADER_SIZE + instance * SLOT_SIZE
+
+    def wait_us(self, instance):
+        return self.words[self.slot_offset(instance) // 8]
+
+    def pid(self, instance):
+        return struct.unpack_from('<I', self.mm, self.slot_offset(instance) + 8)[0]
+
+    def wait_count(self, instance):
+        return struct.unpack_from('<I', self.mm, self.slot_offset(instance) + 12)[0]
+
+    def state(self, instance):
+        '''latest published state of an instance'''
+        (lat, lng, alt, vn, ve, vd, roll, pitch, yaw) = struct.unpack_from(
+            '<ddfffffff', self.mm, self.slot_offset(instance) + 16)
+        return {
+            'lat': lat, 'lng': lng, 'alt': alt,
+            'vel': (vn, ve, vd),
+            'roll': roll, 'pitch': pitch, 'yaw': yaw,
+        }
+
+    def set_step_end(self, step_end_us):
+        self.step_end_us = step_end_us
+        self.words[STEP_END_WORD] = step_end_us
+
+    def shutdown(self):
+        struct.pack_into('<I', self.mm, 20, 1)
+
+
+def pid_alive(pid):
+    try:
+        os.kill(pid, 0)
+    except OSError as e:
+        return e.errno == errno.EPERM
+    return True
+
+
+def run(lockstep, instances, speedup, duration, status_interval, start_timeout):
+    '''advance simulation time until all instances have exited or the
+    duration is reached'''
+    print("Lockstep: waiting for instances %s" % ' '.join([str(i) for i in instances]))
+    tstart = time.time()
+    while True:
+        missing = [i for i in instances if lockstep.pid(i) == 0]
+        if len(missing) == 0:
+            break
+        if start_timeout > 0 and time.time() - tstart > start_timeout:
+            print("Lockstep: instances %s did not start" % ' '.join([str(i) for i in missing]))
+            return False
+        time.sleep(0.01)
+
+    active = list(instances)
+    slots = [lockstep.slot_offset(i) // 8 for i in active]
+    words = lockstep.words
+    step_us = lockstep.step_us
+    step_end = step_us
+    lockstep.set_step_end(step_end)
+
+    wall_start = time.time()
+    last_progress = wall_start
+    last_status = wall_start
+    steps = 0
+    polls = 0
+
+    while len(active) > 0:
+        # a single pass over the slots; instances block once their
+        # simulation time passes step_end
+        ready = True
+        for s in slots:
+            if words[s] <= step_end:
+                ready = False
+                break
+        if not ready:
+            polls += 1
+            if polls & 0x3ff == 0:
+                now = time.time()
+                if now - last_progress > 1.0:
+                    # look for instances which have gone away
+                    dead = [i for i in active if not pid_alive(lockstep.pid(i))]
+                    for i in dead:
+                        print("Lockstep: instance %u exited" % i)
+                        active.remove(i)
+                    slots = [lockstep.slot_offset(i) // 8 for i in active]
+                    last_progress = now
+                time.sleep(0)
+            continue
+
+        step_end += step_us
+        steps += 1
+        if speedup > 0:
+            # pace simulation time against the wall clock
+            target = wall_start + step_end * 1.0e-6 / speedup
+            delay = target - time.time()
+            if delay > 0:
+                time.sleep(delay)
+        lockstep.set_step_end(step_end)
+        last_progress = time.time()
+
+        if status_interval > 0 and last_progress - last_status >= status_interval:
+            elapsed = last_progress - wall_start
+            print("Lockstep: t=%.1fs %u vehicles %.1fx realtime %.0f steps/s" % (
+                step_end * 1.0e-6, len(active), step_end * 1.0e-6 / elapsed, steps / elapsed))
+            last_status = last_progress
+
+        if duration > 0 and step_end >= duration * 1.0e6:
+            print("Lockstep: reached %.1fs" % duration)
+            break
+
+    elapsed = time.time() - wall_start
+    print("Lockstep: %.1fs simulated in %.1fs (%.1fx realtime) with %u steps" % (
+        step_end * 1.0e-6, elapsed, step_end * 1.0e-6 / max(elapsed, 1.0e-6), steps))
+    for i in instances:
+        s = lockstep.state(i)
+        print("Lockstep: instance %u waits=%u lat=%.7f lng=%.7f alt=%.2f" % (
+            i, lockstep.wait_count(i), s['lat'], s['lng'], s['alt']))
+    return True
+
+
+def parse_instances(text):
+    instances = set()
+    for x in text.replace(',', ' ').split():
+        if '-' in x:
+            (first, last) = x.split('-')
+            instances.update(range(int(first), int(last) + 1))
+        else:
+            instances.add(int(x))
+    instances = sorted(instances)
+    for i in instances:
+        if i < 0 or i >= MAX_VEHICLES:
+            raise ValueError("instance %d out of range" % i)
+    return instances
+
+
+if __name__ == '__main__':
+    from argparse import ArgumentParser
+    parser = ArgumentParser(description=__doc__)
+    parser.add_argument("--file", required=True, help="shared memory file to create")
+    parser.add_argument("--instances", default="0", help="instances to coordinate, e.g. 0-49 or 0,2,4")
+    parser.add_argument("--step-us", type=int, default=2500, help="simulation time step in microseconds")
+    parser.add_argument("--speedup", type=float, default=0, help="pace against the wall clock at this speedup, 0 for as fast as possible")
+    parser.add_argument("--duration", type=float, default=0, help="stop all instances after this many simulated seconds")
+    parser.add_argument("--status-interval", type=float, default=10, help="wall clock seconds between status lines")
+    parser.add_argument("--start-timeout", type=float, default=60, help="seconds to wait for all instances to start")
+    args = parser.parse_args()
+
+    instances = parse_instances(args.instances)
+    lockstep = Lockstep(args.file, args.step_us)
+
+    def sig_handler(signum, frame):
+        lockstep.shutdown()
+        sys.exit(1)
+    signal.signal(signal.SIGTERM, sig_handler)
+
+    ok = False
+    try:
+        ok = run(lockstep, instances, args.speedup, args.duration, args.status_interval, args.start_timeout)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        lockstep.shutdown()
+        lockstep.close()
+    sys.exit(0 if ok else 1)
@@ -75,6 +75,10 @@ public:
     // run lowest level body-frame rate controller and send outputs to the motors
     void rate_controller_run() override;
 
+    // run the rate controller on a gyro sample, dt is the time since the last run.
+    // Used when the rate controller runs at the gyro rate in its own thread
+    virtual void rate_controller_run_dt(const Vector3f& gyro, float dt);
+
     // sanity check parameters.  should be called once before take-off
     void parameter_sanity_check() override;
 
@@ -84,7 +88,7 @@ public:
 protected:
 
     // update_throttle_rpy_mix - updates thr_low_comp value towards the target
-    void update_throttle_rpy_mix();
+    void update_throttle_rpy_mix(float dt);
 
     // get maximum value throttle can be raised to based on throttle vs attitude prioritisation
     float get_throttle_avg_max(float throttle_in);
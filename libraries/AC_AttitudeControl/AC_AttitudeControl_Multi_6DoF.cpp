@@ -9,7 +9,7 @@
 // rate commands result in the vehicle behaving as a ordinary copter.
 
 // run lowest level body-frame rate controller and send outputs to the motors
-void AC_AttitudeControl_Multi_6DoF::rate_controller_run() {
+void AC_AttitudeControl_Multi_6DoF::rate_controller_run_dt(const Vector3f& gyro, float dt) {
 
     // pass current offsets to motors and run baseclass controller
     // motors require the offsets to know which way is up
@@ -25,7 +25,7 @@ void AC_AttitudeControl_Multi_6DoF::rate_controller_run() {
     }
     _motors.set_roll_pitch(roll_deg,pitch_deg);
 
-    AC_AttitudeControl_Multi::rate_controller_run();
+    AC_AttitudeControl_Multi::rate_controller_run_dt(gyro, dt);
 }
 
 /*
@@ -35,6 +35,21 @@ extern const AP_HAL::HAL& hal;
     #define AP_OADATABASE_DISTANCE_FROM_HOME 3
 #endif
 
+// size in meters of the horizontal grid cells used to hash database items
+#ifndef AP_OADATABASE_HASH_CELL_SIZE
+    #define AP_OADATABASE_HASH_CELL_SIZE 1.0f
+#endif
+
+// maximum number of cells searched either side of an item before falling
+// back to a linear scan of the database
+#define AP_OADATABASE_HASH_SPAN_MAX 4
+
+// number of items popped from the queue per semaphore take
+#define AP_OADATABASE_QUEUE_BATCH 10
+
+// marks the end of a hash bucket chain
+#define AP_OADATABASE_HASH_NONE UINT16_MAX
+
 const AP_Param::GroupInfo AP_OADatabase::var_info[] = {
 
     // @Param: SIZE
@@ -127,6 +142,8 @@ void AP_OADatabase::init()
         gcs().send_text(MAV_SEVERITY_INFO, "DB init failed . Sizes queue:%u, db:%u", (unsigned int)_queue.size, (unsigned int)_database.size);
         delete _queue.items;
         delete[] _database.items;
+        delete[] _hash.head;
+        delete[] _hash.next;
         return;
     }
 }
@@ -198,6 +215,64 @@ void AP_OADatabase::init_database()
     }
 
     _database.items = new OA_DbItem[_database.size];
+    init_hash();
+}
+
+// allocate a power of two number of hash buckets at least as large as the database
+void AP_OADatabase::init_hash()
+{
+    _hash.num_buckets = 16;
+    while (_hash.num_buckets < _database.size && _hash.num_buckets < 0x8000) {
+        _hash.num_buckets <<= 1;
+    }
+    _hash.head = new uint16_t[_hash.num_buckets];
+    _hash.next = new uint16_t[_database.size];
+    if (_hash.head == nullptr || _hash.next == nullptr) {
+        delete[] _hash.head;
+        delete[] _hash.next;
+        _hash.head = nullptr;
+        _hash.next = nullptr;
+        return;
+    }
+    for (uint16_t i=0; i<_hash.num_buckets; i++) {
+        _hash.head[i] = AP_OADATABASE_HASH_NONE;
+    }
+}
+
+// return the grid cell holding a horizontal position coordinate
+int32_t AP_OADatabase::hash_cell(const float pos) const
+{
+    return (int32_t)floorf(pos * (1.0f / AP_OADATABASE_HASH_CELL_SIZE));
+}
+
+// return the bucket for a grid cell
+uint16_t AP_OADatabase::hash_bucket(const int32_t cell_x, const int32_t cell_y) const
+{
+    const uint32_t h = ((uint32_t)cell_x * 73856093U) ^ ((uint32_t)cell_y * 19349663U);
+    return h & (_hash.num_buckets - 1);
+}
+
+// add database item "index" to the front of its bucket
+void AP_OADatabase::hash_insert(const uint16_t index)
+{
+    const Vector3f &pos = _database.items[index].pos;
+    const uint16_t bucket = hash_bucket(hash_cell(pos.x), hash_cell(pos.y));
+    _hash.next[index] = _hash.head[bucket];
+    _hash.head[bucket] = index;
+}
+
+// unlink database item "index" from its bucket
+void AP_OADatabase::hash_remove(const uint16_t index)
+{
+    const Vector3f &pos = _database.items[index].pos;
+    uint16_t *link = &_hash.head[hash_bucket(hash_cell(pos.x), hash_cell(pos.y))];
+    while (*link != AP_OADATABASE_HASH_NONE) {
+        if (*link == index) {
+            *link = _hash.next[index];
+            return;
+        }
+        link = &_hash.next[*link];
+    }
 }
 
 // get bitmask of gcs channels item should be sent to based on its importance
@@ -243,33 +318,32 @@ bool AP_OADatabase::process_queue()
         return false;
     }
 
-    for (uint16_t queue_index=0; queue_index<queue_available; queue_index++) {
-        OA_DbItem item;
-
-        bool pop_success;
+    uint16_t queue_index = 0;
+    while (queue_index < queue_available) {
+        // take a batch of items with a single semaphore take
+        OA_DbItem items[AP_OADATABASE_QUEUE_BATCH];
+        uint32_t num_popped;
         {
             WITH_SEMAPHORE(_queue.sem);
-            pop_success = _queue.items->pop(item);
+            num_popped = _queue.items->pop(items, MIN(queue_available - queue_index, AP_OADATABASE_QUEUE_BATCH));
         }
-        if (!pop_success) {
+        if (num_popped == 0) {
             return false;
         }
+        queue_index += num_popped;
 
-        item.send_to_gcs = get_send_to_gcs_flags(item.importance);
+        for (uint8_t b=0; b<num_popped; b++) {
+            OA_DbItem &item = items[b];
+            item.send_to_gcs = get_send_to_gcs_flags(item.importance);
 
-        // compare item to all items in database. If found a similar item, update the existing, else add it as a new one
-        bool found = false;
-        for (uint16_t i=0; i<_database.count; i++) {
-            if (is_close_to_item_in_database(i, item)) {
+            // look for a similar item in database. If found, update the existing, else add it as a new one
+            const int32_t i = find_close_item_in_database(item);
+            if (i >= 0) {
                 database_item_refresh(i, item.timestamp_ms, item.radius);
-                found = true;
-                break;
+            } else {
+                database_item_add(item);
             }
         }
-
-        if (!found) {
-            database_item_add(item);
-        }
     }
     return (_queue.items->available() > 0);
 }
@@ -281,6 +355,8 @@ void AP_OADatabase::database_item_add(const OA_DbItem &item)
     }
     _database.items[_database.count] = item;
     _database.items[_database.count].send_to_gcs = get_send_to_gcs_flags(_database.items[_database.count].importance);
+    _database.radius_max = MAX(_database.radius_max, item.radius);
+    hash_insert(_database.count);
     _database.count++;
 }
 
@@ -291,6 +367,8 @@ void AP_OADatabase::database_item_remove(const uint16_t index)
         return;
     }
 
+    hash_remove(index);
+
     // radius of 0 tells the GCS we don't care about it any more (aka it expired)
     _database.items[index].radius = 0;
     _database.items[index].send_to_gcs = get_send_to_gcs_flags(_database.items[index].importance);
@@ -302,8 +380,10 @@ void AP_OADatabase::database_item_remove(const uint16_t index)
 
     if (index != _database.count) {
         // copy last object in array over expired object
+        hash_remove(_database.count);
         _database.items[index] = _database.items[_database.count];
         _database.items[index].send_to_gcs = get_send_to_gcs_flags(_database.items[index].importance);
+        hash_insert(index);
     }
 }
 
@@ -323,6 +403,7 @@ void AP_OADatabase::database_item_refresh(const uint16_t index, const uint32_t t
         // and trigger resending to GCS
         _database.items[index].timestamp_ms = timestamp_ms;
         _database.items[index].radius = radius;
+        _database.radius_max = MAX(_database.radius_max, radius);
         _database.items[index].send_to_gcs = get_send_to_gcs_flags(_database.items[index].importance);
     }
 }
@@ -340,13 +421,17 @@ void AP_OADatabase::database_items_remove_all_expired()
     const uint32_t now_ms = AP_HAL::millis();
     const uint32_t expiry_ms = (uint32_t)_database_expiry_seconds * 1000;
     uint16_t index = 0;
+    float radius_max = 0;
     while (index < _database.count) {
         if (now_ms - _database.items[index].timestamp_ms > expiry_ms) {
             database_item_remove(index);
         } else {
+            // tighten the search radius bound while we are here
+            radius_max = MAX(radius_max, _database.items[index].radius);
             index++;
         }
     }
+    _database.radius_max = radius_max;
 }
 
 // returns true if a similar object already exists in database. When true, the object timer is also reset
@@ -361,6 +446,38 @@ bool AP_OADatabase::is_close_to_item_in_database(const uint16_t index, const OA_
     return ((distance_sq < sq(item.radius)) || (distance_sq < sq(_database.items[index].radius)));
 }
 
+// returns index of the lowest numbered database item close to "item", or -1 if none.
+// Only grid cells within reach of the largest object radius are searched, which
+// gives the same answer as checking every item in index order
+int32_t AP_OADatabase::find_close_item_in_database(const OA_DbItem &item) const
+{
+    const float search_radius = MAX(item.radius, _database.radius_max);
+    const int32_t span = (int32_t)ceilf(search_radius * (1.0f / AP_OADATABASE_HASH_CELL_SIZE));
+    if ((span > AP_OADATABASE_HASH_SPAN_MAX) || (sq(2 * span + 1) >= _database.count)) {
+        // the search area is large compared to the database, check every item
+        for (uint16_t i=0; i<_database.count; i++) {
+            if (is_close_to_item_in_database(i, item)) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    int32_t found = -1;
+    const int32_t cell_x = hash_cell(item.pos.x);
+    const int32_t cell_y = hash_cell(item.pos.y);
+    for (int32_t x = cell_x - span; x <= cell_x + span; x++) {
+        for (int32_t y = cell_y - span; y <= cell_y + span; y++) {
+            for (uint16_t i = _hash.head[hash_bucket(x, y)]; i != AP_OADATABASE_HASH_NONE; i = _hash.next[i]) {
+                if (((found < 0) || (i < found)) && is_close_to_item_in_database(i, item)) {
+                    found = i;
+                }
+            }
+        }
+    }
+    return found;
+}
+
 // send ADSB_VEHICLE mavlink messages
 void AP_OADatabase::send_adsb_vehicle(mavlink_channel_t chan, uint16_t interval_ms)
 {
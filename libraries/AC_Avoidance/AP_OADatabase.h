@@ -38,7 +38,7 @@ public:
     void queue_push(const Vector3f &pos, uint32_t timestamp_ms, float distance);
 
     // returns true if database is healthy
-    bool healthy() const { return (_queue.items != nullptr) && (_database.items != nullptr); }
+    bool healthy() const { return (_queue.items != nullptr) && (_database.items != nullptr) && (_hash.head != nullptr); }
 
     // fetch an item in database. Undefined result when i >= _database.count.
     const OA_DbItem& get_item(uint32_t i) const { return _database.items[i]; }
@@ -73,6 +73,16 @@ private:
     // returns true if database item "index" is close to "item"
     bool is_close_to_item_in_database(const uint16_t index, const OA_DbItem &item) const;
 
+    // returns index of the lowest numbered database item close to "item", or -1 if none
+    int32_t find_close_item_in_database(const OA_DbItem &item) const;
+
+    // spatial hash of database items on a horizontal grid for fast neighbour lookup
+    void init_hash();
+    int32_t hash_cell(const float pos) const;
+    uint16_t hash_bucket(const int32_t cell_x, const int32_t cell_y) const;
+    void hash_insert(const uint16_t index);
+    void hash_remove(const uint16_t index);
+
     // enum for use with _OUTPUT parameter
     enum class OA_DbOutputLevel {
         OUTPUT_LEVEL_DISABLED = 0,
@@ -102,8 +112,15 @@ private:
         OA_DbItem       *items;                             // array of objects in the database
         uint16_t        count;                              // number of objects in the items array
         uint16_t        size;                               // cached value of _database_size_param that sticks after initialized
+        float           radius_max;                         // upper bound on the radius of any object in the items array
     } _database;
 
+    struct {
+        uint16_t        *head;                              // index of first item in each bucket
+        uint16_t        *next;                              // index of next item in the same bucket, one entry per database item
+        uint16_t        num_buckets;                        // number of buckets, always a power of two
+    } _hash;
+
     uint16_t _next_index_to_send[MAVLINK_COMM_NUM_BUFFERS]; // index of next object in _database to send to GCS
     uint16_t _highest_index_sent[MAVLINK_COMM_NUM_BUFFERS]; // highest index in _database sent to GCS
     uint32_t _last_send_to_gcs_ms[MAVLINK_COMM_NUM_BUFFERS];// system time that send_adsb_vehicle was last called
@@ -0,0 +1,93 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AC_Avoidance/AP_OADatabase.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  RPLidar-like scan of a 20m x 14m room with four 0.6m pillars, taken
+  from a vehicle moving slowly across the room. Each scan is 360
+  points at one degree resolution
+ */
+#define SCAN_POINTS 360
+
+static float ray_to_box(const Vector2f &origin, const Vector2f &dir, float half_x, float half_y)
+{
+    float t = FLT_MAX;
+    if (!is_zero(dir.x)) {
+        t = MIN(t, ((dir.x > 0 ? half_x : -half_x) - origin.x) / dir.x);
+    }
+    if (!is_zero(dir.y)) {
+        t = MIN(t, ((dir.y > 0 ? half_y : -half_y) - origin.y) / dir.y);
+    }
+    return t;
+}
+
+static float ray_to_circle(const Vector2f &origin, const Vector2f &dir, const Vector2f &centre, float radius)
+{
+    const Vector2f oc = origin - centre;
+    const float b = oc * dir;
+    const float c = oc.length_squared() - sq(radius);
+    const float disc = sq(b) - c;
+    if (disc < 0) {
+        return FLT_MAX;
+    }
+    const float t = -b - sqrtf(disc);
+    return t > 0 ? t : FLT_MAX;
+}
+
+static void make_scan(uint16_t scan_num, Vector3f *points, float *distances)
+{
+    static const Vector2f pillars[] = {
+        {-5, -3}, {-5, 3}, {5, -3}, {5, 3}
+    };
+    const Vector2f origin(-8.0f + 0.05f * (scan_num % 320), 0.5f * sinf(scan_num * 0.02f));
+    for (uint16_t i = 0; i < SCAN_POINTS; i++) {
+        const float angle = radians(i + 0.3f * (scan_num % 3));
+        const Vector2f dir(cosf(angle), sinf(angle));
+        float t = ray_to_box(origin, dir, 10.0f, 7.0f);
+        for (const Vector2f &p : pillars) {
+            t = MIN(t, ray_to_circle(origin, dir, p, 0.3f));
+        }
+        const Vector2f hit = origin + dir * t;
+        points[i] = Vector3f(hit.x, hit.y, -1.0f);
+        distances[i] = t;
+    }
+}
+
+/*
+  push scans through the queue and into the database. state.range_x()
+  is the database size
+ */
+static void BM_OADatabaseScans(benchmark::State& state)
+{
+    AP_OADatabase db;
+    AP_Param::set_object_value(&db, AP_OADatabase::var_info, "SIZE", state.range_x());
+    AP_Param::set_object_value(&db, AP_OADatabase::var_info, "QUEUE_SIZE", SCAN_POINTS);
+    AP_Param::set_object_value(&db, AP_OADatabase::var_info, "BEAM_WIDTH", 1.0f);
+    AP_Param::set_object_value(&db, AP_OADatabase::var_info, "EXPIRE", 0);
+    db.init();
+
+    Vector3f points[SCAN_POINTS];
+    float distances[SCAN_POINTS];
+    uint16_t scan_num = 0;
+    uint64_t points_pushed = 0;
+
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        make_scan(scan_num++, points, distances);
+        state.ResumeTiming();
+        for (uint16_t i = 0; i < SCAN_POINTS; i++) {
+            db.queue_push(points[i], 0, distances[i]);
+        }
+        while (db.process_queue()) {
+        }
+        points_pushed += SCAN_POINTS;
+    }
+    state.SetItemsProcessed(points_pushed);
+}
+
+BENCHMARK(BM_OADatabaseScans)->Arg(100)->Arg(1000)->Arg(5000);
+
+BENCHMARK_MAIN();
@@ -4,6 +4,7 @@
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
 
 #include "AP_Baro_SITL.h"
+#include <SITL/SIM_SensorRecord.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -72,6 +73,10 @@ void AP_Baro_SITL::_timer()
     // add baro glitch
     sim_alt += _sitl->baro[_instance].glitch;
 
+#if HAL_SIM_SENSOR_RECORD_ENABLED
+    AP::sim_record().sample(SITL::SensorRecord::Type::BARO, _instance, sim_alt);
+#endif
+
     // add delay
     uint32_t best_time_delta = 200;  // initialise large time representing buffer entry closest to current time - delay.
     uint8_t best_index = 0;  // initialise number representing the index of the entry in buffer closest to delay.
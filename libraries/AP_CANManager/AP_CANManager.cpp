@@ -117,7 +117,7 @@ void AP_CANManager::init()
 
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
     if (AP::sitl() != nullptr) {
-        if (AP::sitl()->speedup > 1) {
+        if (AP::sitl()->speedup > 1 || is_zero(AP::sitl()->speedup)) {
             log_text(AP_CANManager::LOG_ERROR, LOG_TAG, "CAN is not supported under speedup.");
 
             return;
@@ -3,6 +3,8 @@
 #include <AP_HAL/AP_HAL.h>
 
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+#include <SITL/SIM_SensorRecord.h>
+
 extern const AP_HAL::HAL& hal;
 
 AP_Compass_SITL::AP_Compass_SITL()
@@ -90,6 +92,9 @@ void AP_Compass_SITL::_timer()
     // units are milli-Gauss
     Vector3f noise = rand_vec3f() * _sitl->mag_noise;
     Vector3f new_mag_data = _sitl->state.bodyMagField + noise;
+#if HAL_SIM_SENSOR_RECORD_ENABLED
+    AP::sim_record().sample(SITL::SensorRecord::Type::COMPASS, 0, new_mag_data);
+#endif
 
     // add delay
     uint32_t best_time_delta = 1000; // initialise large time representing buffer entry closest to current time - delay.
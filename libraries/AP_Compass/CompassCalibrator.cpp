@@ -555,12 +555,7 @@ bool CompassCalibrator::accept_sample(const CompassSample& sample, uint16_t skip
 
 float CompassCalibrator::calc_residual(const Vector3f& sample, const param_t& params) const
 {
-    Matrix3f softiron(
-        params.diag.x    , params.offdiag.x , params.offdiag.y,
-        params.offdiag.x , params.diag.y    , params.offdiag.z,
-        params.offdiag.y , params.offdiag.z , params.diag.z
-    );
-    return params.radius - (softiron*(sample+params.offset)).length();
+    return params.radius - (params.get_softiron()*(sample+params.offset)).length();
 }
 
 // calc the fitness given a set of parameters (offsets, diagonals, off diagonals)
@@ -569,10 +564,11 @@ float CompassCalibrator::calc_mean_squared_residuals(const param_t& params) cons
     if (_sample_buffer == nullptr || _samples_collected == 0) {
         return 1.0e30f;
     }
+    const Matrix3f softiron = params.get_softiron();
     float sum = 0.0f;
     for (uint16_t i=0; i < _samples_collected; i++) {
-        Vector3f sample = _sample_buffer[i].get();
-        float resid = calc_residual(sample, params);
+        const Vector3f sample = _sample_buffer[i].get();
+        float resid = params.radius - (softiron*(sample+params.offset)).length();
         sum += sq(resid);
     }
     sum /= _samples_collected;
@@ -590,38 +586,85 @@ void CompassCalibrator::calc_initial_offset()
     _params.offset /= _samples_collected;
 }
 
-void CompassCalibrator::calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const
+/*
+  accumulate the normal equations J^T.J and J^T.F over all samples in
+  a single pass for either the sphere (radius, offsets) or the
+  ellipsoid (offsets, diagonals, off-diagonals) model.
+
+  The soft-iron matrix is built once per pass and the residual shares
+  the transformed sample with the Jacobian. J^T.J is symmetric so only
+  the upper triangle is accumulated and then mirrored
+ */
+void CompassCalibrator::calc_normal_equations(const param_t& params, bool ellipsoid, float* JTJ, float* JTFI) const
 {
-    const Vector3f &offset = params.offset;
-    const Vector3f &diag = params.diag;
-    const Vector3f &offdiag = params.offdiag;
-    Matrix3f softiron(
-        diag.x    , offdiag.x , offdiag.y,
-        offdiag.x , diag.y    , offdiag.z,
-        offdiag.y , offdiag.z , diag.z
-    );
-
-    float A =  (diag.x    * (sample.x + offset.x)) + (offdiag.x * (sample.y + offset.y)) + (offdiag.y * (sample.z + offset.z));
-    float B =  (offdiag.x * (sample.x + offset.x)) + (diag.y    * (sample.y + offset.y)) + (offdiag.z * (sample.z + offset.z));
-    float C =  (offdiag.y * (sample.x + offset.x)) + (offdiag.z * (sample.y + offset.y)) + (diag.z    * (sample.z + offset.z));
-    float length = (softiron*(sample+offset)).length();
-
-    // 0: partial derivative (radius wrt fitness fn) fn operated on sample
-    ret[0] = 1.0f;
-    // 1-3: partial derivative (offsets wrt fitness fn) fn operated on sample
-    ret[1] = -1.0f * (((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C))/length);
-    ret[2] = -1.0f * (((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C))/length);
-    ret[3] = -1.0f * (((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C))/length);
+    const uint8_t n = ellipsoid ? COMPASS_CAL_NUM_ELLIPSOID_PARAMS : COMPASS_CAL_NUM_SPHERE_PARAMS;
+    const Matrix3f softiron = params.get_softiron();
+
+    memset(JTJ, 0, sizeof(float)*n*n);
+    memset(JTFI, 0, sizeof(float)*n);
+
+    for (uint16_t k = 0; k < _samples_collected; k++) {
+        // sample with offsets applied, and its soft-iron corrected value
+        const Vector3f v = _sample_buffer[k].get() + params.offset;
+        const Vector3f c = softiron * v;
+        const float length = c.length();
+        const float inv_length = 1.0f / length;
+        const float residual = params.radius - length;
+
+        // partial derivative of the offsets wrt fitness fn, common to both models
+        const Vector3f d_ofs = (softiron * c) * -inv_length;
+
+        float jacob[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+        if (ellipsoid) {
+            // 0-2: offsets
+            jacob[0] = d_ofs.x;
+            jacob[1] = d_ofs.y;
+            jacob[2] = d_ofs.z;
+            // 3-5: diagonals
+            jacob[3] = -(v.x * c.x) * inv_length;
+            jacob[4] = -(v.y * c.y) * inv_length;
+            jacob[5] = -(v.z * c.z) * inv_length;
+            // 6-8: off-diagonals
+            jacob[6] = -((v.y * c.x) + (v.x * c.y)) * inv_length;
+            jacob[7] = -((v.z * c.x) + (v.x * c.z)) * inv_length;
+            jacob[8] = -((v.z * c.y) + (v.y * c.z)) * inv_length;
+        } else {
+            // 0: radius, 1-3: offsets
+            jacob[0] = 1.0f;
+            jacob[1] = d_ofs.x;
+            jacob[2] = d_ofs.y;
+            jacob[3] = d_ofs.z;
+        }
+
+        for (uint8_t i = 0; i < n; i++) {
+            for (uint8_t j = i; j < n; j++) {
+                JTJ[i*n+j] += jacob[i] * jacob[j];
+            }
+            JTFI[i] += jacob[i] * residual;
+        }
+    }
+
+    // mirror the upper triangle
+    for (uint8_t i = 1; i < n; i++) {
+        for (uint8_t j = 0; j < i; j++) {
+            JTJ[i*n+j] = JTJ[j*n+i];
+        }
+    }
 }
 
-// run sphere fit to calculate diagonals and offdiagonals
-void CompassCalibrator::run_sphere_fit()
+/*
+  run one Levenberg-Marquardt step, trying both the current lambda and
+  lambda/damping, and keep whichever improves the fitness. Returns
+  true if the parameters were updated
+ */
+bool CompassCalibrator::run_lm_step(bool ellipsoid, float &lambda)
 {
     if (_sample_buffer == nullptr) {
-        return;
+        return false;
     }
 
     const float lma_damping = 10.0f;
+    const uint8_t n = ellipsoid ? COMPASS_CAL_NUM_ELLIPSOID_PARAMS : COMPASS_CAL_NUM_SPHERE_PARAMS;
 
     // take backup of fitness and parameters so we can determine later if this fit has improved the calibration
     float fitness = _fitness;
@@ -629,50 +672,39 @@ void CompassCalibrator::run_sphere_fit()
     param_t fit1_params, fit2_params;
     fit1_params = fit2_params = _params;
 
-    float JTJ[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
-    float JTJ2[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
-    float JTFI[COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
+    float JTJ[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+    float JTJ2[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+    float JTFI[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+    float delta1[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+    float delta2[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
 
     // Gauss Newton Part common for all kind of extensions including LM
-    for (uint16_t k = 0; k<_samples_collected; k++) {
-        Vector3f sample = _sample_buffer[k].get();
-
-        float sphere_jacob[COMPASS_CAL_NUM_SPHERE_PARAMS];
-
-        calc_sphere_jacob(sample, fit1_params, sphere_jacob);
-
-        for (uint8_t i = 0;i < COMPASS_CAL_NUM_SPHERE_PARAMS; i++) {
-            // compute JTJ
-            for (uint8_t j = 0; j < COMPASS_CAL_NUM_SPHERE_PARAMS; j++) {
-                JTJ[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];   //a backup JTJ for LM
-            }
-            // compute JTFI
-            JTFI[i] += sphere_jacob[i] * calc_residual(sample, fit1_params);
-        }
-    }
+    calc_normal_equations(fit1_params, ellipsoid, JTJ, JTFI);
+    memcpy(JTJ2, JTJ, sizeof(float)*n*n);   // a backup JTJ for LM
 
     //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
     // refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
-    for (uint8_t i = 0; i < COMPASS_CAL_NUM_SPHERE_PARAMS; i++) {
-        JTJ[i*COMPASS_CAL_NUM_SPHERE_PARAMS+i] += _sphere_lambda;
-        JTJ2[i*COMPASS_CAL_NUM_SPHERE_PARAMS+i] += _sphere_lambda/lma_damping;
+    for (uint8_t i = 0; i < n; i++) {
+        JTJ[i*n+i] += lambda;
+        JTJ2[i*n+i] += lambda/lma_damping;
     }
 
-    if (!mat_inverse(JTJ, JTJ, 4)) {
-        return;
+    // the damped normal equations are symmetric positive definite, so
+    // solve them directly rather than forming the inverse
+    if (!mat_ldlt_solve(JTJ, JTFI, delta1, n)) {
+        return false;
     }
 
-    if (!mat_inverse(JTJ2, JTJ2, 4)) {
-        return;
+    if (!mat_ldlt_solve(JTJ2, JTFI, delta2, n)) {
+        return false;
     }
 
     // extract radius, offset, diagonals and offdiagonal parameters
-    for (uint8_t row=0; row < COMPASS_CAL_NUM_SPHERE_PARAMS; row++) {
-        for (uint8_t col=0; col < COMPASS_CAL_NUM_SPHERE_PARAMS; col++) {
-            fit1_params.get_sphere_params()[row] -= JTFI[col] * JTJ[row*COMPASS_CAL_NUM_SPHERE_PARAMS+col];
-            fit2_params.get_sphere_params()[row] -= JTFI[col] * JTJ2[row*COMPASS_CAL_NUM_SPHERE_PARAMS+col];
-        }
+    float *p1 = ellipsoid ? fit1_params.get_ellipsoid_params() : fit1_params.get_sphere_params();
+    float *p2 = ellipsoid ? fit2_params.get_ellipsoid_params() : fit2_params.get_sphere_params();
+    for (uint8_t row=0; row < n; row++) {
+        p1[row] -= delta1[row];
+        p2[row] -= delta2[row];
     }
 
     // calculate fitness of two possible sets of parameters
@@ -682,10 +714,10 @@ void CompassCalibrator::run_sphere_fit()
     // decide which of the two sets of parameters is best and store in fit1_params
     if (fit1 > _fitness && fit2 > _fitness) {
         // if neither set of parameters provided better results, increase lambda
-        _sphere_lambda *= lma_damping;
+        lambda *= lma_damping;
     } else if (fit2 < _fitness && fit2 < fit1) {
         // if fit2 was better we will use it. decrease lambda
-        _sphere_lambda /= lma_damping;
+        lambda /= lma_damping;
         fit1_params = fit2_params;
         fitness = fit2;
     } else if (fit1 < _fitness) {
@@ -698,123 +730,46 @@ void CompassCalibrator::run_sphere_fit()
         _fitness = fitness;
         _params = fit1_params;
         update_completion_mask();
+        return true;
     }
+    return false;
 }
 
-void CompassCalibrator::calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const
+// run sphere fit to calculate radius and offsets
+void CompassCalibrator::run_sphere_fit()
 {
-    const Vector3f &offset = params.offset;
-    const Vector3f &diag = params.diag;
-    const Vector3f &offdiag = params.offdiag;
-    Matrix3f softiron(
-        diag.x    , offdiag.x , offdiag.y,
-        offdiag.x , diag.y    , offdiag.z,
-        offdiag.y , offdiag.z , diag.z
-    );
-
-    float A =  (diag.x    * (sample.x + offset.x)) + (offdiag.x * (sample.y + offset.y)) + (offdiag.y * (sample.z + offset.z));
-    float B =  (offdiag.x * (sample.x + offset.x)) + (diag.y    * (sample.y + offset.y)) + (offdiag.z * (sample.z + offset.z));
-    float C =  (offdiag.y * (sample.x + offset.x)) + (offdiag.z * (sample.y + offset.y)) + (diag.z    * (sample.z + offset.z));
-    float length = (softiron*(sample+offset)).length();
-
-    // 0-2: partial derivative (offset wrt fitness fn) fn operated on sample
-    ret[0] = -1.0f * (((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C))/length);
-    ret[1] = -1.0f * (((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C))/length);
-    ret[2] = -1.0f * (((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C))/length);
-    // 3-5: partial derivative (diag offset wrt fitness fn) fn operated on sample
-    ret[3] = -1.0f * ((sample.x + offset.x) * A)/length;
-    ret[4] = -1.0f * ((sample.y + offset.y) * B)/length;
-    ret[5] = -1.0f * ((sample.z + offset.z) * C)/length;
-    // 6-8: partial derivative (off-diag offset wrt fitness fn) fn operated on sample
-    ret[6] = -1.0f * (((sample.y + offset.y) * A) + ((sample.x + offset.x) * B))/length;
-    ret[7] = -1.0f * (((sample.z + offset.z) * A) + ((sample.x + offset.x) * C))/length;
-    ret[8] = -1.0f * (((sample.z + offset.z) * B) + ((sample.y + offset.y) * C))/length;
+    run_lm_step(false, _sphere_lambda);
 }
 
+// run ellipsoid fit to calculate offsets, diagonals and offdiagonals
 void CompassCalibrator::run_ellipsoid_fit()
 {
-    if (_sample_buffer == nullptr) {
-        return;
-    }
-
-    const float lma_damping = 10.0f;
-
-    // take backup of fitness and parameters so we can determine later if this fit has improved the calibration
-    float fitness = _fitness;
-    float fit1, fit2;
-    param_t fit1_params, fit2_params;
-    fit1_params = fit2_params = _params;
-
-    float JTJ[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
-    float JTJ2[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
-    float JTFI[COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
-
-    // Gauss Newton Part common for all kind of extensions including LM
-    for (uint16_t k = 0; k<_samples_collected; k++) {
-        Vector3f sample = _sample_buffer[k].get();
-
-        float ellipsoid_jacob[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
-
-        calc_ellipsoid_jacob(sample, fit1_params, ellipsoid_jacob);
-
-        for (uint8_t i = 0;i < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; i++) {
-            // compute JTJ
-            for (uint8_t j = 0; j < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; j++) {
-                JTJ [i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
-            }
-            // compute JTFI
-            JTFI[i] += ellipsoid_jacob[i] * calc_residual(sample, fit1_params);
-        }
-    }
-
-    //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
-    //refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
-    for (uint8_t i = 0; i < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; i++) {
-        JTJ[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+i] += _ellipsoid_lambda;
-        JTJ2[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+i] += _ellipsoid_lambda/lma_damping;
-    }
-
-    if (!mat_inverse(JTJ, JTJ, 9)) {
-        return;
-    }
+    run_lm_step(true, _ellipsoid_lambda);
+}
 
-    if (!mat_inverse(JTJ2, JTJ2, 9)) {
-        return;
+/*
+  load a set of samples and reset the fit state, bypassing sample
+  collection. Used by the benchmarks to drive the fitter offline
+ */
+bool CompassCalibrator::load_fit_samples(const Vector3f *samples, uint16_t count)
+{
+    if (count == 0 || count > COMPASS_CAL_NUM_SAMPLES) {
+        return false;
     }
-
-    // extract radius, offset, diagonals and offdiagonal parameters
-    for (uint8_t row=0; row < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; row++) {
-        for (uint8_t col=0; col < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; col++) {
-            fit1_params.get_ellipsoid_params()[row] -= JTFI[col] * JTJ[row*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+col];
-            fit2_params.get_ellipsoid_params()[row] -= JTFI[col] * JTJ2[row*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+col];
+    reset_state();
+    if (_sample_buffer == nullptr) {
+        _sample_buffer = (CompassSample*)calloc(COMPASS_CAL_NUM_SAMPLES, sizeof(CompassSample));
+        if (_sample_buffer == nullptr) {
+            return false;
         }
     }
-
-    // calculate fitness of two possible sets of parameters
-    fit1 = calc_mean_squared_residuals(fit1_params);
-    fit2 = calc_mean_squared_residuals(fit2_params);
-
-    // decide which of the two sets of parameters is best and store in fit1_params
-    if (fit1 > _fitness && fit2 > _fitness) {
-        // if neither set of parameters provided better results, increase lambda
-        _ellipsoid_lambda *= lma_damping;
-    } else if (fit2 < _fitness && fit2 < fit1) {
-        // if fit2 was better we will use it. decrease lambda
-        _ellipsoid_lambda /= lma_damping;
-        fit1_params = fit2_params;
-        fitness = fit2;
-    } else if (fit1 < _fitness) {
-        fitness = fit1;
-    }
-    //--------------------Levenberg-part-ends-here--------------------------------//
-
-    // store new parameters and update fitness
-    if (fitness < _fitness) {
-        _fitness = fitness;
-        _params = fit1_params;
-        update_completion_mask();
+    for (uint16_t i = 0; i < count; i++) {
+        _sample_buffer[i].set(samples[i]);
     }
+    _samples_collected = count;
+    calc_initial_offset();
+    initialize_fit();
+    return true;
 }
 
 
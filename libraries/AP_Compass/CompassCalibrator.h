@@ -101,6 +101,20 @@ protected:
     // return true if this is a right angle rotation
     bool right_angle_rotation(Rotation r) const;
 
+    // load samples directly and reset the fit, then run single fit
+    // steps. protected so the AP_Compass benchmarks and tests can
+    // drive the fitter
+    bool load_fit_samples(const Vector3f *samples, uint16_t count);
+    void run_sphere_fit();
+    void run_ellipsoid_fit();
+    float get_fitness() const { return _fitness; }
+    void get_fit_params(float &radius, Vector3f &offset, Vector3f &diag, Vector3f &offdiag) const {
+        radius = _params.radius;
+        offset = _params.offset;
+        diag = _params.diag;
+        offdiag = _params.offdiag;
+    }
+
 private:
 
     // results
@@ -114,6 +128,13 @@ private:
             return &offset.x;
         }
 
+        // symmetric soft-iron correction matrix
+        Matrix3f get_softiron() const {
+            return Matrix3f(diag.x    , offdiag.x , offdiag.y,
+                            offdiag.x , diag.y    , offdiag.z,
+                            offdiag.y , offdiag.z , diag.z);
+        }
+
         float radius;       // magnetic field strength calculated from samples
         Vector3f offset;    // offsets
         Vector3f diag;      // diagonal scaling
@@ -179,13 +200,11 @@ private:
     // calculate initial offsets by simply taking the average values of the samples
     void calc_initial_offset();
 
-    // run sphere fit to calculate diagonals and offdiagonals
-    void calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
-    void run_sphere_fit();
+    // accumulate J^T.J and J^T.F over all samples for the sphere or ellipsoid model
+    void calc_normal_equations(const param_t& params, bool ellipsoid, float* JTJ, float* JTFI) const;
 
-    // run ellipsoid fit to calculate diagonals and offdiagonals
-    void calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
-    void run_ellipsoid_fit();
+    // run one Levenberg-Marquardt step of the sphere or ellipsoid fit
+    bool run_lm_step(bool ellipsoid, float &lambda);
 
     // update the completion mask based on a single sample
     void update_completion_mask(const Vector3f& sample);
@@ -0,0 +1,96 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Compass/CompassCalibrator.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// Dummy class to access protected fit functions through a public interface
+class CompassCalibrator_Bench : public CompassCalibrator
+{
+public:
+    using CompassCalibrator::load_fit_samples;
+    using CompassCalibrator::run_sphere_fit;
+    using CompassCalibrator::run_ellipsoid_fit;
+};
+
+/*
+  deterministic samples spread over a sphere of radius 400mGauss,
+  distorted by a soft-iron matrix and offset by a hard-iron vector
+ */
+static void make_samples(Vector3f *samples, uint16_t count)
+{
+    const Matrix3f softiron(1.10f, 0.05f, -0.03f,
+                            0.05f, 0.95f,  0.02f,
+                           -0.03f, 0.02f,  1.04f);
+    const Vector3f offset(120.0f, -80.0f, 45.0f);
+    for (uint16_t i = 0; i < count; i++) {
+        // golden spiral gives an even spread of directions
+        const float z = 1.0f - (2.0f * i + 1.0f) / count;
+        const float r = sqrtf(1.0f - z*z);
+        const float theta = i * M_PI * (3.0f - sqrtf(5.0f));
+        const Vector3f dir(r * cosf(theta), r * sinf(theta), z);
+        samples[i] = softiron * (dir * 400.0f) + offset;
+    }
+}
+
+static void BM_CompassSphereFit(benchmark::State& state)
+{
+    Vector3f samples[COMPASS_CAL_NUM_SAMPLES];
+    make_samples(samples, COMPASS_CAL_NUM_SAMPLES);
+    CompassCalibrator_Bench cal;
+
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        cal.load_fit_samples(samples, COMPASS_CAL_NUM_SAMPLES);
+        state.ResumeTiming();
+        cal.run_sphere_fit();
+        gbenchmark_clobber();
+    }
+}
+
+static void BM_CompassEllipsoidFit(benchmark::State& state)
+{
+    Vector3f samples[COMPASS_CAL_NUM_SAMPLES];
+    make_samples(samples, COMPASS_CAL_NUM_SAMPLES);
+    CompassCalibrator_Bench cal;
+
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        cal.load_fit_samples(samples, COMPASS_CAL_NUM_SAMPLES);
+        for (uint8_t i = 0; i < 10; i++) {
+            cal.run_sphere_fit();
+        }
+        state.ResumeTiming();
+        cal.run_ellipsoid_fit();
+        gbenchmark_clobber();
+    }
+}
+
+/*
+  full fit as done by update() for one compass: 25 sphere steps and 20
+  ellipsoid steps
+ */
+static void BM_CompassFullFit(benchmark::State& state)
+{
+    Vector3f samples[COMPASS_CAL_NUM_SAMPLES];
+    make_samples(samples, COMPASS_CAL_NUM_SAMPLES);
+    CompassCalibrator_Bench cal;
+
+    while (state.KeepRunning()) {
+        cal.load_fit_samples(samples, COMPASS_CAL_NUM_SAMPLES);
+        for (uint8_t i = 0; i < 25; i++) {
+            cal.run_sphere_fit();
+        }
+        for (uint8_t i = 0; i < 20; i++) {
+            cal.run_ellipsoid_fit();
+        }
+        gbenchmark_clobber();
+    }
+}
+
+BENCHMARK(BM_CompassSphereFit);
+BENCHMARK(BM_CompassEllipsoidFit);
+BENCHMARK(BM_CompassFullFit);
+
+BENCHMARK_MAIN();
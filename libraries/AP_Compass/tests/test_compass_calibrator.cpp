@@ -0,0 +1,250 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Compass/CompassCalibrator.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// Dummy class to access protected fit functions through a public interface
+class CompassCalibrator_Test : public CompassCalibrator
+{
+public:
+    using CompassCalibrator::load_fit_samples;
+    using CompassCalibrator::run_sphere_fit;
+    using CompassCalibrator::run_ellipsoid_fit;
+    using CompassCalibrator::get_fitness;
+    using CompassCalibrator::get_fit_params;
+};
+
+/*
+  deterministic samples spread over a sphere of radius 400mGauss,
+  distorted by a soft-iron matrix, offset by a hard-iron vector and
+  with some noise. They are rounded to the 1/8 mGauss the calibrator
+  stores them in so both fitters see the same values
+ */
+static void make_samples(Vector3f *samples, uint16_t count)
+{
+    const Matrix3f softiron(1.10f, 0.05f, -0.03f,
+                            0.05f, 0.95f,  0.02f,
+                           -0.03f, 0.02f,  1.04f);
+    const Vector3f offset(120.0f, -80.0f, 45.0f);
+    uint32_t seed = 1;
+    for (uint16_t i = 0; i < count; i++) {
+        // golden spiral gives an even spread of directions
+        const float z = 1.0f - (2.0f * i + 1.0f) / count;
+        const float r = sqrtf(1.0f - z*z);
+        const float theta = i * M_PI * (3.0f - sqrtf(5.0f));
+        const Vector3f dir(r * cosf(theta), r * sinf(theta), z);
+        Vector3f s = softiron * (dir * 400.0f) + offset;
+        for (uint8_t j = 0; j < 3; j++) {
+            seed = seed * 1103515245U + 12345U;
+            s[j] += ((seed >> 16) % 1000) / 100.0f - 5.0f;
+            s[j] = roundf(s[j] * 8.0f) / 8.0f;
+        }
+        samples[i] = s;
+    }
+}
+
+/*
+  the fitter as it was before the normal equations were accumulated
+  in a single pass and solved by LDLT, kept as a reference. The
+  parameters are radius, offset, diag and offdiag in that order, so
+  the sphere fit works on the first 4 and the ellipsoid fit on the
+  last 9
+ */
+class ReferenceFit {
+public:
+    ReferenceFit(const Vector3f *samples, uint16_t count, const CompassCalibrator_Test &cal) :
+        _samples(samples),
+        _count(count)
+    {
+        Vector3f offset, diag, offdiag;
+        cal.get_fit_params(p[0], offset, diag, offdiag);
+        for (uint8_t i = 0; i < 3; i++) {
+            p[1+i] = offset[i];
+            p[4+i] = diag[i];
+            p[7+i] = offdiag[i];
+        }
+        fitness = calc_mean_squared_residuals(p);
+    }
+
+    void run_sphere_fit() { run_fit(false, sphere_lambda); }
+    void run_ellipsoid_fit() { run_fit(true, ellipsoid_lambda); }
+
+    float p[10];
+    float fitness;
+
+private:
+    const Vector3f *_samples;
+    const uint16_t _count;
+    float sphere_lambda = 1.0f;
+    float ellipsoid_lambda = 1.0f;
+
+    static Matrix3f softiron(const float *q) {
+        return Matrix3f(q[4], q[7], q[8],
+                        q[7], q[5], q[9],
+                        q[8], q[9], q[6]);
+    }
+
+    static float calc_residual(const Vector3f &sample, const float *q) {
+        return q[0] - (softiron(q)*(sample+Vector3f(q[1], q[2], q[3]))).length();
+    }
+
+    float calc_mean_squared_residuals(const float *q) const {
+        float sum = 0.0f;
+        for (uint16_t i=0; i < _count; i++) {
+            sum += sq(calc_residual(_samples[i], q));
+        }
+        return sum / _count;
+    }
+
+    static void calc_jacob(const Vector3f &sample, const float *q, bool ellipsoid, float *ret) {
+        const Vector3f offset(q[1], q[2], q[3]);
+        const Vector3f diag(q[4], q[5], q[6]);
+        const Vector3f offdiag(q[7], q[8], q[9]);
+
+        float A =  (diag.x    * (sample.x + offset.x)) + (offdiag.x * (sample.y + offset.y)) + (offdiag.y * (sample.z + offset.z));
+        float B =  (offdiag.x * (sample.x + offset.x)) + (diag.y    * (sample.y + offset.y)) + (offdiag.z * (sample.z + offset.z));
+        float C =  (offdiag.y * (sample.x + offset.x)) + (offdiag.z * (sample.y + offset.y)) + (diag.z    * (sample.z + offset.z));
+        float length = (softiron(q)*(sample+offset)).length();
+
+        if (!ellipsoid) {
+            ret[0] = 1.0f;
+            ret[1] = -1.0f * (((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C))/length);
+            ret[2] = -1.0f * (((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C))/length);
+            ret[3] = -1.0f * (((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C))/length);
+            return;
+        }
+        ret[0] = -1.0f * (((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C))/length);
+        ret[1] = -1.0f * (((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C))/length);
+        ret[2] = -1.0f * (((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C))/length);
+        ret[3] = -1.0f * ((sample.x + offset.x) * A)/length;
+        ret[4] = -1.0f * ((sample.y + offset.y) * B)/length;
+        ret[5] = -1.0f * ((sample.z + offset.z) * C)/length;
+        ret[6] = -1.0f * (((sample.y + offset.y) * A) + ((sample.x + offset.x) * B))/length;
+        ret[7] = -1.0f * (((sample.z + offset.z) * A) + ((sample.x + offset.x) * C))/length;
+        ret[8] = -1.0f * (((sample.z + offset.z) * B) + ((sample.y + offset.y) * C))/length;
+    }
+
+    void run_fit(bool ellipsoid, float &lambda) {
+        const float lma_damping = 10.0f;
+        const uint8_t n = ellipsoid ? COMPASS_CAL_NUM_ELLIPSOID_PARAMS : COMPASS_CAL_NUM_SPHERE_PARAMS;
+        const uint8_t first = ellipsoid ? 1 : 0;
+
+        float new_fitness = fitness;
+        float fit1_params[10], fit2_params[10];
+        memcpy(fit1_params, p, sizeof(p));
+        memcpy(fit2_params, p, sizeof(p));
+
+        float JTJ[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
+        float JTJ2[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
+        float JTFI[COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
+
+        for (uint16_t k = 0; k<_count; k++) {
+            float jacob[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+            calc_jacob(_samples[k], fit1_params, ellipsoid, jacob);
+            for (uint8_t i = 0; i < n; i++) {
+                for (uint8_t j = 0; j < n; j++) {
+                    JTJ[i*n+j] += jacob[i] * jacob[j];
+                    JTJ2[i*n+j] += jacob[i] * jacob[j];
+                }
+                JTFI[i] += jacob[i] * calc_residual(_samples[k], fit1_params);
+            }
+        }
+
+        for (uint8_t i = 0; i < n; i++) {
+            JTJ[i*n+i] += lambda;
+            JTJ2[i*n+i] += lambda/lma_damping;
+        }
+
+        if (!mat_inverse(JTJ, JTJ, n) || !mat_inverse(JTJ2, JTJ2, n)) {
+            return;
+        }
+
+        for (uint8_t row=0; row < n; row++) {
+            for (uint8_t col=0; col < n; col++) {
+                fit1_params[first+row] -= JTFI[col] * JTJ[row*n+col];
+                fit2_params[first+row] -= JTFI[col] * JTJ2[row*n+col];
+            }
+        }
+
+        const float fit1 = calc_mean_squared_residuals(fit1_params);
+        const float fit2 = calc_mean_squared_residuals(fit2_params);
+
+        if (fit1 > fitness && fit2 > fitness) {
+            lambda *= lma_damping;
+        } else if (fit2 < fitness && fit2 < fit1) {
+            lambda /= lma_damping;
+            memcpy(fit1_params, fit2_params, sizeof(fit1_params));
+            new_fitness = fit2;
+        } else if (fit1 < fitness) {
+            new_fitness = fit1;
+        }
+
+        if (new_fitness < fitness) {
+            fitness = new_fitness;
+            memcpy(p, fit1_params, sizeof(p));
+        }
+    }
+};
+
+static void expect_same_fit(const CompassCalibrator_Test &cal, const ReferenceFit &ref)
+{
+    float radius;
+    Vector3f offset, diag, offdiag;
+    cal.get_fit_params(radius, offset, diag, offdiag);
+    EXPECT_NEAR(radius, ref.p[0], 0.01f);
+    for (uint8_t i = 0; i < 3; i++) {
+        EXPECT_NEAR(offset[i], ref.p[1+i], 0.01f);
+        EXPECT_NEAR(diag[i], ref.p[4+i], 1.0e-4f);
+        EXPECT_NEAR(offdiag[i], ref.p[7+i], 1.0e-4f);
+    }
+    EXPECT_NEAR(cal.get_fitness(), ref.fitness, MAX(ref.fitness * 1.0e-3f, 1.0e-4f));
+}
+
+// each sphere step gives the same parameters as the reference
+TEST(CompassCalibrator, SphereFitMatchesReference)
+{
+    Vector3f samples[COMPASS_CAL_NUM_SAMPLES];
+    make_samples(samples, COMPASS_CAL_NUM_SAMPLES);
+    CompassCalibrator_Test cal;
+    ASSERT_TRUE(cal.load_fit_samples(samples, COMPASS_CAL_NUM_SAMPLES));
+    ReferenceFit ref(samples, COMPASS_CAL_NUM_SAMPLES, cal);
+    EXPECT_FLOAT_EQ(cal.get_fitness(), ref.fitness);
+
+    for (uint8_t i = 0; i < 25; i++) {
+        cal.run_sphere_fit();
+        ref.run_sphere_fit();
+        expect_same_fit(cal, ref);
+    }
+}
+
+// full fit as done by update(): sphere steps then ellipsoid steps
+TEST(CompassCalibrator, EllipsoidFitMatchesReference)
+{
+    Vector3f samples[COMPASS_CAL_NUM_SAMPLES];
+    make_samples(samples, COMPASS_CAL_NUM_SAMPLES);
+    CompassCalibrator_Test cal;
+    ASSERT_TRUE(cal.load_fit_samples(samples, COMPASS_CAL_NUM_SAMPLES));
+    ReferenceFit ref(samples, COMPASS_CAL_NUM_SAMPLES, cal);
+
+    for (uint8_t i = 0; i < 25; i++) {
+        cal.run_sphere_fit();
+        ref.run_sphere_fit();
+    }
+    for (uint8_t i = 0; i < 20; i++) {
+        cal.run_ellipsoid_fit();
+        ref.run_ellipsoid_fit();
+        expect_same_fit(cal, ref);
+    }
+
+    // and the fit found the distortion the samples were made with
+    float radius;
+    Vector3f offset, diag, offdiag;
+    cal.get_fit_params(radius, offset, diag, offdiag);
+    EXPECT_NEAR(offset.x, -120.0f, 2.0f);
+    EXPECT_NEAR(offset.y, 80.0f, 2.0f);
+    EXPECT_NEAR(offset.z, -45.0f, 2.0f);
+}
+
+AP_GTEST_MAIN()
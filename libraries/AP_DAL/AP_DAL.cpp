@@ -7,7 +7,7 @@
 #include <AP_OpticalFlow/AP_OpticalFlow.h>
 #include <AP_WheelEncoder/AP_WheelEncoder.h>
 
-#if APM_BUILD_TYPE(APM_BUILD_Replay)
+#if APM_BUILD_TYPE(APM_BUILD_Replay) || APM_BUILD_TYPE(APM_BUILD_AP_DAL_Standalone)
 #include <AP_NavEKF2/AP_NavEKF2.h>
 #include <AP_NavEKF3/AP_NavEKF3.h>
 #endif
@@ -47,9 +47,10 @@ void AP_DAL::start_frame(AP_DAL::FrameType frametype)
 
     _RFRF.frame_types = uint8_t(frametype);
     
+    const log_RFRH old_RFRH = _RFRH;
     _RFRH.time_flying_ms = AP::vehicle()->get_time_flying_ms();
     _RFRH.time_us = AP_HAL::micros64();
-    WRITE_REPLAY_BLOCK(RFRH, _RFRH);
+    write_RFRH(old_RFRH);
 
     // update RFRN data
     const log_RFRN old = _RFRN;
@@ -151,6 +152,29 @@ void AP_DAL::init_sensors(void)
     }
 }
 
+/*
+  write the frame header, using the shorter RFRD when the time steps
+  since the last frame fit in 16 bits
+ */
+void AP_DAL::write_RFRH(const log_RFRH &old_RFRH)
+{
+    const uint64_t time_delta_us = _RFRH.time_us - old_RFRH.time_us;
+    const uint32_t time_flying_delta_ms = _RFRH.time_flying_ms - old_RFRH.time_flying_ms;
+    if (time_delta_us > UINT16_MAX ||
+        time_flying_delta_ms > UINT16_MAX ||
+        !delta_write_ok(&_RFRH, offsetof(log_RFRH, _end))) {
+        WRITE_REPLAY_BLOCK(RFRH, _RFRH);
+        return;
+    }
+    struct log_RFRD pkt {
+        time_delta_us : uint16_t(time_delta_us),
+        time_flying_delta_ms : uint16_t(time_flying_delta_ms),
+    };
+    WRITE_REPLAY_BLOCK(RFRD, pkt);
+    // a failed write forces a full RFRH next frame
+    _RFRH._end = pkt._end;
+}
+
 /*
   end a frame. Must be called on all events and injections of data (eg
   flow) and before starting a new frame
@@ -385,7 +409,8 @@ void AP_DAL::writeBodyFrameOdom(float quality, const Vector3f &delPos, const Vec
     WRITE_REPLAY_BLOCK_IFCHANGED(RBOH, _RBOH, old);
 }
 
-#if APM_BUILD_TYPE(APM_BUILD_Replay)
+// also used by the standalone EKF3 benchmark to replay recorded frames
+#if APM_BUILD_TYPE(APM_BUILD_Replay) || APM_BUILD_TYPE(APM_BUILD_AP_DAL_Standalone)
 /*
   handle frame message. This message triggers the EKF2/EKF3 updates and logging
  */
@@ -416,14 +441,14 @@ void AP_DAL::handle_message(const log_RFRF &msg, NavEKF2 &ekf2, NavEKF3 &ekf3)
         if (!ekf3_init_done) {
             ekf3_init_done = ekf3.InitialiseFilter();
         }
-        if (ekf3_init_done) {
+        if (ekf3_init_done && !ekf3_seeking) {
             ekf3.UpdateFilter();
         }
     }
     if (frame_types & uint8_t(AP_DAL::FrameType::LogWriteEKF2)) {
         ekf2.Log_Write();
     }
-    if (frame_types & uint8_t(AP_DAL::FrameType::LogWriteEKF3)) {
+    if ((frame_types & uint8_t(AP_DAL::FrameType::LogWriteEKF3)) && !ekf3_seeking) {
         ekf3.Log_Write();
     }
 }
@@ -477,7 +502,7 @@ void AP_DAL::handle_message(const log_RBOH &msg, NavEKF2 &ekf2, NavEKF3 &ekf3)
     // note that EKF2 does not support body frame odomotry
     ekf3.writeBodyFrameOdom(msg.quality, msg.delPos, msg.delAng, msg.delTime, msg.timeStamp_ms, msg.delay_ms, msg.posOffset);
 }
-#endif // APM_BUILD_Replay
+#endif // APM_BUILD_Replay || APM_BUILD_AP_DAL_Standalone
 
 namespace AP {
 
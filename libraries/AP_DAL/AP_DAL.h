@@ -218,6 +218,12 @@ public:
         _micros = _RFRH.time_us;
         _millis = _RFRH.time_us / 1000UL;
     }
+    void handle_message(const log_RFRD &msg) {
+        _RFRH.time_us += msg.time_delta_us;
+        _RFRH.time_flying_ms += msg.time_flying_delta_ms;
+        _micros = _RFRH.time_us;
+        _millis = _RFRH.time_us / 1000UL;
+    }
     void handle_message(const log_RFRN &msg) {
         _RFRN = msg;
         _home.lat = msg.lat;
@@ -226,12 +232,19 @@ public:
     }
     void handle_message(const log_RFRF &msg, NavEKF2 &ekf2, NavEKF3 &ekf3);
 
+    // when seeking EKF3 is initialised but not updated or logged, so
+    // that its state can be restored from a checkpoint
+    void set_ekf3_seeking(bool seeking) { ekf3_seeking = seeking; }
+
     void handle_message(const log_RISH &msg) {
         _ins.handle_message(msg);
     }
     void handle_message(const log_RISI &msg) {
         _ins.handle_message(msg);
     }
+    void handle_message(const log_RISJ &msg) {
+        _ins.handle_message(msg);
+    }
 
     void handle_message(const log_RASH &msg) {
         if (_airspeed == nullptr) {
@@ -316,6 +329,13 @@ public:
     // only write if the content has changed
     static void WriteLogMessage(enum LogMessages msg_type, void *msg, const void *old_msg, uint8_t msg_size);
 
+    // return true if a delta against the last written copy of msg can
+    // be written in place of msg. The reader only holds that copy if
+    // the last write succeeded and logging has not just started
+    static bool delta_write_ok(const void *msg, uint8_t msg_size) {
+        return logging_started && !force_write && ((const uint8_t *)msg)[msg_size] == 0;
+    }
+
 private:
 
     static AP_DAL *_singleton;
@@ -356,8 +376,12 @@ private:
 
     bool ekf2_init_done;
     bool ekf3_init_done;
+    bool ekf3_seeking;
 
     void init_sensors(void);
+
+    // write RFRH or RFRD for a new frame
+    void write_RFRH(const log_RFRH &old_RFRH);
     bool init_done;
 };
 
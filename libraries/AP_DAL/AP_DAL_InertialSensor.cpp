@@ -43,13 +43,37 @@ void AP_DAL_InertialSensor::start_frame()
 
         update_filtered(i);
 
-        WRITE_REPLAY_BLOCK_IFCHANGED(RISI, RISI, old_RISI);
+        write_RISI(RISI, old_RISI);
 
         // update sensor position
         pos[i] = ins.get_imu_pos_offset(i);
     }
 }
 
+/*
+  write RISI, or the shorter RISJ if only the delta velocity and delta
+  angle have changed since the last frame
+ */
+void AP_DAL_InertialSensor::write_RISI(log_RISI &RISI, const log_RISI &old_RISI)
+{
+    const uint8_t fixed_ofs = offsetof(log_RISI, delta_velocity_dt);
+    const uint8_t fixed_len = offsetof(log_RISI, _end) - fixed_ofs;
+    if (memcmp(&RISI, &old_RISI, fixed_ofs) == 0 ||
+        memcmp(((const uint8_t *)&RISI)+fixed_ofs, ((const uint8_t *)&old_RISI)+fixed_ofs, fixed_len) != 0 ||
+        !AP_DAL::delta_write_ok(&RISI, offsetof(log_RISI, _end))) {
+        WRITE_REPLAY_BLOCK_IFCHANGED(RISI, RISI, old_RISI);
+        return;
+    }
+    struct log_RISJ RISJ {
+        delta_velocity : RISI.delta_velocity,
+        delta_angle : RISI.delta_angle,
+        instance : RISI.instance,
+    };
+    WRITE_REPLAY_BLOCK(RISJ, RISJ);
+    // a failed write forces a full RISI next frame
+    RISI._end = RISJ._end;
+}
+
 // update filtered gyro and accel
 void AP_DAL_InertialSensor::update_filtered(uint8_t i)
 {
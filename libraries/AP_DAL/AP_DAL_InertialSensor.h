@@ -56,7 +56,16 @@ public:
     }
     void handle_message(const log_RISI &msg) {
         _RISI[msg.instance] = msg;
+#if !APM_BUILD_TYPE(APM_BUILD_AP_DAL_Standalone)
+        // the standalone build has no INS, positions stay at zero
         pos[msg.instance] = AP::ins().get_imu_pos_offset(msg.instance);
+#endif
+        update_filtered(msg.instance);
+    }
+    void handle_message(const log_RISJ &msg) {
+        log_RISI &RISI = _RISI[msg.instance];
+        RISI.delta_velocity = msg.delta_velocity;
+        RISI.delta_angle = msg.delta_angle;
         update_filtered(msg.instance);
     }
 
@@ -74,4 +83,7 @@ private:
     uint8_t _primary_gyro;
 
     void update_filtered(uint8_t i);
+
+    // write RISI or RISJ for an instance
+    void write_RISI(log_RISI &RISI, const log_RISI &old_RISI);
 };
@@ -37,7 +37,9 @@
     LOG_REPH_MSG, \
     LOG_REVH_MSG, \
     LOG_RWOH_MSG, \
-    LOG_RBOH_MSG
+    LOG_RBOH_MSG, \
+    LOG_RFRD_MSG, \
+    LOG_RISJ_MSG
 
 // Replay Data Structures
 struct log_RFRH {
@@ -52,6 +54,14 @@ struct log_RFRF {
     uint8_t _end;
 };
 
+// @LoggerMessage: RFRD
+// @Description: Replay frame header delta, written in place of RFRH when the time steps since the last frame fit in 16 bits
+struct log_RFRD {
+    uint16_t time_delta_us;
+    uint16_t time_flying_delta_ms;
+    uint8_t _end;
+};
+
 struct log_RFRN {
     int32_t lat;
     int32_t lng;
@@ -97,6 +107,15 @@ struct log_RISI {
     uint8_t _end;
 };
 
+// @LoggerMessage: RISJ
+// @Description: Replay Inertial Sensor instance delta, written in place of RISI when only the delta velocity and delta angle have changed
+struct log_RISJ {
+    Vector3f delta_velocity;
+    Vector3f delta_angle;
+    uint8_t instance;
+    uint8_t _end;
+};
+
 // @LoggerMessage: REV2
 // @Description: Replay Event
 struct log_REV2 {
@@ -364,6 +383,8 @@ struct log_RBOH {
       "RFRH", "QI", "TimeUS,TF", "s-", "F-" }, \
     { LOG_RFRF_MSG, RLOG_SIZE(RFRF),                          \
       "RFRF", "BB", "FTypes,Slow", "--", "--" }, \
+    { LOG_RFRD_MSG, RLOG_SIZE(RFRD),                          \
+      "RFRD", "HH", "DT,DTF", "--", "--" }, \
     { LOG_RFRN_MSG, RLOG_SIZE(RFRN),                            \
       "RFRN", "IIIfIfffBBB", "HLat,HLon,HAlt,E2T,AM,TX,TY,TZ,VC,EKT,Flags", "DUm????????", "GGB--------" }, \
     { LOG_REV2_MSG, RLOG_SIZE(REV2),                                   \
@@ -384,6 +405,8 @@ struct log_RBOH {
       "RISH", "HBBfBB", "LR,PG,PA,LD,AC,GC", "------", "------" }, \
     { LOG_RISI_MSG, RLOG_SIZE(RISI),                                   \
       "RISI", "ffffffffBB", "DVX,DVY,DVZ,DAX,DAY,DAZ,DVDT,DADT,Flags,I", "---------#", "----------" }, \
+    { LOG_RISJ_MSG, RLOG_SIZE(RISJ),                                   \
+      "RISJ", "ffffffB", "DVX,DVY,DVZ,DAX,DAY,DAZ,I", "------#", "-------" }, \
     { LOG_RASH_MSG, RLOG_SIZE(RASH),                                   \
       "RASH", "BB", "Primary,NumInst", "--", "--" },  \
     { LOG_RASI_MSG, RLOG_SIZE(RASI),                                   \
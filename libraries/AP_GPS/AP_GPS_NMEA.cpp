@@ -48,17 +48,23 @@ extern const AP_HAL::HAL& hal;
 
 bool AP_GPS_NMEA::read(void)
 {
-    int16_t numc;
     bool parsed = false;
 
-    numc = port->available();
-    while (numc--) {
-        char c = port->read();
-        if (_decode(c)) {
-            parsed = true;
+    uint32_t numc = port->available();
+    uint8_t buf[AP_GPS_READ_CHUNK_SIZE];
+    while (numc > 0) {
+        const ssize_t nread = port->read(buf, MIN(numc, sizeof(buf)));
+        if (nread <= 0) {
+            break;
+        }
+        numc -= nread;
+        for (uint16_t i = 0; i < nread; i++) {
+            if (_decode(buf[i])) {
+                parsed = true;
+            }
         }
 #if AP_GPS_DEBUG_LOGGING_ENABLED
-        log_data((const uint8_t *)&c, 1);
+        log_data(buf, nread);
 #endif
     }
     return parsed;
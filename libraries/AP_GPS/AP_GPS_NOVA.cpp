@@ -88,9 +88,16 @@ AP_GPS_NOVA::read(void)
     }
 
     bool ret = false;
-    while (port->available() > 0) {
-        uint8_t temp = port->read();
-        ret |= parse(temp);
+    uint8_t buf[AP_GPS_READ_CHUNK_SIZE];
+    uint32_t available_bytes;
+    while ((available_bytes = port->available()) > 0) {
+        const ssize_t nread = port->read(buf, MIN(available_bytes, sizeof(buf)));
+        if (nread <= 0) {
+            break;
+        }
+        for (uint16_t i = 0; i < nread; i++) {
+            ret |= parse(buf[i]);
+        }
     }
     
     return ret;
@@ -84,9 +84,16 @@ AP_GPS_SBF::read(void)
 {
     bool ret = false;
     uint32_t available_bytes = port->available();
-    for (uint32_t i = 0; i < available_bytes; i++) {
-        uint8_t temp = port->read();
-        ret |= parse(temp);
+    uint8_t buf[AP_GPS_READ_CHUNK_SIZE];
+    while (available_bytes > 0) {
+        const ssize_t nread = port->read(buf, MIN(available_bytes, sizeof(buf)));
+        if (nread <= 0) {
+            break;
+        }
+        available_bytes -= nread;
+        for (uint16_t i = 0; i < nread; i++) {
+            ret |= parse(buf[i]);
+        }
     }
 
     if (gps._auto_config != AP_GPS::GPS_AUTO_CONFIG_DISABLE) {
@@ -539,21 +539,28 @@ AP_GPS_UBLOX::read(void)
     }
 
     const uint16_t numc = MIN(port->available(), 8192U);
-    for (uint16_t i = 0; i < numc; i++) {        // Process bytes received
-
-        // read the next byte
-        const int16_t rdata = port->read();
-        if (rdata < 0) {
+    uint16_t remaining = numc;
+    uint8_t buf[AP_GPS_READ_CHUNK_SIZE];
+    while (remaining > 0) {
+#if GPS_MOVING_BASELINE
+        // the RTCMv3 parser must stop at the last byte of a packet,
+        // so take one byte at a time while it is active
+        const uint16_t chunk = rtcm3_parser ? 1 : MIN(remaining, sizeof(buf));
+#else
+        const uint16_t chunk = MIN(remaining, sizeof(buf));
+#endif
+        const ssize_t nread = port->read(buf, chunk);
+        if (nread <= 0) {
             break;
         }
-        const uint8_t data = rdata;
+        remaining -= nread;
 #if AP_GPS_DEBUG_LOGGING_ENABLED
-        log_data(&data, 1);
+        log_data(buf, nread);
 #endif
 
 #if GPS_MOVING_BASELINE
         if (rtcm3_parser) {
-            if (rtcm3_parser->read(data)) {
+            if (rtcm3_parser->read(buf[0])) {
                 // we've found a RTCMv3 packet. We stop parsing at
                 // this point and reset u-blox parse state. We need to
                 // stop parsing to give the higher level driver a
@@ -565,113 +572,177 @@ AP_GPS_UBLOX::read(void)
         }
 #endif
 
-	reset:
-        switch(_step) {
-
-        // Message preamble detection
-        //
-        // If we fail to match any of the expected bytes, we reset
-        // the state machine and re-consider the failed byte as
-        // the first byte of the preamble.  This improves our
-        // chances of recovering from a mismatch and makes it less
-        // likely that we will be fooled by the preamble appearing
-        // as data in some other message.
-        //
-        case 1:
-            if (PREAMBLE2 == data) {
-                _step++;
+        if (_parse_bytes(buf, nread)) {
+            parsed = true;
+        }
+    }
+    return parsed;
+}
+
+/*
+  parse a span of bytes from the GPS. Hunting for the preamble and
+  collecting the payload are the bulk of the work, so those are done
+  a span at a time, and the rest of the frame a byte at a time.
+  Frames may be split across calls.
+ */
+bool AP_GPS_UBLOX::_parse_bytes(const uint8_t *bytes, uint16_t len)
+{
+    bool parsed = false;
+    uint16_t i = 0;
+    while (i < len) {
+        if (_step == 0) {
+            // skip to the next possible start of a frame
+            const uint8_t *p = (const uint8_t *)memchr(&bytes[i], PREAMBLE1, len - i);
+            if (p == nullptr) {
                 break;
             }
-            _step = 0;
-            Debug("reset %u", __LINE__);
-            FALLTHROUGH;
-        case 0:
-            if(PREAMBLE1 == data)
+            i = p - bytes + 1;
+            _step = 1;
+            continue;
+        }
+        if (_step == 6) {
+            // copy the payload available in this span, checksumming
+            // it in the same pass. The length has already been
+            // checked against the size of _buffer
+            const uint16_t n = MIN(uint16_t(len - i), uint16_t(_payload_length - _payload_counter));
+            const uint8_t *src = &bytes[i];
+            uint8_t *dst = &_buffer[_payload_counter];
+            uint8_t ck_a = _ck_a;
+            uint8_t ck_b = _ck_b;
+            for (uint16_t j = 0; j < n; j++) {
+                const uint8_t data = src[j];
+                dst[j] = data;
+                ck_b += (ck_a += data);
+            }
+            _ck_a = ck_a;
+            _ck_b = ck_b;
+            _payload_counter += n;
+            i += n;
+            if (_payload_counter == _payload_length) {
                 _step++;
-            break;
+            }
+            continue;
+        }
+        if (_parse_byte(bytes[i++])) {
+            parsed = true;
+        }
+    }
+    return parsed;
+}
 
-        // Message header processing
-        //
-        // We sniff the class and message ID to decide whether we
-        // are going to gather the message bytes or just discard
-        // them.
-        //
-        // We always collect the length so that we can avoid being
-        // fooled by preamble bytes in messages.
-        //
-        case 2:
-            _step++;
-            _class = data;
-            _ck_b = _ck_a = data;                       // reset the checksum accumulators
-            break;
-        case 3:
-            _step++;
-            _ck_b += (_ck_a += data);                   // checksum byte
-            _msg_id = data;
-            break;
-        case 4:
+/*
+  run the frame state machine on a single byte
+ */
+bool AP_GPS_UBLOX::_parse_byte(const uint8_t data)
+{
+    bool parsed = false;
+
+reset:
+    switch(_step) {
+
+    // Message preamble detection
+    //
+    // If we fail to match any of the expected bytes, we reset
+    // the state machine and re-consider the failed byte as
+    // the first byte of the preamble.  This improves our
+    // chances of recovering from a mismatch and makes it less
+    // likely that we will be fooled by the preamble appearing
+    // as data in some other message.
+    //
+    case 1:
+        if (PREAMBLE2 == data) {
             _step++;
-            _ck_b += (_ck_a += data);                   // checksum byte
-            _payload_length = data;                     // payload length low byte
             break;
-        case 5:
+        }
+        _step = 0;
+        Debug("reset %u", __LINE__);
+        FALLTHROUGH;
+    case 0:
+        if(PREAMBLE1 == data)
             _step++;
-            _ck_b += (_ck_a += data);                   // checksum byte
-
-            _payload_length += (uint16_t)(data<<8);
-            if (_payload_length > sizeof(_buffer)) {
-                Debug("large payload %u", (unsigned)_payload_length);
-                // assume any payload bigger then what we know about is noise
-                _payload_length = 0;
-                _step = 0;
-				goto reset;
-            }
-            _payload_counter = 0;                       // prepare to receive payload
-            if (_payload_length == 0) {
-                // bypass payload and go straight to checksum
-                _step++;
-            }
-            break;
+        break;
 
-        // Receive message data
-        //
-        case 6:
-            _ck_b += (_ck_a += data);                   // checksum byte
-            if (_payload_counter < sizeof(_buffer)) {
-                _buffer[_payload_counter] = data;
-            }
-            if (++_payload_counter == _payload_length)
-                _step++;
-            break;
+    // Message header processing
+    //
+    // We sniff the class and message ID to decide whether we
+    // are going to gather the message bytes or just discard
+    // them.
+    //
+    // We always collect the length so that we can avoid being
+    // fooled by preamble bytes in messages.
+    //
+    case 2:
+        _step++;
+        _class = data;
+        _ck_b = _ck_a = data;                       // reset the checksum accumulators
+        break;
+    case 3:
+        _step++;
+        _ck_b += (_ck_a += data);                   // checksum byte
+        _msg_id = data;
+        break;
+    case 4:
+        _step++;
+        _ck_b += (_ck_a += data);                   // checksum byte
+        _payload_length = data;                     // payload length low byte
+        break;
+    case 5:
+        _step++;
+        _ck_b += (_ck_a += data);                   // checksum byte
+
+        _payload_length += (uint16_t)(data<<8);
+        if (_payload_length > sizeof(_buffer)) {
+            Debug("large payload %u", (unsigned)_payload_length);
+            // assume any payload bigger then what we know about is noise
+            _payload_length = 0;
+            _step = 0;
+            goto reset;
+        }
+        _payload_counter = 0;                       // prepare to receive payload
+        if (_payload_length == 0) {
+            // bypass payload and go straight to checksum
+            _step++;
+        }
+        break;
 
-        // Checksum and message processing
-        //
-        case 7:
+    // Receive message data
+    //
+    case 6:
+        _ck_b += (_ck_a += data);                   // checksum byte
+        if (_payload_counter < sizeof(_buffer)) {
+            _buffer[_payload_counter] = data;
+        }
+        if (++_payload_counter == _payload_length)
             _step++;
-            if (_ck_a != data) {
-                Debug("bad cka %x should be %x", data, _ck_a);
-                _step = 0;
-				goto reset;
-            }
-            break;
-        case 8:
+        break;
+
+    // Checksum and message processing
+    //
+    case 7:
+        _step++;
+        if (_ck_a != data) {
+            Debug("bad cka %x should be %x", data, _ck_a);
             _step = 0;
-            if (_ck_b != data) {
-                Debug("bad ckb %x should be %x", data, _ck_b);
-                break;                                                  // bad checksum
-            }
+            goto reset;
+        }
+        break;
+    case 8:
+        _step = 0;
+        if (_ck_b != data) {
+            Debug("bad ckb %x should be %x", data, _ck_b);
+            break;                                                  // bad checksum
+        }
 
 #if GPS_MOVING_BASELINE
-            if (rtcm3_parser) {
-                // this is a uBlox packet, discard any partial RTCMv3 state
-                rtcm3_parser->reset();
-            }
+        if (rtcm3_parser) {
+            // this is a uBlox packet, discard any partial RTCMv3 state
+            rtcm3_parser->reset();
+        }
 #endif
-            if (_parse_gps()) {
-                parsed = true;
-            }
-            break;
+        if (_parse_gps()) {
+            parsed = true;
         }
+        break;
     }
     return parsed;
 }
@@ -700,6 +700,10 @@ private:
     // Buffer parse & GPS state update
     bool        _parse_gps();
 
+    // frame parsing from a span of received bytes
+    bool        _parse_bytes(const uint8_t *bytes, uint16_t len);
+    bool        _parse_byte(const uint8_t data);
+
     // used to update fix between status and position packets
     AP_GPS::GPS_Status next_fix;
 
@@ -28,6 +28,12 @@
 #define AP_GPS_DEBUG_LOGGING_ENABLED 0
 #endif
 
+#ifndef AP_GPS_READ_CHUNK_SIZE
+// number of bytes backends take from the port per read. The chunk
+// is on the stack of the GPS update
+#define AP_GPS_READ_CHUNK_SIZE 128
+#endif
+
 #if AP_GPS_DEBUG_LOGGING_ENABLED
 #include <AP_HAL/utility/RingBuffer.h>
 #endif
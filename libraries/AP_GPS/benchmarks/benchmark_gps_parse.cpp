@@ -0,0 +1,224 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_GPS/AP_GPS.h>
+#include <AP_GPS/AP_GPS_UBLOX.h>
+#include <AP_GPS/AP_GPS_NMEA.h>
+#include <AP_GPS/AP_GPS_SBF.h>
+#include <AP_Math/crc.h>
+
+#include <stdio.h>
+#include <vector>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  synthetic one second captures of each protocol at 10Hz, generated
+  here so the benchmark has no data files. The content only has to
+  be framed correctly, the backends are timed on framing and
+  checksumming the stream.
+ */
+typedef std::vector<uint8_t> Stream;
+
+static uint32_t noise_seed = 1;
+static uint8_t noise()
+{
+    noise_seed = noise_seed * 1103515245 + 12345;
+    return noise_seed >> 16;
+}
+
+static void add_ubx(Stream &s, uint8_t msg_class, uint8_t msg_id, const Stream &payload)
+{
+    const size_t start = s.size();
+    s.push_back(0xB5);
+    s.push_back(0x62);
+    s.push_back(msg_class);
+    s.push_back(msg_id);
+    s.push_back(payload.size() & 0xFF);
+    s.push_back(payload.size() >> 8);
+    s.insert(s.end(), payload.begin(), payload.end());
+    uint8_t ck_a = 0, ck_b = 0;
+    for (size_t i = start + 2; i < s.size(); i++) {
+        ck_b += (ck_a += s[i]);
+    }
+    s.push_back(ck_a);
+    s.push_back(ck_b);
+}
+
+static Stream make_ubx(bool with_raw)
+{
+    Stream s;
+    for (uint32_t epoch = 0; epoch < 10; epoch++) {
+        const uint32_t itow = 100000 + epoch * 100;
+        Stream pvt(92);
+        memcpy(&pvt[0], &itow, 4);
+        pvt[20] = 3;    // 3D fix
+        pvt[23] = 18;   // satellites
+        add_ubx(s, 0x01, 0x07, pvt);    // NAV-PVT
+        Stream dop(18);
+        memcpy(&dop[0], &itow, 4);
+        add_ubx(s, 0x01, 0x04, dop);    // NAV-DOP
+        if (with_raw) {
+            // RXM-RAWX with 32 measurements, larger than any message
+            // the driver decodes so it is skipped on the length
+            Stream rawx(16 + 32 * 32);
+            for (auto &b : rawx) {
+                b = noise();
+            }
+            add_ubx(s, 0x02, 0x15, rawx);
+        }
+    }
+    return s;
+}
+
+static void add_nmea(Stream &s, const char *body)
+{
+    uint8_t parity = 0;
+    for (const char *p = body; *p; p++) {
+        parity ^= *p;
+    }
+    char sentence[128];
+    const int n = snprintf(sentence, sizeof(sentence), "$%s*%02X\r\n", body, parity);
+    s.insert(s.end(), sentence, sentence + n);
+}
+
+static Stream make_nmea()
+{
+    Stream s;
+    for (uint32_t epoch = 0; epoch < 10; epoch++) {
+        char body[100];
+        snprintf(body, sizeof(body),
+                 "GPGGA,1234%02u.%u0,3510.1234,S,14910.5678,E,1,18,0.8,584.3,M,12.1,M,,",
+                 unsigned(epoch / 10), unsigned(epoch % 10));
+        add_nmea(s, body);
+        snprintf(body, sizeof(body),
+                 "GPRMC,1234%02u.%u0,A,3510.1234,S,14910.5678,E,3.2,45.1,180926,,,A",
+                 unsigned(epoch / 10), unsigned(epoch % 10));
+        add_nmea(s, body);
+        add_nmea(s, "GPVTG,45.1,T,,M,3.2,N,5.9,K,A");
+    }
+    return s;
+}
+
+static void add_sbf(Stream &s, uint16_t block_id, uint16_t payload_length, uint32_t tow)
+{
+    // blocks are padded to a multiple of 4 bytes
+    const uint16_t length = (8 + payload_length + 3) & ~3U;
+    Stream block(length);
+    block[0] = '$';
+    block[1] = '@';
+    memcpy(&block[4], &block_id, 2);
+    memcpy(&block[6], &length, 2);
+    memcpy(&block[8], &tow, 4);
+    const uint16_t crc = crc16_ccitt(&block[4], length - 4, 0);
+    memcpy(&block[2], &crc, 2);
+    s.insert(s.end(), block.begin(), block.end());
+}
+
+static Stream make_sbf()
+{
+    Stream s;
+    for (uint32_t epoch = 0; epoch < 10; epoch++) {
+        const uint32_t tow = 100000 + epoch * 100;
+        add_sbf(s, 4007 | (2U<<13), 95, tow);  // PVTGeodetic rev 2
+        add_sbf(s, 4001, 28, tow);             // DOP
+    }
+    return s;
+}
+
+/*
+  UART that plays back a stream. At most max_read bytes are returned
+  from each bulk read, so a max_read of 1 costs the same as the
+  byte at a time reads the backends used to do
+ */
+class StreamUart : public AP_HAL::UARTDriver
+{
+public:
+    void set_stream(const Stream &stream, uint16_t max_read) {
+        _stream = &stream;
+        _max_read = max_read;
+        _ofs = 0;
+    }
+    void rewind() { _ofs = 0; }
+
+    void begin(uint32_t baud) override {}
+    void begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace) override {}
+    void end() override {}
+    void flush() override {}
+    bool is_initialized() override { return true; }
+    void set_blocking_writes(bool blocking) override {}
+    bool tx_pending() override { return false; }
+    uint32_t available() override { return _stream->size() - _ofs; }
+    uint32_t txspace() override { return 1024; }
+    bool discard_input() override { _ofs = _stream->size(); return true; }
+    size_t write(uint8_t c) override { return 1; }
+    size_t write(const uint8_t *buffer, size_t size) override { return size; }
+
+    int16_t read() override {
+        if (_ofs >= _stream->size()) {
+            return -1;
+        }
+        return (*_stream)[_ofs++];
+    }
+
+    ssize_t read(uint8_t *buffer, uint16_t count) override {
+        const uint32_t n = MIN(MIN(uint32_t(count), uint32_t(_max_read)), available());
+        memcpy(buffer, &(*_stream)[_ofs], n);
+        _ofs += n;
+        return n;
+    }
+
+private:
+    const Stream *_stream;
+    uint16_t _max_read;
+    uint32_t _ofs;
+};
+
+static AP_GPS gps;
+static AP_GPS::GPS_State gps_state;
+static StreamUart uart;
+
+static void run_parse(benchmark::State& state, AP_GPS_Backend *backend, const Stream &stream)
+{
+    uart.set_stream(stream, state.range_x());
+    while (state.KeepRunning()) {
+        uart.rewind();
+        while (uart.available() > 0) {
+            bool parsed = backend->read();
+            gbenchmark_escape(&parsed);
+        }
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * stream.size());
+    delete backend;
+}
+
+static void BM_GPS_UBLOX(benchmark::State& state)
+{
+    static const Stream stream = make_ubx(false);
+    run_parse(state, new AP_GPS_UBLOX(gps, gps_state, &uart, AP_GPS::GPS_ROLE_NORMAL), stream);
+}
+
+static void BM_GPS_UBLOX_RAWX(benchmark::State& state)
+{
+    static const Stream stream = make_ubx(true);
+    run_parse(state, new AP_GPS_UBLOX(gps, gps_state, &uart, AP_GPS::GPS_ROLE_NORMAL), stream);
+}
+
+static void BM_GPS_NMEA(benchmark::State& state)
+{
+    static const Stream stream = make_nmea();
+    run_parse(state, new AP_GPS_NMEA(gps, gps_state, &uart), stream);
+}
+
+static void BM_GPS_SBF(benchmark::State& state)
+{
+    static const Stream stream = make_sbf();
+    run_parse(state, new AP_GPS_SBF(gps, gps_state, &uart), stream);
+}
+
+// bytes returned per port read: byte at a time and one read chunk
+BENCHMARK(BM_GPS_UBLOX)->Arg(1)->Arg(AP_GPS_READ_CHUNK_SIZE);
+BENCHMARK(BM_GPS_UBLOX_RAWX)->Arg(1)->Arg(AP_GPS_READ_CHUNK_SIZE);
+BENCHMARK(BM_GPS_NMEA)->Arg(1)->Arg(AP_GPS_READ_CHUNK_SIZE);
+BENCHMARK(BM_GPS_SBF)->Arg(1)->Arg(AP_GPS_READ_CHUNK_SIZE);
+
+BENCHMARK_MAIN();
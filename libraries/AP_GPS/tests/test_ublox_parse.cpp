@@ -0,0 +1,120 @@
+#include <AP_gtest.h>
+
+#include <AP_GPS/AP_GPS.h>
+#include <AP_GPS/AP_GPS_UBLOX.h>
+
+#include <vector>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+typedef std::vector<uint8_t> Stream;
+
+static void add_pvt(Stream &s, int32_t lat, bool corrupt)
+{
+    const size_t start = s.size();
+    const uint8_t header[] { 0xB5, 0x62, 0x01, 0x07, 92, 0 };
+    s.insert(s.end(), header, header + sizeof(header));
+    Stream payload(92);
+    memcpy(&payload[28], &lat, 4);
+    s.insert(s.end(), payload.begin(), payload.end());
+    uint8_t ck_a = 0, ck_b = 0;
+    for (size_t i = start + 2; i < s.size(); i++) {
+        ck_b += (ck_a += s[i]);
+    }
+    s.push_back(ck_a);
+    s.push_back(corrupt ? ck_b ^ 1 : ck_b);
+}
+
+/*
+  UART that hands over at most chunk bytes per GPS update
+ */
+class ChunkUart : public AP_HAL::UARTDriver
+{
+public:
+    ChunkUart(const Stream &stream, uint16_t chunk) : _stream(stream), _chunk(chunk) {}
+
+    void begin(uint32_t baud) override {}
+    void begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace) override {}
+    void end() override {}
+    void flush() override {}
+    bool is_initialized() override { return true; }
+    void set_blocking_writes(bool blocking) override {}
+    bool tx_pending() override { return false; }
+    uint32_t available() override { return MIN(uint32_t(_chunk), uint32_t(_stream.size() - _ofs)); }
+    uint32_t txspace() override { return 1024; }
+    bool discard_input() override { return true; }
+    size_t write(uint8_t c) override { return 1; }
+    size_t write(const uint8_t *buffer, size_t size) override { return size; }
+
+    int16_t read() override {
+        if (_ofs >= _stream.size()) {
+            return -1;
+        }
+        return _stream[_ofs++];
+    }
+
+    ssize_t read(uint8_t *buffer, uint16_t count) override {
+        const uint32_t n = MIN(uint32_t(count), uint32_t(_stream.size() - _ofs));
+        memcpy(buffer, &_stream[_ofs], n);
+        _ofs += n;
+        return n;
+    }
+
+    bool done() const { return _ofs >= _stream.size(); }
+
+private:
+    const Stream &_stream;
+    const uint16_t _chunk;
+    uint32_t _ofs = 0;
+};
+
+static AP_GPS gps;
+
+TEST(AP_GPS_UBLOX, split_frames)
+{
+    Stream stream;
+    std::vector<int32_t> expected;
+
+    const uint8_t noise[] { 0x00, 0x62, 0x55, 0xAA, 0xB5, 0x00, 0x10 };
+    // a header with a length too large for any message
+    const uint8_t bad_length[] { 0xB5, 0x62, 0x01, 0x07, 0xFF, 0xFF };
+    for (int32_t i = 0; i < 20; i++) {
+        switch (i % 4) {
+        case 0:
+            stream.insert(stream.end(), noise, noise + sizeof(noise));
+            break;
+        case 1:
+            stream.insert(stream.end(), bad_length, bad_length + sizeof(bad_length));
+            break;
+        case 2:
+            // a frame with a bad checksum is dropped
+            add_pvt(stream, -1, true);
+            break;
+        case 3:
+            // a stray preamble byte ahead of a frame
+            stream.push_back(0xB5);
+            break;
+        }
+        add_pvt(stream, 1000 + i, false);
+        expected.push_back(1000 + i);
+    }
+
+    // chunks up to the frame size complete at most one frame per update
+    for (uint16_t chunk = 1; chunk <= 100; chunk++) {
+        ChunkUart uart(stream, chunk);
+        AP_GPS::GPS_State *state = new AP_GPS::GPS_State;
+        AP_GPS_UBLOX *backend = new AP_GPS_UBLOX(gps, *state, &uart, AP_GPS::GPS_ROLE_NORMAL);
+        std::vector<int32_t> seen;
+        while (!uart.done()) {
+            backend->read();
+            if (state->location.lat != 0 && (seen.empty() || seen.back() != state->location.lat)) {
+                seen.push_back(state->location.lat);
+            }
+        }
+        EXPECT_EQ(expected, seen) << "chunk " << chunk;
+        delete backend;
+        delete state;
+    }
+}
+
+AP_GTEST_MAIN()
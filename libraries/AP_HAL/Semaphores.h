@@ -28,6 +28,28 @@ public:
     virtual ~Semaphore(void) {}
 };
 
+/*
+  a semaphore which one thread waits on for another to signal, e.g. to
+  wake a thread when new data is ready. Signals do not count, several
+  signals before a wait release it once
+ */
+class AP_HAL::BinarySemaphore {
+public:
+    BinarySemaphore(bool initial_state=false) {}
+
+    // do not allow copying
+    BinarySemaphore(const BinarySemaphore &other) = delete;
+    BinarySemaphore &operator=(const BinarySemaphore&) = delete;
+
+    // wait up to timeout_us for a signal, return false on timeout
+    virtual bool wait(uint32_t timeout_us) WARN_IF_UNUSED = 0 ;
+    virtual bool wait_blocking() = 0;
+
+    virtual void signal() = 0;
+
+    virtual ~BinarySemaphore(void) {}
+};
+
 /*
   a method to make semaphores less error prone. The WITH_SEMAPHORE()
   macro will block forever for a semaphore, and will automatically
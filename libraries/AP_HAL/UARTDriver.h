@@ -87,6 +87,7 @@ public:
         OPTION_MAVLINK_NO_FORWARD = (1U<<10), // don't forward MAVLink data to or from this device
         OPTION_NOFIFO             = (1U<<11), // disable hardware FIFO
         OPTION_NOSTREAMOVERRIDE   = (1U<<12), // don't allow GCS to override streamrates
+        OPTION_MAVLINK_FAIR_QUEUE = (1U<<13), // share the measured link rate between MAVLink streams by weight
     };
 
     enum flow_control {
@@ -5,7 +5,11 @@
 #define HAL_MEM_CLASS HAL_MEM_CLASS_1000
 #define HAL_OS_POSIX_IO 1
 #define HAL_OS_SOCKETS 1
+// boards with more room can raise this to 32768 for the larger
+// StorageManager layout
+#ifndef HAL_STORAGE_SIZE
 #define HAL_STORAGE_SIZE            16384
+#endif
 #define HAL_STORAGE_SIZE_AVAILABLE  HAL_STORAGE_SIZE
 #define HAL_DSHOT_ALARM 0
 
@@ -392,6 +396,7 @@
 
 #include <AP_HAL_Linux/Semaphores.h>
 #define HAL_Semaphore Linux::Semaphore
+#define HAL_BinarySemaphore Linux::BinarySemaphore
 #include <AP_HAL/EventHandle.h>
 #define HAL_EventHandle AP_HAL::EventHandle
 
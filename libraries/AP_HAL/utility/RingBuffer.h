@@ -201,6 +201,15 @@ public:
         return buffer->read((uint8_t*)&object, sizeof(T)) == sizeof(T);
     }
 
+    /*
+      pop up to len objects off the front of the queue, returning the
+      number of objects read
+     */
+    // !!! Note ObjectBuffer_TS is a duplicate of this update, in both places !!!
+    uint32_t pop(T *data, uint32_t len) {
+        return buffer->read((uint8_t*)data, len * sizeof(T)) / sizeof(T);
+    }
+
 
     /*
      * push_force() is semantically equivalent to:
@@ -378,6 +387,16 @@ public:
         return buffer->read((uint8_t*)&object, sizeof(T)) == sizeof(T);
     }
 
+    /*
+      pop up to len objects off the front of the queue, returning the
+      number of objects read
+     */
+    // !!! Note this is a duplicate of ObjectBuffer with semaphore, update in both places !!!
+    uint32_t pop(T *data, uint32_t len) {
+        WITH_SEMAPHORE(sem);
+        return buffer->read((uint8_t*)data, len * sizeof(T)) / sizeof(T);
+    }
+
     /*
      * push_force() is semantically equivalent to:
      *   if (!push(t)) { pop(); push(t); }
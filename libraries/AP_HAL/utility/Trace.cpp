@@ -0,0 +1,136 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include "Trace.h"
+
+#if AP_HAL_TRACE_ENABLED
+
+#include <AP_Common/ExpandingString.h>
+#include <AP_Math/AP_Math.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+using namespace AP_HAL;
+
+bool Trace::_enabled;
+std::atomic<Trace::Buffer*> Trace::_buffers[max_threads];
+std::atomic<uint8_t> Trace::_num_buffers;
+thread_local Trace::Buffer *Trace::_thread_buffer;
+thread_local bool Trace::_thread_buffer_failed;
+
+uint64_t Trace::now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+Trace::Buffer *Trace::thread_buffer()
+{
+    if (_thread_buffer != nullptr) {
+        return _thread_buffer;
+    }
+    if (_thread_buffer_failed) {
+        return nullptr;
+    }
+    _thread_buffer_failed = true;
+    const uint8_t idx = _num_buffers.fetch_add(1);
+    if (idx >= max_threads) {
+        return nullptr;
+    }
+    Buffer *b = new Buffer;
+    if (b == nullptr) {
+        return nullptr;
+    }
+    pthread_getname_np(pthread_self(), b->thread_name, sizeof(b->thread_name));
+    _buffers[idx] = b;
+    _thread_buffer = b;
+    _thread_buffer_failed = false;
+    return b;
+}
+
+void Trace::record(const char *name, uint64_t start_ns, uint32_t arg)
+{
+    if (start_ns == 0) {
+        return;
+    }
+    const uint64_t end_ns = now_ns();
+    Buffer *b = thread_buffer();
+    if (b == nullptr) {
+        return;
+    }
+    const uint32_t n = b->count.load(std::memory_order_relaxed);
+    Event &e = b->events[n & (Buffer::num_events - 1)];
+    e.name = name;
+    e.start_ns = start_ns;
+    e.duration_ns = MIN(end_ns - start_ns, UINT32_MAX);
+    e.arg = arg;
+    b->count.store(n + 1, std::memory_order_release);
+}
+
+/*
+  the events are copied out of each buffer while its thread may be
+  writing to it. Events the thread overwrote during the copy are
+  dropped by checking the count again afterwards, along with the
+  oldest, which it may have been part way through overwriting
+ */
+void Trace::dump(ExpandingString &str)
+{
+    Event *copy = new Event[Buffer::num_events];
+    if (copy == nullptr) {
+        return;
+    }
+    str.printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    const char *sep = "";
+    const uint8_t num_buffers = MIN(_num_buffers.load(), max_threads);
+    for (uint8_t tid=0; tid<num_buffers; tid++) {
+        const Buffer *b = _buffers[tid];
+        if (b == nullptr) {
+            continue;
+        }
+        str.printf("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                   sep, unsigned(tid), b->thread_name);
+        sep = ",\n";
+
+        const uint32_t end = b->count.load(std::memory_order_acquire);
+        const uint32_t start = end > Buffer::num_events ? end - Buffer::num_events : 0;
+        for (uint32_t i=start; i<end; i++) {
+            copy[i - start] = b->events[i & (Buffer::num_events - 1)];
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint32_t count = b->count.load(std::memory_order_relaxed);
+        uint32_t first = start;
+        if (count >= Buffer::num_events) {
+            first = MAX(first, count - Buffer::num_events + 1);
+        }
+
+        for (uint32_t i=first; i<end; i++) {
+            const Event &e = copy[i - start];
+            // times are in microseconds. Formatted as integers as
+            // float formatting would lose the precision
+            str.printf("%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%llu.%03u,\"dur\":%u.%03u,\"args\":{\"arg\":%u}}",
+                       sep, e.name, unsigned(tid),
+                       (unsigned long long)(e.start_ns / 1000U), unsigned(e.start_ns % 1000U),
+                       unsigned(e.duration_ns / 1000U), unsigned(e.duration_ns % 1000U),
+                       unsigned(e.arg));
+        }
+    }
+    str.printf("\n]}\n");
+    delete[] copy;
+}
+
+#endif  // AP_HAL_TRACE_ENABLED
@@ -0,0 +1,116 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  low overhead trace of what ran when, on each thread
+
+  The scheduler tasks, HAL timer and IO processes, device periodic
+  callbacks and EKF updates record when they started and how long they
+  took into a ring buffer belonging to the thread they ran on. Only
+  that thread writes to its buffer so recording takes no lock. The
+  buffers can be read while recording, as @SYS/trace.json in the
+  Chrome trace event format, which Perfetto and chrome://tracing show
+  as a timeline per thread.
+
+  Times are from the host monotonic clock, not AP_HAL::micros64(), so
+  in SITL they show how long the code took to run rather than
+  simulation time.
+ */
+
+#pragma once
+
+#include <AP_HAL/AP_HAL_Boards.h>
+
+#ifndef AP_HAL_TRACE_ENABLED
+#define AP_HAL_TRACE_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
+#if AP_HAL_TRACE_ENABLED
+
+#include <atomic>
+#include <stdint.h>
+
+class ExpandingString;
+
+namespace AP_HAL {
+
+class Trace {
+public:
+    // recording is off until enabled
+    static void enable(bool enable) { _enabled = enable; }
+    static bool enabled() { return _enabled; }
+
+    // start time of an event, or zero if not recording
+    static uint64_t start() { return _enabled ? now_ns() : 0; }
+
+    /*
+      record an event which ran from start_ns, as returned by start(),
+      until now. name must be a string which is never freed. arg is
+      shown with the event, for example to tell instances apart
+     */
+    static void record(const char *name, uint64_t start_ns, uint32_t arg=0);
+
+    // write the recorded events as a Chrome trace event JSON file
+    static void dump(ExpandingString &str);
+
+    // record the time spent in a scope
+    class Scope {
+    public:
+        Scope(const char *name, uint32_t arg=0) :
+            _name(name),
+            _arg(arg),
+            _start_ns(start()) {}
+        ~Scope() {
+            record(_name, _start_ns, _arg);
+        }
+    private:
+        const char *_name;
+        const uint32_t _arg;
+        const uint64_t _start_ns;
+    };
+
+private:
+    static uint64_t now_ns();
+
+    struct Event {
+        const char *name;
+        uint64_t start_ns;
+        uint32_t duration_ns;
+        uint32_t arg;
+    };
+
+    struct Buffer {
+        // a power of two
+        static const uint16_t num_events = 2048;
+        Event events[num_events];
+        // number of events ever written
+        std::atomic<uint32_t> count;
+        char thread_name[16];
+    };
+
+    // the calling thread's buffer, allocated on its first event
+    static Buffer *thread_buffer();
+    static thread_local Buffer *_thread_buffer;
+    static thread_local bool _thread_buffer_failed;
+
+    static bool _enabled;
+
+    static const uint8_t max_threads = 32;
+    static std::atomic<Buffer*> _buffers[max_threads];
+    static std::atomic<uint8_t> _num_buffers;
+};
+
+}  // namespace AP_HAL
+
+#endif  // AP_HAL_TRACE_ENABLED
@@ -0,0 +1,86 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/utility/Trace.h>
+
+#if AP_HAL_TRACE_ENABLED
+
+#include <AP_Common/ExpandingString.h>
+#include <string.h>
+#include <thread>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static uint32_t count_occurrences(const char *str, const char *needle)
+{
+    uint32_t count = 0;
+    for (const char *p = strstr(str, needle); p != nullptr; p = strstr(p + 1, needle)) {
+        count++;
+    }
+    return count;
+}
+
+TEST(Trace, Disabled)
+{
+    AP_HAL::Trace::enable(false);
+    EXPECT_EQ(AP_HAL::Trace::start(), 0U);
+    {
+        AP_HAL::Trace::Scope scope("disabled_event");
+    }
+    ExpandingString str;
+    AP_HAL::Trace::dump(str);
+    EXPECT_EQ(strstr(str.get_string(), "disabled_event"), nullptr);
+}
+
+TEST(Trace, Scope)
+{
+    AP_HAL::Trace::enable(true);
+    {
+        AP_HAL::Trace::Scope scope("scope_event", 7);
+    }
+    AP_HAL::Trace::enable(false);
+
+    ExpandingString str;
+    AP_HAL::Trace::dump(str);
+    const char *s = str.get_string();
+    EXPECT_EQ(strncmp(s, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 39), 0);
+    EXPECT_NE(strstr(s, "\"name\":\"scope_event\",\"ph\":\"X\""), nullptr);
+    EXPECT_NE(strstr(s, "\"args\":{\"arg\":7}"), nullptr);
+    EXPECT_EQ(strcmp(s + str.get_length() - 4, "\n]}\n"), 0);
+}
+
+// only the most recent events are kept, less the oldest of the 2048
+// in the buffer which dump() does not read as it may be being
+// overwritten
+TEST(Trace, Wrap)
+{
+    AP_HAL::Trace::enable(true);
+    for (uint16_t i=0; i<5000; i++) {
+        AP_HAL::Trace::record("wrap_event", AP_HAL::Trace::start());
+    }
+    AP_HAL::Trace::enable(false);
+
+    ExpandingString str;
+    AP_HAL::Trace::dump(str);
+    EXPECT_EQ(count_occurrences(str.get_string(), "wrap_event"), 2047U);
+}
+
+// each thread gets its own buffer
+TEST(Trace, Threads)
+{
+    AP_HAL::Trace::enable(true);
+    std::thread t([]() {
+        AP_HAL::Trace::Scope scope("thread_event");
+    });
+    t.join();
+    AP_HAL::Trace::record("main_event", AP_HAL::Trace::start());
+    AP_HAL::Trace::enable(false);
+
+    ExpandingString str;
+    AP_HAL::Trace::dump(str);
+    EXPECT_EQ(count_occurrences(str.get_string(), "\"thread_event\""), 1U);
+    EXPECT_GE(count_occurrences(str.get_string(), "\"thread_name\""), 2U);
+}
+
+#endif  // AP_HAL_TRACE_ENABLED
+
+AP_GTEST_MAIN()
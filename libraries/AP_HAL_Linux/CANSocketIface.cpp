@@ -40,6 +40,7 @@
 #include "Scheduler.h"
 #include <AP_CANManager/AP_CANManager.h>
 #include <AP_Common/ExpandingString.h>
+#include <AP_Math/AP_Math.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -263,128 +264,207 @@ uint32_t CANIface::getErrorCount() const
 void CANIface::_pollWrite()
 {
     while (_hasReadyTx()) {
-        const CanTxItem tx = _tx_queue.top();
-        uint64_t curr_time = AP_HAL::native_micros64();
-        if (tx.deadline >= curr_time) {
-            // hal.console->printf("%x TDEAD: %lu CURRT: %lu DEL: %lu\n",tx.frame.id,  tx.deadline, curr_time, tx.deadline-curr_time);
-            const int res = _write(tx.frame);
-            if (res == 1) {                   // Transmitted successfully
+        // take the frames which are still due, highest priority
+        // first, up to the space left in the socket
+        CanTxItem batch[CAN_IO_BATCH_SIZE];
+        uint8_t count = 0;
+        const uint8_t space = MIN(_max_frames_in_socket_tx_queue - _frames_in_socket_tx_queue, ARRAY_SIZE(batch));
+        const uint64_t curr_time = AP_HAL::native_micros64();
+        while (count < space && !_tx_queue.empty()) {
+            const CanTxItem tx = _tx_queue.top();
+            (void)_tx_queue.pop();
+            if (tx.deadline >= curr_time) {
+                batch[count++] = tx;
+            } else {
+                stats.tx_timedout++;
+            }
+        }
+        if (count == 0) {
+            break;
+        }
+
+        const int res = _write(batch, count);
+        stats.num_tx_syscalls++;
+        uint8_t done = 0;
+        if (res > 0) {                        // Transmitted successfully
+            for (; done < res; done++) {
                 _incrementNumFramesInSocketTxQueue();
-                if (tx.loopback) {
-                    _pending_loopback_ids.insert(tx.frame.id);
+                if (batch[done].loopback) {
+                    _pending_loopback_ids.insert(batch[done].frame.id);
                 }
                 stats.tx_success++;
-            } else if (res == 0) {            // Not transmitted, nor is it an error
-                stats.tx_full++;
-                break;                        // Leaving the loop, the frame remains enqueued for the next retry
-            } else {                          // Transmission error
-                stats.tx_write_fail++;
             }
-        } else {
-            // hal.console->printf("TDEAD: %lu CURRT: %lu DEL: %lu\n", tx.deadline, curr_time, curr_time-tx.deadline);
-            stats.tx_timedout++;
+        } else if (res < 0) {                 // Transmission error
+            // the first frame is removed from the queue even though
+            // transmission failed
+            stats.tx_write_fail++;
+            done = 1;
+        } else {                              // Not transmitted, nor is it an error
+            stats.tx_full++;
         }
 
-        // Removing the frame from the queue even if transmission failed
-        (void)_tx_queue.pop();
+        // the frames which were not sent remain enqueued for the
+        // next retry
+        for (uint8_t i = done; i < count; i++) {
+            _tx_queue.push(batch[i]);
+        }
+        if (res == 0) {
+            break;
+        }
     }
 }
 
 bool CANIface::_pollRead()
 {
+    bool received = false;
     uint8_t iterations_count = 0;
     while (iterations_count < CAN_MAX_POLL_ITERATIONS_COUNT)
     {
-        iterations_count++;
-        CanRxItem rx;
-        rx.timestamp_us = AP_HAL::native_micros64();  // Monotonic timestamp is not required to be precise (unlike UTC)
-        bool loopback = false;
-        const int res = _read(rx.frame, rx.timestamp_us, loopback);
-        if (res == 1) {
+        CanRxItem batch[CAN_IO_BATCH_SIZE];
+        const int res = _read(batch, ARRAY_SIZE(batch));
+        stats.num_rx_syscalls++;
+        if (res < 0) {
+            stats.rx_errors++;
+            break;
+        }
+        for (uint8_t i = 0; i < res; i++) {
+            CanRxItem &rx = batch[i];
             bool accept = true;
-            if (loopback) {           // We receive loopback for all CAN frames
+            if (rx.flags & Loopback) {        // We receive loopback for all CAN frames
                 _confirmSentFrame();
-                rx.flags |= Loopback;
                 accept = _wasInPendingLoopbackSet(rx.frame);
                 stats.tx_confirmed++;
+            } else if (!_checkHWFilters(makeSocketCanFrame(rx.frame))) {
+                accept = false;
             }
             if (accept) {
                 _rx_queue.push(rx);
                 stats.rx_received++;
-                return true;
+                received = true;
             }
-        } else if (res == 0) {
-            break;
-        } else {
-            stats.rx_errors++;
+        }
+        iterations_count += res;
+        // stop once the socket is drained, or when frames have been
+        // received
+        if (res < int(ARRAY_SIZE(batch)) || received) {
             break;
         }
     }
-    return false;
+    return received;
 }
 
-int CANIface::_write(const AP_HAL::CANFrame& frame) const
+/*
+  write frames to the socket with one system call. Returns the number
+  written, 0 if the socket buffer is full or -1 if the first frame
+  could not be written
+ */
+int CANIface::_write(const CanTxItem* items, uint8_t count) const
 {
     if (_fd < 0) {
         return -1;
     }
-    errno = 0;
 
-    const can_frame sockcan_frame = makeSocketCanFrame(frame);
+    can_frame sockcan_frames[CAN_IO_BATCH_SIZE];
+    iovec iov[CAN_IO_BATCH_SIZE];
+    mmsghdr msgs[CAN_IO_BATCH_SIZE] {};
+    count = MIN(count, CAN_IO_BATCH_SIZE);
+    for (uint8_t i = 0; i < count; i++) {
+        sockcan_frames[i] = makeSocketCanFrame(items[i].frame);
+        iov[i].iov_base = &sockcan_frames[i];
+        iov[i].iov_len = sizeof(sockcan_frames[i]);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
 
-    const int res = write(_fd, &sockcan_frame, sizeof(sockcan_frame));
+    errno = 0;
+    const int res = sendmmsg(_fd, msgs, count, MSG_DONTWAIT);
     if (res <= 0) {
         if (errno == ENOBUFS || errno == EAGAIN) {  // Writing is not possible atm, not an error
             return 0;
         }
-        return res;
-    }
-    if (res != sizeof(sockcan_frame)) {
         return -1;
     }
-    return 1;
+    return res;
 }
 
+/*
+  convert the kernel receive time of a frame to the native_micros64()
+  clock, falling back to now_us if there is none
+ */
+static uint64_t kernel_rx_timestamp_us(msghdr &msg, uint64_t now_us, uint64_t now_realtime_us)
+{
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SO_TIMESTAMP) {
+            continue;
+        }
+        timeval tv;
+        memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));
+        const uint64_t rx_realtime_us = uint64_t(tv.tv_sec) * 1000000ULL + tv.tv_usec;
+        // the kernel time is on the realtime clock, so only its age
+        // is used. A step of the realtime clock could make it
+        // nonsense
+        if (rx_realtime_us > now_realtime_us || now_realtime_us - rx_realtime_us > MIN(now_us, 1000000ULL)) {
+            break;
+        }
+        return now_us - (now_realtime_us - rx_realtime_us);
+    }
+    return now_us;
+}
 
-int CANIface::_read(AP_HAL::CANFrame& frame, uint64_t& timestamp_us, bool& loopback) const
+/*
+  read the frames waiting in the socket, up to count, with one system
+  call. Returns the number read, which is 0 if there are none, or -1
+  on error
+ */
+int CANIface::_read(CanRxItem* items, uint8_t count) const
 {
     if (_fd < 0) {
         return -1;
     }
-    auto iov = iovec();
-    auto sockcan_frame = can_frame();
-    iov.iov_base = &sockcan_frame;
-    iov.iov_len  = sizeof(sockcan_frame);
+
+    can_frame sockcan_frames[CAN_IO_BATCH_SIZE];
+    iovec iov[CAN_IO_BATCH_SIZE];
     union {
         uint8_t data[CMSG_SPACE(sizeof(::timeval))];
         struct cmsghdr align;
-    } control;
-
-    auto msg = msghdr();
-    msg.msg_iov    = &iov;
-    msg.msg_iovlen = 1;
-    msg.msg_control = control.data;
-    msg.msg_controllen = sizeof(control.data);
-
-    const int res = recvmsg(_fd, &msg, MSG_DONTWAIT);
+    } control[CAN_IO_BATCH_SIZE];
+    mmsghdr msgs[CAN_IO_BATCH_SIZE] {};
+    count = MIN(count, CAN_IO_BATCH_SIZE);
+    for (uint8_t i = 0; i < count; i++) {
+        iov[i].iov_base = &sockcan_frames[i];
+        iov[i].iov_len = sizeof(sockcan_frames[i]);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = control[i].data;
+        msgs[i].msg_hdr.msg_controllen = sizeof(control[i].data);
+    }
+
+    const int res = recvmmsg(_fd, msgs, count, MSG_DONTWAIT, nullptr);
     if (res <= 0) {
         return (res < 0 && errno == EWOULDBLOCK) ? 0 : res;
     }
-    /*
-     * Flags
-     */
-    loopback = (msg.msg_flags & static_cast<int>(MSG_CONFIRM)) != 0;
 
-    if (!loopback && !_checkHWFilters(sockcan_frame)) {
-        return 0;
+    const uint64_t now_us = AP_HAL::native_micros64();
+    timespec now_realtime;
+    clock_gettime(CLOCK_REALTIME, &now_realtime);
+    const uint64_t now_realtime_us = uint64_t(now_realtime.tv_sec) * 1000000ULL + now_realtime.tv_nsec / 1000U;
+
+    for (uint8_t i = 0; i < res; i++) {
+        CanRxItem &rx = items[i];
+        rx.frame = makeUavcanFrame(sockcan_frames[i]);
+        rx.flags = 0;
+        /*
+         * Flags
+         */
+        if ((msgs[i].msg_hdr.msg_flags & static_cast<int>(MSG_CONFIRM)) != 0) {
+            rx.flags |= Loopback;
+        }
+        /*
+         * Timestamp
+         */
+        rx.timestamp_us = kernel_rx_timestamp_us(msgs[i].msg_hdr, now_us, now_realtime_us);
     }
-
-    frame = makeUavcanFrame(sockcan_frame);
-    /*
-     * Timestamp
-     */
-    timestamp_us = AP_HAL::native_micros64();
-    return 1;
+    return res;
 }
 
 // Might block forever, only to be used for testing
@@ -592,7 +672,9 @@ void CANIface::get_stats(ExpandingString &str)
                "num_tx_poll_req:  %u\n"
                "num_poll_waits:   %u\n"
                "num_poll_tx_events: %u\n"
-               "num_poll_rx_events: %u\n",
+               "num_poll_rx_events: %u\n"
+               "num_tx_syscalls: %u\n"
+               "num_rx_syscalls: %u\n",
                stats.tx_requests,
                stats.tx_write_fail,
                stats.tx_full,
@@ -606,7 +688,9 @@ void CANIface::get_stats(ExpandingString &str)
                stats.num_tx_poll_req,
                stats.num_poll_waits,
                stats.num_poll_tx_events,
-               stats.num_poll_rx_events);
+               stats.num_poll_rx_events,
+               stats.num_tx_syscalls,
+               stats.num_rx_syscalls);
 }
 
 #endif
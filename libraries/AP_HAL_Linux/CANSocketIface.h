@@ -53,6 +53,10 @@ enum class SocketCanError
 #define CAN_MAX_POLL_ITERATIONS_COUNT 100
 #define CAN_MAX_INIT_TRIES_COUNT 100
 #define CAN_FILTER_NUMBER 8
+// most frames moved to or from the socket in one system call. A
+// write batch is also limited by the frames allowed in the socket
+// awaiting loopback, _max_frames_in_socket_tx_queue
+#define CAN_IO_BATCH_SIZE 8
 
 class CANIface: public AP_HAL::CANIface {
 public:
@@ -130,9 +134,9 @@ private:
 
     bool _pollRead();
 
-    int _write(const AP_HAL::CANFrame& frame) const;
+    int _write(const CanTxItem* items, uint8_t count) const;
 
-    int _read(AP_HAL::CANFrame& frame, uint64_t& ts_usec, bool& loopback) const;
+    int _read(CanRxItem* items, uint8_t count) const;
 
     void _incrementNumFramesInSocketTxQueue();
 
@@ -161,6 +165,9 @@ private:
 
     const uint8_t _self_index;
 
+    // kept small as frames in the socket are sent in the order they
+    // were written, so a higher priority frame queued later waits
+    // behind all of them
     const unsigned _max_frames_in_socket_tx_queue;
     unsigned _frames_in_socket_tx_queue;
     uint32_t _tx_frame_counter;
@@ -189,6 +196,8 @@ private:
         uint32_t num_poll_waits;
         uint32_t num_poll_tx_events;
         uint32_t num_poll_rx_events;
+        uint32_t num_tx_syscalls;
+        uint32_t num_rx_syscalls;
     } stats;
 };
 
@@ -21,6 +21,7 @@
 #include <sys/epoll.h>
 #include <sys/timerfd.h>
 
+#include <AP_HAL/utility/Trace.h>
 #include <AP_Math/AP_Math.h>
 
 namespace Linux {
@@ -41,7 +42,13 @@ void TimerPollable::on_can_read()
         _wrapper->start_cb();
     }
 
+#if AP_HAL_TRACE_ENABLED
+    const uint64_t trace_start_ns = AP_HAL::Trace::start();
+#endif
     _cb();
+#if AP_HAL_TRACE_ENABLED
+    AP_HAL::Trace::record("device", trace_start_ns);
+#endif
 
     if (_wrapper) {
         _wrapper->end_cb();
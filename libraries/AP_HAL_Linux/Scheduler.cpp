@@ -10,6 +10,7 @@
 #include <unistd.h>
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/Trace.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_Vehicle/AP_Vehicle_Type.h>
 
@@ -240,6 +241,9 @@ void Scheduler::_timer_task()
     // now call the timer based drivers
     for (i = 0; i < _num_timer_procs; i++) {
         if (_timer_proc[i]) {
+#if AP_HAL_TRACE_ENABLED
+            AP_HAL::Trace::Scope trace_scope("timer", i);
+#endif
             _timer_proc[i]();
         }
     }
@@ -259,6 +263,9 @@ void Scheduler::_run_io(void)
     // now call the IO based drivers
     for (int i = 0; i < _num_io_procs; i++) {
         if (_io_proc[i]) {
+#if AP_HAL_TRACE_ENABLED
+            AP_HAL::Trace::Scope trace_scope("io", i);
+#endif
             _io_proc[i]();
         }
     }
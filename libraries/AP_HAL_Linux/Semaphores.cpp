@@ -43,3 +43,62 @@ bool Semaphore::take_nonblocking()
     return pthread_mutex_trylock(&_lock) == 0;
 }
 
+
+/*
+  binary semaphore
+ */
+BinarySemaphore::BinarySemaphore(bool initial_state) :
+    AP_HAL::BinarySemaphore(initial_state),
+    _pending(initial_state)
+{
+    pthread_mutex_init(&_lock, nullptr);
+
+    // time the waits against the monotonic clock so they are not
+    // affected by the system time being set
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&_cond, &attr);
+}
+
+bool BinarySemaphore::wait(uint32_t timeout_us)
+{
+    pthread_mutex_lock(&_lock);
+    if (!_pending) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        const uint64_t nsec = ts.tv_nsec + uint64_t(timeout_us) * 1000U;
+        ts.tv_sec += nsec / 1000000000ULL;
+        ts.tv_nsec = nsec % 1000000000ULL;
+        while (!_pending) {
+            if (pthread_cond_timedwait(&_cond, &_lock, &ts) != 0) {
+                break;
+            }
+        }
+    }
+    const bool ret = _pending;
+    _pending = false;
+    pthread_mutex_unlock(&_lock);
+    return ret;
+}
+
+bool BinarySemaphore::wait_blocking()
+{
+    pthread_mutex_lock(&_lock);
+    while (!_pending) {
+        pthread_cond_wait(&_cond, &_lock);
+    }
+    _pending = false;
+    pthread_mutex_unlock(&_lock);
+    return true;
+}
+
+void BinarySemaphore::signal()
+{
+    pthread_mutex_lock(&_lock);
+    if (!_pending) {
+        _pending = true;
+        pthread_cond_signal(&_cond);
+    }
+    pthread_mutex_unlock(&_lock);
+}
@@ -9,13 +9,16 @@
 #include <unistd.h>
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Common/ExpandingString.h>
+#include <AP_Math/AP_Math.h>
 #include <AP_Vehicle/AP_Vehicle_Type.h>
 
 using namespace Linux;
 
 /*
-  This stores 'eeprom' data on the SD card, with a 4k size, and a
-  in-memory buffer. This keeps the latency down.
+  This stores 'eeprom' data on the SD card, with a HAL_STORAGE_SIZE
+  in-memory buffer. This keeps the latency down. Changes are written
+  back from the io thread in coalesced batches, see _flush().
  */
 
 // name the storage file after the sketch so you can use the same board
@@ -141,7 +144,7 @@ void Storage::init()
         return;
     }
 
-    _dirty_mask = 0;
+    _dirty_mask.clearall();
 
     dpath = hal.util->get_custom_storage_directory();
     if (!dpath) {
@@ -171,15 +174,13 @@ void Storage::init()
     }
 
     _fd = fd;
+    _path = dpath;
     _initialised = true;
 }
 
 /*
-  mark some lines as dirty. Note that there is no attempt to avoid
-  the race condition between this code and the _timer_tick() code
-  below, which both update _dirty_mask. If we lose the race then the
-  result is that a line is written more than once, but it won't result
-  in a line not being written.
+  mark some lines as dirty. The semaphore protects the multi-word
+  dirty mask against the clear done by _flush() in the io thread
  */
 void Storage::_mark_dirty(uint16_t loc, uint16_t length)
 {
@@ -187,10 +188,13 @@ void Storage::_mark_dirty(uint16_t loc, uint16_t length)
         return;
     }
     uint16_t end = loc + length - 1;
-    for (uint8_t line=loc>>LINUX_STORAGE_LINE_SHIFT;
+    if (_dirty_mask.empty()) {
+        _dirty_since_ms = AP_HAL::millis();
+    }
+    for (uint16_t line=loc>>LINUX_STORAGE_LINE_SHIFT;
          line <= end>>LINUX_STORAGE_LINE_SHIFT;
          line++) {
-        _dirty_mask |= 1U << line;
+        _dirty_mask.set(line);
     }
 }
 
@@ -210,6 +214,7 @@ void Storage::write_block(uint16_t loc, const void *src, size_t n)
     }
     if (memcmp(src, &_buffer[loc], n) != 0) {
         init();
+        WITH_SEMAPHORE(_sem);
         memcpy(&_buffer[loc], src, n);
         _mark_dirty(loc, n);
     }
@@ -217,54 +222,141 @@ void Storage::write_block(uint16_t loc, const void *src, size_t n)
 
 void Storage::_timer_tick(void)
 {
-    if (!_initialised || _dirty_mask == 0 || _fd == -1) {
+    if (!_initialised || _dirty_mask.empty()) {
         return;
     }
 
-    // write out the first dirty set of lines. We don't write more
-    // than one to keep the latency of this call to a minimum
-    uint8_t i, n;
-    for (i=0; i<LINUX_STORAGE_NUM_LINES; i++) {
-        if (_dirty_mask & (1<<i)) {
-            break;
-        }
-    }
-    if (i == LINUX_STORAGE_NUM_LINES) {
-        // this shouldn't be possible
+    // give the caller time to finish a burst of writes so they are
+    // merged into a single flush
+    if (AP_HAL::millis() - _dirty_since_ms < LINUX_STORAGE_FLUSH_INTERVAL_MS) {
         return;
     }
-    uint32_t write_mask = (1U<<i);
-    // see how many lines to write
-    for (n=1; (i+n) < LINUX_STORAGE_NUM_LINES &&
-             n < (LINUX_STORAGE_MAX_WRITE>>LINUX_STORAGE_LINE_SHIFT); n++) {
-        if (!(_dirty_mask & (1<<(n+i)))) {
-            break;
+
+    if (_fd == -1) {
+        // a flush failed and closed the file, try again at most once
+        // per flush interval
+        _fd = open(_path, O_RDWR|O_CLOEXEC);
+        if (_fd == -1) {
+            _dirty_since_ms = AP_HAL::millis();
+            return;
+        }
+    }
+
+    _flush();
+}
+
+/*
+  write all of [offset, offset+length) from _buffer, retrying on
+  short writes and EINTR
+ */
+bool Storage::_write_range(uint32_t offset, uint32_t length)
+{
+    while (length > 0) {
+        ssize_t ret = pwrite(_fd, &_buffer[offset], length, offset);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
         }
-        // mark that line clean
-        write_mask |= (1<<(n+i));
+        if (ret == 0) {
+            return false;
+        }
+        offset += ret;
+        length -= ret;
+        _stats.bytes_written += ret;
     }
+    _stats.writes++;
+    return true;
+}
+
+/*
+  write out every dirty line, merging nearby dirty runs into single
+  writes, followed by one fdatasync()
+ */
+void Storage::_flush(void)
+{
+    const uint64_t start_us = AP_HAL::micros64();
 
     /*
-      write the lines. This also updates _dirty_mask. Note that
-      because this is a SCHED_FIFO thread it will not be preempted
-      by the main task except during blocking calls. This means we
-      don't need a semaphore around the _dirty_mask updates.
+      take the dirty set and clear it while holding the semaphore. A
+      line changed by the main thread while we are writing it will be
+      marked dirty again and picked up by the next flush, so we never
+      lose an update even though we write straight from _buffer
      */
-    if (lseek(_fd, i<<LINUX_STORAGE_LINE_SHIFT, SEEK_SET) == (i<<LINUX_STORAGE_LINE_SHIFT)) {
-        _dirty_mask &= ~write_mask;
-        if (write(_fd, &_buffer[i<<LINUX_STORAGE_LINE_SHIFT], n<<LINUX_STORAGE_LINE_SHIFT) != n<<LINUX_STORAGE_LINE_SHIFT) {
-            // write error - likely EINTR
-            _dirty_mask |= write_mask;
-            close(_fd);
-            _fd = -1;
+    Bitmask<LINUX_STORAGE_NUM_LINES> to_write;
+    {
+        WITH_SEMAPHORE(_sem);
+        to_write = _dirty_mask;
+        _dirty_mask.clearall();
+    }
+
+    bool ok = true;
+    uint16_t line = 0;
+    while (line < LINUX_STORAGE_NUM_LINES) {
+        if (!to_write.get(line)) {
+            line++;
+            continue;
         }
-        if (_dirty_mask == 0) {
-            if (fsync(_fd) != 0) {
-                close(_fd);
-                _fd = -1;
+        const uint16_t first = line;
+        uint16_t last = line;
+        for (line++; line < LINUX_STORAGE_NUM_LINES; line++) {
+            if (to_write.get(line)) {
+                last = line;
+            } else if (line - last > LINUX_STORAGE_MERGE_GAP_LINES) {
+                break;
             }
         }
+        const uint32_t offset = uint32_t(first) << LINUX_STORAGE_LINE_SHIFT;
+        const uint32_t length = uint32_t(last + 1 - first) << LINUX_STORAGE_LINE_SHIFT;
+        if (!_write_range(offset, length)) {
+            ok = false;
+            break;
+        }
+    }
+
+    if (ok && fdatasync(_fd) != 0) {
+        ok = false;
     }
+
+    if (!ok) {
+        // put back everything we took, _timer_tick() reopens the
+        // file and tries again
+        WITH_SEMAPHORE(_sem);
+        for (uint16_t i=0; i<LINUX_STORAGE_NUM_LINES; i++) {
+            if (to_write.get(i)) {
+                _dirty_mask.set(i);
+            }
+        }
+        _stats.errors++;
+        close(_fd);
+        _fd = -1;
+        return;
+    }
+
+    const uint32_t dt_us = AP_HAL::micros64() - start_us;
+    _stats.flushes++;
+    _stats.last_flush_us = dt_us;
+    _stats.max_flush_us = MAX(_stats.max_flush_us, dt_us);
+}
+
+/*
+  report write-back statistics
+ */
+void Storage::storage_info(ExpandingString &str)
+{
+    str.printf("Size: %u lines: %u dirty: %u\n",
+               unsigned(sizeof(_buffer)),
+               unsigned(LINUX_STORAGE_NUM_LINES),
+               unsigned(_dirty_mask.count()));
+    str.printf("Flushes: %u writes: %u errors: %u bytes: %llu\n",
+               unsigned(_stats.flushes),
+               unsigned(_stats.writes),
+               unsigned(_stats.errors),
+               (unsigned long long)_stats.bytes_written);
+    str.printf("Flush latency: last %uus max %uus\n",
+               unsigned(_stats.last_flush_us),
+               unsigned(_stats.max_flush_us));
 }
 
 /*
@@ -1,19 +1,42 @@
 #pragma once
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Common/Bitmask.h>
 
 #define LINUX_STORAGE_SIZE HAL_STORAGE_SIZE
-#define LINUX_STORAGE_MAX_WRITE 512
 #define LINUX_STORAGE_LINE_SHIFT 9
 #define LINUX_STORAGE_LINE_SIZE (1<<LINUX_STORAGE_LINE_SHIFT)
 #define LINUX_STORAGE_NUM_LINES (LINUX_STORAGE_SIZE/LINUX_STORAGE_LINE_SIZE)
 
+/*
+  dirty lines are held back for this long after the first change so
+  that bursts of parameter and mission writes are coalesced into a
+  single flush with one fdatasync()
+ */
+#ifndef LINUX_STORAGE_FLUSH_INTERVAL_MS
+#define LINUX_STORAGE_FLUSH_INTERVAL_MS 500
+#endif
+
+/*
+  dirty runs separated by at most this many clean lines are merged
+  into one write. Rewriting a few clean lines is cheaper on eMMC than
+  an extra partial page program
+ */
+#ifndef LINUX_STORAGE_MERGE_GAP_LINES
+#define LINUX_STORAGE_MERGE_GAP_LINES 4
+#endif
+
+static_assert(LINUX_STORAGE_SIZE % LINUX_STORAGE_LINE_SIZE == 0,
+              "Storage is not multiple of line size");
+static_assert(LINUX_STORAGE_SIZE <= 65536,
+              "Storage must be addressable with 16 bit offsets");
+
 namespace Linux {
 
 class Storage : public AP_HAL::Storage
 {
 public:
-    Storage() : _fd(-1),_dirty_mask(0) { }
+    Storage() : _fd(-1) { }
 
     static Storage *from(AP_HAL::Storage *storage) {
         return static_cast<Storage*>(storage);
@@ -36,14 +59,32 @@ public:
 
     virtual void _timer_tick(void) override;
 
+    void storage_info(ExpandingString &str) override;
+
 protected:
     void _mark_dirty(uint16_t loc, uint16_t length);
     int _storage_create(const char *dpath);
+    void _flush(void);
+    bool _write_range(uint32_t offset, uint32_t length);
 
     int _fd;
+    // storage file, reopened after a failed flush
+    const char *_path;
     volatile bool _initialised;
-    volatile uint32_t _dirty_mask;
+    HAL_Semaphore _sem;
+    Bitmask<LINUX_STORAGE_NUM_LINES> _dirty_mask;
+    uint32_t _dirty_since_ms;
     uint8_t _buffer[LINUX_STORAGE_SIZE];
+
+    // write-back statistics, reported through storage_info()
+    struct {
+        uint64_t bytes_written;
+        uint32_t flushes;
+        uint32_t writes;
+        uint32_t errors;
+        uint32_t last_flush_us;
+        uint32_t max_flush_us;
+    } _stats;
 };
 
 }
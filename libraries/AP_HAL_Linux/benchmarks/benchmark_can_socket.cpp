@@ -0,0 +1,281 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX && HAL_NUM_CAN_IFACES
+
+#include <AP_HAL_Linux/CANSocketIface.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <net/if.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+/*
+  cost of moving frames through a SocketCAN socket one system call
+  per frame, as the driver used to, against sendmmsg()/recvmmsg() on
+  batches of frames. Needs a virtual CAN interface named can0:
+
+    ip link add dev can0 type vcan && ip link set up can0
+
+  Each iteration of the transmit benchmarks sends a batch of frames
+  and reads back their loopback, as the driver does to confirm
+  transmission. The driver has at most _max_frames_in_socket_tx_queue
+  (2) frames awaiting loopback, so it never writes more than 2 frames
+  in one call and those are the batch sizes measured. The receive
+  benchmarks have a second socket on can0 stand in for other nodes on
+  the bus, sending frames the driver reads in batches of up to
+  CAN_IO_BATCH_SIZE.
+
+  As well as the frame rate the label gives the latency from starting
+  to send the batch to reading each frame, mean and max, and the mean
+  of the part of it up to the kernel SO_TIMESTAMP of the frame. Frames
+  that do not arrive within DRAIN_TIMEOUT_US are counted as lost.
+ */
+
+#define DRAIN_TIMEOUT_US 100000U
+
+static uint64_t realtime_us()
+{
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return uint64_t(ts.tv_sec) * 1000000ULL + ts.tv_nsec / 1000U;
+}
+
+// kernel receive time of a frame on the realtime clock, 0 if none
+static uint64_t kernel_timestamp_us(msghdr &msg)
+{
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_TIMESTAMP) {
+            timeval tv;
+            memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));
+            return uint64_t(tv.tv_sec) * 1000000ULL + tv.tv_usec;
+        }
+    }
+    return 0;
+}
+
+struct Latency {
+    uint64_t count;
+    uint64_t total_us;
+    uint64_t max_us;
+    uint64_t kernel_count;
+    uint64_t kernel_total_us;
+    uint64_t lost;
+};
+
+static int open_socket(bool recv_own_msgs)
+{
+    const int s = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (s < 0) {
+        return -1;
+    }
+    ifreq ifr {};
+    strncpy(ifr.ifr_name, "can0", sizeof(ifr.ifr_name) - 1);
+    sockaddr_can addr {};
+    addr.can_family = AF_CAN;
+    const int on = 1;
+    const int own = recv_own_msgs;
+    if (ioctl(s, SIOCGIFINDEX, &ifr) < 0 ||
+        (addr.can_ifindex = ifr.ifr_ifindex,
+         bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) ||
+        setsockopt(s, SOL_SOCKET, SO_TIMESTAMP, &on, sizeof(on)) < 0 ||
+        setsockopt(s, SOL_CAN_RAW, CAN_RAW_RECV_OWN_MSGS, &own, sizeof(own)) < 0 ||
+        fcntl(s, F_SETFL, O_NONBLOCK) < 0) {
+        close(s);
+        return -1;
+    }
+    return s;
+}
+
+/*
+  read until the loopback of count frames sent at sent_us has been
+  received, or DRAIN_TIMEOUT_US has passed, adding the latency of each
+  to lat
+ */
+static void drain(int s, unsigned count, bool batched, uint64_t sent_us, Latency &lat)
+{
+    can_frame frames[CAN_IO_BATCH_SIZE];
+    iovec iov[CAN_IO_BATCH_SIZE];
+    union {
+        uint8_t data[CMSG_SPACE(sizeof(::timeval))];
+        struct cmsghdr align;
+    } control[CAN_IO_BATCH_SIZE];
+    mmsghdr msgs[CAN_IO_BATCH_SIZE] {};
+    for (uint8_t i = 0; i < CAN_IO_BATCH_SIZE; i++) {
+        iov[i].iov_base = &frames[i];
+        iov[i].iov_len = sizeof(frames[i]);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    while (count > 0) {
+        int res;
+        if (batched) {
+            for (uint8_t i = 0; i < CAN_IO_BATCH_SIZE; i++) {
+                msgs[i].msg_hdr.msg_control = control[i].data;
+                msgs[i].msg_hdr.msg_controllen = sizeof(control[i].data);
+            }
+            res = recvmmsg(s, msgs, count < CAN_IO_BATCH_SIZE ? count : CAN_IO_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+        } else {
+            msgs[0].msg_hdr.msg_control = control[0].data;
+            msgs[0].msg_hdr.msg_controllen = sizeof(control[0].data);
+            res = recvmsg(s, &msgs[0].msg_hdr, MSG_DONTWAIT) > 0 ? 1 : -1;
+        }
+        const uint64_t now_us = realtime_us();
+        if (res > 0) {
+            for (int i = 0; i < res; i++) {
+                const uint64_t latency_us = now_us - sent_us;
+                lat.count++;
+                lat.total_us += latency_us;
+                if (latency_us > lat.max_us) {
+                    lat.max_us = latency_us;
+                }
+                const uint64_t kernel_us = kernel_timestamp_us(msgs[i].msg_hdr);
+                if (kernel_us >= sent_us) {
+                    lat.kernel_count++;
+                    lat.kernel_total_us += kernel_us - sent_us;
+                }
+            }
+            count -= res;
+        } else if (errno != EWOULDBLOCK || now_us - sent_us > DRAIN_TIMEOUT_US) {
+            lat.lost += count;
+            return;
+        }
+    }
+}
+
+// frames with distinct ids, each in its own message for sendmmsg()
+struct TxFrames {
+    TxFrames() {
+        for (uint8_t i = 0; i < CAN_IO_BATCH_SIZE; i++) {
+            frames[i].can_id = 0x100 + i;
+            frames[i].can_dlc = 8;
+            iov[i].iov_base = &frames[i];
+            iov[i].iov_len = sizeof(frames[i]);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+    can_frame frames[CAN_IO_BATCH_SIZE] {};
+    iovec iov[CAN_IO_BATCH_SIZE];
+    mmsghdr msgs[CAN_IO_BATCH_SIZE] {};
+};
+
+static void set_label(benchmark::State &state, const Latency &lat, uint64_t unsent)
+{
+    char label[128];
+    snprintf(label, sizeof(label), "latency mean=%.1fus max=%uus kernel=%.1fus unsent=%u lost=%u",
+             lat.count ? double(lat.total_us) / lat.count : 0.0,
+             unsigned(lat.max_us),
+             lat.kernel_count ? double(lat.kernel_total_us) / lat.kernel_count : 0.0,
+             unsigned(unsent), unsigned(lat.lost));
+    state.SetLabel(label);
+}
+
+static void BM_CANSocketTx(benchmark::State &state, bool batched)
+{
+    const int s = open_socket(true);
+    if (s < 0) {
+        state.SetLabel("no can0 interface");
+        while (state.KeepRunning()) {}
+        return;
+    }
+    const unsigned count = state.range_x();
+    TxFrames tx;
+
+    Latency lat {};
+    uint64_t unsent = 0;
+    while (state.KeepRunning()) {
+        const uint64_t sent_us = realtime_us();
+        unsigned sent = 0;
+        if (batched) {
+            const int res = sendmmsg(s, tx.msgs, count, MSG_DONTWAIT);
+            sent = res > 0 ? res : 0;
+        } else {
+            for (unsigned i = 0; i < count; i++) {
+                if (write(s, &tx.frames[i], sizeof(tx.frames[i])) != sizeof(tx.frames[i])) {
+                    break;
+                }
+                sent++;
+            }
+        }
+        unsent += count - sent;
+        drain(s, sent, batched, sent_us, lat);
+    }
+    state.SetItemsProcessed(lat.count);
+    close(s);
+    set_label(state, lat, unsent);
+}
+
+static void BM_CANSocketRx(benchmark::State &state, bool batched)
+{
+    const int s = open_socket(true);
+    const int peer = open_socket(false);
+    if (s < 0 || peer < 0) {
+        if (s >= 0) {
+            close(s);
+        }
+        if (peer >= 0) {
+            close(peer);
+        }
+        state.SetLabel("no can0 interface");
+        while (state.KeepRunning()) {}
+        return;
+    }
+    const unsigned count = state.range_x();
+    TxFrames tx;
+
+    Latency lat {};
+    uint64_t unsent = 0;
+    while (state.KeepRunning()) {
+        // only the reads are timed
+        state.PauseTiming();
+        const uint64_t sent_us = realtime_us();
+        const int res = sendmmsg(peer, tx.msgs, count, MSG_DONTWAIT);
+        const unsigned sent = res > 0 ? res : 0;
+        unsent += count - sent;
+        state.ResumeTiming();
+        drain(s, sent, batched, sent_us, lat);
+    }
+    state.SetItemsProcessed(lat.count);
+    close(peer);
+    close(s);
+    set_label(state, lat, unsent);
+}
+
+static void BM_CANSocketTxPerFrame(benchmark::State &state)
+{
+    BM_CANSocketTx(state, false);
+}
+
+static void BM_CANSocketTxBatched(benchmark::State &state)
+{
+    BM_CANSocketTx(state, true);
+}
+
+static void BM_CANSocketRxPerFrame(benchmark::State &state)
+{
+    BM_CANSocketRx(state, false);
+}
+
+static void BM_CANSocketRxBatched(benchmark::State &state)
+{
+    BM_CANSocketRx(state, true);
+}
+
+// the driver writes at most _max_frames_in_socket_tx_queue frames at a time
+BENCHMARK(BM_CANSocketTxPerFrame)->Arg(1)->Arg(2);
+BENCHMARK(BM_CANSocketTxBatched)->Arg(1)->Arg(2);
+BENCHMARK(BM_CANSocketRxPerFrame)->Arg(1)->Arg(4)->Arg(CAN_IO_BATCH_SIZE);
+BENCHMARK(BM_CANSocketRxBatched)->Arg(1)->Arg(4)->Arg(CAN_IO_BATCH_SIZE);
+
+#endif  // CONFIG_HAL_BOARD == HAL_BOARD_LINUX && HAL_NUM_CAN_IFACES
+
+BENCHMARK_MAIN();
@@ -175,7 +175,10 @@ void HAL_SITL::setup_signal_handlers() const
     sigaction(SIGHUP, &sa, NULL);
     sigaction(SIGQUIT, &sa, NULL);
 #endif
-
+    if (AP::sim_profile().enabled()) {
+        // exit cleanly on ^C so the profile report is printed
+        sigaction(SIGINT, &sa, NULL);
+    }
 }
 
 /*
@@ -17,6 +17,7 @@
 #include "I2CDevice.h"
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/Trace.h>
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL && !defined(HAL_BUILD_AP_PERIPH)
 
 #include <SITL/SITL.h>
@@ -87,6 +88,9 @@ void I2CBus::_timer_tick()
     for (struct callback_info *ci = callbacks; ci != nullptr; ci = ci->next) {
         if (ci->next_usec < now) {
             WITH_SEMAPHORE(sem);
+#if AP_HAL_TRACE_ENABLED
+            AP_HAL::Trace::Scope trace_scope("device", bus);
+#endif
             ci->cb();
             ci->next_usec += ci->period_usec;
         }
@@ -136,12 +136,17 @@ void SITL_State::_setup_fdm(void)
 void SITL_State::_fdm_input_step(void)
 {
     static uint32_t last_pwm_input = 0;
+    static uint32_t last_parent_check_ms = 0;
 
     _fdm_input_local();
 
-    /* make sure we die if our parent dies */
-    if (kill(_parent_pid, 0) != 0) {
-        exit(1);
+    /* make sure we die if our parent dies. This is a system call, so
+       don't make it on every frame */
+    if (AP_HAL::millis() - last_parent_check_ms >= 100) {
+        last_parent_check_ms = AP_HAL::millis();
+        if (kill(_parent_pid, 0) != 0) {
+            exit(1);
+        }
     }
 
     if (_scheduler->interrupts_are_blocked() || _sitl == nullptr) {
@@ -187,7 +192,8 @@ void SITL_State::wait_clock(uint64_t wait_time_usec)
     // MAVProxy/pymavlink take too long to process packets and it ends
     // up seeing traffic well into our past and hits time-out
     // conditions.
-    if (sitl_model->get_speedup() > 1) {
+    const float speedup = sitl_model->get_speedup();
+    if (speedup > 1 || is_zero(speedup)) {
         while (true) {
             const int queue_length = ((HALSITL::UARTDriver*)hal.serial(0))->get_system_outqueue_length();
             // ::fprintf(stderr, "queue_length=%d\n", (signed)queue_length);
@@ -496,6 +502,7 @@ void SITL_State::_output_to_flightgear(void)
  */
 void SITL_State::_fdm_input_local(void)
 {
+    SITL::Profile::Scope profile_scope(SITL::Profile::Category::PHYSICS);
     struct sitl_input input;
 
     // check for direct RC input
@@ -509,12 +516,30 @@ void SITL_State::_fdm_input_local(void)
     // read servo inputs from ride along flight controllers
     ride_along.receive(input);
 
-    // update the model
-    sitl_model->update_model(input);
+#if HAL_SIM_SENSOR_RECORD_ENABLED
+    SITL::SensorRecord &sensor_record = AP::sim_record();
+    const bool replaying = _sitl != nullptr && sensor_record.replaying();
+#else
+    const bool replaying = false;
+#endif
+
+    // update the model, unless a sensor recording replaces it
+    if (!replaying) {
+        sitl_model->update_model(input);
+    }
 
     // get FDM output from the model
     if (_sitl) {
-        sitl_model->fill_fdm(_sitl->state);
+        if (replaying) {
+#if HAL_SIM_SENSOR_RECORD_ENABLED
+            sensor_record.replay_fdm(_sitl->state);
+#endif
+        } else {
+            sitl_model->fill_fdm(_sitl->state);
+#if HAL_SIM_SENSOR_RECORD_ENABLED
+            sensor_record.record_fdm(_sitl->state);
+#endif
+        }
 
         if (_sitl->rc_fail == SITL::SIM::SITL_RCFail_None) {
             for (uint8_t i=0; i< _sitl->state.rcin_chan_count; i++) {
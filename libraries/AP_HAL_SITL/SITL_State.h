@@ -47,6 +47,9 @@
 #include <SITL/SIM_LORD.h>
 #include <SITL/SIM_AIS.h>
 #include <SITL/SIM_GPS.h>
+#include <SITL/SIM_Lockstep.h>
+#include <SITL/SIM_Profile.h>
+#include <SITL/SIM_SensorRecord.h>
 
 #include <SITL/SIM_Frsky_D.h>
 #include <SITL/SIM_CRSF.h>
@@ -264,6 +267,11 @@ private:
     // Ride along instances via JSON SITL backend
     SITL::JSON_Master ride_along;
 
+#if HAL_SIM_LOCKSTEP_ENABLED
+    // simulation time shared with other instances
+    SITL::Lockstep lockstep;
+#endif
+
     // simulated AIS stream
     SITL::AIS *ais;
 
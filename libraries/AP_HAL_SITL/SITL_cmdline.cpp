@@ -72,7 +72,7 @@ void SITL_State::_usage(void)
            "\t--help|-h                display this help information\n"
            "\t--wipe|-w                wipe eeprom\n"
            "\t--unhide-groups|-u       parameter enumeration ignores AP_PARAM_FLAG_ENABLE\n"
-           "\t--speedup|-s SPEEDUP     set simulation speedup\n"
+           "\t--speedup|-s SPEEDUP     set simulation speedup, 0 to run as fast as possible\n"
            "\t--rate|-r RATE           set SITL framerate\n"
            "\t--console|-C             use console instead of TCP ports\n"
            "\t--instance|-I N          set instance of SITL (adds 10*instance to all port numbers)\n"
@@ -116,6 +116,14 @@ void SITL_State::_usage(void)
            "\t--start-time TIMESTR     set simulation start time in UNIX timestamp\n"
            "\t--sysid ID               set SYSID_THISMAV\n"
            "\t--slave number           set the number of JSON slaves\n"
+#if HAL_SIM_LOCKSTEP_ENABLED
+           "\t--lockstep FILE          take simulation time steps from a lockstep coordinator\n"
+#endif
+           "\t--profile                print a wall clock profile of the simulation at exit\n"
+#if HAL_SIM_SENSOR_RECORD_ENABLED
+           "\t--record FILE            record simulated sensor data to FILE\n"
+           "\t--replay FILE            replay simulated sensor data from FILE instead of running the model\n"
+#endif
         );
 }
 
@@ -208,6 +216,9 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
     char *autotest_dir = nullptr;
     _fg_address = "127.0.0.1";
     const char* config = "";
+#if HAL_SIM_LOCKSTEP_ENABLED
+    const char *lockstep_path = nullptr;
+#endif
 
     const int BASE_PORT = 5760;
     const int RCIN_PORT = 5501;
@@ -267,6 +278,10 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         CMDLINE_START_TIME,
         CMDLINE_SYSID,
         CMDLINE_SLAVE,
+        CMDLINE_LOCKSTEP,
+        CMDLINE_PROFILE,
+        CMDLINE_RECORD,
+        CMDLINE_REPLAY,
 #if STORAGE_USE_FLASH
         CMDLINE_SET_STORAGE_FLASH_ENABLED,
 #endif
@@ -326,6 +341,10 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         {"start-time",      true,   0, CMDLINE_START_TIME},
         {"sysid",           true,   0, CMDLINE_SYSID},
         {"slave",           true,   0, CMDLINE_SLAVE},
+        {"lockstep",        true,   0, CMDLINE_LOCKSTEP},
+        {"profile",         false,  0, CMDLINE_PROFILE},
+        {"record",          true,   0, CMDLINE_RECORD},
+        {"replay",          true,   0, CMDLINE_REPLAY},
 #if STORAGE_USE_FLASH
         {"set-storage-flash-enabled", true,   0, CMDLINE_SET_STORAGE_FLASH_ENABLED},
 #endif
@@ -514,6 +533,29 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
             }
             break;
         }
+        case CMDLINE_LOCKSTEP:
+#if HAL_SIM_LOCKSTEP_ENABLED
+            lockstep_path = gopt.optarg;
+#else
+            printf("lockstep not supported on this build\n");
+            exit(1);
+#endif
+            break;
+        case CMDLINE_PROFILE:
+            AP::sim_profile().enable();
+            break;
+#if HAL_SIM_SENSOR_RECORD_ENABLED
+        case CMDLINE_RECORD:
+            if (!AP::sim_record().start_recording(gopt.optarg)) {
+                exit(1);
+            }
+            break;
+        case CMDLINE_REPLAY:
+            if (!AP::sim_record().start_replay(gopt.optarg)) {
+                exit(1);
+            }
+            break;
+#endif
         default:
             _usage();
             exit(1);
@@ -554,6 +596,14 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
             sitl_model->set_instance(_instance);
             sitl_model->set_autotest_dir(autotest_dir);
             sitl_model->set_config(config);
+#if HAL_SIM_LOCKSTEP_ENABLED
+            if (lockstep_path != nullptr) {
+                if (!lockstep.init(lockstep_path, _instance)) {
+                    exit(1);
+                }
+                sitl_model->set_lockstep(&lockstep);
+            }
+#endif
             _synthetic_clock_mode = true;
             break;
         }
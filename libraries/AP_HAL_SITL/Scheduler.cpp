@@ -7,6 +7,8 @@
 #include <sys/time.h>
 #include <fenv.h>
 #include <AP_BoardConfig/AP_BoardConfig.h>
+#include <SITL/SIM_Profile.h>
+#include <AP_HAL/utility/Trace.h>
 #if defined (__clang__) || (defined (__APPLE__) && defined (__MACH__))
 #include <stdlib.h>
 #else
@@ -203,10 +205,14 @@ void Scheduler::_run_timer_procs()
         return;
     }
     _in_timer_proc = true;
+    SITL::Profile::Scope profile_scope(SITL::Profile::Category::TIMERS);
 
     // now call the timer based drivers
     for (int i = 0; i < _num_timer_procs; i++) {
         if (_timer_proc[i]) {
+#if AP_HAL_TRACE_ENABLED
+            AP_HAL::Trace::Scope trace_scope("timer", i);
+#endif
             _timer_proc[i]();
         }
     }
@@ -225,10 +231,14 @@ void Scheduler::_run_io_procs()
         return;
     }
     _in_io_proc = true;
+    SITL::Profile::Scope profile_scope(SITL::Profile::Category::IO);
 
     // now call the IO based drivers
     for (int i = 0; i < _num_io_procs; i++) {
         if (_io_proc[i]) {
+#if AP_HAL_TRACE_ENABLED
+            AP_HAL::Trace::Scope trace_scope("io", i);
+#endif
             _io_proc[i]();
         }
     }
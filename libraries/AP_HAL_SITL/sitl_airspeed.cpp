@@ -55,6 +55,12 @@ void SITL_State::_update_airspeed(float airspeed)
         airspeed2 = 340.29409348 * sqrt(5 * (pow((tube_pressure / SSL_AIR_PRESSURE + 1), 2.0/7.0) - 1.0));
     }
 
+#if HAL_SIM_SENSOR_RECORD_ENABLED
+    SITL::SensorRecord &sensor_record = AP::sim_record();
+    sensor_record.sample(SITL::SensorRecord::Type::AIRSPEED, 0, airspeed);
+    sensor_record.sample(SITL::SensorRecord::Type::AIRSPEED, 1, airspeed2);
+#endif
+
     float airspeed_pressure = (airspeed * airspeed) / airspeed_ratio;
     float airspeed2_pressure = (airspeed2 * airspeed2) / airspeed_ratio;
 
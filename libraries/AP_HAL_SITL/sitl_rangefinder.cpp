@@ -51,7 +51,11 @@ float SITL_State::_sonar_pin_voltage() const
  */
 void SITL_State::_update_rangefinder()
 {
-    sonar_pin_value = 1023 * (_sonar_pin_voltage() / 5.0f);
+    float voltage = _sonar_pin_voltage();
+#if HAL_SIM_SENSOR_RECORD_ENABLED
+    AP::sim_record().sample(SITL::SensorRecord::Type::RANGEFINDER, 0, voltage);
+#endif
+    sonar_pin_value = 1023 * (voltage / 5.0f);
 }
 
 #endif
@@ -35,6 +35,16 @@
 #define HAL_INS_TEMPERATURE_CAL_ENABLE !HAL_MINIMIZE_FEATURES && BOARD_FLASH_SIZE > 1024
 #endif
 
+// filtered gyro samples delivered to a rate controller thread, needs HAL_BinarySemaphore
+#ifndef AP_INERTIALSENSOR_RATE_LOOP_BUFFER_ENABLED
+#define AP_INERTIALSENSOR_RATE_LOOP_BUFFER_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
+// timing of gyro samples through to the motor outputs, logged as GLAT
+#ifndef AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED
+#define AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED !HAL_MINIMIZE_FEATURES && BOARD_FLASH_SIZE > 1024
+#endif
+
 
 #include <stdint.h>
 
@@ -426,6 +436,63 @@ public:
     };
     BatchSampler batchsampler{*this};
 
+#if AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED
+    /*
+      time from a gyro sample being taken to the motor outputs it
+      produced. The vehicle starts a trace on the sample its rate
+      controller runs on and marks each stage as it completes, all
+      from the thread running the rate controller. The latency of
+      each stage from the sample is logged once a second as GLAT
+     */
+    class LatencyTrace {
+    public:
+        enum class Stage : uint8_t {
+            FILTERED = 0,       // out of the notch and low pass filters
+            RATE_CONTROL,       // rate controller has run
+            MIXER,              // motor mix has run
+            OUTPUT,             // outputs pushed to the HAL
+        };
+
+        // start timing a sample taken at sample_us, which came out
+        // of the filters at filtered_us
+        void start(uint64_t sample_us, uint64_t filtered_us);
+
+        // record the time to a stage. OUTPUT ends the trace and may
+        // write the log message
+        void stage(Stage s);
+
+    private:
+        static const uint8_t num_stages = uint8_t(Stage::OUTPUT) + 1;
+        // histogram of the OUTPUT latency, the last bin holds
+        // everything over it
+        static const uint8_t num_bins = 40;
+        static const uint16_t bin_width_us = 100;
+
+        uint16_t percentile_us(uint8_t percent) const;
+        void Write_GLAT();
+
+        uint64_t _sample_us;
+        uint64_t _filtered_us;
+        bool _active;
+        // latency of each stage of the current trace
+        uint32_t _latency_us[num_stages];
+
+        uint32_t _count;
+        struct {
+            uint64_t sum_us;
+            uint32_t max_us;
+        } _stages[num_stages];
+        uint32_t _min_output_us;
+        uint16_t _bins[num_bins];
+        uint32_t _last_log_ms;
+    };
+    LatencyTrace latency_trace;
+
+    // sample and filter output times of the primary gyro sample
+    // returned by get_gyro()
+    void get_gyro_sample_times(uint64_t &sample_us, uint64_t &filtered_us) const;
+#endif
+
 #if HAL_EXTERNAL_AHRS_ENABLED
     // handle external AHRS data
     void handle_external(const AP_ExternalAHRS::ins_data_message_t &pkt);
@@ -442,6 +509,54 @@ public:
     // force save of current calibration as valid
     void force_save_calibration(void);
 
+#if AP_INERTIALSENSOR_RATE_LOOP_BUFFER_ENABLED
+    /*
+      filtered samples of one gyro as they arrive from the backend,
+      for a rate controller running in its own thread rather than at
+      the main loop rate
+     */
+    struct GyroSample {
+        Vector3f gyro;          // filtered rate in rad/s
+        float dt;               // seconds since the previous sample
+        uint64_t sample_us;
+        uint64_t filtered_us;   // when the sample came out of the filters
+    };
+
+    /*
+      queue of samples from the backend thread to the single rate
+      loop thread
+     */
+    class RateLoopBuffer {
+    public:
+        // called from the backend thread, false if the sample was
+        // dropped because the buffer is full
+        bool push(const GyroSample &sample);
+        // wait up to timeout_us for the next sample, false on timeout
+        bool pop(GyroSample &sample, uint32_t timeout_us);
+        // false if the sample storage could not be allocated
+        bool valid(void) const { return samples.get_size() != 0; }
+        void clear(void) { samples.clear(); }
+        uint32_t get_overruns(void) const { return overruns; }
+    private:
+        ObjectBuffer<GyroSample> samples{8};
+        HAL_BinarySemaphore sem;
+        uint32_t overruns = 0;
+    };
+
+    bool enable_rate_loop_buffer(void);
+    void disable_rate_loop_buffer(void);
+
+    // wait up to timeout_us for the next sample, false on timeout
+    bool get_next_gyro_sample(GyroSample &sample, uint32_t timeout_us);
+
+    // gyro the samples are taken from, which should follow the AHRS
+    // primary gyro
+    void set_rate_loop_gyro(uint8_t instance) { _rate_loop_gyro = instance; }
+
+    // samples dropped because the rate loop did not keep up
+    uint32_t get_rate_loop_overruns(void) const;
+#endif
+
 private:
     // load backend drivers
     bool _add_backend(AP_InertialSensor_Backend *backend);
@@ -502,6 +617,15 @@ private:
     bool _new_accel_data[INS_MAX_INSTANCES];
     bool _new_gyro_data[INS_MAX_INSTANCES];
 
+#if AP_INERTIALSENSOR_RATE_LOOP_BUFFER_ENABLED
+    RateLoopBuffer *_rate_loop_buffer;
+    bool _rate_loop_buffer_enabled;
+    uint8_t _rate_loop_gyro;
+
+    // called by the backends with each filtered gyro sample
+    void push_rate_loop_gyro_sample(uint8_t instance, const Vector3f &gyro, float dt, uint64_t sample_us);
+#endif
+
     // optional notch filter on gyro
     HarmonicNotchFilterParams _notch_filter;
     HarmonicNotchFilterVector3f _gyro_notch_filter[INS_MAX_INSTANCES];
@@ -563,6 +687,17 @@ private:
     uint64_t _accel_last_sample_us[INS_MAX_INSTANCES];
     uint64_t _gyro_last_sample_us[INS_MAX_INSTANCES];
 
+#if AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED
+    // sample and filter output times of the latest filtered gyro
+    // sample, and of the one published to the frontend
+    struct GyroSampleTimes {
+        uint64_t sample_us;
+        uint64_t filtered_us;
+    };
+    GyroSampleTimes _gyro_filtered_times[INS_MAX_INSTANCES];
+    GyroSampleTimes _gyro_times[INS_MAX_INSTANCES];
+#endif
+
     // sample times for checking real sensor rate for FIFO sensors
     uint16_t _sample_accel_count[INS_MAX_INSTANCES];
     uint32_t _sample_accel_start_us[INS_MAX_INSTANCES];
@@ -294,6 +294,12 @@ void AP_InertialSensor_Backend::_notify_new_gyro_raw_sample(uint8_t instance,
             _imu._gyro_harmonic_notch_filter[instance].reset();
         } else {
             _imu._gyro_filtered[instance] = gyro_filtered;
+#if AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED
+            _imu._gyro_filtered_times[instance] = { sample_us, AP_HAL::micros64() };
+#endif
+#if AP_INERTIALSENSOR_RATE_LOOP_BUFFER_ENABLED
+            _imu.push_rate_loop_gyro_sample(instance, gyro_filtered, dt, sample_us);
+#endif
         }
 
         _imu._new_gyro_data[instance] = true;
@@ -415,6 +421,12 @@ void AP_InertialSensor_Backend::_notify_new_delta_angle(uint8_t instance, const
             _imu._gyro_harmonic_notch_filter[instance].reset();
         } else {
             _imu._gyro_filtered[instance] = gyro_filtered;
+#if AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED
+            _imu._gyro_filtered_times[instance] = { sample_us, AP_HAL::micros64() };
+#endif
+#if AP_INERTIALSENSOR_RATE_LOOP_BUFFER_ENABLED
+            _imu.push_rate_loop_gyro_sample(instance, gyro_filtered, dt, sample_us);
+#endif
         }
 
         _imu._new_gyro_data[instance] = true;
@@ -727,6 +739,9 @@ void AP_InertialSensor_Backend::update_gyro(uint8_t instance)
     }
     if (_imu._new_gyro_data[instance]) {
         _publish_gyro(instance, _imu._gyro_filtered[instance]);
+#if AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED
+        _imu._gyro_times[instance] = _imu._gyro_filtered_times[instance];
+#endif
         // copy the gyro samples from the backend to the frontend window
 #if HAL_WITH_DSP
         _imu._gyro_raw[instance] = _imu._last_raw_gyro[instance] * _imu._gyro_raw_sampling_multiplier[instance];
@@ -0,0 +1,107 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  delivery of filtered samples of the AHRS primary gyro to a rate
+  controller thread. The backends push each sample as it is filtered
+  and wake the thread, so the rate controller runs at the gyro rate
+  with the latency of the sensor bus rather than of the main loop
+ */
+
+#include "AP_InertialSensor.h"
+
+#if AP_INERTIALSENSOR_RATE_LOOP_BUFFER_ENABLED
+
+bool AP_InertialSensor::enable_rate_loop_buffer(void)
+{
+    if (_rate_loop_buffer == nullptr) {
+        RateLoopBuffer *buffer = new RateLoopBuffer;
+        if (buffer == nullptr) {
+            return false;
+        }
+        if (!buffer->valid()) {
+            delete buffer;
+            return false;
+        }
+        _rate_loop_buffer = buffer;
+    }
+    // drop samples left from when the buffer was last enabled
+    _rate_loop_buffer->clear();
+    _rate_loop_buffer_enabled = true;
+    return true;
+}
+
+/*
+  stop pushing samples. The buffer is not freed as a backend may still
+  be pushing to it
+ */
+void AP_InertialSensor::disable_rate_loop_buffer(void)
+{
+    _rate_loop_buffer_enabled = false;
+}
+
+bool AP_InertialSensor::get_next_gyro_sample(GyroSample &sample, uint32_t timeout_us)
+{
+    if (!_rate_loop_buffer_enabled) {
+        return false;
+    }
+    return _rate_loop_buffer->pop(sample, timeout_us);
+}
+
+uint32_t AP_InertialSensor::get_rate_loop_overruns(void) const
+{
+    if (_rate_loop_buffer == nullptr) {
+        return 0;
+    }
+    return _rate_loop_buffer->get_overruns();
+}
+
+/*
+  called from the backend thread with each filtered sample
+ */
+void AP_InertialSensor::push_rate_loop_gyro_sample(uint8_t instance, const Vector3f &gyro, float dt, uint64_t sample_us)
+{
+    if (!_rate_loop_buffer_enabled || instance != _rate_loop_gyro) {
+        return;
+    }
+    _rate_loop_buffer->push(GyroSample{gyro, dt, sample_us, AP_HAL::micros64()});
+}
+
+bool AP_InertialSensor::RateLoopBuffer::push(const GyroSample &sample)
+{
+    // the buffer has a single reader, so the newest sample is dropped
+    // rather than popping the oldest from this thread
+    const bool ret = samples.push(sample);
+    if (!ret) {
+        overruns++;
+    }
+    sem.signal();
+    return ret;
+}
+
+bool AP_InertialSensor::RateLoopBuffer::pop(GyroSample &sample, uint32_t timeout_us)
+{
+    const uint32_t start_us = AP_HAL::micros();
+    while (!samples.pop(sample)) {
+        // the signal for a sample popped without waiting is still
+        // pending, so waking to an empty buffer is not a timeout
+        const uint32_t waited_us = AP_HAL::micros() - start_us;
+        if (waited_us >= timeout_us || !sem.wait(timeout_us - waited_us)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif  // AP_INERTIALSENSOR_RATE_LOOP_BUFFER_ENABLED
@@ -4,6 +4,7 @@
 #include <stdio.h>
 
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+#include <SITL/SIM_SensorRecord.h>
 
 const extern AP_HAL::HAL& hal;
 
@@ -181,6 +182,9 @@ void AP_InertialSensor_SITL::generate_accel()
     }
 
     accel_accum /= nsamples;
+#if HAL_SIM_SENSOR_RECORD_ENABLED
+    AP::sim_record().sample(SITL::SensorRecord::Type::ACCEL, accel_instance, accel_accum);
+#endif
     _rotate_and_correct_accel(accel_instance, accel_accum);
     _notify_new_accel_raw_sample(accel_instance, accel_accum, AP_HAL::micros64());
 
@@ -264,6 +268,9 @@ void AP_InertialSensor_SITL::generate_gyro()
         gyro.y *= (1 + scale.y * 0.01f);
         gyro.z *= (1 + scale.z * 0.01f);
 
+#if HAL_SIM_SENSOR_RECORD_ENABLED
+        AP::sim_record().sample(SITL::SensorRecord::Type::GYRO, gyro_instance, gyro);
+#endif
         gyro_accum += gyro;
         _notify_new_gyro_sensor_rate_sample(gyro_instance, gyro);
     }
@@ -0,0 +1,106 @@
+#include "AP_InertialSensor.h"
+
+#if AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED
+
+#include <AP_Logger/AP_Logger.h>
+
+#define LATENCY_TRACE_LOG_INTERVAL_MS 1000
+
+// sample and filter output times of the primary gyro sample returned
+// by get_gyro()
+void AP_InertialSensor::get_gyro_sample_times(uint64_t &sample_us, uint64_t &filtered_us) const
+{
+    sample_us = _gyro_times[_primary_gyro].sample_us;
+    filtered_us = _gyro_times[_primary_gyro].filtered_us;
+}
+
+void AP_InertialSensor::LatencyTrace::start(uint64_t sample_us, uint64_t filtered_us)
+{
+    if (sample_us == 0 || filtered_us < sample_us) {
+        // not filtered yet
+        _active = false;
+        return;
+    }
+    _sample_us = sample_us;
+    _filtered_us = filtered_us;
+    _active = true;
+}
+
+void AP_InertialSensor::LatencyTrace::stage(Stage s)
+{
+    if (!_active) {
+        return;
+    }
+    _latency_us[uint8_t(s)] = AP_HAL::micros64() - _sample_us;
+    if (s != Stage::OUTPUT) {
+        return;
+    }
+    _active = false;
+
+    // stages which were not marked count as taking no time
+    _latency_us[uint8_t(Stage::FILTERED)] = _filtered_us - _sample_us;
+    for (uint8_t i=1; i<num_stages; i++) {
+        _latency_us[i] = MAX(_latency_us[i], _latency_us[i-1]);
+    }
+    const uint32_t output_us = _latency_us[uint8_t(Stage::OUTPUT)];
+    for (uint8_t i=0; i<num_stages; i++) {
+        _stages[i].sum_us += _latency_us[i];
+        _stages[i].max_us = MAX(_stages[i].max_us, _latency_us[i]);
+        _latency_us[i] = 0;
+    }
+    if (_count == 0 || output_us < _min_output_us) {
+        _min_output_us = output_us;
+    }
+    _bins[MIN(output_us / bin_width_us, num_bins - 1U)]++;
+    _count++;
+
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - _last_log_ms >= LATENCY_TRACE_LOG_INTERVAL_MS) {
+        _last_log_ms = now_ms;
+        Write_GLAT();
+        memset(_stages, 0, sizeof(_stages));
+        memset(_bins, 0, sizeof(_bins));
+        _count = 0;
+    }
+}
+
+/*
+  latency of the OUTPUT stage below which percent of the samples
+  were, to the resolution of the histogram
+ */
+uint16_t AP_InertialSensor::LatencyTrace::percentile_us(uint8_t percent) const
+{
+    const uint32_t target = (uint64_t(_count) * percent + 99) / 100;
+    uint32_t total = 0;
+    for (uint8_t i=0; i<num_bins; i++) {
+        total += _bins[i];
+        if (total >= target) {
+            return MIN((i + 1U) * bin_width_us, _stages[uint8_t(Stage::OUTPUT)].max_us);
+        }
+    }
+    return MIN(_stages[uint8_t(Stage::OUTPUT)].max_us, UINT16_MAX);
+}
+
+void AP_InertialSensor::LatencyTrace::Write_GLAT()
+{
+    if (_count == 0) {
+        return;
+    }
+    const struct log_GLAT pkt{
+        LOG_PACKET_HEADER_INIT(LOG_GLAT_MSG),
+        time_us     : AP_HAL::micros64(),
+        count       : _count,
+        filter_us   : uint32_t(_stages[uint8_t(Stage::FILTERED)].sum_us / _count),
+        rate_us     : uint32_t(_stages[uint8_t(Stage::RATE_CONTROL)].sum_us / _count),
+        mixer_us    : uint32_t(_stages[uint8_t(Stage::MIXER)].sum_us / _count),
+        output_us   : uint32_t(_stages[uint8_t(Stage::OUTPUT)].sum_us / _count),
+        output_min_us : _min_output_us,
+        output_max_us : _stages[uint8_t(Stage::OUTPUT)].max_us,
+        p50_us      : percentile_us(50),
+        p95_us      : percentile_us(95),
+        p99_us      : percentile_us(99),
+    };
+    AP::logger().WriteBlock(&pkt, sizeof(pkt));
+}
+
+#endif  // AP_INERTIALSENSOR_LATENCY_TRACE_ENABLED
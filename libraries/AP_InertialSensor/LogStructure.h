@@ -8,7 +8,8 @@
     LOG_IMU_MSG, \
     LOG_ISBH_MSG, \
     LOG_ISBD_MSG, \
-    LOG_VIBE_MSG
+    LOG_VIBE_MSG, \
+    LOG_GLAT_MSG
 
 // @LoggerMessage: ACC
 // @Description: IMU accelerometer data
@@ -111,6 +112,34 @@ struct PACKED log_Vibe {
     uint32_t clipping;
 };
 
+// @LoggerMessage: GLAT
+// @Description: Gyro sample to motor output latency
+// @Field: TimeUS: Time since system startup
+// @Field: N: number of samples traced
+// @Field: Flt: mean time from the sample to the filter output
+// @Field: Rate: mean time from the sample to the rate controller output
+// @Field: Mix: mean time from the sample to the motor mix
+// @Field: Out: mean time from the sample to the outputs being pushed
+// @Field: OutMin: minimum time from the sample to the outputs being pushed
+// @Field: OutMax: maximum time from the sample to the outputs being pushed
+// @Field: P50: median time from the sample to the outputs being pushed
+// @Field: P95: 95th percentile of the time from the sample to the outputs being pushed
+// @Field: P99: 99th percentile of the time from the sample to the outputs being pushed
+struct PACKED log_GLAT {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint32_t count;
+    uint32_t filter_us;
+    uint32_t rate_us;
+    uint32_t mixer_us;
+    uint32_t output_us;
+    uint32_t output_min_us;
+    uint32_t output_max_us;
+    uint16_t p50_us;
+    uint16_t p95_us;
+    uint16_t p99_us;
+};
+
 #define LOG_STRUCTURE_FROM_INERTIALSENSOR        \
     { LOG_ACC_MSG, sizeof(log_ACC), \
       "ACC", "QBQfff",        "TimeUS,I,SampleUS,AccX,AccY,AccZ", "s#sooo", "F-F000" , true }, \
@@ -123,4 +152,6 @@ struct PACKED log_Vibe {
     { LOG_ISBH_MSG, sizeof(log_ISBH), \
       "ISBH", "QHBBHHQf", "TimeUS,N,type,instance,mul,smp_cnt,SampleUS,smp_rate", "s-----sz", "F-----F-" },  \
     { LOG_ISBD_MSG, sizeof(log_ISBD), \
-      "ISBD", "QHHaaa", "TimeUS,N,seqno,x,y,z", "s--ooo", "F--???" },
+      "ISBD", "QHHaaa", "TimeUS,N,seqno,x,y,z", "s--ooo", "F--???" }, \
+    { LOG_GLAT_MSG, sizeof(log_GLAT), \
+      "GLAT", "QIIIIIIIHHH", "TimeUS,N,Flt,Rate,Mix,Out,OutMin,OutMax,P50,P95,P99", "s-sssssssss", "F-FFFFFFFFF" },
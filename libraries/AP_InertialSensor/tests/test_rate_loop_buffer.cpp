@@ -0,0 +1,79 @@
+#include <AP_gtest.h>
+
+#include <AP_InertialSensor/AP_InertialSensor.h>
+
+#if AP_INERTIALSENSOR_RATE_LOOP_BUFFER_ENABLED
+
+#include <chrono>
+#include <thread>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+typedef AP_InertialSensor::GyroSample GyroSample;
+
+static GyroSample make_sample(uint32_t n)
+{
+    return GyroSample{Vector3f(n, 0, 0), 0.001f, n, n};
+}
+
+TEST(RateLoopBuffer, InOrder)
+{
+    AP_InertialSensor::RateLoopBuffer buffer;
+    ASSERT_TRUE(buffer.valid());
+    for (uint32_t i = 1; i <= 3; i++) {
+        EXPECT_TRUE(buffer.push(make_sample(i)));
+    }
+    for (uint32_t i = 1; i <= 3; i++) {
+        GyroSample sample;
+        ASSERT_TRUE(buffer.pop(sample, 1000));
+        EXPECT_EQ(sample.sample_us, i);
+    }
+    EXPECT_EQ(buffer.get_overruns(), 0U);
+}
+
+TEST(RateLoopBuffer, Timeout)
+{
+    AP_InertialSensor::RateLoopBuffer buffer;
+    GyroSample sample;
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(buffer.pop(sample, 5000));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::microseconds(5000));
+}
+
+/*
+  a pop which does not wait leaves the signal for its sample
+  pending. The next pop must keep waiting for a sample rather than
+  wake on that signal and report a timeout
+ */
+TEST(RateLoopBuffer, NoTimeoutBeforeDeadline)
+{
+    AP_InertialSensor::RateLoopBuffer buffer;
+    uint32_t n = 0;
+    for (uint8_t i = 0; i < 10; i++) {
+        // the reader is a sample behind, so both pops return at once
+        buffer.push(make_sample(++n));
+        buffer.push(make_sample(++n));
+        GyroSample sample;
+        ASSERT_TRUE(buffer.pop(sample, 0));
+        ASSERT_TRUE(buffer.pop(sample, 0));
+
+        // the next sample arrives well within the timeout
+        const uint32_t next = ++n;
+        std::thread producer([&buffer, next]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            buffer.push(make_sample(next));
+        });
+        const bool ret = buffer.pop(sample, 500000);
+        producer.join();
+        ASSERT_TRUE(ret) << "pass " << unsigned(i);
+        EXPECT_EQ(sample.sample_us, next);
+    }
+
+    // and with nothing pushed after the last pop it does time out
+    GyroSample sample;
+    EXPECT_FALSE(buffer.pop(sample, 1000));
+}
+
+#endif  // AP_INERTIALSENSOR_RATE_LOOP_BUFFER_ENABLED
+
+AP_GTEST_MAIN()
@@ -24,6 +24,7 @@
 #include <AP_Math/AP_Math.h>
 #include <GCS_MAVLink/GCS.h>
 #include <stdio.h>
+#include <SITL/SIM_Profile.h>
 
 
 extern const AP_HAL::HAL& hal;
@@ -884,6 +885,9 @@ void AP_Logger_File::flush(void)
 
 void AP_Logger_File::io_timer(void)
 {
+#if HAL_SIM_PROFILE_ENABLED
+    SITL::Profile::Scope profile_scope(SITL::Profile::Category::LOGGING);
+#endif
     uint32_t tnow = AP_HAL::millis();
     _io_timer_heartbeat = tnow;
 
@@ -1016,7 +1020,9 @@ bool AP_Logger_File::io_thread_alive() const
     // SITL speedup options, so we allow for it here.
     SITL::SIM *sitl = AP::sitl();
     if (sitl != nullptr) {
-        timeout_ms *= sitl->speedup;
+        // a speedup of zero runs as fast as possible; allow for a
+        // large speedup
+        timeout_ms *= is_zero(sitl->speedup) ? 100 : sitl->speedup;
     }
 #endif
     return (AP_HAL::millis() - _io_timer_heartbeat) < timeout_ms;
@@ -127,6 +127,12 @@ bool mat_inverse(const T *x, T *y, uint16_t dim) WARN_IF_UNUSED;
 template <typename T>
 void mat_identity(T *x, uint16_t dim);
 
+// solve A.x = b for a symmetric positive definite NxN matrix using an
+// LDL^T factorisation. Only the lower triangle of A is read and A is
+// overwritten with the factors
+template <typename T>
+bool mat_ldlt_solve(T *A, const T *b, T *x, uint16_t n) WARN_IF_UNUSED;
+
 /*
  * Constrain an angle to be within the range: -180 to 180 degrees. The second
  * parameter changes the units. Default: 1 == degrees, 10 == dezi,
@@ -0,0 +1,100 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+/*
+  throughput of the CRCs over buffers from a MAVLink frame up to a
+  terrain or FTP block. With AP_CRC_FAST_ENABLED these are the table
+  driven versions, BM_CRC32Bitwise is the bitwise crc32 for comparison
+ */
+static uint8_t buf[4096];
+
+static void fill_buf()
+{
+    uint32_t seed = 1;
+    for (uint16_t i=0; i<sizeof(buf); i++) {
+        seed = seed * 1103515245U + 12345U;
+        buf[i] = seed >> 16;
+    }
+}
+
+static void BM_CRC32(benchmark::State& state)
+{
+    fill_buf();
+    const uint32_t len = state.range_x();
+    while (state.KeepRunning()) {
+        uint32_t crc = crc_crc32(0, buf, len);
+        gbenchmark_escape(&crc);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * len);
+}
+
+static void BM_CRC32Bitwise(benchmark::State& state)
+{
+    fill_buf();
+    const uint32_t len = state.range_x();
+    while (state.KeepRunning()) {
+        uint32_t crc = 0;
+        for (uint32_t i=0; i<len; i++) {
+            crc ^= buf[i];
+            for (uint8_t j=0; j<8; j++) {
+                crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+            }
+        }
+        gbenchmark_escape(&crc);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * len);
+}
+
+static void BM_CRC24(benchmark::State& state)
+{
+    fill_buf();
+    const uint32_t len = state.range_x();
+    while (state.KeepRunning()) {
+        uint32_t crc = crc_crc24(buf, len);
+        gbenchmark_escape(&crc);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * len);
+}
+
+static void BM_CRC16CCITT(benchmark::State& state)
+{
+    fill_buf();
+    const uint32_t len = state.range_x();
+    while (state.KeepRunning()) {
+        uint16_t crc = crc16_ccitt(buf, len, 0);
+        gbenchmark_escape(&crc);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * len);
+}
+
+static void BM_CRCModbus(benchmark::State& state)
+{
+    fill_buf();
+    const uint32_t len = state.range_x();
+    while (state.KeepRunning()) {
+        uint16_t crc = calc_crc_modbus(buf, len);
+        gbenchmark_escape(&crc);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * len);
+}
+
+static void BM_CRC8DVBS2(benchmark::State& state)
+{
+    fill_buf();
+    const uint32_t len = state.range_x();
+    while (state.KeepRunning()) {
+        uint8_t crc = crc8_dvb_s2_update(0, buf, len);
+        gbenchmark_escape(&crc);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * len);
+}
+
+BENCHMARK(BM_CRC32)->Arg(64)->Arg(512)->Arg(4096);
+BENCHMARK(BM_CRC32Bitwise)->Arg(64)->Arg(512)->Arg(4096);
+BENCHMARK(BM_CRC24)->Arg(64)->Arg(512)->Arg(4096);
+BENCHMARK(BM_CRC16CCITT)->Arg(64)->Arg(512)->Arg(4096);
+BENCHMARK(BM_CRCModbus)->Arg(64)->Arg(512)->Arg(4096);
+BENCHMARK(BM_CRC8DVBS2)->Arg(64)->Arg(512)->Arg(4096);
+
+BENCHMARK_MAIN();
@@ -17,8 +17,65 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 #include "crc.h"
 
+#if AP_CRC_FAST_ENABLED && defined(__ARM_FEATURE_CRC32)
+// the ARMv8 CRC32 instructions use the same polynomial as crc_crc32()
+#include <arm_acle.h>
+#define AP_CRC_HW_CRC32 1
+#else
+#define AP_CRC_HW_CRC32 0
+#endif
+
+#if AP_CRC_FAST_ENABLED
+/*
+  lookup tables for the CRCs which are otherwise done a bit at a
+  time. They are built from the bitwise definitions on first use
+ */
+struct crc_tables {
+    crc_tables();
+    uint32_t crc32[8][256];     // slice-by-8, crc32[0] is the byte table
+    uint32_t crc24[256];
+    uint16_t modbus[256];
+    uint8_t dvb_s2[256];
+};
+
+crc_tables::crc_tables()
+{
+    for (uint16_t i=0; i<256; i++) {
+        uint32_t c32 = i;
+        uint32_t c24 = i<<16;
+        uint16_t modbus_crc = i;
+        uint8_t dvb_crc = i;
+        for (uint8_t j=0; j<8; j++) {
+            c32 = (c32 >> 1) ^ (0xEDB88320 & -(c32 & 1));
+            c24 <<= 1;
+            if (c24 & 0x1000000) {
+                c24 ^= 0x1864CFB;
+            }
+            modbus_crc = (modbus_crc >> 1) ^ (0xA001 & -(modbus_crc & 1));
+            dvb_crc = (dvb_crc << 1) ^ ((dvb_crc & 0x80) ? 0xD5 : 0);
+        }
+        crc32[0][i] = c32;
+        crc24[i] = c24;
+        modbus[i] = modbus_crc;
+        dvb_s2[i] = dvb_crc;
+    }
+    for (uint16_t i=0; i<256; i++) {
+        for (uint8_t k=1; k<8; k++) {
+            crc32[k][i] = (crc32[k-1][i] >> 8) ^ crc32[0][crc32[k-1][i] & 0xff];
+        }
+    }
+}
+
+static const crc_tables &tables()
+{
+    static const crc_tables t;
+    return t;
+}
+#endif // AP_CRC_FAST_ENABLED
+
 /**
  * crc4 method from datasheet for 16 bytes (8 short values)
  * 
@@ -93,7 +150,11 @@ uint8_t crc_crc8(const uint8_t *p, uint8_t len)
 // crc8 from betaflight
 uint8_t crc8_dvb_s2(uint8_t crc, uint8_t a)
 {
+#if AP_CRC_FAST_ENABLED
+    return tables().dvb_s2[crc ^ a];
+#else
     return crc8_dvb(crc, a, 0xD5);
+#endif
 }
 
 // crc8 from betaflight
@@ -116,9 +177,16 @@ uint8_t crc8_dvb_s2_update(uint8_t crc, const void *data, uint32_t length)
     const uint8_t *p = (const uint8_t *)data;
     const uint8_t *pend = p + length;
 
+#if AP_CRC_FAST_ENABLED
+    const uint8_t *table = tables().dvb_s2;
+    for (; p != pend; p++) {
+        crc = table[crc ^ *p];
+    }
+#else
     for (; p != pend; p++) {
         crc = crc8_dvb_s2(crc, *p);
     }
+#endif
     return crc;
 }
 
@@ -126,7 +194,12 @@ uint8_t crc8_dvb_s2_update(uint8_t crc, const void *data, uint32_t length)
 uint8_t crc8_dvb_update(uint8_t crc, const uint8_t* buf, const uint16_t buf_len)
 {
     for (uint16_t i = 0; i < buf_len; i++) {
+#if AP_CRC_FAST_ENABLED
+        // crc8_table is the same polynomial
+        crc = crc8_table[crc ^ buf[i]];
+#else
         crc = crc8_dvb(buf[i], crc, 0x7);
+#endif
     }
     return crc;
 }
@@ -188,6 +261,10 @@ uint8_t crc8_maxim(const uint8_t *data, uint16_t length)
  */
 uint16_t crc_xmodem_update(uint16_t crc, uint8_t data)
 {
+#if AP_CRC_FAST_ENABLED
+    // xmodem is the CCITT polynomial, which has a table
+    return crc16_ccitt(&data, 1, crc);
+#else
 	crc = crc ^ ((uint16_t)data << 8);
 	for (uint16_t i=0; i<8; i++)
 	{
@@ -199,15 +276,20 @@ uint16_t crc_xmodem_update(uint16_t crc, uint8_t data)
 	}
 
 	return crc;
+#endif
 }
 
 uint16_t crc_xmodem(const uint8_t *data, uint16_t len)
 {
+#if AP_CRC_FAST_ENABLED
+    return crc16_ccitt(data, len, 0);
+#else
     uint16_t crc = 0;
     for (uint16_t i=0; i<len; i++) {
         crc = crc_xmodem_update(crc, data[i]);
     }
     return crc;
+#endif
 }
 
 /*
@@ -262,6 +344,32 @@ static const uint32_t crc32_tab[] = {
 
 uint32_t crc_crc32(uint32_t crc, const uint8_t *buf, uint32_t size)
 {
+#if AP_CRC_HW_CRC32
+    for (; size >= 8; size -= 8, buf += 8) {
+        uint64_t v;
+        memcpy(&v, buf, sizeof(v));
+        crc = __crc32d(crc, v);
+    }
+    while (size--) {
+        crc = __crc32b(crc, *buf++);
+    }
+    return crc;
+#elif AP_CRC_FAST_ENABLED && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // slice-by-8, eight table lookups per 8 bytes with no dependency
+    // between them
+    const uint32_t (&t)[8][256] = tables().crc32;
+    for (; size >= 8; size -= 8, buf += 8) {
+        uint32_t lo, hi;
+        memcpy(&lo, buf, sizeof(lo));
+        memcpy(&hi, buf+4, sizeof(hi));
+        lo ^= crc;
+        crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^
+              t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^
+              t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+    }
+#endif
+
 	for (uint32_t i=0; i<size; i++) {
 		crc = crc32_tab[(crc ^ buf[i]) & 0xff] ^ (crc >> 8);
 	}
@@ -272,6 +380,9 @@ uint32_t crc_crc32(uint32_t crc, const uint8_t *buf, uint32_t size)
 // smaller (and slower) crc32 for bootloader
 uint32_t crc32_small(uint32_t crc, const uint8_t *buf, uint32_t size)
 {
+#if AP_CRC_FAST_ENABLED
+    return crc_crc32(crc, buf, size);
+#else
     while (size--) {
         const uint8_t byte = *buf++;
         crc ^= byte;
@@ -282,6 +393,7 @@ uint32_t crc32_small(uint32_t crc, const uint8_t *buf, uint32_t size)
         }
     }
     return crc;
+#endif
 }
 
 /*
@@ -357,6 +469,12 @@ uint16_t crc16_ccitt_GDL90(const uint8_t *buf, uint32_t len, uint16_t crc)
 uint16_t calc_crc_modbus(uint8_t *buf, uint16_t len)
 {
     uint16_t crc = 0xFFFF;
+#if AP_CRC_FAST_ENABLED
+    const uint16_t *table = tables().modbus;
+    for (uint16_t pos = 0; pos < len; pos++) {
+        crc = (crc >> 8) ^ table[(crc ^ buf[pos]) & 0xFF];
+    }
+#else
     for (uint16_t pos = 0; pos < len; pos++) {
         crc ^= (uint16_t) buf[pos]; // XOR byte into least sig. byte of crc
         for (uint8_t i = 8; i != 0; i--) { // Loop over each bit
@@ -369,6 +487,7 @@ uint16_t calc_crc_modbus(uint8_t *buf, uint16_t len)
             }
         }
     }
+#endif
     return crc;
 }
 
@@ -383,11 +502,17 @@ void hash_fnv_1a(uint32_t len, const uint8_t* buf, uint64_t* hash)
     }
 }
 
-// calculate 24 bit crc. We take an approach that saves memory and flash at the cost of higher CPU load.
+// calculate 24 bit crc. Unless AP_CRC_FAST_ENABLED we take an approach that saves memory and flash at the cost of higher CPU load.
 uint32_t crc_crc24(const uint8_t *bytes, uint16_t len)
 {
-    static constexpr uint32_t POLYCRC24 = 0x1864CFB;
     uint32_t crc = 0;
+#if AP_CRC_FAST_ENABLED
+    const uint32_t *table = tables().crc24;
+    while (len--) {
+        crc = ((crc<<8)&0xFFFFFF) ^ table[(crc>>16) ^ *bytes++];
+    }
+#else
+    static constexpr uint32_t POLYCRC24 = 0x1864CFB;
     while (len--) {
         uint8_t b = *bytes++;
         const uint8_t idx = (crc>>16) ^ b;
@@ -400,6 +525,7 @@ uint32_t crc_crc24(const uint8_t *bytes, uint16_t len)
         }
         crc = ((crc<<8)&0xFFFFFF) ^ crct;
     }
+#endif
     return crc;
 }
 
@@ -17,6 +17,15 @@
  */
 #pragma once
 
+#include <stdint.h>
+#include <AP_HAL/AP_HAL_Boards.h>
+
+#ifndef AP_CRC_FAST_ENABLED
+// use lookup tables for the bitwise CRCs and slice-by-8 for crc32. The
+// tables take about 10k of RAM, so by default only where it is plentiful
+#define AP_CRC_FAST_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
 uint16_t crc_crc4(uint16_t *data);
 uint8_t crc_crc8(const uint8_t *p, uint8_t len);
 uint8_t crc8_dvb_s2(uint8_t crc, uint8_t a);
@@ -466,10 +466,69 @@ void mat_identity(T *A, uint16_t n)
     }
 }
 
+/*
+ *    solve A.x = b for symmetric positive definite A using an LDL^T
+ *    factorisation. This needs no heap and roughly a third of the work
+ *    of mat_inverse() when only one solution is wanted, which is the
+ *    case for the normal equations of least squares fits
+ *
+ *    @param     A,     input nxn matrix, lower triangle is used. On return
+ *                      holds L below the diagonal and D on the diagonal
+ *    @param     b,     right hand side vector of length n
+ *    @param     x,     output solution vector of length n, may alias b
+ *    @param     n,     dimension of square matrix
+ *    @returns          false = matrix is not positive definite
+ */
+template <typename T>
+bool mat_ldlt_solve(T *A, const T *b, T *x, uint16_t n)
+{
+    for (uint16_t j = 0; j < n; j++) {
+        T d = A[j*n + j];
+        for (uint16_t k = 0; k < j; k++) {
+            d -= A[j*n + k] * A[j*n + k] * A[k*n + k];
+        }
+        if (!(d > 0) || isinf(d)) {
+            return false;
+        }
+        A[j*n + j] = d;
+        for (uint16_t i = j+1; i < n; i++) {
+            T s = A[i*n + j];
+            for (uint16_t k = 0; k < j; k++) {
+                s -= A[i*n + k] * A[j*n + k] * A[k*n + k];
+            }
+            A[i*n + j] = s / d;
+        }
+    }
+
+    if (x != b) {
+        memcpy(x, b, n*sizeof(T));
+    }
+
+    // forward substitution with unit lower triangular L
+    for (uint16_t i = 0; i < n; i++) {
+        for (uint16_t k = 0; k < i; k++) {
+            x[i] -= A[i*n + k] * x[k];
+        }
+    }
+    // diagonal
+    for (uint16_t i = 0; i < n; i++) {
+        x[i] /= A[i*n + i];
+    }
+    // back substitution with L^T
+    for (int16_t i = n-1; i >= 0; i--) {
+        for (uint16_t k = i+1; k < n; k++) {
+            x[i] -= A[k*n + i] * x[k];
+        }
+    }
+    return true;
+}
+
 template bool mat_inverse<float>(const float x[], float y[], uint16_t dim);
 template void mat_mul<float>(const float *A, const float *B, float *C, uint16_t n);
 template void mat_identity<float>(float x[], uint16_t dim);
+template bool mat_ldlt_solve<float>(float *A, const float *b, float *x, uint16_t n);
 
 template bool mat_inverse<double>(const double x[], double y[], uint16_t dim);
 template void mat_mul<double>(const double *A, const double *B, double *C, uint16_t n);
 template void mat_identity<double>(double x[], uint16_t dim);
+template bool mat_ldlt_solve<double>(double *A, const double *b, double *x, uint16_t n);
@@ -0,0 +1,128 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  bitwise reference versions of the CRCs which have table driven
+  versions when AP_CRC_FAST_ENABLED
+ */
+static uint32_t ref_crc32(uint32_t crc, const uint8_t *buf, uint32_t size)
+{
+    while (size--) {
+        crc ^= *buf++;
+        for (uint8_t i=0; i<8; i++) {
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+        }
+    }
+    return crc;
+}
+
+static uint32_t ref_crc24(const uint8_t *buf, uint16_t len)
+{
+    uint32_t crc = 0;
+    while (len--) {
+        crc ^= uint32_t(*buf++) << 16;
+        for (uint8_t i=0; i<8; i++) {
+            crc <<= 1;
+            if (crc & 0x1000000) {
+                crc ^= 0x1864CFB;
+            }
+        }
+    }
+    return crc;
+}
+
+static uint16_t ref_xmodem(uint16_t crc, const uint8_t *buf, uint32_t len)
+{
+    while (len--) {
+        crc ^= uint16_t(*buf++) << 8;
+        for (uint8_t i=0; i<8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint16_t ref_modbus(const uint8_t *buf, uint16_t len)
+{
+    uint16_t crc = 0xFFFF;
+    while (len--) {
+        crc ^= *buf++;
+        for (uint8_t i=0; i<8; i++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+        }
+    }
+    return crc;
+}
+
+static uint8_t ref_crc8(uint8_t crc, const uint8_t *buf, uint32_t len, uint8_t poly)
+{
+    while (len--) {
+        crc ^= *buf++;
+        for (uint8_t i=0; i<8; i++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ poly : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static const uint8_t check_string[] = "123456789";
+static const uint8_t check_len = 9;
+
+// the standard check values of each CRC
+TEST(CRC, CheckValues)
+{
+    EXPECT_EQ(0xCBF43926U, ~crc_crc32(~0U, check_string, check_len));
+    EXPECT_EQ(0xCBF43926U, ~crc32_small(~0U, check_string, check_len));
+    EXPECT_EQ(0xCDE703U, crc_crc24(check_string, check_len));
+    EXPECT_EQ(0x31C3U, crc_xmodem(check_string, check_len));
+    EXPECT_EQ(0x31C3U, crc16_ccitt(check_string, check_len, 0));
+    EXPECT_EQ(0x4B37U, calc_crc_modbus(const_cast<uint8_t*>(check_string), check_len));
+    EXPECT_EQ(0xBCU, crc8_dvb_s2_update(0, check_string, check_len));
+    EXPECT_EQ(0xF4U, crc8_dvb_update(0, check_string, check_len));
+}
+
+// every byte value from every CRC state reachable in one byte
+TEST(CRC, SingleBytes)
+{
+    for (uint16_t c=0; c<256; c++) {
+        for (uint16_t b=0; b<256; b++) {
+            const uint8_t byte = b;
+            // crc32 and crc16 states are seeded with spread out bits
+            const uint32_t crc32 = c * 0x01010101U ^ 0x5A3C9600U;
+            const uint16_t crc16 = c * 0x0101U ^ 0x3C00U;
+            ASSERT_EQ(ref_crc32(crc32, &byte, 1), crc_crc32(crc32, &byte, 1));
+            ASSERT_EQ(ref_crc32(crc32, &byte, 1), crc32_small(crc32, &byte, 1));
+            ASSERT_EQ(ref_xmodem(crc16, &byte, 1), crc_xmodem_update(crc16, byte));
+            ASSERT_EQ(ref_crc8(c, &byte, 1, 0xD5), crc8_dvb_s2(c, byte));
+            ASSERT_EQ(ref_crc8(c, &byte, 1, 0x07), crc8_dvb_update(c, &byte, 1));
+        }
+    }
+}
+
+// all lengths up to a few slices from every alignment
+TEST(CRC, Buffers)
+{
+    uint8_t buf[300 + 8];
+    uint32_t seed = 12345;
+    for (uint16_t i=0; i<sizeof(buf); i++) {
+        seed = seed * 1103515245U + 12345U;
+        buf[i] = seed >> 16;
+    }
+    for (uint8_t align=0; align<8; align++) {
+        uint8_t *p = &buf[align];
+        for (uint16_t len=0; len<=300; len++) {
+            ASSERT_EQ(ref_crc32(0x12345678, p, len), crc_crc32(0x12345678, p, len));
+            ASSERT_EQ(ref_crc32(0x12345678, p, len), crc32_small(0x12345678, p, len));
+            ASSERT_EQ(ref_crc24(p, len), crc_crc24(p, len));
+            ASSERT_EQ(ref_xmodem(0, p, len), crc_xmodem(p, len));
+            ASSERT_EQ(ref_modbus(p, len), calc_crc_modbus(p, len));
+            ASSERT_EQ(ref_crc8(0x2A, p, len, 0xD5), crc8_dvb_s2_update(0x2A, p, len));
+            ASSERT_EQ(ref_crc8(0x2A, p, len, 0x07), crc8_dvb_update(0x2A, p, len));
+        }
+    }
+}
+
+AP_GTEST_MAIN()
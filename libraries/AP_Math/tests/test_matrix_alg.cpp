@@ -0,0 +1,76 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// build a symmetric positive definite matrix M.M^T + I from a fixed seed
+static void make_spd(float *A, uint16_t n)
+{
+    float M[9*9];
+    uint32_t seed = 12345;
+    for (uint16_t i = 0; i < n*n; i++) {
+        seed = seed * 1103515245U + 12345U;
+        M[i] = ((seed >> 16) % 2000) / 1000.0f - 1.0f;
+    }
+    for (uint16_t i = 0; i < n; i++) {
+        for (uint16_t j = 0; j < n; j++) {
+            float s = 0;
+            for (uint16_t k = 0; k < n; k++) {
+                s += M[i*n+k] * M[j*n+k];
+            }
+            A[i*n+j] = s + (i == j ? 1.0f : 0.0f);
+        }
+    }
+}
+
+TEST(MatrixAlgTest, LDLTSolveMatchesInverse)
+{
+    for (uint16_t n = 1; n <= 9; n++) {
+        float A[9*9], A2[9*9], inv[9*9], b[9], x[9];
+        make_spd(A, n);
+        memcpy(A2, A, sizeof(float)*n*n);
+        for (uint16_t i = 0; i < n; i++) {
+            b[i] = float(i) - 3.5f;
+        }
+        ASSERT_TRUE(mat_inverse(A, inv, n));
+        ASSERT_TRUE(mat_ldlt_solve(A2, b, x, n));
+        for (uint16_t i = 0; i < n; i++) {
+            float expected = 0;
+            for (uint16_t j = 0; j < n; j++) {
+                expected += inv[i*n+j] * b[j];
+            }
+            EXPECT_NEAR(expected, x[i], 1.0e-4f);
+        }
+    }
+}
+
+TEST(MatrixAlgTest, LDLTSolveInPlace)
+{
+    float A[4*4];
+    make_spd(A, 4);
+    float A2[4*4];
+    memcpy(A2, A, sizeof(A));
+    float b[4] = { 1, -2, 3, -4 };
+    float x[4];
+    ASSERT_TRUE(mat_ldlt_solve(A, b, x, 4));
+    ASSERT_TRUE(mat_ldlt_solve(A2, b, b, 4));
+    for (uint8_t i = 0; i < 4; i++) {
+        EXPECT_FLOAT_EQ(x[i], b[i]);
+    }
+}
+
+TEST(MatrixAlgTest, LDLTSolveRejectsIndefinite)
+{
+    float A[2*2] = { 1, 2,
+                     2, 1 };
+    float b[2] = { 1, 1 };
+    float x[2];
+    EXPECT_FALSE(mat_ldlt_solve(A, b, x, 2));
+
+    float Z[2*2] = { 0, 0,
+                     0, 0 };
+    EXPECT_FALSE(mat_ldlt_solve(Z, b, x, 2));
+}
+
+AP_GTEST_MAIN()
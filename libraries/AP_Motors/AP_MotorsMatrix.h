@@ -122,6 +122,9 @@ protected:
     // remove_motor
     void                remove_motor(int8_t motor_num);
 
+    // rebuild the list of enabled motors, must be called whenever motor_enabled changes
+    void                update_enabled_motors();
+
     // configures the motors for the defined frame_class and frame_type
     virtual void        setup_motors(motor_frame_class frame_class, motor_frame_type frame_type);
 
@@ -141,6 +144,10 @@ protected:
     float               _thrust_rpyt_out[AP_MOTORS_MAX_NUM_MOTORS]; // combined roll, pitch, yaw and throttle outputs to motors in 0~1 range
     uint8_t             _test_order[AP_MOTORS_MAX_NUM_MOTORS];  // order of the motors in the test sequence
 
+    // enabled motor numbers in ascending order, the mixer loops over these rather than testing motor_enabled
+    uint8_t             _enabled_motors[AP_MOTORS_MAX_NUM_MOTORS];
+    uint8_t             _num_enabled_motors;
+
     // motor failure handling
     float               _thrust_rpyt_out_filt[AP_MOTORS_MAX_NUM_MOTORS];    // filtered thrust outputs with 1 second time constant
     uint8_t             _motor_lost_index;  // index number of the lost motor
@@ -0,0 +1,122 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_BattMonitor/AP_BattMonitor.h>
+#include <AP_Motors/AP_Motors.h>
+#include <SRV_Channel/SRV_Channel.h>
+
+#include <stdio.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static SRV_Channels srvs;
+static AP_BattMonitor _battmonitor{0, nullptr, nullptr};
+
+class AP_MotorsMatrix_Bench : public AP_MotorsMatrix
+{
+public:
+    using AP_MotorsMatrix::AP_MotorsMatrix;
+    using AP_MotorsMatrix::output_armed_stabilizing;
+    using AP_MotorsMatrix::update_throttle_filter;
+    using AP_MotorsMatrix::output_logic;
+    using AP_MotorsMatrix::get_type_string;
+
+    float thrust_out(uint8_t i) const { return _thrust_rpyt_out[i]; }
+};
+
+// AP_MotorsMatrix is a singleton, each frame is set up on this one
+static AP_MotorsMatrix_Bench motors(400);
+
+struct Frame {
+    AP_Motors::motor_frame_class frame_class;
+    AP_Motors::motor_frame_type frame_type;
+};
+
+static const Frame frames[] {
+    { AP_Motors::MOTOR_FRAME_QUAD,       AP_Motors::MOTOR_FRAME_TYPE_X },
+    { AP_Motors::MOTOR_FRAME_HEXA,       AP_Motors::MOTOR_FRAME_TYPE_X },
+    { AP_Motors::MOTOR_FRAME_Y6,         AP_Motors::MOTOR_FRAME_TYPE_Y6B },
+    { AP_Motors::MOTOR_FRAME_OCTA,       AP_Motors::MOTOR_FRAME_TYPE_X },
+    { AP_Motors::MOTOR_FRAME_OCTAQUAD,   AP_Motors::MOTOR_FRAME_TYPE_X },
+    { AP_Motors::MOTOR_FRAME_DECA,       AP_Motors::MOTOR_FRAME_TYPE_X },
+    { AP_Motors::MOTOR_FRAME_DODECAHEXA, AP_Motors::MOTOR_FRAME_TYPE_X },
+};
+
+/*
+  attitude controller outputs, a mix of small corrections and
+  saturating demands so both sides of the yaw and scaling limits are
+  taken
+ */
+struct Demand {
+    float roll, pitch, yaw;
+};
+static Demand demands[64];
+
+static void setup_frame(const Frame &frame, bool thrust_boost)
+{
+    motors.armed(false);
+    motors.init(frame.frame_class, frame.frame_type);
+    motors.update_throttle_range();
+    motors.set_throttle_avg_max(0.5f);
+    motors.armed(true);
+    motors.set_interlock(true);
+    motors.set_throttle(0.5f);
+    // spool up so the throttle is not limited to zero
+    motors.set_desired_spool_state(AP_Motors::DesiredSpoolState::THROTTLE_UNLIMITED);
+    for (uint16_t i=0; i<1000; i++) {
+        motors.output_logic();
+        motors.update_throttle_filter();
+    }
+    motors.set_thrust_boost(thrust_boost);
+
+    uint32_t seed = 1;
+    for (auto &d : demands) {
+        seed = seed * 1103515245U + 12345U;
+        d.roll = int8_t(seed >> 24) / 160.0f;
+        seed = seed * 1103515245U + 12345U;
+        d.pitch = int8_t(seed >> 24) / 160.0f;
+        seed = seed * 1103515245U + 12345U;
+        d.yaw = int8_t(seed >> 24) / 256.0f;
+    }
+}
+
+/*
+  one mix of roll, pitch, yaw and throttle to the motor outputs as
+  done on every fast loop. range_x indexes frames, range_y is 1 with
+  thrust boost active for a lost motor
+ */
+static void BM_MotorsMatrixMix(benchmark::State& state)
+{
+    const Frame &frame = frames[state.range_x()];
+    setup_frame(frame, state.range_y());
+    uint8_t n = 0;
+    float sum = 0;
+    while (state.KeepRunning()) {
+        const Demand &d = demands[n++ % ARRAY_SIZE(demands)];
+        motors.set_roll(d.roll);
+        motors.set_pitch(d.pitch);
+        motors.set_yaw(d.yaw);
+        // the motor loss check ends thrust boost on a balanced frame
+        motors.set_thrust_boost(state.range_y());
+        motors.output_armed_stabilizing();
+        sum += motors.thrust_out(0);
+    }
+    gbenchmark_escape(&sum);
+    state.SetItemsProcessed(state.iterations());
+
+    uint8_t num_motors = 0;
+    for (uint8_t i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        num_motors += motors.is_motor_enabled(i);
+    }
+    char label[48];
+    snprintf(label, sizeof(label), "%s/%s %u motors%s",
+             motors.get_frame_string(), motors.get_type_string(),
+             unsigned(num_motors), state.range_y() ? " boost" : "");
+    state.SetLabel(label);
+}
+
+BENCHMARK(BM_MotorsMatrixMix)
+    ->ArgPair(0, 0)->ArgPair(1, 0)->ArgPair(2, 0)->ArgPair(3, 0)
+    ->ArgPair(4, 0)->ArgPair(5, 0)->ArgPair(6, 0)
+    ->ArgPair(1, 1)->ArgPair(3, 1)->ArgPair(6, 1);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,438 @@
+#include <AP_gtest.h>
+
+#include <AP_BattMonitor/AP_BattMonitor.h>
+#include <AP_Motors/AP_Motors.h>
+#include <SRV_Channel/SRV_Channel.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static SRV_Channels srvs;
+static AP_BattMonitor _battmonitor{0, nullptr, nullptr};
+
+// Dummy class to access the protected mixer through a public interface
+class AP_MotorsMatrix_Test : public AP_MotorsMatrix
+{
+public:
+    using AP_MotorsMatrix::AP_MotorsMatrix;
+    using AP_MotorsMatrix::output_armed_stabilizing;
+    using AP_MotorsMatrix::update_throttle_filter;
+    using AP_MotorsMatrix::output_logic;
+    using AP_MotorsMatrix::remove_motor;
+
+    void output_armed_stabilizing_reference();
+
+    // everything the mixer reads back or writes
+    struct State {
+        float thrust_rpyt_out[AP_MOTORS_MAX_NUM_MOTORS];
+        float thrust_rpyt_out_filt[AP_MOTORS_MAX_NUM_MOTORS];
+        AP_Motors_limit limit;
+        float throttle_out;
+        uint8_t motor_lost_index;
+        bool thrust_boost;
+        bool thrust_balanced;
+    };
+
+    void save(State &s) const {
+        memcpy(s.thrust_rpyt_out, _thrust_rpyt_out, sizeof(s.thrust_rpyt_out));
+        memcpy(s.thrust_rpyt_out_filt, _thrust_rpyt_out_filt, sizeof(s.thrust_rpyt_out_filt));
+        s.limit = limit;
+        s.throttle_out = _throttle_out;
+        s.motor_lost_index = _motor_lost_index;
+        s.thrust_boost = _thrust_boost;
+        s.thrust_balanced = _thrust_balanced;
+    }
+
+    void load(const State &s) {
+        memcpy(_thrust_rpyt_out, s.thrust_rpyt_out, sizeof(_thrust_rpyt_out));
+        memcpy(_thrust_rpyt_out_filt, s.thrust_rpyt_out_filt, sizeof(_thrust_rpyt_out_filt));
+        limit = s.limit;
+        _throttle_out = s.throttle_out;
+        _motor_lost_index = s.motor_lost_index;
+        _thrust_boost = s.thrust_boost;
+        _thrust_balanced = s.thrust_balanced;
+    }
+
+    // lose a motor, with thrust boost part way in by ratio
+    void set_lost_motor(uint8_t motor, float ratio) {
+        _thrust_boost = true;
+        _thrust_boost_ratio = ratio;
+        _motor_lost_index = motor;
+    }
+
+    void clear_lost_motor() {
+        _thrust_boost = false;
+        _thrust_boost_ratio = 0.0f;
+    }
+
+private:
+    void check_for_failed_motor_reference(float throttle_thrust_best_plus_adj);
+};
+
+// AP_MotorsMatrix is a singleton, each frame is set up on this one
+static AP_MotorsMatrix_Test motors(400);
+
+/*
+  the mixer as it was before it looped over the packed list of enabled
+  motors, kept as a reference
+ */
+void AP_MotorsMatrix_Test::output_armed_stabilizing_reference()
+{
+    uint8_t i;                          // general purpose counter
+    float   roll_thrust;                // roll thrust input value, +/- 1.0
+    float   pitch_thrust;               // pitch thrust input value, +/- 1.0
+    float   yaw_thrust;                 // yaw thrust input value, +/- 1.0
+    float   throttle_thrust;            // throttle thrust input value, 0.0 - 1.0
+    float   throttle_avg_max;           // throttle thrust average maximum value, 0.0 - 1.0
+    float   throttle_thrust_max;        // throttle thrust maximum value, 0.0 - 1.0
+    float   throttle_thrust_best_rpy;   // throttle providing maximum roll, pitch and yaw range without climbing
+    float   rpy_scale = 1.0f;           // this is used to scale the roll, pitch and yaw to fit within the motor limits
+    float   yaw_allowed = 1.0f;         // amount of yaw we can fit in
+    float   thr_adj;                    // the difference between the pilot's desired throttle and throttle_thrust_best_rpy
+
+    // apply voltage and air pressure compensation
+    const float compensation_gain = get_compensation_gain(); // compensation for battery voltage and altitude
+    roll_thrust = (_roll_in + _roll_in_ff) * compensation_gain;
+    pitch_thrust = (_pitch_in + _pitch_in_ff) * compensation_gain;
+    yaw_thrust = (_yaw_in + _yaw_in_ff) * compensation_gain;
+    throttle_thrust = get_throttle() * compensation_gain;
+    throttle_avg_max = _throttle_avg_max * compensation_gain;
+
+    // If thrust boost is active then do not limit maximum thrust
+    throttle_thrust_max = _thrust_boost_ratio + (1.0f - _thrust_boost_ratio) * _throttle_thrust_max * compensation_gain;
+
+    // sanity check throttle is above zero and below current limited throttle
+    if (throttle_thrust <= 0.0f) {
+        throttle_thrust = 0.0f;
+        limit.throttle_lower = true;
+    }
+    if (throttle_thrust >= throttle_thrust_max) {
+        throttle_thrust = throttle_thrust_max;
+        limit.throttle_upper = true;
+    }
+
+    // ensure that throttle_avg_max is between the input throttle and the maximum throttle
+    throttle_avg_max = constrain_float(throttle_avg_max, throttle_thrust, throttle_thrust_max);
+
+    // calculate the highest allowed average thrust that will provide maximum control range
+    throttle_thrust_best_rpy = MIN(0.5f, throttle_avg_max);
+
+    // calculate amount of yaw we can fit into the throttle range
+    // this is always equal to or less than the requested yaw from the pilot or rate controller
+    float rp_low = 1.0f;    // lowest thrust value
+    float rp_high = -1.0f;  // highest thrust value
+    for (i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        if (motor_enabled[i]) {
+            // calculate the thrust outputs for roll and pitch
+            _thrust_rpyt_out[i] = roll_thrust * _roll_factor[i] + pitch_thrust * _pitch_factor[i];
+            // record lowest roll + pitch command
+            if (_thrust_rpyt_out[i] < rp_low) {
+                rp_low = _thrust_rpyt_out[i];
+            }
+            // record highest roll + pitch command
+            if (_thrust_rpyt_out[i] > rp_high && (!_thrust_boost || i != _motor_lost_index)) {
+                rp_high = _thrust_rpyt_out[i];
+            }
+
+            // Check the maximum yaw control that can be used on this channel
+            // Exclude any lost motors if thrust boost is enabled
+            if (!is_zero(_yaw_factor[i]) && (!_thrust_boost || i != _motor_lost_index)){
+                if (is_positive(yaw_thrust * _yaw_factor[i])) {
+                    yaw_allowed = MIN(yaw_allowed, fabsf(MAX(1.0f - (throttle_thrust_best_rpy + _thrust_rpyt_out[i]), 0.0f)/_yaw_factor[i]));
+                } else {
+                    yaw_allowed = MIN(yaw_allowed, fabsf(MAX(throttle_thrust_best_rpy + _thrust_rpyt_out[i], 0.0f)/_yaw_factor[i]));
+                }
+            }
+        }
+    }
+
+    // calculate the maximum yaw control that can be used
+    // todo: make _yaw_headroom 0 to 1
+    float yaw_allowed_min = (float)_yaw_headroom / 1000.0f;
+
+    // increase yaw headroom to 50% if thrust boost enabled
+    yaw_allowed_min = _thrust_boost_ratio * 0.5f + (1.0f - _thrust_boost_ratio) * yaw_allowed_min;
+
+    // Let yaw access minimum amount of head room
+    yaw_allowed = MAX(yaw_allowed, yaw_allowed_min);
+
+    // Include the lost motor scaled by _thrust_boost_ratio to smoothly transition this motor in and out of the calculation
+    if (_thrust_boost && motor_enabled[_motor_lost_index]) {
+        // record highest roll + pitch command
+        if (_thrust_rpyt_out[_motor_lost_index] > rp_high) {
+            rp_high = _thrust_boost_ratio * rp_high + (1.0f - _thrust_boost_ratio) * _thrust_rpyt_out[_motor_lost_index];
+        }
+
+        // Check the maximum yaw control that can be used on this channel
+        // Exclude any lost motors if thrust boost is enabled
+        if (!is_zero(_yaw_factor[_motor_lost_index])){
+            if (is_positive(yaw_thrust * _yaw_factor[_motor_lost_index])) {
+                yaw_allowed = _thrust_boost_ratio * yaw_allowed + (1.0f - _thrust_boost_ratio) * MIN(yaw_allowed, fabsf(MAX(1.0f - (throttle_thrust_best_rpy + _thrust_rpyt_out[_motor_lost_index]), 0.0f)/_yaw_factor[_motor_lost_index]));
+            } else {
+                yaw_allowed = _thrust_boost_ratio * yaw_allowed + (1.0f - _thrust_boost_ratio) * MIN(yaw_allowed, fabsf(MAX(throttle_thrust_best_rpy + _thrust_rpyt_out[_motor_lost_index], 0.0f)/_yaw_factor[_motor_lost_index]));
+            }
+        }
+    }
+
+    if (fabsf(yaw_thrust) > yaw_allowed) {
+        // not all commanded yaw can be used
+        yaw_thrust = constrain_float(yaw_thrust, -yaw_allowed, yaw_allowed);
+        limit.yaw = true;
+    }
+
+    // add yaw control to thrust outputs
+    float rpy_low = 1.0f;   // lowest thrust value
+    float rpy_high = -1.0f; // highest thrust value
+    for (i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        if (motor_enabled[i]) {
+            _thrust_rpyt_out[i] = _thrust_rpyt_out[i] + yaw_thrust * _yaw_factor[i];
+
+            // record lowest roll + pitch + yaw command
+            if (_thrust_rpyt_out[i] < rpy_low) {
+                rpy_low = _thrust_rpyt_out[i];
+            }
+            // record highest roll + pitch + yaw command
+            // Exclude any lost motors if thrust boost is enabled
+            if (_thrust_rpyt_out[i] > rpy_high && (!_thrust_boost || i != _motor_lost_index)) {
+                rpy_high = _thrust_rpyt_out[i];
+            }
+        }
+    }
+    // Include the lost motor scaled by _thrust_boost_ratio to smoothly transition this motor in and out of the calculation
+    if (_thrust_boost) {
+        // record highest roll + pitch + yaw command
+        if (_thrust_rpyt_out[_motor_lost_index] > rpy_high && motor_enabled[_motor_lost_index]) {
+            rpy_high = _thrust_boost_ratio * rpy_high + (1.0f - _thrust_boost_ratio) * _thrust_rpyt_out[_motor_lost_index];
+        }
+    }
+
+    // calculate any scaling needed to make the combined thrust outputs fit within the output range
+    if (rpy_high - rpy_low > 1.0f) {
+        rpy_scale = 1.0f / (rpy_high - rpy_low);
+    }
+    if (throttle_avg_max + rpy_low < 0) {
+        rpy_scale = MIN(rpy_scale, -throttle_avg_max / rpy_low);
+    }
+
+    // calculate how close the motors can come to the desired throttle
+    rpy_high *= rpy_scale;
+    rpy_low *= rpy_scale;
+    throttle_thrust_best_rpy = -rpy_low;
+    thr_adj = throttle_thrust - throttle_thrust_best_rpy;
+    if (rpy_scale < 1.0f) {
+        // Full range is being used by roll, pitch, and yaw.
+        limit.roll = true;
+        limit.pitch = true;
+        limit.yaw = true;
+        if (thr_adj > 0.0f) {
+            limit.throttle_upper = true;
+        }
+        thr_adj = 0.0f;
+    } else {
+        if (thr_adj < 0.0f) {
+            // Throttle can't be reduced to desired value
+            thr_adj = 0.0f;
+        } else if (thr_adj > 1.0f - (throttle_thrust_best_rpy + rpy_high)) {
+            // Throttle can't be increased to desired value
+            thr_adj = 1.0f - (throttle_thrust_best_rpy + rpy_high);
+            limit.throttle_upper = true;
+        }
+    }
+
+    // add scaled roll, pitch, constrained yaw and throttle for each motor
+    const float throttle_thrust_best_plus_adj = throttle_thrust_best_rpy + thr_adj;
+    for (i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        if (motor_enabled[i]) {
+            _thrust_rpyt_out[i] = (throttle_thrust_best_plus_adj * _throttle_factor[i]) + (rpy_scale * _thrust_rpyt_out[i]);
+        }
+    }
+
+    // determine throttle thrust for harmonic notch
+    // compensation_gain can never be zero
+    _throttle_out = throttle_thrust_best_plus_adj / compensation_gain;
+
+    // check for failed motor
+    check_for_failed_motor_reference(throttle_thrust_best_plus_adj);
+}
+
+void AP_MotorsMatrix_Test::check_for_failed_motor_reference(float throttle_thrust_best_plus_adj)
+{
+    // record filtered and scaled thrust output for motor loss monitoring purposes
+    float alpha = 1.0f / (1.0f + _loop_rate * 0.5f);
+    for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        if (motor_enabled[i]) {
+            _thrust_rpyt_out_filt[i] += alpha * (_thrust_rpyt_out[i] - _thrust_rpyt_out_filt[i]);
+        }
+    }
+
+    float rpyt_high = 0.0f;
+    float rpyt_sum = 0.0f;
+    uint8_t number_motors = 0.0f;
+    for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        if (motor_enabled[i]) {
+            number_motors += 1;
+            rpyt_sum += _thrust_rpyt_out_filt[i];
+            // record highest filtered thrust command
+            if (_thrust_rpyt_out_filt[i] > rpyt_high) {
+                rpyt_high = _thrust_rpyt_out_filt[i];
+                // hold motor lost index constant while thrust boost is active
+                if (!_thrust_boost) {
+                    _motor_lost_index = i;
+                }
+            }
+        }
+    }
+
+    float thrust_balance = 1.0f;
+    if (rpyt_sum > 0.1f) {
+        thrust_balance = rpyt_high * number_motors / rpyt_sum;
+    }
+    // ensure thrust balance does not activate for multirotors with less than 6 motors
+    if (number_motors >= 6 && thrust_balance >= 1.5f && _thrust_balanced) {
+        _thrust_balanced = false;
+    }
+    if (thrust_balance <= 1.25f && !_thrust_balanced) {
+        _thrust_balanced = true;
+    }
+
+    // check to see if thrust boost is using more throttle than _throttle_thrust_max
+    if ((_throttle_thrust_max * get_compensation_gain() > throttle_thrust_best_plus_adj) && (rpyt_high < 0.9f) && _thrust_balanced) {
+        _thrust_boost = false;
+    }
+}
+
+struct Frame {
+    AP_Motors::motor_frame_class frame_class;
+    AP_Motors::motor_frame_type frame_type;
+};
+
+static const Frame frames[] {
+    { AP_Motors::MOTOR_FRAME_QUAD,       AP_Motors::MOTOR_FRAME_TYPE_X },
+    { AP_Motors::MOTOR_FRAME_HEXA,       AP_Motors::MOTOR_FRAME_TYPE_X },
+    { AP_Motors::MOTOR_FRAME_Y6,         AP_Motors::MOTOR_FRAME_TYPE_Y6B },
+    { AP_Motors::MOTOR_FRAME_OCTA,       AP_Motors::MOTOR_FRAME_TYPE_PLUS },
+    { AP_Motors::MOTOR_FRAME_OCTAQUAD,   AP_Motors::MOTOR_FRAME_TYPE_X },
+    { AP_Motors::MOTOR_FRAME_DECA,       AP_Motors::MOTOR_FRAME_TYPE_X },
+    { AP_Motors::MOTOR_FRAME_DODECAHEXA, AP_Motors::MOTOR_FRAME_TYPE_X },
+};
+
+static void setup_frame(const Frame &frame, float throttle)
+{
+    motors.armed(false);
+    motors.init(frame.frame_class, frame.frame_type);
+    motors.update_throttle_range();
+    motors.set_throttle_avg_max(0.5f);
+    motors.armed(true);
+    motors.set_interlock(true);
+    motors.set_throttle(throttle);
+    // spool up so the throttle is not limited to zero
+    motors.set_desired_spool_state(AP_Motors::DesiredSpoolState::THROTTLE_UNLIMITED);
+    for (uint16_t i=0; i<1000; i++) {
+        motors.output_logic();
+        motors.update_throttle_filter();
+    }
+    motors.clear_lost_motor();
+}
+
+/*
+  run both mixers on the same state for a spread of small corrections
+  and saturating demands. Each step carries on from the state the
+  mixer left, so the motor loss check sees a history. If a motor is
+  given it is lost with thrust boost at ratio before every step, as
+  the motor loss check would otherwise end thrust boost
+ */
+static void expect_same_mix(const char *name, uint16_t steps, int8_t lost=-1, float ratio=0.0f)
+{
+    SCOPED_TRACE(name);
+    uint32_t seed = 1;
+    for (uint16_t n=0; n<steps; n++) {
+        if (lost >= 0) {
+            motors.set_lost_motor(lost, ratio);
+        }
+        seed = seed * 1103515245U + 12345U;
+        motors.set_roll(int8_t(seed >> 24) / 160.0f);
+        seed = seed * 1103515245U + 12345U;
+        motors.set_pitch(int8_t(seed >> 24) / 160.0f);
+        seed = seed * 1103515245U + 12345U;
+        motors.set_yaw(int8_t(seed >> 24) / 256.0f);
+
+        AP_MotorsMatrix_Test::State start, ref, out;
+        motors.save(start);
+        motors.output_armed_stabilizing_reference();
+        motors.save(ref);
+        motors.load(start);
+        motors.output_armed_stabilizing();
+        motors.save(out);
+
+        for (uint8_t i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
+            EXPECT_FLOAT_EQ(out.thrust_rpyt_out[i], ref.thrust_rpyt_out[i]) << "step " << n << " motor " << unsigned(i);
+            EXPECT_FLOAT_EQ(out.thrust_rpyt_out_filt[i], ref.thrust_rpyt_out_filt[i]) << "step " << n << " motor " << unsigned(i);
+        }
+        EXPECT_EQ(bool(out.limit.roll), bool(ref.limit.roll)) << "step " << n;
+        EXPECT_EQ(bool(out.limit.pitch), bool(ref.limit.pitch)) << "step " << n;
+        EXPECT_EQ(bool(out.limit.yaw), bool(ref.limit.yaw)) << "step " << n;
+        EXPECT_EQ(bool(out.limit.throttle_lower), bool(ref.limit.throttle_lower)) << "step " << n;
+        EXPECT_EQ(bool(out.limit.throttle_upper), bool(ref.limit.throttle_upper)) << "step " << n;
+        EXPECT_FLOAT_EQ(out.throttle_out, ref.throttle_out) << "step " << n;
+        EXPECT_EQ(out.motor_lost_index, ref.motor_lost_index) << "step " << n;
+        EXPECT_EQ(out.thrust_boost, ref.thrust_boost) << "step " << n;
+        EXPECT_EQ(out.thrust_balanced, ref.thrust_balanced) << "step " << n;
+    }
+}
+
+static uint8_t num_enabled_motors()
+{
+    uint8_t num_motors = 0;
+    for (uint8_t i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        num_motors += motors.is_motor_enabled(i);
+    }
+    return num_motors;
+}
+
+// every frame with all motors working
+TEST(AP_MotorsMatrix, MixMatchesReference)
+{
+    for (const Frame &frame : frames) {
+        for (const float throttle : { 0.1f, 0.5f, 0.9f }) {
+            setup_frame(frame, throttle);
+            ASSERT_GT(num_enabled_motors(), 0);
+            expect_same_mix(motors.get_frame_string(), 200);
+        }
+    }
+}
+
+// thrust boost for each motor of each frame, from just starting to
+// fully in. At high throttle the lost motor sets the roll, pitch and
+// yaw scaling rather than the lowest motor
+TEST(AP_MotorsMatrix, ThrustBoostMatchesReference)
+{
+    for (const Frame &frame : frames) {
+        setup_frame(frame, 0.5f);
+        for (uint8_t lost=0; lost<AP_MOTORS_MAX_NUM_MOTORS; lost++) {
+            if (!motors.is_motor_enabled(lost)) {
+                continue;
+            }
+            for (const float throttle : { 0.5f, 0.9f }) {
+                for (const float ratio : { 0.0f, 0.5f, 1.0f }) {
+                    setup_frame(frame, throttle);
+                    expect_same_mix(motors.get_frame_string(), 50, lost, ratio);
+                }
+            }
+        }
+    }
+}
+
+// a motor removed from the frame, with and without thrust boost for another
+TEST(AP_MotorsMatrix, RemovedMotorMatchesReference)
+{
+    setup_frame({ AP_Motors::MOTOR_FRAME_OCTA, AP_Motors::MOTOR_FRAME_TYPE_X }, 0.5f);
+    motors.remove_motor(2);
+    ASSERT_EQ(num_enabled_motors(), 7);
+    expect_same_mix("octa without motor 3", 200);
+
+    expect_same_mix("octa without motor 3, motor 6 lost", 200, 5, 0.5f);
+
+    // thrust boost for the removed motor itself
+    expect_same_mix("octa without motor 3, motor 3 lost", 200, 2, 1.0f);
+}
+
+AP_GTEST_MAIN()
@@ -123,6 +123,40 @@ void ekf_ring_buffer::reset()
     memset((void *)buffer,0,_size*uint32_t(elsize));
 }
 
+/*
+  checkpoint support for Replay. The data is the buffer indices
+  followed by the buffer contents
+ */
+uint32_t ekf_ring_buffer::checkpoint_size() const
+{
+    return 4 + _size*uint32_t(elsize);
+}
+
+void ekf_ring_buffer::checkpoint_save(uint8_t *data) const
+{
+    data[0] = _size;
+    data[1] = _head;
+    data[2] = _tail;
+    data[3] = _new_data;
+    if (buffer != nullptr) {
+        memcpy(&data[4], buffer, _size*uint32_t(elsize));
+    }
+}
+
+bool ekf_ring_buffer::checkpoint_restore(const uint8_t *data)
+{
+    if (data[0] != _size) {
+        return false;
+    }
+    _head = data[1];
+    _tail = data[2];
+    _new_data = data[3];
+    if (buffer != nullptr) {
+        memcpy(buffer, &data[4], _size*uint32_t(elsize));
+    }
+    return true;
+}
+
 ////////////////////////////////////////////////////
 /*
   IMU buffer operations implemented separately due to different
@@ -211,3 +245,37 @@ void *ekf_imu_buffer::get(uint8_t index) const
 {
     return get_offset(index);
 }
+
+/*
+  checkpoint support for Replay. The data is the buffer indices
+  followed by the buffer contents
+ */
+uint32_t ekf_imu_buffer::checkpoint_size() const
+{
+    return 4 + _size*uint32_t(elsize);
+}
+
+void ekf_imu_buffer::checkpoint_save(uint8_t *data) const
+{
+    data[0] = _size;
+    data[1] = _oldest;
+    data[2] = _youngest;
+    data[3] = _filled;
+    if (buffer != nullptr) {
+        memcpy(&data[4], buffer, _size*uint32_t(elsize));
+    }
+}
+
+bool ekf_imu_buffer::checkpoint_restore(const uint8_t *data)
+{
+    if (data[0] != _size) {
+        return false;
+    }
+    _oldest = data[1];
+    _youngest = data[2];
+    _filled = data[3];
+    if (buffer != nullptr) {
+        memcpy(buffer, &data[4], _size*uint32_t(elsize));
+    }
+    return true;
+}
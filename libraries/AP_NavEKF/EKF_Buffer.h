@@ -39,6 +39,15 @@ public:
     // zeroes all data in the ring buffer
     void reset();
 
+    /*
+      checkpoint support for Replay. The saved data holds the indices
+      and contents of the buffer. A checkpoint can only be restored
+      into a buffer of the same size
+     */
+    uint32_t checkpoint_size() const;
+    void checkpoint_save(uint8_t *data) const;
+    bool checkpoint_restore(const uint8_t *data);
+
 private:
     const uint8_t elsize;
     void *buffer;
@@ -78,6 +87,10 @@ public:
     void reset() {
         return ekf_ring_buffer::reset();
     }
+
+    using ekf_ring_buffer::checkpoint_size;
+    using ekf_ring_buffer::checkpoint_save;
+    using ekf_ring_buffer::checkpoint_restore;
 };
 
 
@@ -125,6 +138,15 @@ public:
         return _youngest;
     }
 
+    /*
+      checkpoint support for Replay. The saved data holds the indices
+      and contents of the buffer. A checkpoint can only be restored
+      into a buffer of the same size
+     */
+    uint32_t checkpoint_size() const;
+    void checkpoint_save(uint8_t *data) const;
+    bool checkpoint_restore(const uint8_t *data);
+
 protected:
     const uint8_t elsize;
     void *buffer;
@@ -194,4 +216,8 @@ public:
     inline uint8_t get_youngest_index() {
         return ekf_imu_buffer::get_youngest_index();
     }
+
+    using ekf_imu_buffer::checkpoint_size;
+    using ekf_imu_buffer::checkpoint_save;
+    using ekf_imu_buffer::checkpoint_restore;
 };
@@ -4,6 +4,8 @@
 #include <GCS_MAVLink/GCS.h>
 #include <AP_Logger/AP_Logger.h>
 #include <AP_Vehicle/AP_Vehicle_Type.h>
+#include <SITL/SIM_Profile.h>
+#include <AP_HAL/utility/Trace.h>
 #include <new>
 
 /*
@@ -747,6 +749,12 @@ bool NavEKF2::coreBetterScore(uint8_t new_core, uint8_t current_core) const
 // Update Filter States - this should be called whenever new IMU data is available
 void NavEKF2::UpdateFilter(void)
 {
+#if HAL_SIM_PROFILE_ENABLED
+    SITL::Profile::Scope profile_scope(SITL::Profile::Category::EKF);
+#endif
+#if AP_HAL_TRACE_ENABLED
+    AP_HAL::Trace::Scope trace_scope("EKF2");
+#endif
     AP::dal().start_frame(AP_DAL::FrameType::UpdateFilterEKF2);
 
     if (!core) {
@@ -767,6 +775,9 @@ void NavEKF2::UpdateFilter(void)
         } else {
             statePredictEnabled[i] = true;
         }
+#if AP_HAL_TRACE_ENABLED
+        AP_HAL::Trace::Scope core_trace_scope("EKF2 core", i);
+#endif
         core[i].UpdateFilter(statePredictEnabled[i]);
     }
 
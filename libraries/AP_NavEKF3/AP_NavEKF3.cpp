@@ -7,6 +7,8 @@
 #include <AP_BoardConfig/AP_BoardConfig.h>
 
 #include "AP_DAL/AP_DAL.h"
+#include <SITL/SIM_Profile.h>
+#include <AP_HAL/utility/Trace.h>
 
 #include <new>
 
@@ -882,6 +884,12 @@ bool NavEKF3::coreBetterScore(uint8_t new_core, uint8_t current_core) const
 */
 void NavEKF3::UpdateFilter(void)
 {
+#if HAL_SIM_PROFILE_ENABLED
+    SITL::Profile::Scope profile_scope(SITL::Profile::Category::EKF);
+#endif
+#if AP_HAL_TRACE_ENABLED
+    AP_HAL::Trace::Scope trace_scope("EKF3");
+#endif
     AP::dal().start_frame(AP_DAL::FrameType::UpdateFilterEKF3);
 
     if (!core) {
@@ -900,6 +908,9 @@ void NavEKF3::UpdateFilter(void)
             AP::dal().ekf_low_time_remaining(AP_DAL::EKFType::EKF3, i)) {
             allow_state_prediction = false;
         }
+#if AP_HAL_TRACE_ENABLED
+        AP_HAL::Trace::Scope core_trace_scope("EKF3 core", i);
+#endif
         core[i].UpdateFilter(allow_state_prediction);
     }
 
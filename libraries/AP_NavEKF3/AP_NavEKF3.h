@@ -25,6 +25,7 @@
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <AP_NavEKF/AP_Nav_Common.h>
 #include <AP_NavEKF/AP_NavEKF_Source.h>
+#include "AP_NavEKF3_feature.h"
 
 class NavEKF3_core;
 class EKFGSF_yaw;
@@ -362,7 +363,22 @@ public:
     // get a yaw estimator instance
     const EKFGSF_yaw *get_yawEstimator(void) const;
 
+#if EK3_FEATURE_CHECKPOINT
+    // save and restore the state of all cores and the lane selection
+    // logic. Used by Replay to start replaying part way through a
+    // log. Parameters are not part of a checkpoint, a checkpoint
+    // written with different parameters is rejected. Returns 0 size
+    // if the filter has not been initialised
+    uint32_t checkpoint_size() const;
+    void checkpoint_save(uint8_t *data) const;
+    bool checkpoint_restore(const uint8_t *data, uint32_t length);
+#endif
+
 private:
+#if EK3_FEATURE_CHECKPOINT
+    uint64_t checkpoint_param_hash() const;
+#endif
+
     uint8_t num_cores; // number of allocated cores
     uint8_t primary;   // current primary core
     NavEKF3_core *core = nullptr;
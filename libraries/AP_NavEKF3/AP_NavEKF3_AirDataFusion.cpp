@@ -19,6 +19,8 @@
 */
 void NavEKF3_core::FuseAirspeed()
 {
+    EK3_STEP_TIMER(FUSE_AIRSPEED);
+
     // declarations
     ftype vn;
     ftype ve;
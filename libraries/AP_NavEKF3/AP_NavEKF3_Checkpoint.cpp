@@ -0,0 +1,466 @@
+#include "AP_NavEKF3.h"
+#include "AP_NavEKF3_core.h"
+
+#if EK3_FEATURE_CHECKPOINT
+
+#include <AP_DAL/AP_DAL.h>
+#include <AP_Math/crc.h>
+
+/*
+  checkpoints hold the complete state of the filter so that Replay
+  can start part way through a log. Each member of the core which
+  holds filter state is saved in turn, followed by the contents of the
+  data buffers and the objects the core allocates. Members which refer
+  to memory owned by the running process are never saved.
+
+  The header holds a hash of the EK3 parameters and each core holds a
+  hash of the sizes of the members it saved, so a checkpoint is
+  rejected if it was written with different parameters or by a build
+  with a different set of state members
+ */
+
+#define CHECKPOINT_MAGIC   0x504b4345 // "ECKP"
+#define CHECKPOINT_VERSION 2
+
+struct PACKED checkpoint_header {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t num_cores;
+    uint64_t param_hash;
+};
+
+// setup of a core, which must match the core being restored into
+struct PACKED checkpoint_core_header {
+    uint8_t imu_index;
+    uint8_t core_index;
+    uint8_t imu_buffer_length;
+    uint8_t obs_buffer_length;
+    uint64_t state_hash;
+};
+
+/*
+  the members of NavEKF3_core which hold filter state, in the order
+  they are declared in AP_NavEKF3_core.h. New state members must be
+  added here, or to the feature lists below, or they will not survive
+  a checkpoint
+ */
+#define CHECKPOINT_CORE_STATE(op)                                       \
+    op(gyro_index_active); op(accel_index_active); op(statesArray);     \
+    op(inactiveBias); op(statesInitialised); op(magHealth);             \
+    op(velTimeout); op(posTimeout); op(hgtTimeout); op(magTimeout);     \
+    op(tasTimeout); op(badIMUdata); op(badIMUdata_ms);                  \
+    op(goodIMUdata_ms); op(vertVelVarClipCounter);                      \
+    op(gpsNoiseScaler); op(P); op(prevTnb); op(accNavMag);              \
+    op(accNavMagHoriz); op(earthRateNED); op(dtIMUavg);                 \
+    op(dtEkfAvg); op(dt); op(hgtRate); op(onGround);                    \
+    op(prevOnGround); op(inFlight); op(prevInFlight);                   \
+    op(manoeuvring); op(innovVelPos); op(varInnovVelPos);               \
+    op(velPosObs); op(fuseVelData); op(fusePosData);                    \
+    op(fuseHgtData); op(innovMag); op(varInnovMag); op(innovVtas);      \
+    op(varInnovVtas); op(defaultAirSpeed);                              \
+    op(defaultAirSpeedVariance); op(magFusePerformed);                  \
+    op(effectiveMagCal); op(prevTasStep_ms);                            \
+    op(prevBetaDragStep_ms); op(innovBeta); op(lastMagUpdate_us);       \
+    op(lastMagRead_ms); op(velDotNED); op(velDotNEDfilt);               \
+    op(imuSampleTime_ms); op(tasDataToFuse);                            \
+    op(lastBaroReceived_ms); op(hgtRetryTime_ms);                       \
+    op(lastVelPassTime_ms); op(lastPosPassTime_ms);                     \
+    op(lastHgtPassTime_ms); op(lastTasPassTime_ms);                     \
+    op(lastTimeGpsReceived_ms); op(timeAtLastAuxEKF_ms);                \
+    op(lastHealthyMagTime_ms); op(allMagSensorsFailed);                 \
+    op(lastSynthYawTime_ms); op(ekfStartTime_ms);                       \
+    op(lastKnownPositionNE); op(lastLaunchAccelTime_ms);                \
+    op(velTestRatio); op(posTestRatio); op(hgtTestRatio);               \
+    op(magTestRatio); op(tasTestRatio); op(inhibitWindStates);          \
+    op(windStatesAligned); op(inhibitMagStates);                        \
+    op(lastInhibitMagStates); op(needMagBodyVarReset);                  \
+    op(needEarthBodyVarReset); op(inhibitDelAngBiasStates);             \
+    op(gpsIsInUse); op(EKF_origin); op(validOrigin);                    \
+    op(gpsSpdAccuracy); op(gpsPosAccuracy); op(gpsHgtAccuracy);         \
+    op(lastGpsVelFail_ms); op(lastGpsVelPass_ms);                       \
+    op(lastGpsAidBadTime_ms); op(posDownAtTakeoff);                     \
+    op(useGpsVertVel); op(yawResetAngle); op(lastYawReset_ms);          \
+    op(tiltAlignComplete); op(yawAlignComplete);                        \
+    op(magStateInitComplete); op(stateIndexLim); op(imuDataDelayed);    \
+    op(imuDataNew); op(imuDataDownSampledNew);                          \
+    op(imuQuatDownSampleNew); op(baroDataNew); op(baroDataDelayed);     \
+    op(rangeDataNew); op(rangeDataDelayed); op(tasDataNew);             \
+    op(tasDataDelayed); op(usingDefaultAirspeed);                       \
+    op(magDataDelayed); op(gpsDataNew); op(gpsDataDelayed);             \
+    op(last_gps_idx); op(outputDataNew); op(outputDataDelayed);         \
+    op(delAngCorrection); op(velErrintegral); op(posErrintegral);       \
+    op(badImuVelErrIntegral); op(innovYaw); op(timeTasReceived_ms);     \
+    op(gpsGoodToAlign); op(magYawResetTimer_ms);                        \
+    op(consistentMagData); op(motorsArmed); op(prevMotorsArmed);        \
+    op(posVelFusionDelayed); op(optFlowFusionDelayed);                  \
+    op(airSpdFusionDelayed); op(sideSlipFusionDelayed);                 \
+    op(airDataFusionWindOnly); op(lastMagOffsets);                      \
+    op(lastMagOffsetsValid); op(posResetNE); op(lastPosReset_ms);       \
+    op(velResetNE); op(lastVelReset_ms); op(posResetD);                 \
+    op(lastPosResetD_ms); op(yawTestRatio); op(prevQuatMagReset);       \
+    op(hgtInnovFiltState); op(magSelectIndex); op(runUpdates);          \
+    op(framesSincePredict); op(startPredictEnabled);                    \
+    op(localFilterTimeStep_ms); op(posDownObsNoise);                    \
+    op(delAngCorrected); op(delVelCorrected); op(magFieldLearned);      \
+    op(wasLearningCompass_ms); op(earthMagFieldVar);                    \
+    op(bodyMagFieldVar); op(delAngBiasLearned); op(filterStatus);       \
+    op(ekfOriginHgtVar); op(ekfGpsRefHgt); op(lastOriginHgtTime_ms);    \
+    op(outputTrackError); op(velOffsetNED); op(posOffsetNED);           \
+    op(firstInitTime_ms); op(lastInitFailReport_ms);                    \
+    op(tiltErrorVariance); op(vertCompFiltState); op(gpsloc_prev);      \
+    op(lastPreAlignGpsCheckTime_ms); op(gpsDriftNE);                    \
+    op(gpsVertVelFilt); op(gpsHorizVelFilt); op(gpsSpdAccPass);         \
+    op(ekfInnovationsPass); op(sAccFilterState1);                       \
+    op(sAccFilterState2); op(lastGpsCheckTime_ms);                      \
+    op(lastInnovPassTime_ms); op(lastInnovFailTime_ms);                 \
+    op(gpsAccuracyGood); op(gpsVelInnov); op(gpsVelVarInnov);           \
+    op(gpsVelInnovTime_ms); op(flowDataValid); op(auxFlowObsInnov);     \
+    op(flowValidMeaTime_ms); op(rngValidMeaTime_ms);                    \
+    op(flowMeaTime_ms); op(gndHgtValidTime_ms); op(flowVarInnov);       \
+    op(flowInnov); op(flowInnovTime_ms); op(Popt); op(terrainState);    \
+    op(prevPosN); op(prevPosE); op(varInnovRng); op(innovRng);          \
+    op(hgtMea); op(inhibitGndState); op(prevFlowFuseTime_ms);           \
+    op(flowTestRatio); op(auxFlowTestRatio); op(R_LOS);                 \
+    op(auxRngTestRatio); op(flowGyroBias); op(rangeDataToFuse);         \
+    op(baroDataToFuse); op(gpsDataToFuse); op(magDataToFuse);           \
+    op(PV_AidingMode); op(PV_AidingModePrev); op(gndOffsetValid);       \
+    op(delAngBodyOF); op(delTimeOF); op(flowFusionActive);              \
+    op(accelPosOffset); op(baroHgtOffset); op(rngOnGnd);                \
+    op(storedRngMeas); op(storedRngMeasTime_ms);                        \
+    op(lastRngMeasTime_ms); op(rngMeasIndex); op(terrainHgtStable);     \
+    op(lastbodyVelPassTime_ms); op(bodyVelTestRatio);                   \
+    op(varInnovBodyVel); op(innovBodyVel);                              \
+    op(prevBodyVelFuseTime_ms); op(bodyOdmMeasTime_ms);                 \
+    op(bodyVelFusionDelayed); op(bodyVelFusionActive);                  \
+    op(yawMeasTime_ms); op(yawAngDataNew); op(yawAngDataDelayed);       \
+    op(yawAngDataStatic); op(rngBcnDataDelayed);                        \
+    op(lastRngBcnPassTime_ms); op(rngBcnTestRatio);                     \
+    op(rngBcnHealth); op(varInnovRngBcn); op(innovRngBcn);              \
+    op(lastTimeRngBcn_ms); op(rngBcnDataToFuse);                        \
+    op(beaconVehiclePosNED); op(beaconVehiclePosErr);                   \
+    op(rngBcnLast3DmeasTime_ms); op(rngBcnGoodToAlign);                 \
+    op(lastRngBcnChecked); op(receiverPos); op(receiverPosCov);         \
+    op(rngBcnAlignmentStarted); op(rngBcnAlignmentCompleted);           \
+    op(lastBeaconIndex); op(rngBcnPosSum); op(numBcnMeas);              \
+    op(rngSum); op(N_beacons); op(maxBcnPosD); op(minBcnPosD);          \
+    op(usingMinHypothesis); op(bcnPosDownOffsetMax);                    \
+    op(bcnPosOffsetMaxVar); op(maxOffsetStateChangeFilt);               \
+    op(bcnPosDownOffsetMin); op(bcnPosOffsetMinVar);                    \
+    op(minOffsetStateChangeFilt); op(bcnPosOffsetNED);                  \
+    op(bcnOriginEstInit); op(rngBcnFuseDataReportIndex);                \
+    op(dragFusionEnabled); op(activeHgtSource); op(prevHgtSource);      \
+    op(takeOffDetected); op(rngAtStartOfFlight);                        \
+    op(timeAtArming_ms); op(meaHgtAtTakeOff);                           \
+    op(finalInflightYawInit); op(magYawAnomallyCount);                  \
+    op(finalInflightMagInit); op(magStateResetRequest);                 \
+    op(magYawResetRequest); op(gpsYawResetRequest);                     \
+    op(posDownAtLastMagReset); op(yawInnovAtLastMagReset);              \
+    op(quatAtLastMagReset); op(gyro_diff); op(accel_diff);              \
+    op(gyro_prev); op(accel_prev); op(onGroundNotMoving);               \
+    op(lastMoveCheckLogTime_ms); op(inhibitDelVelBiasStates);           \
+    op(dvelBiasAxisInhibit); op(dvelBiasAxisVarPrev);                   \
+    op(useExtNavVel); op(faultStatus); op(gpsCheckStatus);              \
+    op(mag_state); op(prearm_fail_string);                              \
+    op(have_table_earth_field); op(table_earth_field_ga);               \
+    op(table_declination); op(last_oneHz_ms); op(timing);               \
+    op(last_filter_ok_ms); op(last_gps_yaw_ms);                         \
+    op(last_gps_yaw_fuse_ms); op(gps_yaw_mag_fallback_ok);              \
+    op(gps_yaw_mag_fallback_active);                                    \
+    op(gps_yaw_fallback_good_counter); op(EKFGSF_yaw_reset_ms);         \
+    op(EKFGSF_yaw_reset_request_ms); op(EKFGSF_yaw_reset_count);        \
+    op(EKFGSF_run_filterbank); op(EKFGSF_yaw_valid_count);              \
+    op(lastLogTime_ms); op(lastUpdateTime_ms);                          \
+    op(lastEkfStateVarLogTime_ms); op(lastTimingLogTime_ms);            \
+    op(selected_gps); op(preferred_gps); op(selected_baro);             \
+    op(selected_airspeed); op(posxy_source_last);                       \
+    op(posxy_source_reset); op(yaw_source_last);                        \
+    op(yaw_source_reset);
+
+#if EK3_FEATURE_BODY_ODOM
+#define CHECKPOINT_STATE_BODY_ODOM(op)                                  \
+    op(bodyOdmDataNew); op(bodyOdmDataDelayed);                         \
+    op(wheelOdmDataDelayed);
+#else
+#define CHECKPOINT_STATE_BODY_ODOM(op)
+#endif
+
+#if EK3_FEATURE_DRAG_FUSION
+#define CHECKPOINT_STATE_DRAG(op)                                       \
+    op(dragSampleDelayed); op(dragDownSampled); op(dragSampleCount);    \
+    op(dragSampleTimeDelta); op(innovDrag); op(innovDragVar);           \
+    op(dragTestRatio);
+#else
+#define CHECKPOINT_STATE_DRAG(op)
+#endif
+
+#if EK3_FEATURE_EXTERNAL_NAV
+#define CHECKPOINT_STATE_EXTNAV(op)                                     \
+    op(extNavDataDelayed); op(extNavMeasTime_ms);                       \
+    op(extNavLastPosResetTime_ms); op(extNavDataToFuse);                \
+    op(extNavUsedForPos); op(extNavVelDelayed);                         \
+    op(extNavVelMeasTime_ms); op(extNavVelToFuse);                      \
+    op(extNavVelInnov); op(extNavVelVarInnov);                          \
+    op(extNavVelInnovTime_ms); op(extNavYawAngDataDelayed);             \
+    op(last_extnav_yaw_fusion_ms);
+#else
+#define CHECKPOINT_STATE_EXTNAV(op)
+#endif
+
+#define CHECKPOINT_STATE(op)                                            \
+    CHECKPOINT_CORE_STATE(op)                                           \
+    CHECKPOINT_STATE_BODY_ODOM(op)                                      \
+    CHECKPOINT_STATE_DRAG(op)                                           \
+    CHECKPOINT_STATE_EXTNAV(op)
+
+#if EK3_FEATURE_BODY_ODOM
+#define CHECKPOINT_BUFFERS_BODY_ODOM(op) op(storedBodyOdm); op(storedWheelOdm);
+#else
+#define CHECKPOINT_BUFFERS_BODY_ODOM(op)
+#endif
+
+#if EK3_FEATURE_DRAG_FUSION
+#define CHECKPOINT_BUFFERS_DRAG(op) op(storedDrag);
+#else
+#define CHECKPOINT_BUFFERS_DRAG(op)
+#endif
+
+#if EK3_FEATURE_EXTERNAL_NAV
+#define CHECKPOINT_BUFFERS_EXTNAV(op) op(storedExtNav); op(storedExtNavVel); op(storedExtNavYawAng);
+#else
+#define CHECKPOINT_BUFFERS_EXTNAV(op)
+#endif
+
+// apply op to each of the data buffers of a core
+#define CHECKPOINT_BUFFERS(op)                                          \
+    op(storedIMU); op(storedGPS); op(storedMag); op(storedBaro);        \
+    op(storedTAS); op(storedRange); op(storedOutput); op(storedOF);     \
+    op(storedYawAng); op(storedRangeBeacon);                            \
+    CHECKPOINT_BUFFERS_BODY_ODOM(op)                                    \
+    CHECKPOINT_BUFFERS_DRAG(op)                                         \
+    CHECKPOINT_BUFFERS_EXTNAV(op)
+
+// runtime state of the frontend. Parameters are not included
+#define CHECKPOINT_FRONTEND(op)                                         \
+    op(primary); op(_frameTimeUsec); op(_framesPerPrediction);          \
+    op(imuSampleTime_us); op(lastLaneSwitch_ms); op(lastLogWrite_us);   \
+    op(yaw_reset_data); op(pos_reset_data); op(pos_down_reset_data);    \
+    op(runCoreSelection); op(coreSetupRequired); op(coreImuIndex);      \
+    op(coreRelativeErrors); op(coreErrorScores);                        \
+    op(coreLastTimePrimary_us); op(common_EKF_origin);                  \
+    op(common_origin_valid);
+
+// number of range beacon fusion reports allocated
+static uint8_t rng_bcn_report_count(AP_DAL &dal, const void *reports)
+{
+    if (reports == nullptr || dal.beacon() == nullptr) {
+        return 0;
+    }
+    return dal.beacon()->count();
+}
+
+/*
+  hash the values of the parameters in a var_info table, following
+  nested groups
+ */
+static void hash_params(const AP_Param::GroupInfo *info, const uint8_t *base, uint64_t &hash)
+{
+    for (uint8_t i=0; info[i].type != AP_PARAM_NONE; i++) {
+        const uint8_t *ptr = base + info[i].offset;
+        if (info[i].flags & AP_PARAM_FLAG_POINTER) {
+            ptr = *(const uint8_t * const *)ptr;
+            if (ptr == nullptr) {
+                continue;
+            }
+        }
+        if (info[i].type == AP_PARAM_GROUP) {
+            const AP_Param::GroupInfo *group = (info[i].flags & AP_PARAM_FLAG_INFO_POINTER) ? *info[i].group_info_ptr : info[i].group_info;
+            hash_params(group, ptr, hash);
+            continue;
+        }
+        hash_fnv_1a(AP_Param::type_size((enum ap_var_type)info[i].type), ptr, &hash);
+    }
+}
+
+/*
+  hash of the sizes of the state members, so that a checkpoint can't
+  be restored by a build which saves different members
+ */
+uint64_t NavEKF3_core::checkpoint_state_hash() const
+{
+    uint64_t hash = FNV_1_OFFSET_BASIS_64;
+#define FIELD_HASH(v) { const uint32_t len = sizeof(v); hash_fnv_1a(sizeof(len), (const uint8_t *)&len, &hash); }
+    CHECKPOINT_STATE(FIELD_HASH);
+#undef FIELD_HASH
+    const uint32_t gsf_size = sizeof(EKFGSF_yaw);
+    hash_fnv_1a(sizeof(gsf_size), (const uint8_t *)&gsf_size, &hash);
+    return hash;
+}
+
+uint32_t NavEKF3_core::checkpoint_size() const
+{
+    uint32_t size = sizeof(checkpoint_core_header);
+#define FIELD_SIZE(v) size += sizeof(v)
+    CHECKPOINT_STATE(FIELD_SIZE);
+#undef FIELD_SIZE
+#define BUFFER_SIZE(b) size += b.checkpoint_size()
+    CHECKPOINT_BUFFERS(BUFFER_SIZE);
+#undef BUFFER_SIZE
+    size += 1 + sizeof(EKFGSF_yaw);
+    size += 1 + rng_bcn_report_count(dal, rngBcnFusionReport) * sizeof(rngBcnFusionReport_t);
+    return size;
+}
+
+void NavEKF3_core::checkpoint_save(uint8_t *data) const
+{
+    const struct checkpoint_core_header hdr {
+        imu_index : imu_index,
+        core_index : core_index,
+        imu_buffer_length : imu_buffer_length,
+        obs_buffer_length : obs_buffer_length,
+        state_hash : checkpoint_state_hash(),
+    };
+    memcpy(data, &hdr, sizeof(hdr));
+    data += sizeof(hdr);
+
+#define FIELD_SAVE(v) memcpy(data, (const void *)&v, sizeof(v)); data += sizeof(v)
+    CHECKPOINT_STATE(FIELD_SAVE);
+#undef FIELD_SAVE
+
+#define BUFFER_SAVE(b) b.checkpoint_save(data); data += b.checkpoint_size()
+    CHECKPOINT_BUFFERS(BUFFER_SAVE);
+#undef BUFFER_SAVE
+
+    *data++ = (yawEstimator != nullptr);
+    if (yawEstimator != nullptr) {
+        memcpy(data, (const void *)yawEstimator, sizeof(EKFGSF_yaw));
+    } else {
+        memset(data, 0, sizeof(EKFGSF_yaw));
+    }
+    data += sizeof(EKFGSF_yaw);
+
+    const uint8_t num_reports = rng_bcn_report_count(dal, rngBcnFusionReport);
+    *data++ = num_reports;
+    memcpy(data, (const void *)rngBcnFusionReport, num_reports * sizeof(rngBcnFusionReport_t));
+}
+
+/*
+  restore a checkpoint written by checkpoint_save(). The caller must
+  have checked the length of the data against checkpoint_size(). On
+  failure the core is left in an undefined state and must not be used
+ */
+bool NavEKF3_core::checkpoint_restore(const uint8_t *data)
+{
+    struct checkpoint_core_header hdr;
+    memcpy(&hdr, data, sizeof(hdr));
+    if (hdr.imu_index != imu_index ||
+        hdr.core_index != core_index ||
+        hdr.imu_buffer_length != imu_buffer_length ||
+        hdr.obs_buffer_length != obs_buffer_length ||
+        hdr.state_hash != checkpoint_state_hash()) {
+        return false;
+    }
+    data += sizeof(hdr);
+
+#define FIELD_RESTORE(v) memcpy((void *)&v, data, sizeof(v)); data += sizeof(v)
+    CHECKPOINT_STATE(FIELD_RESTORE);
+#undef FIELD_RESTORE
+
+#define BUFFER_RESTORE(b) if (!b.checkpoint_restore(data)) { return false; } data += b.checkpoint_size()
+    CHECKPOINT_BUFFERS(BUFFER_RESTORE);
+#undef BUFFER_RESTORE
+
+    const bool have_gsf = *data++;
+    if (have_gsf) {
+        if (yawEstimator == nullptr) {
+            yawEstimator = new EKFGSF_yaw();
+            if (yawEstimator == nullptr) {
+                return false;
+            }
+        }
+        memcpy((void *)yawEstimator, data, sizeof(EKFGSF_yaw));
+    }
+    data += sizeof(EKFGSF_yaw);
+
+    const uint8_t num_reports = *data++;
+    if (num_reports != rng_bcn_report_count(dal, rngBcnFusionReport)) {
+        return false;
+    }
+    memcpy((void *)rngBcnFusionReport, data, num_reports * sizeof(rngBcnFusionReport_t));
+
+    return true;
+}
+
+// hash of the EK3 parameters
+uint64_t NavEKF3::checkpoint_param_hash() const
+{
+    uint64_t hash = FNV_1_OFFSET_BASIS_64;
+    hash_params(var_info, (const uint8_t *)this, hash);
+    return hash;
+}
+
+uint32_t NavEKF3::checkpoint_size() const
+{
+    if (core == nullptr) {
+        return 0;
+    }
+    uint32_t size = sizeof(checkpoint_header);
+#define FIELD_SIZE(v) size += sizeof(v)
+    CHECKPOINT_FRONTEND(FIELD_SIZE);
+#undef FIELD_SIZE
+    for (uint8_t i=0; i<num_cores; i++) {
+        size += core[i].checkpoint_size();
+    }
+    return size;
+}
+
+void NavEKF3::checkpoint_save(uint8_t *data) const
+{
+    const struct checkpoint_header hdr {
+        magic : CHECKPOINT_MAGIC,
+        version : CHECKPOINT_VERSION,
+        num_cores : num_cores,
+        param_hash : checkpoint_param_hash(),
+    };
+    memcpy(data, &hdr, sizeof(hdr));
+    data += sizeof(hdr);
+
+#define FIELD_SAVE(v) memcpy(data, (const void *)&v, sizeof(v)); data += sizeof(v)
+    CHECKPOINT_FRONTEND(FIELD_SAVE);
+#undef FIELD_SAVE
+
+    for (uint8_t i=0; i<num_cores; i++) {
+        core[i].checkpoint_save(data);
+        data += core[i].checkpoint_size();
+    }
+}
+
+bool NavEKF3::checkpoint_restore(const uint8_t *data, uint32_t length)
+{
+    struct checkpoint_header hdr;
+    if (core == nullptr || length < sizeof(hdr)) {
+        return false;
+    }
+    memcpy(&hdr, data, sizeof(hdr));
+    if (hdr.magic != CHECKPOINT_MAGIC ||
+        hdr.version != CHECKPOINT_VERSION ||
+        hdr.num_cores != num_cores ||
+        hdr.param_hash != checkpoint_param_hash() ||
+        length != checkpoint_size()) {
+        return false;
+    }
+    data += sizeof(hdr);
+
+#define FIELD_RESTORE(v) memcpy((void *)&v, data, sizeof(v)); data += sizeof(v)
+    CHECKPOINT_FRONTEND(FIELD_RESTORE);
+#undef FIELD_RESTORE
+
+    for (uint8_t i=0; i<num_cores; i++) {
+        if (!core[i].checkpoint_restore(data)) {
+            return false;
+        }
+        data += core[i].checkpoint_size();
+    }
+    return true;
+}
+
+#endif // EK3_FEATURE_CHECKPOINT
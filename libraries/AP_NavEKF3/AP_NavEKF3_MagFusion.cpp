@@ -443,6 +443,8 @@ void NavEKF3_core::SelectMagFusion()
 */
 void NavEKF3_core::FuseMagnetometer()
 {
+    EK3_STEP_TIMER(FUSE_MAGNETOMETER);
+
     // declarations
     ftype &q0 = mag_state.q0;
     ftype &q1 = mag_state.q1;
@@ -269,6 +269,8 @@ void NavEKF3_core::EstimateTerrainOffset(const of_elements &ofDataDelayed)
 */
 void NavEKF3_core::FuseOptFlow(const of_elements &ofDataDelayed, bool really_fuse)
 {
+    EK3_STEP_TIMER(FUSE_OPT_FLOW);
+
     Vector24 H_LOS;
     Vector3F relVelSensor;
     Vector2 losPred;
@@ -7,6 +7,10 @@
 #include <AP_Logger/AP_Logger.h>
 #include <AP_DAL/AP_DAL.h>
 
+#if EK3_FEATURE_STEP_TIMING
+NavEKF3_core::StepTiming NavEKF3_core::step_timing[uint8_t(NavEKF3_core::Step::NUM_STEPS)];
+#endif
+
 // constructor
 NavEKF3_core::NavEKF3_core(NavEKF3 *_frontend) :
     frontend(_frontend),
@@ -1016,6 +1020,8 @@ void NavEKF3_core::calcOutputStates()
 */
 void NavEKF3_core::CovariancePrediction(Vector3F *rotVarVecPtr)
 {
+    EK3_STEP_TIMER(COVARIANCE_PREDICTION);
+
     ftype daxVar;       // X axis delta angle noise variance rad^2
     ftype dayVar;       // Y axis delta angle noise variance rad^2
     ftype dazVar;       // Z axis delta angle noise variance rad^2
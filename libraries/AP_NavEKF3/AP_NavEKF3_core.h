@@ -37,6 +37,13 @@
 
 #include "AP_NavEKF/EKFGSF_yaw.h"
 
+#if EK3_FEATURE_STEP_TIMING
+#include <time.h>
+#define EK3_STEP_TIMER(step) StepTimer step_timer(Step::step)
+#else
+#define EK3_STEP_TIMER(step)
+#endif
+
 // GPS pre-flight check bit locations
 #define MASK_GPS_NSATS      (1<<0)
 #define MASK_GPS_HDOP       (1<<1)
@@ -424,7 +431,61 @@ public:
     // get a yaw estimator instance
     const EKFGSF_yaw *get_yawEstimator(void) const { return yawEstimator; }
 
+#if EK3_FEATURE_CHECKPOINT
+    // save and restore the complete state of the core. A checkpoint
+    // can only be restored into a core setup with the same IMU and
+    // buffer lengths. State members added to this class must also be
+    // added to CHECKPOINT_CORE_STATE in AP_NavEKF3_Checkpoint.cpp
+    uint32_t checkpoint_size() const;
+    void checkpoint_save(uint8_t *data) const;
+    bool checkpoint_restore(const uint8_t *data);
+#endif
+
+#if EK3_FEATURE_STEP_TIMING
+    // host clock time spent in the main filter steps, summed over
+    // all cores. AP_HAL::micros() can't be used as it is simulation
+    // time in SITL and the DAL time in replay
+    enum class Step : uint8_t {
+        COVARIANCE_PREDICTION = 0,
+        FUSE_VEL_POS_NED,
+        FUSE_MAGNETOMETER,
+        FUSE_OPT_FLOW,
+        FUSE_AIRSPEED,
+        NUM_STEPS
+    };
+    struct StepTiming {
+        uint64_t total_ns;
+        uint64_t count;
+    };
+    static StepTiming step_timing[uint8_t(Step::NUM_STEPS)];
+
+    static uint64_t step_time_ns() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+    }
+
+    // accumulate the time spent in the enclosing scope
+    class StepTimer {
+    public:
+        StepTimer(Step step) :
+            _step(uint8_t(step)),
+            _start_ns(step_time_ns()) {}
+        ~StepTimer() {
+            step_timing[_step].total_ns += step_time_ns() - _start_ns;
+            step_timing[_step].count++;
+        }
+    private:
+        const uint8_t _step;
+        const uint64_t _start_ns;
+    };
+#endif
+
 private:
+#if EK3_FEATURE_CHECKPOINT
+    uint64_t checkpoint_state_hash() const;
+#endif
+
     EKFGSF_yaw *yawEstimator;
     AP_DAL &dal;
 
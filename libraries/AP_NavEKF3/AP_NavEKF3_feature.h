@@ -25,3 +25,13 @@
 #define EK3_FEATURE_DRAG_FUSION EK3_FEATURE_ALL || BOARD_FLASH_SIZE > 1024
 #endif
 
+
+// saving and restoring the filter state, used by Replay to seek
+#ifndef EK3_FEATURE_CHECKPOINT
+#define EK3_FEATURE_CHECKPOINT APM_BUILD_TYPE(APM_BUILD_Replay)
+#endif
+
+// host clock timing of the main filter steps, used by the EKF3 benchmark
+#ifndef EK3_FEATURE_STEP_TIMING
+#define EK3_FEATURE_STEP_TIMING (APM_BUILD_TYPE(APM_BUILD_AP_DAL_Standalone) && (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX))
+#endif
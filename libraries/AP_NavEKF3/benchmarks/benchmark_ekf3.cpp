@@ -0,0 +1,793 @@
+/*
+  EKF3 benchmark driven by DAL replay data
+
+  The DAL frames are replayed into NavEKF3 the same way as Replay does,
+  with the EKF linked against nothing but the DAL, as for the
+  AP_DAL_Standalone example. Build with:
+
+    ./waf configure --board sitl --no-gcs --disable-scripting --enable-benchmarks
+    ./waf benchmarks
+    ./build/sitl/benchmarks/benchmark_ekf3
+
+  Add --ekf-single to the configure to benchmark the single precision
+  filter. By default a synthetic fixed wing flight is generated; set
+  EKF3_BENCHMARK_LOG to the name of a dataflash log recorded with
+  LOG_REPLAY=1 to use real data instead. EK3_ parameters in the log are
+  applied, except for EK3_IMU_MASK which is set from the benchmark
+  argument.
+
+  Each iteration is one replay frame and the time reported is the host
+  time spent handling the frame message, which is where UpdateFilter
+  runs. The label gives the time per call and calls per frame of the
+  main filter steps.
+ */
+#include <AP_gbenchmark.h>
+
+#include <AP_DAL/AP_DAL.h>
+#include <AP_NavEKF2/AP_NavEKF2.h>
+#include <AP_NavEKF3/AP_NavEKF3.h>
+#include <AP_NavEKF3/AP_NavEKF3_core.h>
+#include <AP_Declination/AP_Declination.h>
+#include <AP_Logger/AP_Logger.h>
+#include <AP_Baro/AP_Baro.h>
+#include <AP_Beacon/AP_Beacon.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if !EK3_FEATURE_STEP_TIMING
+#error "EKF3 benchmark needs EK3_FEATURE_STEP_TIMING"
+#endif
+
+/*
+  stubs for the parts of the vehicle the EKF doesn't link against
+ */
+template <typename T>
+static void set_scalar(void *ptr, float value)
+{
+    ((T *)ptr)->set(value);
+}
+
+static void set_param_value(uint8_t type, void *ptr, float value)
+{
+    switch (type) {
+    case AP_PARAM_INT8:
+        set_scalar<AP_Int8>(ptr, value);
+        break;
+    case AP_PARAM_INT16:
+        set_scalar<AP_Int16>(ptr, value);
+        break;
+    case AP_PARAM_INT32:
+        set_scalar<AP_Int32>(ptr, value);
+        break;
+    case AP_PARAM_FLOAT:
+        set_scalar<AP_Float>(ptr, value);
+        break;
+    case AP_PARAM_VECTOR3F:
+        ((AP_Vector3f *)ptr)->set(Vector3f(value, value, value));
+        break;
+    }
+}
+
+void AP_Param::setup_object_defaults(void const *object_pointer, AP_Param::GroupInfo const *group_info)
+{
+    for (uint8_t i=0; group_info[i].type != AP_PARAM_NONE; i++) {
+        if (group_info[i].type != AP_PARAM_GROUP) {
+            set_param_value(group_info[i].type, (uint8_t *)object_pointer + group_info[i].offset, group_info[i].def_value);
+        }
+    }
+}
+
+/*
+  set a parameter of an object by name, looking in subgroups
+ */
+static bool set_param(void *object, const AP_Param::GroupInfo *group_info, const char *name, float value)
+{
+    for (uint8_t i=0; group_info[i].type != AP_PARAM_NONE; i++) {
+        const AP_Param::GroupInfo &info = group_info[i];
+        const size_t len = strlen(info.name);
+        if (info.type == AP_PARAM_GROUP) {
+            if ((info.flags & AP_PARAM_FLAG_POINTER) != 0 || strncmp(name, info.name, len) != 0) {
+                continue;
+            }
+            const AP_Param::GroupInfo *ginfo = (info.flags & AP_PARAM_FLAG_INFO_POINTER) ? *info.group_info_ptr : info.group_info;
+            if (set_param((uint8_t *)object + info.offset, ginfo, name + len, value)) {
+                return true;
+            }
+        } else if (strcmp(name, info.name) == 0) {
+            set_param_value(info.type, (uint8_t *)object + info.offset, value);
+            return true;
+        }
+    }
+    return false;
+}
+
+void *nologger = nullptr;
+AP_Logger &AP::logger() {
+    return *((AP_Logger*)nologger);
+}
+void AP_Logger::WriteBlock(void const*, unsigned short) {}
+bool AP_Logger::WriteReplayBlock(uint8_t msg_id, const void *pBuffer, uint16_t size) { return true; }
+
+AP_Baro &AP::baro() {
+    return *((AP_Baro*)nologger);
+}
+void AP_Baro::update_calibration() {}
+
+AP_Beacon *AP::beacon() {
+    return nullptr;
+}
+
+class BenchmarkUtil : public AP_HAL::Util {
+public:
+    bool run_debug_shell(AP_HAL::BetterStream *stream) override { return false; }
+    void set_hw_rtc(uint64_t time_utc_usec) override {}
+    uint64_t get_hw_rtc() const override { return 0; }
+};
+
+static BenchmarkUtil benchmark_util;
+
+class AP_HAL_EKF3_Benchmark : public AP_HAL::HAL {
+public:
+    AP_HAL_EKF3_Benchmark() :
+        AP_HAL::HAL(
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            &benchmark_util,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr
+            ) {}
+    void run(int argc, char* const argv[], Callbacks* callbacks) const override {}
+};
+
+static AP_HAL_EKF3_Benchmark _hal;
+const AP_HAL::HAL &hal = _hal;
+
+/*
+  the DAL messages a replay can contain
+ */
+#define DAL_MESSAGES \
+    DAL_MSG(RFRH) DAL_MSG(RFRD) DAL_MSG(RFRF) DAL_MSG(RFRN) \
+    DAL_MSG(RISH) DAL_MSG(RISI) DAL_MSG(RISJ) \
+    DAL_MSG(RBRH) DAL_MSG(RBRI) DAL_MSG(RRNH) DAL_MSG(RRNI) \
+    DAL_MSG(RGPH) DAL_MSG(RGPI) DAL_MSG(RGPJ) \
+    DAL_MSG(RASH) DAL_MSG(RASI) DAL_MSG(RBCH) DAL_MSG(RBCI) \
+    DAL_MSG(RVOH) DAL_MSG(RMGH) DAL_MSG(RMGI) \
+    DAL_MSG(ROFH) DAL_MSG(REPH) DAL_MSG(REVH) DAL_MSG(RWOH) DAL_MSG(RBOH) \
+    DAL_MSG(REV3) DAL_MSG(RSO3) DAL_MSG(RWA3) DAL_MSG(REY3)
+
+enum class Msg : uint8_t {
+#define DAL_MSG(name) name,
+    DAL_MESSAGES
+#undef DAL_MSG
+    NUM_MSGS
+};
+
+static const struct {
+    const char *name;
+    uint8_t length;
+} msg_info[] = {
+#define DAL_MSG(name) { #name, offsetof(log_ ## name, _end) },
+    DAL_MESSAGES
+#undef DAL_MSG
+};
+
+/*
+  replay data held in memory as the message type followed by the
+  payload, without the log headers
+ */
+class ReplayData {
+public:
+    void add(Msg type, const void *msg) {
+        const uint8_t len = msg_info[uint8_t(type)].length;
+        if (length + 1 + len > space) {
+            space = MAX(space * 2, 65536U);
+            data = (uint8_t *)realloc(data, space);
+        }
+        data[length++] = uint8_t(type);
+        memcpy(&data[length], msg, len);
+        length += len;
+        if (type == Msg::RFRF) {
+            num_frames++;
+        }
+    }
+
+    void add_param(const char *name, float value) {
+        if (num_params < ARRAY_SIZE(params)) {
+            strncpy(params[num_params].name, name, sizeof(params[0].name)-1);
+            params[num_params].value = value;
+            num_params++;
+        }
+    }
+
+    bool load_log(const char *filename);
+    void make_flight();
+
+    // frames to replay before timing
+    uint32_t warmup_frames() const {
+        return MIN(uint32_t(30 * loop_rate_hz), num_frames / 4);
+    }
+
+    uint8_t *data = nullptr;
+    uint32_t length = 0;
+    uint32_t space = 0;
+    uint32_t num_frames = 0;
+    uint16_t loop_rate_hz = 400;
+
+    // EK3_ parameters from the log, without the prefix
+    struct param {
+        char name[16];
+        float value;
+    } params[64] {};
+    uint8_t num_params = 0;
+};
+
+/*
+  load the DAL messages and EK3_ parameters from a dataflash log
+ */
+bool ReplayData::load_log(const char *filename)
+{
+    FILE *f = fopen(filename, "rb");
+    if (f == nullptr) {
+        ::fprintf(stderr, "Failed to open %s\n", filename);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    const long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *buf = (uint8_t *)malloc(size);
+    if (buf == nullptr || fread(buf, 1, size, f) != size_t(size)) {
+        ::fprintf(stderr, "Failed to read %s\n", filename);
+        fclose(f);
+        free(buf);
+        return false;
+    }
+    fclose(f);
+
+    // log message id to DAL message type, and length of each log message
+    uint8_t type_map[256];
+    uint8_t lengths[256] {};
+    memset(type_map, 0xFF, sizeof(type_map));
+    lengths[LOG_FORMAT_MSG] = sizeof(log_Format);
+    uint8_t parm_id = 0xFF;
+
+    long ofs = 0;
+    while (ofs + 3 <= size) {
+        if (buf[ofs] != HEAD_BYTE1 || buf[ofs+1] != HEAD_BYTE2 || lengths[buf[ofs+2]] == 0) {
+            // resync on the next header
+            ofs++;
+            continue;
+        }
+        const uint8_t id = buf[ofs+2];
+        const uint8_t len = lengths[id];
+        if (ofs + len > size) {
+            break;
+        }
+        const uint8_t *msg = &buf[ofs];
+        ofs += len;
+        if (id == LOG_FORMAT_MSG) {
+            log_Format fmt;
+            memcpy(&fmt, msg, sizeof(fmt));
+            lengths[fmt.type] = fmt.length;
+            if (strncmp(fmt.name, "PARM", 4) == 0) {
+                parm_id = fmt.type;
+            }
+            for (uint8_t i=0; i<uint8_t(Msg::NUM_MSGS); i++) {
+                if (strncmp(fmt.name, msg_info[i].name, 4) == 0 &&
+                    fmt.length == 3 + msg_info[i].length) {
+                    type_map[fmt.type] = i;
+                }
+            }
+            continue;
+        }
+        if (id == parm_id) {
+            log_Parameter parm;
+            memcpy(&parm, msg, sizeof(parm));
+            char name[sizeof(parm.name)+1] {};
+            memcpy(name, parm.name, sizeof(parm.name));
+            if (strncmp(name, "EK3_", 4) == 0) {
+                add_param(&name[4], parm.value);
+            }
+            continue;
+        }
+        if (type_map[id] == 0xFF) {
+            continue;
+        }
+        const Msg type = Msg(type_map[id]);
+        if (type == Msg::RISH && num_frames == 0) {
+            log_RISH RISH {};
+            memcpy(&RISH, msg+3, msg_info[uint8_t(type)].length);
+            loop_rate_hz = MAX(RISH.loop_rate_hz, 1U);
+        }
+        add(type, msg+3);
+    }
+    free(buf);
+
+    if (num_frames == 0) {
+        ::fprintf(stderr, "No replay frames in %s, was it logged with LOG_REPLAY=1?\n", filename);
+        return false;
+    }
+    ::printf("Loaded %u frames and %u EK3 parameters from %s\n",
+             unsigned(num_frames), unsigned(num_params), filename);
+    return true;
+}
+
+/*
+  deterministic noise in -scale to scale
+ */
+static uint32_t noise_state = 0x2545F491;
+static float noise(float scale)
+{
+    noise_state ^= noise_state << 13;
+    noise_state ^= noise_state >> 17;
+    noise_state ^= noise_state << 5;
+    return scale * (int32_t(noise_state) * (1.0f / 2147483648.0f));
+}
+
+static float smoothstep(float x)
+{
+    x = constrain_float(x, 0, 1);
+    return x * x * (3 - 2 * x);
+}
+
+/*
+  synthetic fixed wing flight with 3 IMUs, GPS, baro, compass and
+  airspeed. The vehicle sits disarmed for 10s, then accelerates to
+  20m/s on a 200m radius circle while climbing to 50m
+ */
+void ReplayData::make_flight()
+{
+    const uint16_t rate_hz = 400;
+    const float dt = 1.0f / rate_hz;
+    const float duration_s = 150;
+    const float arm_s = 10;
+    const float radius = 200;
+    const float cruise_speed = 20;
+    const float accel_time = 15;
+    const float climb_alt = 50;
+    const float climb_time = 20;
+    const uint8_t num_imus = 3;
+
+    loop_rate_hz = rate_hz;
+
+    // the ArduPlane default, learning the field states once flying
+    add_param("MAG_CAL", 0);
+
+    const Location home(-353632610, 1491652300, 58400, Location::AltFrame::ABSOLUTE);
+    const Vector3f earth_field_mgauss = AP_Declination::get_earth_field_ga(home) * 1000;
+    const float declination = radians(AP_Declination::get_declination(home.lat*1.0e-7, home.lng*1.0e-7));
+
+    Vector3f gyro_bias[num_imus];
+    for (uint8_t i=0; i<num_imus; i++) {
+        gyro_bias[i] = Vector3f(noise(0.005), noise(0.005), noise(0.005));
+    }
+
+    log_RISH RISH {};
+    RISH.loop_rate_hz = rate_hz;
+    RISH.loop_delta_t = dt;
+    RISH.accel_count = num_imus;
+    RISH.gyro_count = num_imus;
+
+    log_RGPH RGPH {};
+    RGPH.num_sensors = 1;
+    log_RBRH RBRH {};
+    RBRH.num_instances = 1;
+    log_RASH RASH {};
+    RASH.num_sensors = 1;
+    log_RMGH RMGH {};
+    RMGH.declination = declination;
+    RMGH.available = true;
+    RMGH.count = 1;
+    RMGH.auto_declination_enabled = true;
+    RMGH.num_enabled = 1;
+    RMGH.consistent = true;
+
+    log_RFRN RFRN {};
+    RFRN.lat = home.lat;
+    RFRN.lng = home.lng;
+    RFRN.alt = home.alt;
+    RFRN.EAS2TAS = 1;
+    RFRN.available_memory = 1024*1024;
+    RFRN.vehicle_class = uint8_t(AP_DAL::VehicleClass::FIXED_WING);
+    RFRN.ekf_type = 3;
+    RFRN.fly_forward = true;
+    RFRN.ahrs_airspeed_sensor_enabled = true;
+
+    Quaternion last_quat;
+    float arc = 0;
+    const uint32_t steps = duration_s * rate_hz;
+    for (uint32_t step=0; step<steps; step++) {
+        const float t = step * dt;
+        const uint64_t time_us = uint64_t(step) * 1000000ULL / rate_hz;
+        const uint32_t time_ms = time_us / 1000;
+
+        // speed along the circle and height above home
+        const float ta = (t - arm_s) / accel_time;
+        const float speed = cruise_speed * smoothstep(ta);
+        const float speed_dot = (ta > 0 && ta < 1) ? cruise_speed * 6 * ta * (1 - ta) / accel_time : 0;
+        const float tc = constrain_float((t - arm_s) / climb_time, 0, 1);
+        const float alt = climb_alt * smoothstep(tc);
+        const float climb_rate = (tc > 0 && tc < 1) ? climb_alt * 6 * tc * (1 - tc) / climb_time : 0;
+        const float climb_accel = (tc > 0 && tc < 1) ? climb_alt * (6 - 12 * tc) / sq(climb_time) : 0;
+        arc += speed * dt;
+
+        // clockwise circle starting north from home
+        const float theta = arc / radius;
+        const Vector3f pos(radius * sinf(theta), radius * (1 - cosf(theta)), -alt);
+        const Vector3f vel(speed * cosf(theta), speed * sinf(theta), -climb_rate);
+        const Vector3f accel = Vector3f(cosf(theta), sinf(theta), 0) * speed_dot +
+            Vector3f(-sinf(theta), cosf(theta), 0) * (sq(speed) / radius) +
+            Vector3f(0, 0, -climb_accel);
+
+        const float roll = atanf(sq(speed) / (radius * GRAVITY_MSS));
+        Quaternion quat;
+        quat.from_euler(roll, 0, theta);
+        if (step == 0) {
+            last_quat = quat;
+        }
+        Matrix3f dcm;
+        quat.rotation_matrix(dcm);
+
+        log_RFRH RFRH {};
+        RFRH.time_us = time_us;
+        RFRH.time_flying_ms = speed > 0 ? uint32_t((t - arm_s) * 1000) : 0;
+        add(Msg::RFRH, &RFRH);
+
+        const bool armed = t >= arm_s;
+        if (step == 0 || armed != RFRN.armed) {
+            RFRN.armed = armed;
+            add(Msg::RFRN, &RFRN);
+        }
+        if (step == 0) {
+            add(Msg::RISH, &RISH);
+            add(Msg::RGPH, &RGPH);
+            add(Msg::RBRH, &RBRH);
+            add(Msg::RASH, &RASH);
+            add(Msg::RMGH, &RMGH);
+        }
+
+        // IMUs, the delta angle being the body frame rotation since
+        // the last sample
+        Vector3f delta_angle;
+        (last_quat.inverse() * quat).to_axis_angle(delta_angle);
+        last_quat = quat;
+        const Vector3f delta_velocity = dcm.mul_transpose(accel - Vector3f(0, 0, GRAVITY_MSS)) * dt;
+        for (uint8_t i=0; i<num_imus; i++) {
+            log_RISI RISI {};
+            RISI.delta_velocity = delta_velocity + Vector3f(noise(0.05), noise(0.05), noise(0.05)) * dt;
+            RISI.delta_angle = delta_angle + (gyro_bias[i] + Vector3f(noise(0.002), noise(0.002), noise(0.002))) * dt;
+            RISI.delta_velocity_dt = dt;
+            RISI.delta_angle_dt = dt;
+            RISI.use_accel = true;
+            RISI.use_gyro = true;
+            RISI.get_delta_velocity_ret = true;
+            RISI.get_delta_angle_ret = true;
+            RISI.instance = i;
+            add(Msg::RISI, &RISI);
+        }
+
+        Location loc = home;
+        loc.offset(pos.x, pos.y);
+        loc.alt += alt * 100;
+
+        // 10Hz GPS
+        if (step % (rate_hz / 10) == 0) {
+            log_RGPI RGPI {};
+            RGPI.have_vertical_velocity = true;
+            RGPI.horizontal_accuracy_returncode = true;
+            RGPI.vertical_accuracy_returncode = true;
+            RGPI.get_lag_returncode = true;
+            RGPI.speed_accuracy_returncode = true;
+            RGPI.status = 3;
+            RGPI.num_sats = 14;
+            add(Msg::RGPI, &RGPI);
+
+            log_RGPJ RGPJ {};
+            RGPJ.last_message_time_ms = time_ms;
+            RGPJ.velocity = vel + Vector3f(noise(0.1), noise(0.1), noise(0.1));
+            RGPJ.sacc = 0.3;
+            RGPJ.lat = loc.lat;
+            RGPJ.lng = loc.lng;
+            RGPJ.alt = loc.alt + noise(50);
+            RGPJ.hacc = 0.8;
+            RGPJ.vacc = 1.2;
+            RGPJ.hdop = 80;
+            add(Msg::RGPJ, &RGPJ);
+        }
+
+        // 20Hz baro
+        if (step % (rate_hz / 20) == 0) {
+            log_RBRI RBRI {};
+            RBRI.last_update_ms = time_ms;
+            RBRI.altitude = alt + noise(0.2);
+            RBRI.healthy = true;
+            add(Msg::RBRI, &RBRI);
+        }
+
+        // 50Hz compass
+        if (step % (rate_hz / 50) == 0) {
+            log_RMGI RMGI {};
+            RMGI.last_update_usec = time_us;
+            RMGI.field = dcm.mul_transpose(earth_field_mgauss) + Vector3f(noise(2), noise(2), noise(2));
+            RMGI.use_for_yaw = true;
+            RMGI.healthy = true;
+            add(Msg::RMGI, &RMGI);
+        }
+
+        // 10Hz airspeed with no wind
+        if (step % (rate_hz / 10) == 0) {
+            log_RASI RASI {};
+            RASI.airspeed = vel.length() + noise(0.3);
+            RASI.last_update_ms = time_ms;
+            RASI.healthy = true;
+            RASI.use = true;
+            add(Msg::RASI, &RASI);
+        }
+
+        log_RFRF RFRF {};
+        RFRF.frame_types = uint8_t(AP_DAL::FrameType::InitialiseFilterEKF3) | uint8_t(AP_DAL::FrameType::UpdateFilterEKF3);
+        add(Msg::RFRF, &RFRF);
+    }
+}
+
+static ReplayData *get_data()
+{
+    static ReplayData *data;
+    if (data == nullptr) {
+        data = new ReplayData;
+        const char *filename = getenv("EKF3_BENCHMARK_LOG");
+        if (filename != nullptr) {
+            if (!data->load_log(filename)) {
+                exit(1);
+            }
+        } else {
+            data->make_flight();
+        }
+    }
+    return data;
+}
+
+/*
+  an EKF3 being fed from the start of the replay data. When the data
+  runs out it is rewound and the filter initialised again. NavEKF3 has
+  no teardown, so the cores of a deleted replay are leaked; that only
+  happens when the number of cores changes
+ */
+class EKF3Replay {
+public:
+    EKF3Replay(const ReplayData &_data, uint8_t _num_cores);
+
+    const uint8_t num_cores;
+
+    bool at_end() const { return ofs >= data.length; }
+
+    // go back to the start of the data
+    void rewind();
+
+    uint8_t active_cores() const { return ekf3.activeCores(); }
+
+    // replay up to and including the next frame message, returning
+    // the host time spent handling it
+    uint64_t next_frame();
+
+private:
+    const ReplayData &data;
+    uint32_t ofs = 0;
+    bool first_frame = true;
+    NavEKF3 ekf3;
+
+    void handle_event(const log_REV3 &msg);
+};
+
+// only EKF3 is run, but the DAL frame handler needs both
+static NavEKF2 ekf2;
+
+EKF3Replay::EKF3Replay(const ReplayData &_data, uint8_t _num_cores) :
+    num_cores(_num_cores),
+    data(_data)
+{
+    for (uint8_t i=0; i<data.num_params; i++) {
+        set_param(&ekf3, NavEKF3::var_info, data.params[i].name, data.params[i].value);
+    }
+    set_param(&ekf3, NavEKF3::var_info, "IMU_MASK", (1U<<num_cores)-1);
+
+    rewind();
+}
+
+void EKF3Replay::rewind()
+{
+    ofs = 0;
+    // the first frame initialises the filter again
+    first_frame = true;
+    for (uint32_t i=0; i<data.warmup_frames(); i++) {
+        next_frame();
+    }
+}
+
+void EKF3Replay::handle_event(const log_REV3 &msg)
+{
+    switch ((AP_DAL::Event)msg.event) {
+    case AP_DAL::Event::resetGyroBias:
+        ekf3.resetGyroBias();
+        break;
+    case AP_DAL::Event::resetHeightDatum:
+        ekf3.resetHeightDatum();
+        break;
+    case AP_DAL::Event::setTerrainHgtStable:
+        ekf3.setTerrainHgtStable(true);
+        break;
+    case AP_DAL::Event::unsetTerrainHgtStable:
+        ekf3.setTerrainHgtStable(false);
+        break;
+    case AP_DAL::Event::requestYawReset:
+        ekf3.requestYawReset();
+        break;
+    case AP_DAL::Event::checkLaneSwitch:
+        ekf3.checkLaneSwitch();
+        break;
+    }
+}
+
+uint64_t EKF3Replay::next_frame()
+{
+    AP_DAL &dal = AP::dal();
+
+#define MSG_CREATE(sname) log_ ## sname msg {}; memcpy((void*)&msg, payload, msg_info[uint8_t(Msg::sname)].length)
+#define DAL_CASE(sname) case Msg::sname: { MSG_CREATE(sname); dal.handle_message(msg); break; }
+#define EKF_CASE(sname) case Msg::sname: { MSG_CREATE(sname); dal.handle_message(msg, ekf2, ekf3); break; }
+
+    while (!at_end()) {
+        const Msg type = Msg(data.data[ofs]);
+        const uint8_t *payload = &data.data[ofs+1];
+        ofs += 1 + msg_info[uint8_t(type)].length;
+
+        switch (type) {
+        DAL_CASE(RFRH);
+        DAL_CASE(RFRD);
+        DAL_CASE(RFRN);
+        DAL_CASE(RISH);
+        DAL_CASE(RISI);
+        DAL_CASE(RISJ);
+        DAL_CASE(RBRH);
+        DAL_CASE(RBRI);
+        DAL_CASE(RRNH);
+        DAL_CASE(RRNI);
+        DAL_CASE(RGPH);
+        DAL_CASE(RGPI);
+        DAL_CASE(RGPJ);
+        DAL_CASE(RASH);
+        DAL_CASE(RASI);
+        DAL_CASE(RBCH);
+        DAL_CASE(RBCI);
+        DAL_CASE(RVOH);
+        DAL_CASE(RMGH);
+        DAL_CASE(RMGI);
+        EKF_CASE(ROFH);
+        EKF_CASE(REPH);
+        EKF_CASE(REVH);
+        EKF_CASE(RWOH);
+        EKF_CASE(RBOH);
+        case Msg::REV3: {
+            MSG_CREATE(REV3);
+            handle_event(msg);
+            break;
+        }
+        case Msg::RSO3: {
+            MSG_CREATE(RSO3);
+            Location loc;
+            loc.lat = msg.lat;
+            loc.lng = msg.lng;
+            loc.alt = msg.alt;
+            ekf3.setOriginLLH(loc);
+            break;
+        }
+        case Msg::RWA3: {
+            MSG_CREATE(RWA3);
+            ekf3.writeDefaultAirSpeed(msg.airspeed, msg.uncertainty);
+            break;
+        }
+        case Msg::REY3: {
+            MSG_CREATE(REY3);
+            ekf3.writeEulerYawAngle(msg.yawangle, msg.yawangleerr, msg.timestamp_ms, msg.type);
+            break;
+        }
+        case Msg::RFRF: {
+            MSG_CREATE(RFRF);
+            // EKF2 is not run, and there is no logger
+            msg.frame_types &= uint8_t(AP_DAL::FrameType::InitialiseFilterEKF3) | uint8_t(AP_DAL::FrameType::UpdateFilterEKF3);
+            if (first_frame) {
+                // the log may start with the filter already running
+                msg.frame_types |= uint8_t(AP_DAL::FrameType::InitialiseFilterEKF3);
+                first_frame = false;
+            }
+            const uint64_t start_ns = NavEKF3_core::step_time_ns();
+            dal.handle_message(msg, ekf2, ekf3);
+            return NavEKF3_core::step_time_ns() - start_ns;
+        }
+        case Msg::NUM_MSGS:
+            break;
+        }
+    }
+    return 0;
+
+#undef EKF_CASE
+#undef DAL_CASE
+#undef MSG_CREATE
+}
+
+static EKF3Replay *replay;
+
+static const char *step_names[] = {
+    "CovPred",
+    "VelPosNED",
+    "Mag",
+    "OptFlow",
+    "Airspeed",
+};
+
+static_assert(ARRAY_SIZE(step_names) == uint8_t(NavEKF3_core::Step::NUM_STEPS), "missing step name");
+
+/*
+  state.range_x() is the number of cores
+ */
+static void BM_EKF3_UpdateFilter(benchmark::State& state)
+{
+    const uint8_t num_cores = state.range_x();
+    const ReplayData &data = *get_data();
+    if (replay == nullptr || replay->num_cores != num_cores) {
+        delete replay;
+        replay = new EKF3Replay(data, num_cores);
+    }
+
+    NavEKF3_core::StepTiming start[ARRAY_SIZE(step_names)];
+    memcpy(start, NavEKF3_core::step_timing, sizeof(start));
+    uint64_t frames = 0;
+
+    while (state.KeepRunning()) {
+        if (replay->at_end()) {
+            replay->rewind();
+        }
+        state.SetIterationTime(replay->next_frame() * 1.0e-9);
+        frames++;
+    }
+
+    state.SetItemsProcessed(frames);
+
+    char label[256];
+    int n = snprintf(label, sizeof(label), "%s cores=%u",
+                     sizeof(ftype) == sizeof(double) ? "double" : "float",
+                     unsigned(replay->active_cores()));
+    for (uint8_t i=0; i<ARRAY_SIZE(step_names) && n > 0 && size_t(n) < sizeof(label); i++) {
+        const uint64_t count = NavEKF3_core::step_timing[i].count - start[i].count;
+        const uint64_t total_ns = NavEKF3_core::step_timing[i].total_ns - start[i].total_ns;
+        n += snprintf(&label[n], sizeof(label) - n, " %s=%.0fns/%.2f",
+                      step_names[i],
+                      count ? double(total_ns) / count : 0.0,
+                      frames ? double(count) / frames : 0.0);
+    }
+    state.SetLabel(label);
+}
+
+BENCHMARK(BM_EKF3_UpdateFilter)->DenseRange(1, 3)->UseManualTime();
+
+BENCHMARK_MAIN();
@@ -174,6 +174,14 @@ const AP_Param::GroupInfo AP_Proximity::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO("_FILT", 18, AP_Proximity, _filt_freq, 0.25f),
 
+    // @Param: _SECTORS
+    // @DisplayName: Proximity boundary sectors
+    // @Description: Number of horizontal sectors in each layer of the proximity boundary. High resolution sensors such as scanning lidars benefit from more sectors, which lets avoidance stay closer to obstacles. Sensors fixed in the 8 45 degree directions fill every sector their direction covers. Rounded down to a multiple of 8 and limited to the maximum the board supports, which is 8 except on SITL and Linux boards
+    // @Range: 8 72
+    // @Increment: 8
+    // @User: Advanced
+    AP_GROUPINFO("_SECTORS", 19, AP_Proximity, _num_sectors, PROXIMITY_NUM_SECTORS_DEFAULT),
+
     AP_GROUPEND
 };
 
@@ -373,8 +381,16 @@ bool AP_Proximity::get_active_layer_distances(uint8_t layer, AP_Proximity::Proxi
     return drivers[primary_instance]->get_active_layer_distances(layer, prx_dist_array, prx_filt_dist_array);
 }
 
+// return number of sectors to use in each layer of the 3D boundary
+// this is a whole number of sectors for each of the PROXIMITY_MAX_DIRECTION directions, within the space the boundary has
+uint8_t AP_Proximity::get_num_sectors() const
+{
+    const int16_t num_sectors = constrain_int16(_num_sectors, PROXIMITY_MAX_DIRECTION, PROXIMITY_MAX_SECTORS);
+    return num_sectors - (num_sectors % PROXIMITY_MAX_DIRECTION);
+}
+
 // get total number of obstacles, used in GPS based Simple Avoidance
-uint8_t AP_Proximity::get_obstacle_count() const
+uint16_t AP_Proximity::get_obstacle_count() const
 {   
     if (!valid_instance(primary_instance)) {
         return 0;
@@ -392,7 +408,7 @@ uint8_t AP_Proximity::get_num_layers() const
 }
 
 // get vector to obstacle based on obstacle_num passed, used in GPS based Simple Avoidance
-bool AP_Proximity::get_obstacle(uint8_t obstacle_num, Vector3f& vec_to_obstacle) const
+bool AP_Proximity::get_obstacle(uint16_t obstacle_num, Vector3f& vec_to_obstacle) const
 {
     if (!valid_instance(primary_instance)) {
         return false;
@@ -402,7 +418,7 @@ bool AP_Proximity::get_obstacle(uint8_t obstacle_num, Vector3f& vec_to_obstacle)
 
 // returns shortest distance to "obstacle_num" obstacle, from a line segment formed between "seg_start" and "seg_end"
 // used in GPS based Simple Avoidance
-bool AP_Proximity::closest_point_from_segment_to_obstacle(uint8_t obstacle_num, const Vector3f& seg_start, const Vector3f& seg_end, Vector3f& closest_point) const
+bool AP_Proximity::closest_point_from_segment_to_obstacle(uint16_t obstacle_num, const Vector3f& seg_start, const Vector3f& seg_end, Vector3f& closest_point) const
 {
     if (!valid_instance(primary_instance)) {
         return false;
@@ -61,6 +61,12 @@ void AP_Proximity_Backend::boundary_3D_checks()
     // set the cutoff freq for low pass filter
     boundary.set_filter_freq(frontend.get_filter_freq());
 
+    // change boundary resolution if requested, this resets the boundary
+    const uint8_t num_sectors = frontend.get_num_sectors();
+    if (num_sectors != boundary.get_num_sectors()) {
+        boundary.set_num_sectors(num_sectors);
+    }
+
     // check if any face has valid distance when it should not
     const uint32_t now_ms = AP_HAL::millis();
     // run this check every PROXIMITY_BOUNDARY_3D_TIMEOUT_MS
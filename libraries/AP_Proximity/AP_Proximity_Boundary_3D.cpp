@@ -25,20 +25,35 @@
 AP_Proximity_Boundary_3D::AP_Proximity_Boundary_3D() 
 {
     // initialise sector edge vector used for building the boundary fence
+    set_num_sectors(PROXIMITY_NUM_SECTORS_DEFAULT);
+}
+
+// set the number of sectors per layer and re-initialise the boundary
+void AP_Proximity_Boundary_3D::set_num_sectors(uint8_t num_sectors)
+{
+    num_sectors = constrain_int16(num_sectors, PROXIMITY_MAX_DIRECTION, PROXIMITY_MAX_SECTORS);
+    _num_sectors = num_sectors - (num_sectors % PROXIMITY_MAX_DIRECTION);
+    _sector_width_deg = 360.0f / _num_sectors;
     init();
+    reset();
 }
 
 // initialise the boundary and sector_edge_vector array used for object avoidance
-//   should be called if the sector_middle_deg or _sector_width_deg arrays are changed
+//   should be called if the number of sectors is changed
 void AP_Proximity_Boundary_3D::init()
 {
     for (uint8_t layer=0; layer < PROXIMITY_NUM_LAYERS; layer++) {
         const float pitch = ((float)_pitch_middle_deg[layer]);
-        for (uint8_t sector=0; sector < PROXIMITY_NUM_SECTORS; sector++) {
-            const float angle_rad = ((float)_sector_middle_deg[sector]+(PROXIMITY_SECTOR_WIDTH_DEG/2.0f));
-            _sector_edge_vector[layer][sector].offset_bearing(angle_rad, pitch, 100.0f);
+        for (uint8_t sector=0; sector < _num_sectors; sector++) {
+            // edge between this sector and the next one clockwise
+            const float angle_deg = (sector + 0.5f) * _sector_width_deg;
+            _sector_edge_vector[layer][sector].zero();
+            _sector_edge_vector[layer][sector].offset_bearing(angle_deg, pitch, 100.0f);
             _boundary_points[layer][sector] = _sector_edge_vector[layer][sector] * PROXIMITY_BOUNDARY_DIST_DEFAULT;
         }
+        for (uint8_t sector=0; sector < _num_sectors; sector++) {
+            update_obstacle_vector(layer, sector);
+        }
     }
 }
 
@@ -47,7 +62,11 @@ void AP_Proximity_Boundary_3D::init()
 // yaw is the horizontal body-frame angle (in degrees) to the obstacle (0=directly ahead of the vehicle, 90 is to the right of the vehicle)
 AP_Proximity_Boundary_3D::Face AP_Proximity_Boundary_3D::get_face(float pitch, float yaw) const
 {   
-    const uint8_t sector = wrap_360(yaw + (PROXIMITY_SECTOR_WIDTH_DEG * 0.5f)) / 45.0f;
+    uint8_t sector = wrap_360(yaw + (_sector_width_deg * 0.5f)) / _sector_width_deg;
+    if (sector >= _num_sectors) {
+        // rounding just below 360 degrees
+        sector = 0;
+    }
     const float pitch_limited = constrain_float(pitch, -75.0f, 74.9f);
     const uint8_t layer = (pitch_limited + 75.0f)/PROXIMITY_PITCH_WIDTH_DEG;
     return Face{layer, sector};
@@ -57,7 +76,7 @@ AP_Proximity_Boundary_3D::Face AP_Proximity_Boundary_3D::get_face(float pitch, f
 // This method will also mark the sector and layer to be "valid", so this distance can be used for Obstacle Avoidance
 void AP_Proximity_Boundary_3D::set_face_attributes(const Face &face, float pitch, float angle, float distance)
 {
-    if (!face.valid()) {
+    if (!face_valid(face)) {
         return;
     }
 
@@ -73,11 +92,51 @@ void AP_Proximity_Boundary_3D::set_face_attributes(const Face &face, float pitch
     update_boundary(face);
 }
 
+// get the middle layer faces covered by one of the PROXIMITY_MAX_DIRECTION directions.
+// These are the same sectors get_layer_distances() reports for that direction
+uint8_t AP_Proximity_Boundary_3D::get_direction_faces(uint8_t direction, Face *faces) const
+{
+    if (direction >= PROXIMITY_MAX_DIRECTION) {
+        return 0;
+    }
+    const uint8_t sectors_per_direction = _num_sectors / PROXIMITY_MAX_DIRECTION;
+    uint8_t sector = direction * sectors_per_direction;
+    for (uint8_t i=0; i < sectors_per_direction / 2; i++) {
+        sector = get_prev_sector(sector);
+    }
+    for (uint8_t i=0; i < sectors_per_direction; i++) {
+        faces[i] = Face{PROXIMITY_MIDDLE_LAYER, sector};
+        sector = get_next_sector(sector);
+    }
+    return sectors_per_direction;
+}
+
+// set every face covered by one of the PROXIMITY_MAX_DIRECTION directions.
+// The sensor can't tell where in its field the object is so each face takes the yaw of its own centre
+void AP_Proximity_Boundary_3D::set_direction_attributes(uint8_t direction, float distance)
+{
+    Face faces[PROXIMITY_MAX_SECTORS / PROXIMITY_MAX_DIRECTION];
+    const uint8_t num_faces = get_direction_faces(direction, faces);
+    for (uint8_t i=0; i < num_faces; i++) {
+        set_face_attributes(faces[i], faces[i].sector * _sector_width_deg, distance);
+    }
+}
+
+// reset every face covered by one of the PROXIMITY_MAX_DIRECTION directions
+void AP_Proximity_Boundary_3D::reset_direction(uint8_t direction)
+{
+    Face faces[PROXIMITY_MAX_SECTORS / PROXIMITY_MAX_DIRECTION];
+    const uint8_t num_faces = get_direction_faces(direction, faces);
+    for (uint8_t i=0; i < num_faces; i++) {
+        reset_face(faces[i]);
+    }
+}
+
 // apply a new cutoff_freq to low-pass filter
 void AP_Proximity_Boundary_3D::apply_filter_freq(float cutoff_freq)
 {
     for (uint8_t layer=0; layer < PROXIMITY_NUM_LAYERS; layer++) {
-        for (uint8_t sector=0; sector < PROXIMITY_NUM_SECTORS; sector++) {
+        for (uint8_t sector=0; sector < PROXIMITY_MAX_SECTORS; sector++) {
             _filtered_distance[layer][sector].set_cutoff_frequency(cutoff_freq);
         }
     }
@@ -86,7 +145,7 @@ void AP_Proximity_Boundary_3D::apply_filter_freq(float cutoff_freq)
 // Apply low pass filter on the raw distance
 void AP_Proximity_Boundary_3D::set_filtered_distance(const Face &face, float distance)
 {
-    if (!face.valid()) {
+    if (!face_valid(face)) {
         return;
     }
     if (!is_equal(_filtered_distance[face.layer][face.sector].get_cutoff_freq(), _filter_freq)) {
@@ -111,7 +170,7 @@ void AP_Proximity_Boundary_3D::set_filtered_distance(const Face &face, float dis
 void AP_Proximity_Boundary_3D::update_boundary(const Face &face)
 {
     // sanity check
-    if (!face.valid()) {
+    if (!face_valid(face)) {
         return;
     }
 
@@ -157,23 +216,34 @@ void AP_Proximity_Boundary_3D::update_boundary(const Face &face)
     if (!_distance_valid[layer][prev_sector_ccw]) {
         _boundary_points[layer][prev_sector_ccw] = _sector_edge_vector[layer][prev_sector_ccw] * shortest_distance;
     }
+
+    // boundary points from prev_sector_ccw to next_sector may have moved, refresh the lines that use them
+    uint8_t line_sector = get_prev_sector(prev_sector_ccw);
+    for (uint8_t i=0; i < 5; i++) {
+        update_obstacle_vector(layer, line_sector);
+        line_sector = get_next_sector(line_sector);
+    }
+}
+
+// recalculate the cached closest point to the vehicle on the boundary line between sector and sector+1
+void AP_Proximity_Boundary_3D::update_obstacle_vector(uint8_t layer, uint8_t sector)
+{
+    const Vector3f &start = _boundary_points[layer][get_next_sector(sector)];
+    const Vector3f &end = _boundary_points[layer][sector];
+    _obstacle_vector[layer][sector] = Vector3f::point_on_line_closest_to_other_point(start, end, Vector3f{});
 }
 
 // reset boundary.  marks all distances as invalid
 void AP_Proximity_Boundary_3D::reset()
 {
-    for (uint8_t layer=0; layer < PROXIMITY_NUM_LAYERS; layer++) {
-        for (uint8_t sector=0; sector < PROXIMITY_NUM_SECTORS; sector++) {
-            _distance_valid[layer][sector] = false;
-        }
-    }
+    memset(_distance_valid, 0, sizeof(_distance_valid));
 }
 
 // Reset this location, specified by Face object, back to default
 // i.e Distance is marked as not-valid, and set to a large number.
 void AP_Proximity_Boundary_3D::reset_face(const Face &face)
 {
-    if (!face.valid()) {
+    if (!face_valid(face)) {
         return;
     }
     _distance_valid[face.layer][face.sector] = false;
@@ -185,10 +255,11 @@ void AP_Proximity_Boundary_3D::reset_face(const Face &face)
 // check if a face has valid distance even if it was updated a long time back
 void AP_Proximity_Boundary_3D::check_face_timeout()
 {
+    const uint32_t now_ms = AP_HAL::millis();
     for (uint8_t layer=0; layer < PROXIMITY_NUM_LAYERS; layer++) {
-        for (uint8_t sector=0; sector < PROXIMITY_NUM_SECTORS; sector++) {
+        for (uint8_t sector=0; sector < _num_sectors; sector++) {
             if (_distance_valid[layer][sector]) {
-                if ((AP_HAL::millis() - _last_update_ms[layer][sector]) > PROXIMITY_FACE_RESET_MS) {
+                if ((now_ms - _last_update_ms[layer][sector]) > PROXIMITY_FACE_RESET_MS) {
                     // this face has a valid distance but wasn't updated for a long time, reset it
                     AP_Proximity_Boundary_3D::Face face{layer, sector};
                     reset_face(face);
@@ -201,7 +272,7 @@ void AP_Proximity_Boundary_3D::check_face_timeout()
 // get distance for a face.  returns true on success and fills in distance argument with distance in meters
 bool AP_Proximity_Boundary_3D::get_distance(const Face &face, float &distance) const
 {
-    if (!face.valid()) {
+    if (!face_valid(face)) {
         return false;
     }
 
@@ -214,9 +285,9 @@ bool AP_Proximity_Boundary_3D::get_distance(const Face &face, float &distance) c
 }
 
 // get the total number of obstacles 
-uint8_t AP_Proximity_Boundary_3D::get_obstacle_count() const
+uint16_t AP_Proximity_Boundary_3D::get_obstacle_count() const
 {
-    return PROXIMITY_NUM_LAYERS * PROXIMITY_NUM_SECTORS;
+    return PROXIMITY_NUM_LAYERS * _num_sectors;
 }
 
 // Converts obstacle_num passed from avoidance library into appropriate face of the boundary
@@ -224,11 +295,14 @@ uint8_t AP_Proximity_Boundary_3D::get_obstacle_count() const
 // "update_boundary" method manipulates two sectors ccw and one sector cw from any valid face.
 // Any boundary that does not fall into these manipulated faces are useless, and will be marked as false
 // The resultant is packed into a Boundary Location object and returned by reference as "face"
-bool AP_Proximity_Boundary_3D::convert_obstacle_num_to_face(uint8_t obstacle_num, Face& face) const
+bool AP_Proximity_Boundary_3D::convert_obstacle_num_to_face(uint16_t obstacle_num, Face& face) const
 {
+    if (obstacle_num >= get_obstacle_count()) {
+        return false;
+    }
     // obstacle num is just "flattened layers, and sectors"
-    const uint8_t layer = obstacle_num / PROXIMITY_NUM_SECTORS;
-    const uint8_t sector = obstacle_num % PROXIMITY_NUM_SECTORS;
+    const uint8_t layer = obstacle_num / _num_sectors;
+    const uint8_t sector = obstacle_num % _num_sectors;
     face.sector = sector;
     face.layer = layer;
 
@@ -251,19 +325,15 @@ bool AP_Proximity_Boundary_3D::convert_obstacle_num_to_face(uint8_t obstacle_num
 // Then returns the closest point on this line from vehicle, in body-frame. 
 // Used by GPS based Simple Avoidance  
 // False is returned if the obstacle_num provided does not produce a valid obstacle 
-bool AP_Proximity_Boundary_3D::get_obstacle(uint8_t obstacle_num, Vector3f& vec_to_obstacle) const
+bool AP_Proximity_Boundary_3D::get_obstacle(uint16_t obstacle_num, Vector3f& vec_to_obstacle) const
 {
     Face face;
     if (!convert_obstacle_num_to_face(obstacle_num, face)) {
         // not a valid face
         return false;
     }
-    const uint8_t sector_end = face.sector;
-    const uint8_t sector_start = get_next_sector(face.sector);
-    
-    const Vector3f start = _boundary_points[face.layer][sector_start];
-    const Vector3f end = _boundary_points[face.layer][sector_end];
-    vec_to_obstacle = Vector3f::point_on_line_closest_to_other_point(start, end, Vector3f{});
+    // closest point is recalculated whenever the boundary points move
+    vec_to_obstacle = _obstacle_vector[face.layer][face.sector];
     return true;
 }
 
@@ -275,7 +345,7 @@ bool AP_Proximity_Boundary_3D::get_obstacle(uint8_t obstacle_num, Vector3f& vec_
 // This helps us know if the passed line segment was in the direction of the boundary, or going in a different direction.
 // Used by GPS based Simple Avoidance  - for "brake mode"
 // False is returned if the obstacle_num provided does not produce a valid obstacle
-bool AP_Proximity_Boundary_3D::closest_point_from_segment_to_obstacle(uint8_t obstacle_num, const Vector3f& seg_start, const Vector3f& seg_end, Vector3f& closest_point) const
+bool AP_Proximity_Boundary_3D::closest_point_from_segment_to_obstacle(uint16_t obstacle_num, const Vector3f& seg_start, const Vector3f& seg_end, Vector3f& closest_point) const
 {
     Face face;
     if (!convert_obstacle_num_to_face(obstacle_num, face)) {
@@ -285,8 +355,8 @@ bool AP_Proximity_Boundary_3D::closest_point_from_segment_to_obstacle(uint8_t ob
 
     const uint8_t sector_end = face.sector;
     const uint8_t sector_start = get_next_sector(face.sector);
-    const Vector3f start = _boundary_points[face.layer][sector_start];
-    const Vector3f end = _boundary_points[face.layer][sector_end];
+    const Vector3f &start = _boundary_points[face.layer][sector_start];
+    const Vector3f &end = _boundary_points[face.layer][sector_end];
 
     // closest point between passed line segment and boundary
     Vector3f::segment_to_segment_closest_point(seg_start, seg_end, start, end, closest_point);
@@ -302,43 +372,42 @@ bool AP_Proximity_Boundary_3D::closest_point_from_segment_to_obstacle(uint8_t ob
 //   returns true on success, false if no valid readings
 bool AP_Proximity_Boundary_3D::get_closest_object(float& angle_deg, float &distance) const
 {
-    bool closest_found = false;
-    uint8_t closest_sector = 0;
-    uint8_t closest_layer = 0;
+    float closest_distance = FLT_MAX;
+    const float *closest_angle = nullptr;
 
     // check boundary for shortest distance
     // only check for middle layers and higher
     // lower layers might contain ground, which will give false pre-arm failure
     for (uint8_t layer=PROXIMITY_MIDDLE_LAYER; layer<PROXIMITY_NUM_LAYERS; layer++) {
-        for (uint8_t sector=0; sector<PROXIMITY_NUM_SECTORS; sector++) {
-            if (_distance_valid[layer][sector]) {
-                if (!closest_found || (_distance[layer][sector] < _distance[closest_layer][closest_sector])) {
-                    closest_layer = layer;
-                    closest_sector = sector;
-                    closest_found = true;
-                }
+        const float *layer_distance = _distance[layer];
+        const bool *layer_valid = _distance_valid[layer];
+        for (uint8_t sector=0; sector<_num_sectors; sector++) {
+            if (layer_valid[sector] && (closest_angle == nullptr || layer_distance[sector] < closest_distance)) {
+                closest_distance = layer_distance[sector];
+                closest_angle = &_angle[layer][sector];
             }
         }
     }
 
-    if (closest_found) {
-        angle_deg = _angle[closest_layer][closest_sector];
-        distance = _distance[closest_layer][closest_sector];
+    if (closest_angle == nullptr) {
+        return false;
     }
-    return closest_found;
+    angle_deg = *closest_angle;
+    distance = closest_distance;
+    return true;
 }
 
 // get number of objects, used for non-GPS avoidance
 uint8_t AP_Proximity_Boundary_3D::get_horizontal_object_count() const
 {
-    return PROXIMITY_NUM_SECTORS;
+    return _num_sectors;
 }
 
 // get an object's angle and distance, used for non-GPS avoidance
 // returns false if no angle or distance could be returned for some reason
 bool AP_Proximity_Boundary_3D::get_horizontal_object_angle_and_distance(uint8_t object_number, float &angle_deg, float &distance) const
 {
-    if ((object_number < PROXIMITY_NUM_SECTORS) && _distance_valid[PROXIMITY_MIDDLE_LAYER][object_number]) {
+    if ((object_number < _num_sectors) && _distance_valid[PROXIMITY_MIDDLE_LAYER][object_number]) {
         angle_deg = _angle[PROXIMITY_MIDDLE_LAYER][object_number];
         distance = _filtered_distance[PROXIMITY_MIDDLE_LAYER][object_number].get();
         return true;
@@ -349,7 +418,7 @@ bool AP_Proximity_Boundary_3D::get_horizontal_object_angle_and_distance(uint8_t
 // Return filtered distance for the passed in face
 bool AP_Proximity_Boundary_3D::get_filtered_distance(const Face &face, float &distance) const
 {
-    if (!face.valid()) {
+    if (!face_valid(face)) {
         return false;
     }
 
@@ -363,20 +432,41 @@ bool AP_Proximity_Boundary_3D::get_filtered_distance(const Face &face, float &di
 }
 
 // Get raw and filtered distances in 8 directions per layer
+// Each direction reports the shortest distance from the sectors centred within 22.5 degrees of it
 bool AP_Proximity_Boundary_3D::get_layer_distances(uint8_t layer_number, float dist_max, AP_Proximity::Proximity_Distance_Array &prx_dist_array, AP_Proximity::Proximity_Distance_Array &prx_filt_dist_array) const
 {
+    if (layer_number >= PROXIMITY_NUM_LAYERS) {
+        return false;
+    }
+
     // cycle through all sectors filling in distances and orientations
     // see MAV_SENSOR_ORIENTATION for orientations (0 = forward, 1 = 45 degree clockwise from north, etc)
+    const uint8_t sectors_per_direction = _num_sectors / PROXIMITY_MAX_DIRECTION;
     bool valid_distances = false;
     prx_dist_array.offset_valid = 0;
     prx_filt_dist_array.offset_valid = 0;
     for (uint8_t i=0; i<PROXIMITY_MAX_DIRECTION; i++) {
         prx_dist_array.orientation[i] = i;
-        const AP_Proximity_Boundary_3D::Face face(layer_number, i);
-        if (!face.valid()) {
-            return false;
+        bool direction_valid = false;
+        uint8_t sector = i * sectors_per_direction;
+        for (uint8_t j=0; j < sectors_per_direction / 2; j++) {
+            sector = get_prev_sector(sector);
         }
-        if (get_distance(face, prx_dist_array.distance[i]) && get_filtered_distance(face, prx_filt_dist_array.distance[i])) {
+        for (uint8_t j=0; j < sectors_per_direction; j++) {
+            if (_distance_valid[layer_number][sector]) {
+                const float dist = _distance[layer_number][sector];
+                const float filt_dist = _filtered_distance[layer_number][sector].get();
+                if (!direction_valid || dist < prx_dist_array.distance[i]) {
+                    prx_dist_array.distance[i] = dist;
+                }
+                if (!direction_valid || filt_dist < prx_filt_dist_array.distance[i]) {
+                    prx_filt_dist_array.distance[i] = filt_dist;
+                }
+                direction_valid = true;
+            }
+            sector = get_next_sector(sector);
+        }
+        if (direction_valid) {
             valid_distances = true;
             prx_dist_array.offset_valid |= (1U << i);
             prx_filt_dist_array.offset_valid |= (1U << i);
@@ -393,7 +483,7 @@ bool AP_Proximity_Boundary_3D::get_layer_distances(uint8_t layer_number, float d
 void AP_Proximity_Temp_Boundary::reset()
 {
     for (uint8_t layer=0; layer < PROXIMITY_NUM_LAYERS; layer++) {
-        for (uint8_t sector=0; sector < PROXIMITY_NUM_SECTORS; sector++) {
+        for (uint8_t sector=0; sector < PROXIMITY_MAX_SECTORS; sector++) {
             _distances[layer][sector] = FLT_MAX;
         }
     }
@@ -410,11 +500,21 @@ void AP_Proximity_Temp_Boundary::add_distance(const AP_Proximity_Boundary_3D::Fa
     }
 }
 
+// add a distance to every face covered by one of the PROXIMITY_MAX_DIRECTION directions of boundary
+void AP_Proximity_Temp_Boundary::add_direction_distance(const AP_Proximity_Boundary_3D &boundary, uint8_t direction, float distance)
+{
+    AP_Proximity_Boundary_3D::Face faces[PROXIMITY_MAX_SECTORS / PROXIMITY_MAX_DIRECTION];
+    const uint8_t num_faces = boundary.get_direction_faces(direction, faces);
+    for (uint8_t i=0; i < num_faces; i++) {
+        add_distance(faces[i], faces[i].sector * boundary.get_sector_width_deg(), distance);
+    }
+}
+
 // fill the original 3D boundary with the contents of this temporary boundary
 void AP_Proximity_Temp_Boundary::update_3D_boundary(AP_Proximity_Boundary_3D &boundary)
 {
     for (uint8_t layer=0; layer < PROXIMITY_NUM_LAYERS; layer++) {
-        for (uint8_t sector=0; sector < PROXIMITY_NUM_SECTORS; sector++) {
+        for (uint8_t sector=0; sector < boundary.get_num_sectors(); sector++) {
             if (_distances[layer][sector] < FLT_MAX) {
                 AP_Proximity_Boundary_3D::Face face{layer, sector};
                 boundary.set_face_attributes(face, _pitch[layer][sector], _angle[layer][sector], _distances[layer][sector]);
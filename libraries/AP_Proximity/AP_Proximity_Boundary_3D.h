@@ -21,16 +21,35 @@
 
 #include <Filter/LowPassFilter.h>
 
-#define PROXIMITY_NUM_SECTORS         8       // number of sectors
+/*
+  maximum number of sectors per layer. This sets the memory used by
+  the boundary, the number actually used is set at runtime with
+  PRX_SECTORS so that high resolution sensors are not collapsed into
+  45 degree sectors. 72 sectors take about 25kB for each backend and
+  4kB for each temporary boundary, so only SITL and Linux boards have
+  them
+ */
+#ifndef PROXIMITY_MAX_SECTORS
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#define PROXIMITY_MAX_SECTORS         72
+#else
+#define PROXIMITY_MAX_SECTORS         8
+#endif
+#endif
+#define PROXIMITY_NUM_SECTORS_DEFAULT 8       // default number of sectors
 #define PROXIMITY_NUM_LAYERS          5       // num of layers in a sector
 #define PROXIMITY_MIDDLE_LAYER        2       // middle layer
 #define PROXIMITY_PITCH_WIDTH_DEG     30      // width between each layer in degrees
-#define PROXIMITY_SECTOR_WIDTH_DEG    (360.0f/PROXIMITY_NUM_SECTORS)   // width of sectors in degrees
 #define PROXIMITY_BOUNDARY_DIST_MIN   0.6f    // minimum distance for a boundary point.  This ensures the object avoidance code doesn't think we are outside the boundary.
 #define PROXIMITY_BOUNDARY_DIST_DEFAULT 100   // if we have no data for a sector, boundary is placed 100m out
 #define PROXIMITY_FILT_RESET_TIME     1000    // reset filter if last distance was pushed more than this many ms away
 #define PROXIMITY_FACE_RESET_MS       1000    // face will be reset if not updated within this many ms
 
+// each of the PROXIMITY_MAX_DIRECTION directions reported to the GCS must cover a whole number of sectors
+static_assert(PROXIMITY_MAX_SECTORS >= PROXIMITY_MAX_DIRECTION && PROXIMITY_MAX_SECTORS % PROXIMITY_MAX_DIRECTION == 0,
+              "PROXIMITY_MAX_SECTORS must be a multiple of PROXIMITY_MAX_DIRECTION");
+static_assert(PROXIMITY_MAX_SECTORS <= UINT8_MAX, "PROXIMITY_MAX_SECTORS must fit in a uint8_t");
+
 class AP_Proximity_Boundary_3D
 {
 public:
@@ -48,14 +67,14 @@ public:
 	    Face(uint8_t _layer, uint8_t _sector) { layer = _layer; sector = _sector; }
 
 	    // return true if face has valid layer and sector values
-	    bool valid() const { return ((layer < PROXIMITY_NUM_LAYERS) && (sector < PROXIMITY_NUM_SECTORS)); }
+	    bool valid() const { return ((layer < PROXIMITY_NUM_LAYERS) && (sector < PROXIMITY_MAX_SECTORS)); }
 
 	    // comparison operator
 	    bool operator ==(const Face &other) const { return ((layer == other.layer) && (sector == other.sector)); }
 	    bool operator !=(const Face &other) const { return ((layer != other.layer) || (sector != other.sector)); }
 
         uint8_t layer;  // vertical "steps" on the 3D Boundary. 0th layer is the bottom most layer, 1st layer is 30 degrees above (in body frame) and so on
-        uint8_t sector; // horizontal "steps" on the 3D Boundary. 0th sector is directly in front of the vehicle. Each sector is 45 degrees wide.
+        uint8_t sector; // horizontal "steps" on the 3D Boundary. 0th sector is directly in front of the vehicle. Each sector is 360/get_num_sectors() degrees wide.
     };
 
     // returns face corresponding to the provided yaw and (optionally) pitch
@@ -76,6 +95,15 @@ public:
     //   the boundary point is set to the shortest distance found in the two adjacent sectors, this is a conservative boundary around the vehicle
     void update_boundary(const Face &face);
 
+    // get the middle layer faces covered by one of the PROXIMITY_MAX_DIRECTION directions (0 = forward, 1 = 45 degrees clockwise, etc).
+    // sensors fixed in these directions see 45 degrees, so with more than 8 sectors they cover several sectors each.
+    // faces must hold PROXIMITY_MAX_SECTORS / PROXIMITY_MAX_DIRECTION entries. returns the number filled in
+    uint8_t get_direction_faces(uint8_t direction, Face *faces) const;
+
+    // set or reset every face covered by one of the PROXIMITY_MAX_DIRECTION directions
+    void set_direction_attributes(uint8_t direction, float distance);
+    void reset_direction(uint8_t direction);
+
     // reset boundary.  marks all distances as invalid
     void reset();
 
@@ -90,15 +118,15 @@ public:
     bool get_distance(const Face &face, float &distance) const;
 
     // Get the total number of obstacles 
-    uint8_t get_obstacle_count() const;
+    uint16_t get_obstacle_count() const;
 
     // Returns a body frame vector (in cm) to an obstacle
     // False is returned if the obstacle_num provided does not produce a valid obstacle
-    bool get_obstacle(uint8_t obstacle_num, Vector3f& vec_to_boundary) const;
+    bool get_obstacle(uint16_t obstacle_num, Vector3f& vec_to_boundary) const;
 
     // Returns a body frame vector (in cm) nearest to obstacle, in betwen seg_start and seg_end
     // True is returned if the segment intersects a plane formed by considering the "closest point" as normal vector to the plane.
-    bool closest_point_from_segment_to_obstacle(uint8_t obstacle_num, const Vector3f& seg_start, const Vector3f& seg_end, Vector3f& closest_point) const;
+    bool closest_point_from_segment_to_obstacle(uint16_t obstacle_num, const Vector3f& seg_start, const Vector3f& seg_end, Vector3f& closest_point) const;
 
     // get distance and angle to closest object (used for pre-arm check)
     //   returns true on success, false if no valid readings
@@ -111,15 +139,21 @@ public:
     // get number of layers
     uint8_t get_num_layers() const { return PROXIMITY_NUM_LAYERS; }
 
+    // get and set the number of sectors per layer. Changing the number of sectors resets the boundary
+    // num_sectors should be a multiple of PROXIMITY_MAX_DIRECTION and no more than PROXIMITY_MAX_SECTORS
+    uint8_t get_num_sectors() const { return _num_sectors; }
+    void set_num_sectors(uint8_t num_sectors);
+
+    // get width of each sector in degrees
+    float get_sector_width_deg() const { return _sector_width_deg; }
+
     // get raw and filtered distances in 8 directions per layer.
+    // with more than 8 sectors each direction reports the shortest distance of the sectors it covers
     bool get_layer_distances(uint8_t layer_number, float dist_max, AP_Proximity::Proximity_Distance_Array &prx_dist_array, AP_Proximity::Proximity_Distance_Array &prx_filt_dist_array) const;
 
     // pass down filter cut-off freq from params
     void set_filter_freq(float filt_freq) { _filter_freq = filt_freq; }
 
-    // sectors
-    static_assert(PROXIMITY_NUM_SECTORS == 8, "PROXIMITY_NUM_SECTOR must be 8");
-    const uint16_t _sector_middle_deg[PROXIMITY_NUM_SECTORS] {0, 45, 90, 135, 180, 225, 270, 315};    // middle angle of each sector
     // layers
     static_assert(PROXIMITY_NUM_LAYERS == 5, "PROXIMITY_NUM_LAYERS must be 5");
     const int16_t _pitch_middle_deg[PROXIMITY_NUM_LAYERS] {-60, -30, 0, 30, 60};
@@ -129,18 +163,24 @@ private:
     // initialise the boundary and sector_edge_vector array used for object avoidance
     void init();
 
+    // return true if face is valid for the current number of sectors
+    bool face_valid(const Face &face) const { return face.valid() && (face.sector < _num_sectors); }
+
     // get the next sector which is CW to the passed sector
-    uint8_t get_next_sector(uint8_t sector) const {return ((sector >= PROXIMITY_NUM_SECTORS-1) ? 0 : sector+1); }
+    uint8_t get_next_sector(uint8_t sector) const {return ((sector >= _num_sectors-1) ? 0 : sector+1); }
     
     // get the prev sector which is CCW to the passed sector 
-    uint8_t get_prev_sector(uint8_t sector) const {return ((sector <= 0) ? PROXIMITY_NUM_SECTORS-1 : sector-1); }
+    uint8_t get_prev_sector(uint8_t sector) const {return ((sector <= 0) ? _num_sectors-1 : sector-1); }
 
     // Converts obstacle_num passed from avoidance library into appropriate face of the boundary
     // Returns false if the face is invalid
     // "update_boundary" method manipulates two sectors ccw and one sector cw from any valid face.
     // Any boundary that does not fall into these manipulated faces are useless, and will be marked as false
     // The resultant is packed into a Boundary Location object and returned by reference as "face"
-    bool convert_obstacle_num_to_face(uint8_t obstacle_num, Face& face) const WARN_IF_UNUSED;
+    bool convert_obstacle_num_to_face(uint16_t obstacle_num, Face& face) const WARN_IF_UNUSED;
+
+    // recalculate the cached closest point to the vehicle on the boundary line between sector and sector+1
+    void update_obstacle_vector(uint8_t layer, uint8_t sector);
 
     // Apply a new cutoff_freq to low-pass filter
     void apply_filter_freq(float cutoff_freq);
@@ -151,15 +191,19 @@ private:
     // Return filtered distance for the passed in face
     bool get_filtered_distance(const Face &face, float &distance) const;
 
-    Vector3f _sector_edge_vector[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];
-    Vector3f _boundary_points[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];
+    uint8_t _num_sectors;                                               // number of sectors in use in each layer
+    float _sector_width_deg;                                            // width of each sector in degrees
 
-    float _angle[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];          // yaw angle in degrees to closest object within each sector and layer
-    float _pitch[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];          // pitch angle in degrees to the closest object within each sector and layer
-    float _distance[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];       // distance to closest object within each sector and layer
-    bool _distance_valid[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];  // true if a valid distance received for each sector and layer
-    uint32_t _last_update_ms[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS]; // time when distance was last updated
-    LowPassFilterFloat _filtered_distance[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS]; // low pass filter
+    Vector3f _sector_edge_vector[PROXIMITY_NUM_LAYERS][PROXIMITY_MAX_SECTORS];
+    Vector3f _boundary_points[PROXIMITY_NUM_LAYERS][PROXIMITY_MAX_SECTORS];
+    Vector3f _obstacle_vector[PROXIMITY_NUM_LAYERS][PROXIMITY_MAX_SECTORS]; // closest point to vehicle on the line between each boundary point and the next, kept up to date by update_boundary
+
+    float _angle[PROXIMITY_NUM_LAYERS][PROXIMITY_MAX_SECTORS];          // yaw angle in degrees to closest object within each sector and layer
+    float _pitch[PROXIMITY_NUM_LAYERS][PROXIMITY_MAX_SECTORS];          // pitch angle in degrees to the closest object within each sector and layer
+    float _distance[PROXIMITY_NUM_LAYERS][PROXIMITY_MAX_SECTORS];       // distance to closest object within each sector and layer
+    bool _distance_valid[PROXIMITY_NUM_LAYERS][PROXIMITY_MAX_SECTORS];  // true if a valid distance received for each sector and layer
+    uint32_t _last_update_ms[PROXIMITY_NUM_LAYERS][PROXIMITY_MAX_SECTORS]; // time when distance was last updated
+    LowPassFilterFloat _filtered_distance[PROXIMITY_NUM_LAYERS][PROXIMITY_MAX_SECTORS]; // low pass filter
     float _filter_freq;                                                 // cutoff freq of low pass filter
 };
 
@@ -178,16 +222,19 @@ public:
     // add a distance to the temp boundary if it is shorter than any other provided distance since the last time the boundary was reset
     // pitch and yaw are in degrees, distance is in meters
     void add_distance(const AP_Proximity_Boundary_3D::Face &face, float pitch, float yaw, float distance);
-    void add_distance(const AP_Proximity_Boundary_3D::Face &face, float yaw, float distance) { add_distance(face, 0.0f, PID_TUNING_YAW, distance); }
+    void add_distance(const AP_Proximity_Boundary_3D::Face &face, float yaw, float distance) { add_distance(face, 0.0f, yaw, distance); }
+
+    // add a distance to every face covered by one of the PROXIMITY_MAX_DIRECTION directions of boundary
+    void add_direction_distance(const AP_Proximity_Boundary_3D &boundary, uint8_t direction, float distance);
 
     // fill the original 3D boundary with the contents of this temporary boundary
     void update_3D_boundary(AP_Proximity_Boundary_3D &boundary);
 
 private:
 
-    float _distances[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];      // distance to closest object within each sector and layer. Will start with FLT_MAX, and then be changed to a valid distance if needed
-    float _angle[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];          // yaw angle in degrees to closest object within each sector and layer
-    float _pitch[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];          // pitch angle in degrees to the closest object within each sector and layer
+    float _distances[PROXIMITY_NUM_LAYERS][PROXIMITY_MAX_SECTORS];      // distance to closest object within each sector and layer. Will start with FLT_MAX, and then be changed to a valid distance if needed
+    float _angle[PROXIMITY_NUM_LAYERS][PROXIMITY_MAX_SECTORS];          // yaw angle in degrees to closest object within each sector and layer
+    float _pitch[PROXIMITY_NUM_LAYERS][PROXIMITY_MAX_SECTORS];          // pitch angle in degrees to the closest object within each sector and layer
 };
 
 #endif // HAL_PROXIMITY_ENABLED
\ No newline at end of file
@@ -92,15 +92,13 @@ void AP_Proximity_MAV::handle_distance_sensor_msg(const mavlink_message_t &msg)
         }
         // store in meters
         const float distance = packet.current_distance * 0.01f;
-        const uint8_t sector = packet.orientation;
-        // get the face for this sector
-        const float yaw_angle_deg = sector * 45;
-        const AP_Proximity_Boundary_3D::Face face = boundary.get_face(yaw_angle_deg);
+        const uint8_t direction = packet.orientation;
+        const float yaw_angle_deg = direction * 45;
         _distance_min = packet.min_distance * 0.01f;
         _distance_max = packet.max_distance * 0.01f;
         const bool in_range = distance <= _distance_max && distance >= _distance_min;
         if (in_range && !check_obstacle_near_ground(yaw_angle_deg, distance)) {
-            temp_boundary.add_distance(face, yaw_angle_deg, distance);
+            temp_boundary.add_direction_distance(boundary, direction, distance);
             // update OA database
             database_push(yaw_angle_deg, distance);
         }
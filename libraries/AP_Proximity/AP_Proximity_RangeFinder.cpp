@@ -43,19 +43,18 @@ void AP_Proximity_RangeFinder::update(void)
         if (sensor->has_data()) {
             // check for horizontal range finders
             if (sensor->orientation() <= ROTATION_YAW_315) {
-                const uint8_t sector = (uint8_t)sensor->orientation();
-                const float angle = sector * 45;
-                const AP_Proximity_Boundary_3D::Face face = boundary.get_face(angle);
+                const uint8_t direction = (uint8_t)sensor->orientation();
+                const float angle = direction * 45;
                 // distance in meters
                 const float distance = sensor->distance();
                 _distance_min = sensor->min_distance_cm() * 0.01f;
                 _distance_max = sensor->max_distance_cm() * 0.01f;
                 if ((distance <= _distance_max) && (distance >= _distance_min) && !check_obstacle_near_ground(angle, distance)) {
-                    boundary.set_face_attributes(face, angle, distance);
+                    boundary.set_direction_attributes(direction, distance);
                     // update OA database
                     database_push(angle, distance);
                 } else {
-                    boundary.reset_face(face);
+                    boundary.reset_direction(direction);
                 }
                 _last_update_ms = now;
             }
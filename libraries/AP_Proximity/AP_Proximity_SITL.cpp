@@ -57,8 +57,8 @@ void AP_Proximity_SITL::update(void)
     if (AP::fence()->polyfence().inclusion_boundary_available()) {
         set_status(AP_Proximity::Status::Good);
         // update distance in each sector
-        for (uint8_t sector=0; sector < PROXIMITY_NUM_SECTORS; sector++) {
-            const float yaw_angle_deg = sector * 45.0f;
+        for (uint8_t sector=0; sector < boundary.get_num_sectors(); sector++) {
+            const float yaw_angle_deg = sector * boundary.get_sector_width_deg();
             AP_Proximity_Boundary_3D::Face face = boundary.get_face(yaw_angle_deg);
             float fence_distance;
             if (get_distance_to_fence(yaw_angle_deg, fence_distance)) {
@@ -94,14 +94,14 @@ bool AP_Proximity_TeraRangerTower::read_sensor_data()
 // process reply
 void AP_Proximity_TeraRangerTower::update_sector_data(int16_t angle_deg, uint16_t distance_cm)
 {   
-    // Get location on 3-D boundary based on angle to the object
-    const AP_Proximity_Boundary_3D::Face face = boundary.get_face(angle_deg);
+    // the sensors point in the 45 degree directions, fill every sector each one sees
+    const uint8_t direction = angle_deg / 45;
     if ((distance_cm != 0xffff) && !check_obstacle_near_ground(angle_deg, distance_cm * 0.001f)) {
-        boundary.set_face_attributes(face, angle_deg, ((float) distance_cm) / 1000);
+        boundary.set_direction_attributes(direction, ((float) distance_cm) / 1000);
         // update OA database
         database_push(angle_deg, ((float) distance_cm) / 1000);
     } else {
-        boundary.reset_face(face);
+        boundary.reset_direction(direction);
     }
     _last_distance_received_ms = AP_HAL::millis();
 }
@@ -0,0 +1,137 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Proximity/AP_Proximity_Boundary_3D.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  lidar-like scan at half degree resolution of an 8m x 5m room with
+  the vehicle off centre, so that every sector holds a different
+  distance
+ */
+#define SCAN_POINTS 720
+
+static void make_scan(float *distances)
+{
+    const Vector2f origin(1.5f, -0.7f);
+    for (uint16_t i = 0; i < SCAN_POINTS; i++) {
+        const float angle = radians(i * 0.5f);
+        const Vector2f dir(cosf(angle), sinf(angle));
+        float t = FLT_MAX;
+        if (!is_zero(dir.x)) {
+            t = MIN(t, ((dir.x > 0 ? 4.0f : -4.0f) - origin.x) / dir.x);
+        }
+        if (!is_zero(dir.y)) {
+            t = MIN(t, ((dir.y > 0 ? 2.5f : -2.5f) - origin.y) / dir.y);
+        }
+        distances[i] = t;
+    }
+}
+
+// feed one scan into the boundary the way the scanning lidar backends do
+static void push_scan(AP_Proximity_Boundary_3D &boundary, const float *distances)
+{
+    AP_Proximity_Boundary_3D::Face face;
+    float face_distance = 0;
+    float face_yaw_deg = 0;
+    for (uint16_t i = 0; i < SCAN_POINTS; i++) {
+        const float angle_deg = i * 0.5f;
+        const AP_Proximity_Boundary_3D::Face latest_face = boundary.get_face(angle_deg);
+        if (latest_face != face) {
+            if (face.valid()) {
+                boundary.set_face_attributes(face, face_yaw_deg, face_distance);
+            }
+            face = latest_face;
+            face_distance = FLT_MAX;
+        }
+        if (distances[i] < face_distance) {
+            face_distance = distances[i];
+            face_yaw_deg = angle_deg;
+        }
+    }
+    boundary.set_face_attributes(face, face_yaw_deg, face_distance);
+}
+
+/*
+  state.range_x() is the number of sectors in each layer
+ */
+static void BM_ProximityBoundaryScan(benchmark::State& state)
+{
+    AP_Proximity_Boundary_3D boundary;
+    boundary.set_num_sectors(state.range_x());
+    float distances[SCAN_POINTS];
+    make_scan(distances);
+
+    while (state.KeepRunning()) {
+        push_scan(boundary, distances);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * SCAN_POINTS);
+}
+
+// what AC_Avoid does each loop in "slide" mode
+static void BM_ProximityBoundaryObstacles(benchmark::State& state)
+{
+    AP_Proximity_Boundary_3D boundary;
+    boundary.set_num_sectors(state.range_x());
+    float distances[SCAN_POINTS];
+    make_scan(distances);
+    push_scan(boundary, distances);
+
+    while (state.KeepRunning()) {
+        Vector3f sum;
+        for (uint16_t i = 0; i < boundary.get_obstacle_count(); i++) {
+            Vector3f vec;
+            if (boundary.get_obstacle(i, vec)) {
+                sum += vec;
+            }
+        }
+        gbenchmark_escape(&sum);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * boundary.get_obstacle_count());
+}
+
+// what AC_Avoid does each loop in "stop" mode
+static void BM_ProximityBoundarySegment(benchmark::State& state)
+{
+    AP_Proximity_Boundary_3D boundary;
+    boundary.set_num_sectors(state.range_x());
+    float distances[SCAN_POINTS];
+    make_scan(distances);
+    push_scan(boundary, distances);
+    const Vector3f stopping_point(150.0f, 80.0f, 0.0f);
+
+    while (state.KeepRunning()) {
+        uint16_t intersections = 0;
+        for (uint16_t i = 0; i < boundary.get_obstacle_count(); i++) {
+            Vector3f closest_point;
+            if (boundary.closest_point_from_segment_to_obstacle(i, Vector3f{}, stopping_point, closest_point)) {
+                intersections++;
+            }
+        }
+        gbenchmark_escape(&intersections);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * boundary.get_obstacle_count());
+}
+
+static void BM_ProximityBoundaryClosestObject(benchmark::State& state)
+{
+    AP_Proximity_Boundary_3D boundary;
+    boundary.set_num_sectors(state.range_x());
+    float distances[SCAN_POINTS];
+    make_scan(distances);
+    push_scan(boundary, distances);
+
+    while (state.KeepRunning()) {
+        float angle_deg, distance;
+        boundary.get_closest_object(angle_deg, distance);
+        gbenchmark_escape(&distance);
+    }
+}
+
+BENCHMARK(BM_ProximityBoundaryScan)->Arg(8)->Arg(24)->Arg(72);
+BENCHMARK(BM_ProximityBoundaryObstacles)->Arg(8)->Arg(24)->Arg(72);
+BENCHMARK(BM_ProximityBoundarySegment)->Arg(8)->Arg(24)->Arg(72);
+BENCHMARK(BM_ProximityBoundaryClosestObject)->Arg(8)->Arg(24)->Arg(72);
+
+BENCHMARK_MAIN();
@@ -35,6 +35,52 @@
 
 extern const AP_HAL::HAL& hal;
 
+/*
+  what the byte stream of each protocol looks like while searching. A
+  protocol with sync bytes starts every frame with one of them, after
+  an idle gap of at least FRAME_GAP when its decoder needs one. Its
+  decoder only needs the bytes from a sync byte up to MAX_LEN bytes
+  later, the rest of the stream is skipped
+ */
+static const struct {
+    uint32_t baud;
+    uint16_t frame_gap_us;
+    uint8_t max_frame_len;
+    uint8_t num_sync;
+    uint8_t sync[4];
+} byte_signatures[] {
+    // BAUD  FRAME_GAP MAX_LEN NSYNC SYNC
+    // PPM, pulses only:
+    {      0,    0,   0,  0, {} },
+    // IBUS:
+    { 115200, 2000,  32,  1, { 0x20 } },
+    // SBUS and SBUS_NI:
+    { 100000, 2000,  25,  1, { 0x0F } },
+    { 100000, 2000,  25,  1, { 0x0F } },
+    // DSM has no sync byte:
+    { 115200,    0,   0,  0, {} },
+    // SUMD, header and CRC around up to 32 channels:
+    { 115200,    0,  3 + 2*SUMD_MAX_CHANNELS + 2,  1, { 0xA8 } },
+    // SRXL, one header per variant:
+    { 115200, 8000,  35,  3, { 0xA1, 0xA2, 0xA5 } },
+    // SRXL2:
+    { 115200,    0,  80,  1, { 0xA6 } },
+    // CRSF takes any device address as the first byte:
+    { 416666,    0,   0,  0, {} },
+    // ST24:
+    { 115200,    0,  70,  1, { 0x55 } },
+    // FPort, byte stuffing can double the length:
+    { 115200,    0,  58,  1, { 0x7E } },
+    // FPort2 starts with the frame length:
+    { 115200,    0,  38,  4, { 0x08, 0x0D, 0x18, 0x23 } },
+#if AP_RCPROTOCOL_FASTSBUS_ENABLED
+    // FastSBUS:
+    { 200000, 2000,  25,  1, { 0x0F } },
+#endif
+};
+
+static_assert(ARRAY_SIZE(byte_signatures) == AP_RCProtocol::NONE, "must have a byte signature per protocol");
+
 void AP_RCProtocol::init()
 {
     backend[AP_RCProtocol::PPM] = new AP_RCProtocol_PPMSum(*this);
@@ -54,6 +100,12 @@ void AP_RCProtocol::init()
 #endif
     backend[AP_RCProtocol::ST24] = new AP_RCProtocol_ST24(*this);
     backend[AP_RCProtocol::FPORT] = new AP_RCProtocol_FPort(*this, true);
+
+    for (const auto &sig : byte_signatures) {
+        for (uint8_t i = 0; i < sig.num_sync; i++) {
+            _fingerprint.sync_bytes[sig.sync[i]>>3] |= 1U<<(sig.sync[i]&7);
+        }
+    }
 }
 
 AP_RCProtocol::~AP_RCProtocol()
@@ -76,6 +128,74 @@ bool AP_RCProtocol::should_search(uint32_t now_ms) const
     return (now_ms - _last_input_ms >= 200);
 }
 
+/*
+  return the mask of protocols a byte could be part of a frame of
+ */
+uint16_t AP_RCProtocol::byte_candidates(uint8_t byte, uint32_t baudrate)
+{
+    auto &fp = _fingerprint;
+
+    if (baudrate != fp.baudrate) {
+        fp.baudrate = baudrate;
+        fp.no_sync_mask = 0;
+        fp.sync_mask = 0;
+        fp.open_mask = 0;
+        for (uint8_t i = 0; i < AP_RCProtocol::NONE; i++) {
+            const auto &sig = byte_signatures[i];
+            if (sig.baud != baudrate) {
+                continue;
+            }
+            if (sig.num_sync == 0) {
+                fp.no_sync_mask |= 1U<<i;
+            } else {
+                fp.sync_mask |= 1U<<i;
+            }
+        }
+    }
+
+    const uint32_t now_us = AP_HAL::micros();
+    const uint32_t gap_us = now_us - fp.last_byte_us;
+    fp.last_byte_us = now_us;
+    fp.byte_count++;
+
+    // close the frames which have ended
+    if (fp.open_mask != 0 && fp.byte_count >= fp.next_frame_end) {
+        fp.next_frame_end = UINT32_MAX;
+        for (uint8_t i = 0; i < AP_RCProtocol::NONE; i++) {
+            if (!(fp.open_mask & (1U<<i))) {
+                continue;
+            }
+            if (fp.byte_count >= fp.frame_end[i]) {
+                fp.open_mask &= ~(1U<<i);
+            } else {
+                fp.next_frame_end = MIN(fp.next_frame_end, fp.frame_end[i]);
+            }
+        }
+    }
+
+    // open a frame for each protocol this is the sync byte of
+    if (fp.sync_bytes[byte>>3] & (1U<<(byte&7))) {
+        for (uint8_t i = 0; i < AP_RCProtocol::NONE; i++) {
+            const auto &sig = byte_signatures[i];
+            // the decoders timestamp the byte a little later than we
+            // do, so allow some slack on the gap
+            if (!(fp.sync_mask & (1U<<i)) ||
+                gap_us < sig.frame_gap_us*3/4 ||
+                memchr(sig.sync, byte, sig.num_sync) == nullptr) {
+                continue;
+            }
+            if (fp.open_mask == 0) {
+                fp.next_frame_end = UINT32_MAX;
+            }
+            fp.open_mask |= 1U<<i;
+            fp.frame_end[i] = fp.byte_count + sig.max_frame_len;
+            fp.next_frame_end = MIN(fp.next_frame_end, fp.frame_end[i]);
+        }
+    }
+
+    return fp.no_sync_mask | fp.open_mask;
+}
+
 void AP_RCProtocol::process_pulse(uint32_t width_s0, uint32_t width_s1)
 {
     uint32_t now = AP_HAL::millis();
@@ -104,12 +224,30 @@ void AP_RCProtocol::process_pulse(uint32_t width_s0, uint32_t width_s1)
         return;
     }
 
+    /*
+      PPM pulses are all over 700usec. The serial protocols have
+      bits of 10usec or less with no gap between the bytes of a frame,
+      so a run of long pulses can only be PPM and the SoftSerial
+      decoders are skipped until a short pulse comes along
+     */
+    if (width_s0 + width_s1 > 700) {
+        if (_fingerprint.long_pulses < 8) {
+            _fingerprint.long_pulses++;
+        }
+    } else {
+        _fingerprint.long_pulses = 0;
+    }
+    const bool ppm_only = _fingerprint.long_pulses >= 8;
+
     // otherwise scan all protocols
     for (uint8_t i = 0; i < AP_RCProtocol::NONE; i++) {
         if (_disabled_for_pulses & (1U << i)) {
             // this protocol is disabled for pulse input
             continue;
         }
+        if (ppm_only && i != AP_RCProtocol::PPM) {
+            continue;
+        }
         if (backend[i] != nullptr) {
             if (!protocol_enabled(rcprotocol_t(i))) {
                 continue;
@@ -189,8 +327,13 @@ bool AP_RCProtocol::process_byte(uint8_t byte, uint32_t baudrate)
         return true;
     }
 
-    // otherwise scan all protocols
+    const uint16_t candidates = byte_candidates(byte, baudrate);
+
+    // otherwise scan the protocols which could be in the stream
     for (uint8_t i = 0; i < AP_RCProtocol::NONE; i++) {
+        if (!(candidates & (1U << i))) {
+            continue;
+        }
         if (backend[i] != nullptr) {
             if (!protocol_enabled(rcprotocol_t(i))) {
                 continue;
@@ -294,11 +437,16 @@ void AP_RCProtocol::check_added_uart(void)
 
     uint32_t n = added.uart->available();
     n = MIN(n, 255U);
-    for (uint8_t i=0; i<n; i++) {
-        int16_t b = added.uart->read();
-        if (b >= 0) {
-            process_byte(uint8_t(b), current_baud);
+    while (n > 0) {
+        uint8_t buf[32];
+        const ssize_t nread = added.uart->read(buf, MIN(n, sizeof(buf)));
+        if (nread <= 0) {
+            break;
+        }
+        for (uint8_t i=0; i<nread; i++) {
+            process_byte(buf[i], current_baud);
         }
+        n -= nread;
     }
     if (searching) {
         if (now - added.last_config_change_ms > 1000) {
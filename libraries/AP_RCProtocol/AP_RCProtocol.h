@@ -138,6 +138,9 @@ public:
 private:
     void check_added_uart(void);
 
+    // return mask of protocols a byte could be part of a frame of
+    uint16_t byte_candidates(uint8_t byte, uint32_t baudrate);
+
     // return true if a specific protocol is enabled
     bool protocol_enabled(enum rcprotocol_t protocol) const;
 
@@ -149,6 +152,21 @@ private:
     uint32_t _last_input_ms;
     bool _valid_serial_prot;
 
+    // fingerprint of the input while searching, used to skip the
+    // decoders of protocols which can't be in the stream
+    struct {
+        uint8_t sync_bytes[32];     // bitmap of the sync bytes of all protocols
+        uint32_t baudrate;          // baudrate of the masks below
+        uint16_t no_sync_mask;      // protocols at baudrate without sync bytes
+        uint16_t sync_mask;         // protocols at baudrate with sync bytes
+        uint16_t open_mask;         // protocols which have started a frame
+        uint32_t byte_count;
+        uint32_t frame_end[NONE];   // byte_count at the end of the started frame
+        uint32_t next_frame_end;
+        uint32_t last_byte_us;
+        uint8_t long_pulses;        // run of pulses only PPM could have sent
+    } _fingerprint;
+
     // optional additional uart
     struct {
         AP_HAL::UARTDriver *uart;
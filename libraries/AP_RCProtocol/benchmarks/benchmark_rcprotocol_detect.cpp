@@ -0,0 +1,188 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_RCProtocol/AP_RCProtocol.h>
+#include <AP_Math/AP_Math.h>
+#include <RC_Channel/RC_Channel.h>
+
+#include <stdio.h>
+#include <vector>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+class RC_Channel_Bench : public RC_Channel
+{
+};
+
+class RC_Channels_Bench : public RC_Channels
+{
+public:
+    RC_Channel *channel(uint8_t chan) override {
+        return &obj_channels[chan];
+    }
+
+    RC_Channel_Bench obj_channels[NUM_RC_CHANNELS];
+private:
+    int8_t flight_mode_channel_number() const override { return -1; };
+};
+
+#define RC_CHANNELS_SUBCLASS RC_Channels_Bench
+#define RC_CHANNEL_SUBCLASS RC_Channel_Bench
+
+#include <RC_Channel/RC_Channels_VarInfo.h>
+
+static RC_Channels_Bench _rc;
+
+/*
+  frames recorded from receivers (from the RCProtocolTest example)
+  played back at their baudrate and frame rate on a stopped clock, so
+  the decoders see the same byte timing as on the RC input thread
+ */
+typedef std::vector<uint8_t> Frame;
+
+static const Frame sbus_frame {
+    0x0F, 0x4C, 0x1C, 0x5F, 0x32, 0x34, 0x38, 0xDD, 0x89,
+    0x83, 0x0F, 0x7C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+// DSMX_2048_11MS, two frames
+static const Frame dsm_frame {
+    0x00, 0xb2, 0x80, 0x94, 0x3c, 0x02, 0x1b, 0xfe,
+    0x44, 0x00, 0x4c, 0x00, 0x5c, 0x00, 0xff, 0xff
+};
+static const Frame dsm_frame2 {
+    0x00, 0xb2, 0x0c, 0x03, 0x2e, 0xaa, 0x14, 0x00,
+    0x21, 0x56, 0x34, 0x02, 0x54, 0x00, 0xff, 0xff
+};
+
+static const Frame fport_frame {
+    0x7e, 0x19, 0x00, 0xe7, 0x3b, 0xdf, 0x5a, 0xce,
+    0x07, 0x10, 0x75, 0x49, 0x9c, 0x15, 0xe0, 0x03,
+    0x1f, 0xf8, 0xc0, 0x07, 0x3e, 0xf0, 0x81, 0x0f,
+    0x7c, 0x00, 0x38, 0xfa, 0x7e
+};
+
+static const Frame ibus_frame {
+    0x20, 0x40, 0xdc, 0x05, 0xdc, 0x05, 0xe8, 0x03, 0xdc, 0x05, 0xdc, 0x05,
+    0xdc, 0x05, 0xdc, 0x05, 0xdc, 0x05, 0xdc, 0x05, 0xdc, 0x05, 0xdc, 0x05,
+    0xdc, 0x05, 0xdc, 0x05, 0xdc, 0x05, 0x47, 0xf3
+};
+
+// CRSF RC channels frame with all 16 channels centred
+static Frame make_crsf_frame()
+{
+    Frame f { 0xC8, 24, 0x16 };
+    uint32_t bits = 0;
+    uint8_t nbits = 0;
+    for (uint8_t i=0; i<16; i++) {
+        bits |= 992U << nbits;
+        nbits += 11;
+        while (nbits >= 8) {
+            f.push_back(bits & 0xFF);
+            bits >>= 8;
+            nbits -= 8;
+        }
+    }
+    f.push_back(crc8_dvb_s2_update(0, &f[2], f.size() - 2));
+    return f;
+}
+static const Frame crsf_frame = make_crsf_frame();
+
+struct RCStream {
+    AP_RCProtocol::rcprotocol_t protocol;
+    uint32_t baudrate;
+    uint8_t bits_per_byte;
+    uint32_t frame_period_us;
+    const Frame *frames[2];
+};
+
+static const RCStream streams[] {
+    { AP_RCProtocol::SBUS,  100000, 12, 14000, { &sbus_frame, &sbus_frame } },
+    { AP_RCProtocol::CRSF,  416666, 10,  4000, { &crsf_frame, &crsf_frame } },
+    { AP_RCProtocol::DSM,   115200, 10, 11000, { &dsm_frame, &dsm_frame2 } },
+    { AP_RCProtocol::FPORT, 115200, 10,  9000, { &fport_frame, &fport_frame } },
+    { AP_RCProtocol::IBUS,  115200, 10,  7000, { &ibus_frame, &ibus_frame } },
+};
+
+static uint64_t clock_us = 1000000;
+
+/*
+  time to detect each protocol from a fresh AP_RCProtocol, all
+  decoders are searching until then. The label gives the bytes it
+  took
+ */
+static void BM_RCProtocolDetect(benchmark::State& state)
+{
+    const RCStream &stream = streams[state.range_x()];
+    const uint32_t byte_us = stream.bits_per_byte * 1000000U / stream.baudrate;
+    uint32_t bytes = 0;
+    uint32_t detect_bytes = 0;
+    bool detected = false;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        AP_RCProtocol *rcprot = new AP_RCProtocol();
+        rcprot->init();
+        state.ResumeTiming();
+
+        detect_bytes = 0;
+        for (uint8_t n=0; n<50 && rcprot->protocol_detected() != stream.protocol; n++) {
+            const Frame &frame = *stream.frames[n % 2];
+            const uint64_t frame_start_us = clock_us;
+            for (uint8_t b : frame) {
+                clock_us += byte_us;
+                hal.scheduler->stop_clock(clock_us);
+                rcprot->process_byte(b, stream.baudrate);
+            }
+            detect_bytes += frame.size();
+            clock_us = frame_start_us + stream.frame_period_us;
+        }
+        bytes += detect_bytes;
+        detected = rcprot->protocol_detected() == stream.protocol;
+
+        state.PauseTiming();
+        delete rcprot;
+        state.ResumeTiming();
+    }
+    state.SetBytesProcessed(bytes);
+    char label[32];
+    if (detected) {
+        snprintf(label, sizeof(label), "%s %u bytes",
+                 AP_RCProtocol::protocol_name_from_protocol(stream.protocol),
+                 unsigned(detect_bytes));
+    } else {
+        snprintf(label, sizeof(label), "%s not detected",
+                 AP_RCProtocol::protocol_name_from_protocol(stream.protocol));
+    }
+    state.SetLabel(label);
+}
+
+/*
+  cost per byte of searching a stream none of the protocols can lock
+  on to, as when the receiver is not sending RC frames yet
+ */
+static void BM_RCProtocolSearch(benchmark::State& state)
+{
+    static Frame noise(1000);
+    uint32_t seed = 1;
+    for (auto &b : noise) {
+        seed = seed * 1103515245U + 12345U;
+        b = seed >> 16;
+    }
+    AP_RCProtocol *rcprot = new AP_RCProtocol();
+    rcprot->init();
+    while (state.KeepRunning()) {
+        for (uint8_t b : noise) {
+            clock_us += 87;
+            hal.scheduler->stop_clock(clock_us);
+            rcprot->process_byte(b, 115200);
+        }
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * noise.size());
+    delete rcprot;
+}
+
+// index into streams
+BENCHMARK(BM_RCProtocolDetect)->Arg(0)->Arg(1)->Arg(2)->Arg(3)->Arg(4);
+BENCHMARK(BM_RCProtocolSearch);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,81 @@
+#include <AP_gtest.h>
+
+#include <AP_RCProtocol/AP_RCProtocol.h>
+#include <AP_RCProtocol/AP_RCProtocol_SUMD.h>
+#include <AP_Math/AP_Math.h>
+#include <RC_Channel/RC_Channel.h>
+
+#include <vector>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+class RC_Channel_Test : public RC_Channel
+{
+};
+
+class RC_Channels_Test : public RC_Channels
+{
+public:
+    RC_Channel *channel(uint8_t chan) override {
+        return &obj_channels[chan];
+    }
+
+    RC_Channel_Test obj_channels[NUM_RC_CHANNELS];
+private:
+    int8_t flight_mode_channel_number() const override { return -1; };
+};
+
+#define RC_CHANNELS_SUBCLASS RC_Channels_Test
+#define RC_CHANNEL_SUBCLASS RC_Channel_Test
+
+#include <RC_Channel/RC_Channels_VarInfo.h>
+
+static RC_Channels_Test _rc;
+
+// SUMD frame with every channel at 1500us
+static std::vector<uint8_t> make_sumd_frame(uint8_t num_channels)
+{
+    std::vector<uint8_t> f { 0xA8, 0x01, num_channels };
+    for (uint8_t i=0; i<num_channels; i++) {
+        const uint16_t value = 1500 * 8;
+        f.push_back(value >> 8);
+        f.push_back(value & 0xFF);
+    }
+    uint16_t crc = 0;
+    for (uint8_t b : f) {
+        crc = crc_xmodem_update(crc, b);
+    }
+    f.push_back(crc >> 8);
+    f.push_back(crc & 0xFF);
+    return f;
+}
+
+/*
+  the search only passes each protocol the bytes of its longest
+  frame, a frame with all 32 channels must reach the decoder whole
+ */
+TEST(AP_RCProtocol, SUMDMaxChannels)
+{
+    const std::vector<uint8_t> frame = make_sumd_frame(SUMD_MAX_CHANNELS);
+    EXPECT_EQ(frame.size(), 3U + 2*SUMD_MAX_CHANNELS + 2);
+
+    AP_RCProtocol *rcprot = new AP_RCProtocol();
+    rcprot->init();
+
+    // each frame arrives in one UART read, 10ms apart
+    uint64_t clock_us = 1000000;
+    for (uint8_t n=0; n<10 && rcprot->protocol_detected() != AP_RCProtocol::SUMD; n++) {
+        clock_us += 10000;
+        hal.scheduler->stop_clock(clock_us);
+        for (uint8_t b : frame) {
+            rcprot->process_byte(b, 115200);
+        }
+    }
+    EXPECT_EQ(rcprot->protocol_detected(), AP_RCProtocol::SUMD);
+    EXPECT_EQ(rcprot->num_channels(), MIN(SUMD_MAX_CHANNELS, MAX_RCIN_CHANNELS));
+    EXPECT_EQ(rcprot->read(0), 1500);
+
+    delete rcprot;
+}
+
+AP_GTEST_MAIN()
@@ -27,9 +27,11 @@
 #include <AP_InertialSensor/AP_InertialSensor.h>
 #include <AP_InternalError/AP_InternalError.h>
 #include <AP_Common/ExpandingString.h>
+#include <AP_HAL/utility/Trace.h>
 
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
 #include <SITL/SITL.h>
+#include <SITL/SIM_Profile.h>
 #endif
 #include <stdio.h>
 
@@ -62,7 +64,7 @@ const AP_Param::GroupInfo AP_Scheduler::var_info[] = {
     // @Param: OPTIONS
     // @DisplayName: Scheduling options
     // @Description: This controls optional aspects of the scheduler.
-    // @Bitmask: 0:Enable per-task perf info
+    // @Bitmask: 0:Enable per-task perf info,1:Record a trace of tasks and threads in @SYS/trace.json
     // @User: Advanced
     AP_GROUPINFO("OPTIONS",  2, AP_Scheduler, _options, 0),
 
@@ -246,9 +248,24 @@ void AP_Scheduler::run(uint32_t time_available)
         hal.util->persistent_data.scheduler_task = i;
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
         fill_nanf_stack();
+        // AP_HAL::micros() is simulation time, so profile against the host clock
+        const uint64_t task_start_ns = AP::sim_profile().enabled() ? SITL::Profile::now_ns() : 0;
+#endif
+#if AP_HAL_TRACE_ENABLED
+        const uint64_t trace_start_ns = AP_HAL::Trace::start();
 #endif
         task.function();
+#if AP_HAL_TRACE_ENABLED
+        AP_HAL::Trace::record(task.name, trace_start_ns);
+#endif
         hal.util->persistent_data.scheduler_task = -1;
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+        if (task_start_ns != 0) {
+            const uint64_t dt_ns = SITL::Profile::now_ns() - task_start_ns;
+            AP::sim_profile().add(SITL::Profile::Category::TASKS, dt_ns);
+            AP::sim_profile().add_task(i, task.name, dt_ns);
+        }
+#endif
 
         // record the tick counter when we ran. This drives
         // when we next run the event
@@ -334,6 +351,12 @@ void AP_Scheduler::loop()
     // ---------------------
     if (_fastloop_fn) {
         hal.util->persistent_data.scheduler_task = -2;
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+        SITL::Profile::Scope profile_scope(SITL::Profile::Category::FAST_LOOP);
+#endif
+#if AP_HAL_TRACE_ENABLED
+        AP_HAL::Trace::Scope trace_scope("fast_loop");
+#endif
         _fastloop_fn();
         hal.util->persistent_data.scheduler_task = -1;
     }
@@ -419,6 +442,9 @@ void AP_Scheduler::update_logging()
     } else if ((_options & uint8_t(Options::RECORD_TASK_INFO)) && !perf_info.has_task_info()) {
         perf_info.allocate_task_info(_num_tasks);
     }
+#if AP_HAL_TRACE_ENABLED
+    AP_HAL::Trace::enable(_options & uint8_t(Options::RECORD_TRACE));
+#endif
 }
 
 // Write a performance monitoring packet
@@ -84,7 +84,8 @@ public:
     };
 
     enum class Options : uint8_t {
-        RECORD_TASK_INFO = 1 << 0
+        RECORD_TASK_INFO = 1 << 0,
+        RECORD_TRACE     = 1 << 1,
     };
 
     // initialise scheduler
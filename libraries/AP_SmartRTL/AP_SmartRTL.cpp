@@ -19,6 +19,9 @@
 
 extern const AP_HAL::HAL& hal;
 
+// marks the end of a pruning grid bucket
+#define SMARTRTL_PRUNING_GRID_NONE UINT16_MAX
+
 const AP_Param::GroupInfo AP_SmartRTL::var_info[] = {
     // @Param: ACCURACY
     // @DisplayName: SmartRTL accuracy
@@ -30,8 +33,8 @@ const AP_Param::GroupInfo AP_SmartRTL::var_info[] = {
 
     // @Param: POINTS
     // @DisplayName: SmartRTL maximum number of points on path
-    // @Description: SmartRTL maximum number of points on path. Set to 0 to disable SmartRTL.  100 points consumes about 3k of memory.
-    // @Range: 0 500
+    // @Description: SmartRTL maximum number of points on path. Set to 0 to disable SmartRTL.  100 points consumes about 3k of memory.  Boards with more memory support up to 5000 points, others up to 500.
+    // @Range: 0 5000
     // @User: Advanced
     // @RebootRequired: True
     AP_GROUPINFO("POINTS", 1, AP_SmartRTL, _points_max, SMARTRTL_POINTS_DEFAULT),
@@ -67,6 +70,11 @@ const AP_Param::GroupInfo AP_SmartRTL::var_info[] = {
 *    2. Simplification uses the Ramer-Douglas-Peucker algorithm. See Wikipedia
 *    for a more complete description.
 *
+*    To avoid comparing every segment with every other segment, pruning keeps
+*    the path's segments in a horizontal grid and only compares segments in
+*    nearby grid cells.  The grid is extended as points are added and cut back
+*    when points are removed, so each cleanup only does work for new points.
+*
 *    The simplification and pruning algorithms run in the background and do not
 *    alter the path in memory.  Two definitions, SMARTRTL_SIMPLIFY_TIME_US and
 *    SMARTRTL_PRUNING_LOOP_TIME_US are used to limit how long each algorithm will
@@ -115,17 +123,34 @@ void AP_SmartRTL::init()
     _simplify.stack_max = _points_max * SMARTRTL_SIMPLIFY_STACK_LEN_MULT;
     _simplify.stack = (simplify_start_finish_t*)calloc(_simplify.stack_max, sizeof(simplify_start_finish_t));
 
+    // power of two number of grid buckets, roughly one for every four points
+    _grid.num_buckets = 16;
+    while (_grid.num_buckets < _points_max / 4) {
+        _grid.num_buckets <<= 1;
+    }
+    _grid.head = (uint16_t*)calloc(_grid.num_buckets + 1, sizeof(uint16_t));
+    _grid.entries_max = _points_max * SMARTRTL_PRUNING_GRID_ENTRIES_MULT;
+    _grid.entries = (grid_entry_t*)calloc(_grid.entries_max, sizeof(grid_entry_t));
+
     // check if memory allocation failed
-    if (_path == nullptr || _prune.loops == nullptr || _simplify.stack == nullptr) {
+    if (_path == nullptr || _prune.loops == nullptr || _simplify.stack == nullptr || _grid.head == nullptr || _grid.entries == nullptr) {
         log_action(SRTL_DEACTIVATED_INIT_FAILED);
         gcs().send_text(MAV_SEVERITY_WARNING, "SmartRTL deactivated: init failed");
         free(_path);
         free(_prune.loops);
         free(_simplify.stack);
+        free(_grid.head);
+        free(_grid.entries);
+        _path = nullptr;
+        _prune.loops = nullptr;
+        _simplify.stack = nullptr;
+        _grid.head = nullptr;
+        _grid.entries = nullptr;
         return;
     }
 
     _path_points_max = _points_max;
+    grid_reset();
 
     // when running the example sketch, we want the cleanup tasks to run when we tell them to, not in the background (so that they can be timed.)
     if (!_example_mode){
@@ -365,6 +390,9 @@ void AP_SmartRTL::run_background_cleanup()
     _path_points_completed_limit = SMARTRTL_POINTS_MAX;
     _path_sem.give();
 
+    // points popped from the path may since have been replaced by new points
+    grid_truncate(path_points_completed_limit);
+
     // check if thorough cleanup is required
     if (_thorough_clean_request_ms > 0) {
         // check if we have already completed the request
@@ -520,23 +548,30 @@ void AP_SmartRTL::detect_simplifications()
         const uint16_t start_index = tmp.start;
         const uint16_t end_index = tmp.finish;
 
-        // find the point between start and end points that is farthest from the start-end line segment
-        float max_dist = 0.0f;
+        // find the point between start and end points that is farthest from the start-end line
+        // squared distances are compared, found from the cross product with the line, to avoid square roots
+        const Vector3f &start = _path[start_index];
+        const Vector3f line = _path[end_index] - start;
+        const float line_length_sq = line.length_squared();
+        float max_dist_sq = 0.0f;
         uint16_t farthest_point_index = start_index;
-        for (uint16_t i = start_index + 1; i < end_index; i++) {
-            // only check points that have not already been flagged for simplification
-            if (_simplify.bitmask.get(i)) {
-                const float dist = _path[i].distance_to_segment(_path[start_index], _path[end_index]);
-                if (dist > max_dist) {
-                    farthest_point_index = i;
-                    max_dist = dist;
+        if (line_length_sq >= sq(FLT_EPSILON)) {
+            const float line_length_sq_inv = 1.0f / line_length_sq;
+            for (uint16_t i = start_index + 1; i < end_index; i++) {
+                // only check points that have not already been flagged for simplification
+                if (_simplify.bitmask.get(i)) {
+                    const float dist_sq = ((_path[i] - start) % line).length_squared() * line_length_sq_inv;
+                    if (dist_sq > max_dist_sq) {
+                        farthest_point_index = i;
+                        max_dist_sq = dist_sq;
+                    }
                 }
             }
         }
 
         // if the farthest point is more than ACCURACY * 0.5 add two new elements to the _simplification_stack
         // so that on the next iteration we will check between start-to-farthestpoint and farthestpoint-to-end
-        if (max_dist > SMARTRTL_SIMPLIFY_EPSILON) {
+        if (max_dist_sq > sq(SMARTRTL_SIMPLIFY_EPSILON)) {
             // if the to-do list is full, give up on simplifying. This should never happen.
             if (_simplify.stack_count >= _simplify.stack_max) {
                 _simplify.complete = true;
@@ -560,6 +595,7 @@ void AP_SmartRTL::detect_simplifications()
 *   This method runs for the allotted time, and detects loops in a path. Any detected loops are added to _prune.loops,
 *   this function does not alter the path in memory. It works by comparing the line segment between any two sequential points
 *   to the line segment between any other two sequential points. If they get close enough, anything between them could be pruned.
+*   Only segments in nearby cells of the pruning grid are compared, see find_loop_start.
 *
 *   reset_pruning should have been called at least once before this function is called to setup the indexes (_prune.i, etc)
 */
@@ -574,36 +610,230 @@ void AP_SmartRTL::detect_loops()
     // capture start time
     const uint32_t start_time_us = AP_HAL::micros();
 
+    // add any new segments to the grid, segments not yet in the grid are checked linearly
+    grid_add_segments(_prune.path_points_count, start_time_us);
+
     // run for defined amount of time
     while (AP_HAL::micros() - start_time_us < SMARTRTL_PRUNING_LOOP_TIME_US) {
 
-        // advance inner loop
-        _prune.j++;
-        if (_prune.j > _prune.i - 2) {
-            // set inner loop back to first point
-            _prune.j = 1;
-            // reduce outer loop
-            _prune.i--;
-            // complete when outer loop has run out of new points to check
-            if (_prune.i < 4 || _prune.i < _prune.path_points_completed) {
+        // find the earliest segment that comes close to the segment ending at _prune.i
+        dist_point dp;
+        uint16_t j;
+        if (!find_loop_start(_prune.i, j, dp, start_time_us)) {
+            // out of time, the search continues on the next call
+            return;
+        }
+        if (j > 0) {
+            // if there is a loop here, add to loop array
+            if (!add_loop(j, _prune.i-1, dp.midpoint)) {
+                // if the buffer is full, stop trying to prune
                 _prune.complete = true;
-                _prune.path_points_completed = _prune.path_points_count;
                 return;
             }
         }
 
-        // find the closest distance between two line segments and the mid-point
-        dist_point dp = segment_segment_dist(_path[_prune.i], _path[_prune.i-1], _path[_prune.j-1], _path[_prune.j]);
-        if (dp.distance < SMARTRTL_PRUNING_DELTA) {
-            // if there is a loop here, add to loop array
-            if (!add_loop(_prune.j, _prune.i-1, dp.midpoint)) {
-                // if the buffer is full, stop trying to prune
-                _prune.complete = true;
+        // reduce outer loop
+        _prune.i--;
+        // complete when outer loop has run out of new points to check
+        if (_prune.i < 4 || _prune.i < _prune.path_points_completed) {
+            _prune.complete = true;
+            _prune.path_points_completed = _prune.path_points_count;
+            return;
+        }
+    }
+}
+
+// find the first segment on the path (lowest index) that comes within SMARTRTL_PRUNING_DELTA of the segment ending at point i
+//  this gives the same result as checking segments 1 to i-2 in order, the segments next to segment i are never checked
+//  the linear checks can cover the whole path so they stop at the time limit and are resumed on the next call
+bool AP_SmartRTL::find_loop_start(uint16_t i, uint16_t &loop_start, dist_point &dp, uint32_t start_time_us)
+{
+    const uint16_t j_max = i - 2;
+
+    // continue a linear check cut short by the time limit
+    if (_prune.j > 0) {
+        return scan_segments(i, j_max, loop_start, dp, start_time_us);
+    }
+
+    // check segments in the grid, these are the segments ending before point _grid.path_points_count
+    if (_grid.path_points_count > 1) {
+        const uint16_t grid_j_max = MIN(j_max, _grid.path_points_count - 1);
+        const Vector3f &p1 = _path[i-1];
+        const Vector3f &p2 = _path[i];
+        const float delta = SMARTRTL_PRUNING_DELTA;
+        const int32_t x_min = grid_cell(MIN(p1.x, p2.x) - delta);
+        const int32_t x_max = grid_cell(MAX(p1.x, p2.x) + delta);
+        const int32_t y_min = grid_cell(MIN(p1.y, p2.y) - delta);
+        const int32_t y_max = grid_cell(MAX(p1.y, p2.y) + delta);
+
+        if ((x_max - x_min + 1) * (y_max - y_min + 1) > SMARTRTL_PRUNING_GRID_SEARCH_CELLS_MAX) {
+            // the segment covers too many cells, check against all earlier segments
+            _prune.j = 1;
+            return scan_segments(i, j_max, loop_start, dp, start_time_us);
+        } else {
+            // check segments in nearby cells and in the list of segments too long to be placed in cells
+            uint16_t found = 0;
+            dist_point dp_check;
+            for (int32_t x = x_min; x <= x_max + 1; x++) {
+                for (int32_t y = y_min; y <= y_max; y++) {
+                    // x_max + 1 is used to visit the long segments bucket once
+                    const uint16_t bucket = (x <= x_max) ? grid_bucket(x, y) : _grid.num_buckets;
+                    for (uint16_t e = _grid.head[bucket]; e != SMARTRTL_PRUNING_GRID_NONE; e = _grid.entries[e].next) {
+                        const uint16_t j = _grid.entries[e].segment;
+                        if ((j <= grid_j_max) && ((found == 0) || (j < found)) && segments_close(i, j, dp_check)) {
+                            found = j;
+                            dp = dp_check;
+                        }
+                    }
+                    if (x > x_max) {
+                        break;
+                    }
+                }
+            }
+            if (found > 0) {
+                loop_start = found;
+                return true;
             }
-            // set inner loop forward to trigger outer loop move to next segment
-            _prune.j = _prune.i;
         }
     }
+
+    // check segments which are not in the grid
+    _prune.j = MAX(_grid.path_points_count, 1);
+    return scan_segments(i, j_max, loop_start, dp, start_time_us);
+}
+
+// check segments from _prune.j to j_max in order against the segment ending at point i
+//  returns false if the time limit was reached first, leaving _prune.j at the next segment to check
+bool AP_SmartRTL::scan_segments(uint16_t i, uint16_t j_max, uint16_t &loop_start, dist_point &dp, uint32_t start_time_us)
+{
+    for (; _prune.j <= j_max; _prune.j++) {
+        if (segments_close(i, _prune.j, dp)) {
+            loop_start = _prune.j;
+            _prune.j = 0;
+            return true;
+        }
+        // check the time every few segments
+        if (((_prune.j & 0x0F) == 0) && (AP_HAL::micros() - start_time_us >= SMARTRTL_PRUNING_LOOP_TIME_US)) {
+            _prune.j++;
+            return false;
+        }
+    }
+    loop_start = 0;
+    _prune.j = 0;
+    return true;
+}
+
+// returns true if the segment ending at point j comes within SMARTRTL_PRUNING_DELTA of the segment ending at point i
+bool AP_SmartRTL::segments_close(uint16_t i, uint16_t j, dist_point &dp) const
+{
+    dp = segment_segment_dist(_path[i], _path[i-1], _path[j-1], _path[j]);
+    return dp.distance < SMARTRTL_PRUNING_DELTA;
+}
+
+// clear the pruning grid
+void AP_SmartRTL::grid_reset()
+{
+    if (_grid.head == nullptr) {
+        return;
+    }
+    for (uint16_t b = 0; b <= _grid.num_buckets; b++) {
+        _grid.head[b] = SMARTRTL_PRUNING_GRID_NONE;
+    }
+    _grid.entries_count = 0;
+    _grid.path_points_count = 0;
+    _grid.full = false;
+    // cell size is fixed until the next reset so that segments are always found in the cells they were added to
+    _grid.cell_size_inv = 1.0f / MAX(SMARTRTL_PRUNING_GRID_CELL_SIZE, 0.1f);
+}
+
+// return the grid cell holding a horizontal position coordinate
+int32_t AP_SmartRTL::grid_cell(float pos) const
+{
+    return (int32_t)floorf(pos * _grid.cell_size_inv);
+}
+
+// return the bucket for a grid cell
+uint16_t AP_SmartRTL::grid_bucket(int32_t cell_x, int32_t cell_y) const
+{
+    const uint32_t h = ((uint32_t)cell_x * 73856093U) ^ ((uint32_t)cell_y * 19349663U);
+    return h & (_grid.num_buckets - 1);
+}
+
+// add segments to the grid until it covers path_points_count points or the time limit is reached
+void AP_SmartRTL::grid_add_segments(uint16_t path_points_count, uint32_t start_time_us)
+{
+    if (_grid.head == nullptr) {
+        return;
+    }
+    while (!_grid.full && (_grid.path_points_count < path_points_count)) {
+        // the first point does not end a segment
+        const uint16_t j = _grid.path_points_count;
+        if (j == 0) {
+            _grid.path_points_count++;
+            continue;
+        }
+
+        // leave time for the loop search
+        if (AP_HAL::micros() - start_time_us > SMARTRTL_PRUNING_LOOP_TIME_US / 2) {
+            return;
+        }
+
+        // cells covered by segment's bounding box
+        const Vector3f &p1 = _path[j-1];
+        const Vector3f &p2 = _path[j];
+        const int32_t x_min = grid_cell(MIN(p1.x, p2.x));
+        const int32_t x_max = grid_cell(MAX(p1.x, p2.x));
+        const int32_t y_min = grid_cell(MIN(p1.y, p2.y));
+        const int32_t y_max = grid_cell(MAX(p1.y, p2.y));
+        const bool too_long = (x_max - x_min + 1) * (y_max - y_min + 1) > SMARTRTL_PRUNING_GRID_SEGMENT_CELLS_MAX;
+        const uint16_t entries_required = too_long ? 1 : (x_max - x_min + 1) * (y_max - y_min + 1);
+        if (_grid.entries_count + entries_required > _grid.entries_max) {
+            _grid.full = true;
+            return;
+        }
+
+        for (int32_t x = x_min; x <= x_max; x++) {
+            for (int32_t y = y_min; y <= y_max; y++) {
+                const uint16_t bucket = too_long ? _grid.num_buckets : grid_bucket(x, y);
+                grid_entry_t &entry = _grid.entries[_grid.entries_count];
+                entry.segment = j;
+                entry.next = _grid.head[bucket];
+                _grid.head[bucket] = _grid.entries_count++;
+                if (too_long) {
+                    break;
+                }
+            }
+            if (too_long) {
+                break;
+            }
+        }
+        _grid.path_points_count++;
+    }
+}
+
+// remove segments which use points at or beyond path_points_count from the grid
+void AP_SmartRTL::grid_truncate(uint16_t path_points_count)
+{
+    if ((_grid.head == nullptr) || (path_points_count >= _grid.path_points_count)) {
+        return;
+    }
+
+    // entries are in path order so removed segments are at the end of the entries array
+    uint16_t entries_count = _grid.entries_count;
+    while ((entries_count > 0) && (_grid.entries[entries_count-1].segment >= path_points_count)) {
+        entries_count--;
+    }
+
+    // and at the start of each bucket
+    for (uint16_t b = 0; b <= _grid.num_buckets; b++) {
+        while ((_grid.head[b] != SMARTRTL_PRUNING_GRID_NONE) && (_grid.head[b] >= entries_count)) {
+            _grid.head[b] = _grid.entries[_grid.head[b]].next;
+        }
+    }
+
+    _grid.entries_count = entries_count;
+    _grid.path_points_count = path_points_count;
+    _grid.full = false;
 }
 
 // restart simplify if new points have been added to path
@@ -657,6 +887,7 @@ void AP_SmartRTL::reset_pruning()
     restart_pruning(0);
     _prune.loops_count = 0; // clear the loops that we've recorded
     _prune.path_points_completed = 0;
+    grid_reset();
 }
 
 // remove all simplify-able points from the path
@@ -671,6 +902,10 @@ void AP_SmartRTL::remove_points_by_simplify_bitmask()
     for (uint16_t src = 1; src < _path_points_count; src++) {
         if (!_simplify.bitmask.get(src)) {
             log_action(SRTL_POINT_SIMPLIFY, _path[src]);
+            if (removed == 0) {
+                // points before this one are unchanged
+                grid_truncate(src);
+            }
             removed++;
         } else {
             _path[dest] = _path[src];
@@ -711,6 +946,7 @@ bool AP_SmartRTL::remove_points_by_loops(uint16_t num_points_to_remove)
     }
 
     uint16_t removed_points = 0;
+    uint16_t first_changed_index = _path_points_count;
     uint16_t i = _prune.loops_count;
     while ((i > 0) && (removed_points < num_points_to_remove)) {
         i--;
@@ -718,6 +954,7 @@ bool AP_SmartRTL::remove_points_by_loops(uint16_t num_points_to_remove)
 
         // midpoint goes into start_index (this is the end point of the first segment)
         _path[loop.start_index] = loop.midpoint;
+        first_changed_index = MIN(first_changed_index, loop.start_index);
 
         // shift points after the end of the loop down by the number of points in the loop
         uint16_t loop_num_points_to_remove = loop.end_index - loop.start_index;
@@ -752,6 +989,9 @@ bool AP_SmartRTL::remove_points_by_loops(uint16_t num_points_to_remove)
         _prune.loops_count--;
     }
 
+    // points before the earliest loop are unchanged
+    grid_truncate(first_changed_index);
+
     _path_sem.give();
     return true;
 }
@@ -7,7 +7,13 @@
 // definitions and macros
 #define SMARTRTL_ACCURACY_DEFAULT        2.0f   // default _ACCURACY parameter value.  Points will be no closer than this distance (in meters) together.
 #define SMARTRTL_POINTS_DEFAULT          300    // default _POINTS parameter value.  High numbers improve path pruning but use more memory and CPU for cleanup. Memory used will be 20bytes * this number.
-#define SMARTRTL_POINTS_MAX              500    // the absolute maximum number of points this library can support.
+#ifndef SMARTRTL_POINTS_MAX
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#define SMARTRTL_POINTS_MAX              5000   // the absolute maximum number of points this library can support.
+#else
+#define SMARTRTL_POINTS_MAX              500
+#endif
+#endif
 #define SMARTRTL_TIMEOUT                 15000  // the time in milliseconds with no points saved to the path (for whatever reason), before SmartRTL is disabled for the flight
 #define SMARTRTL_CLEANUP_POINT_TRIGGER   50     // simplification will trigger when this many points are added to the path
 #define SMARTRTL_CLEANUP_START_MARGIN    10     // routine cleanup algorithms begin when the path array has only this many empty slots remaining
@@ -20,6 +26,10 @@
 #define SMARTRTL_PRUNING_DELTA (_accuracy * 0.99)   // How many meters apart must two points be, such that we can assume that there is no obstacle between them.  must be smaller than _ACCURACY parameter
 #define SMARTRTL_PRUNING_LOOP_BUFFER_LEN_MULT 0.25f // pruning loop buffer size as compared to maximum number of points
 #define SMARTRTL_PRUNING_LOOP_TIME_US    200    // maximum time (in microseconds) that the loop finding algorithm will run before returning
+#define SMARTRTL_PRUNING_GRID_CELL_SIZE (_accuracy * 4.0f) // size in meters of the horizontal grid cells used to find nearby segments when pruning
+#define SMARTRTL_PRUNING_GRID_ENTRIES_MULT 1.5f // pruning grid entries as compared to maximum number of points.  Segments that do not fit are checked linearly
+#define SMARTRTL_PRUNING_GRID_SEGMENT_CELLS_MAX 4 // segments covering more grid cells than this are kept in a separate list which is always checked
+#define SMARTRTL_PRUNING_GRID_SEARCH_CELLS_MAX 16 // segments needing more grid cells than this to be searched are checked against all earlier segments
 
 class AP_SmartRTL {
 
@@ -154,6 +164,16 @@ private:
     // returns false if it failed to remove points (because it could not take semaphore)
     bool remove_points_by_loops(uint16_t num_points_to_remove);
 
+    // pruning grid.  Holds the path's segments in horizontal grid cells so that detect_loops
+    //  only compares segments that are near each other
+    void grid_reset();
+    int32_t grid_cell(float pos) const;
+    uint16_t grid_bucket(int32_t cell_x, int32_t cell_y) const;
+    // add segments to the grid until it covers path_points_count points or the time limit is reached
+    void grid_add_segments(uint16_t path_points_count, uint32_t start_time_us);
+    // remove segments which use points at or beyond path_points_count from the grid
+    void grid_truncate(uint16_t path_points_count);
+
     // add loop to loops array
     //  returns true if loop added successfully, false on failure (because loop array is full)
     //  checks if loop overlaps with an existing loop, keeps only the longer loop
@@ -169,6 +189,18 @@ private:
     // get the closest distance between 2 line segments and the point midway between the closest points
     static dist_point segment_segment_dist(const Vector3f& p1, const Vector3f& p2, const Vector3f& p3, const Vector3f& p4);
 
+    // find the first segment on the path (lowest index) that comes within SMARTRTL_PRUNING_DELTA of the segment ending at point i
+    //  segments are identified by the index of their end point.  loop_start is set to 0 if no segment is close enough
+    //  dp is filled in with the distance and midpoint for the segment found
+    //  returns false if the time limit was reached first, the search then continues from _prune.j on the next call
+    bool find_loop_start(uint16_t i, uint16_t &loop_start, dist_point &dp, uint32_t start_time_us);
+
+    // check segments from _prune.j to j_max in order against the segment ending at point i, as find_loop_start
+    bool scan_segments(uint16_t i, uint16_t j_max, uint16_t &loop_start, dist_point &dp, uint32_t start_time_us);
+
+    // returns true if the segment ending at point j comes within SMARTRTL_PRUNING_DELTA of the segment ending at point i
+    bool segments_close(uint16_t i, uint16_t j, dist_point &dp) const;
+
     // de-activate SmartRTL, send warning to GCS and logger
     void deactivate(SRTL_Actions action, const char *reason);
 
@@ -226,13 +258,32 @@ private:
         bool complete;
         uint16_t path_points_count;  // copy of _path_points_count taken when the prune algorithm started
         uint16_t path_points_completed; // number of points in that path that have already been checked for loops and should be ignored
-        uint16_t i;     // loop search's outer loop index
-        uint16_t j;     // loop search's inner loop index
+        uint16_t i;     // loop search's outer loop index, the end point of the next segment to be checked
+        uint16_t j;     // next segment of a linear search for segment i cut short by the time limit, 0 if none
         prune_loop_t* loops;// the result of the pruning algorithm
         uint16_t loops_max; // maximum number of elements in the _prunable_loops array
         uint16_t loops_count;   // number of elements in the _prunable_loops array
     } _prune;
 
+    // Pruning grid
+    // each segment is entered into every grid cell its horizontal bounding box covers.  Entries are stored in
+    // path order and each bucket is a list starting from the newest entry, so the grid can be cut back cheaply
+    // when points are removed from the path
+    typedef struct {
+        uint16_t segment;   // index of the segment's end point.  The segment runs from _path[segment-1] to _path[segment]
+        uint16_t next;      // index of next entry in the same bucket
+    } grid_entry_t;
+    struct {
+        uint16_t* head;         // index of newest entry in each bucket.  The extra bucket at num_buckets holds segments covering too many cells
+        grid_entry_t* entries;  // entries for all segments in the grid
+        uint16_t entries_max;   // maximum number of elements in the entries array
+        uint16_t entries_count; // number of elements in the entries array
+        uint16_t num_buckets;   // number of buckets, always a power of two
+        uint16_t path_points_count; // segments between the first path_points_count points are in the grid
+        float cell_size_inv;    // one over the grid cell size in meters
+        bool full;              // true if the entries array filled up, later segments are checked linearly
+    } _grid;
+
     // returns true if the two loops overlap (used within add_loop to determine which loops to keep or throw away)
     bool loops_overlap(const prune_loop_t& loop1, const prune_loop_t& loop2) const;
 };
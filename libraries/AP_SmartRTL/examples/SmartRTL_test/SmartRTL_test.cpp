@@ -27,18 +27,30 @@ static DummyVehicle vehicle;
 
 AP_AHRS &ahrs(vehicle.ahrs);
 AP_SmartRTL smart_rtl{true};
+AP_SmartRTL smart_rtl_long{true};
 AP_BoardConfig board_config;
 
+// long synthetic flight used to time cleanup of a large path
+static std::vector<Vector3f> long_path;
+
 void setup();
 void loop();
 void reset();
 void check_path(const std::vector<Vector3f> &correct_path, const char* test_name, uint32_t time_us);
+void make_long_path();
+void long_path_test();
+void long_segment_test();
 
 void setup()
 {
     hal.console->printf("SmartRTL test\n");
     board_config.init();
     smart_rtl.init();
+
+    // use the largest path supported
+    AP_Param::set_object_value(&smart_rtl_long, AP_SmartRTL::var_info, "POINTS", SMARTRTL_POINTS_MAX);
+    smart_rtl_long.init();
+    make_long_path();
 }
 
 void loop()
@@ -76,6 +88,14 @@ void loop()
     run_time = AP_HAL::micros() - reference_time;
     check_path(test_path_complete, "simplify and pruning", run_time);
 
+    // time cleanup of a long path
+    hal.scheduler->delay(5);
+    long_path_test();
+
+    // time cleanup of a full path ending in long segments
+    hal.scheduler->delay(5);
+    long_segment_test();
+
     // delay before next display
     hal.scheduler->delay(5e3); // 5 seconds
 }
@@ -89,6 +109,118 @@ void reset()
     }
 }
 
+/*
+  survey pattern of parallel passes with an orbit every few passes and a
+  return leg back across the passes, so there are many segments which
+  are close to each other.  Points are 3m apart which is just over the
+  default accuracy
+ */
+void make_long_path()
+{
+    const uint16_t num_passes = SMARTRTL_POINTS_MAX / 80;
+    Vector3f pos;
+    for (uint16_t pass = 0; pass < num_passes; pass++) {
+        // pass along the x axis with some wander
+        for (uint16_t i = 0; i < 60; i++) {
+            pos.x += (pass & 1) ? -3.0f : 3.0f;
+            pos.y += 0.3f * sinf(i * 0.7f);
+            pos.z = -20.0f - 2.0f * sinf(i * 0.1f);
+            long_path.push_back(pos);
+        }
+        // step across to the next pass
+        for (uint8_t i = 0; i < 4; i++) {
+            pos.y += 3.0f;
+            long_path.push_back(pos);
+        }
+        // orbit
+        if (pass % 5 == 4) {
+            for (uint8_t i = 0; i < 30; i++) {
+                const float angle = i * 0.21f;
+                long_path.push_back(pos + Vector3f{8.0f * sinf(angle), 8.0f * (1.0f - cosf(angle)), 0.0f});
+            }
+        }
+    }
+    // return diagonally across the survey
+    const Vector3f end = pos;
+    for (uint16_t i = 0; i < 150; i++) {
+        pos = end * (1.0f - i / 150.0f);
+        pos.x += 5.0f * sinf(i * 0.3f);
+        long_path.push_back(pos);
+    }
+}
+
+// add long path to smart_rtl_long running the routine cleanup after each point as the IO thread would, then run a thorough cleanup
+void long_path_test()
+{
+    smart_rtl_long.set_home(true, Vector3f{0.0f, 0.0f, 0.0f});
+
+    uint32_t routine_max_us = 0;
+    uint32_t routine_total_us = 0;
+    for (const Vector3f &v : long_path) {
+        smart_rtl_long.update(true, v);
+        const uint32_t reference_time = AP_HAL::micros();
+        smart_rtl_long.run_background_cleanup();
+        const uint32_t run_time = AP_HAL::micros() - reference_time;
+        routine_max_us = MAX(routine_max_us, run_time);
+        routine_total_us += run_time;
+    }
+    const uint16_t points_before_thorough = smart_rtl_long.get_num_points();
+
+    const uint32_t reference_time = AP_HAL::micros();
+    while (!smart_rtl_long.request_thorough_cleanup(AP_SmartRTL::THOROUGH_CLEAN_ALL)) {
+        smart_rtl_long.run_background_cleanup();
+    }
+    const uint32_t thorough_us = AP_HAL::micros() - reference_time;
+
+    hal.console->printf("long path: %u points added\n", (unsigned)long_path.size());
+    hal.console->printf("   routine cleanup max:%u us total:%u us, %u points remain\n",
+                        (unsigned)routine_max_us, (unsigned)routine_total_us, (unsigned)points_before_thorough);
+    hal.console->printf("   thorough cleanup time:%u us, %u points remain\n",
+                        (unsigned)thorough_us, (unsigned)smart_rtl_long.get_num_points());
+}
+
+/*
+  fill the path with a zigzag which simplification keeps, its amplitude
+  growing slowly so that the farthest point is always near the end.
+  Then fly a long straight segment away from it and another back across
+  its middle.  The long segments cover too many grid cells to be
+  searched in the grid, and the later part of the zigzag does not fit
+  in the grid, so the loop search falls back to checking segments in
+  order.  That must still stop at the time limit, and the loop back
+  across the middle must be found
+ */
+void long_segment_test()
+{
+    smart_rtl_long.set_home(true, Vector3f{0.0f, 0.0f, 0.0f});
+
+    Vector3f pos;
+    for (uint16_t i = 1; i < SMARTRTL_POINTS_MAX - 10; i++) {
+        const float amplitude = 1.5f + 0.0001f * i;
+        pos = Vector3f{3.0f * i, (i & 1) ? amplitude : -amplitude, -20.0f};
+        smart_rtl_long.update(true, pos);
+    }
+    smart_rtl_long.update(true, Vector3f{pos.x, 600.0f, -20.0f});
+    smart_rtl_long.update(true, Vector3f{pos.x * 0.5f + 0.7f, 0.3f, -20.0f});
+    smart_rtl_long.update(true, Vector3f{pos.x * 0.5f + 0.7f, -50.0f, -20.0f});
+    const uint16_t points_added = smart_rtl_long.get_num_points();
+
+    uint32_t cleanup_max_us = 0;
+    const uint32_t start_time = AP_HAL::micros();
+    while (!smart_rtl_long.request_thorough_cleanup(AP_SmartRTL::THOROUGH_CLEAN_ALL)) {
+        const uint32_t reference_time = AP_HAL::micros();
+        smart_rtl_long.run_background_cleanup();
+        cleanup_max_us = MAX(cleanup_max_us, AP_HAL::micros() - reference_time);
+    }
+    const uint32_t thorough_us = AP_HAL::micros() - start_time;
+
+    // the loop removes the second half of the zigzag
+    const bool success = smart_rtl_long.get_num_points() <= points_added / 2 + 5;
+    hal.console->printf("long segment: %s time:%u us\n", success ? "success" : "fail", (unsigned)thorough_us);
+    hal.console->printf("   cleanup max:%u us (limit %u us), %u of %u points remain\n",
+                        (unsigned)cleanup_max_us, (unsigned)SMARTRTL_PRUNING_LOOP_TIME_US,
+                        (unsigned)smart_rtl_long.get_num_points(), (unsigned)points_added);
+}
+
 // compare the vector array passed in with the path held in the smart_rtl object
 void check_path(const std::vector<Vector3f>& correct_path, const char* test_name, uint32_t time_us)
 {
@@ -33,6 +33,7 @@
 #include "MissionItemProtocol_Rally.h"
 #include "MissionItemProtocol_Fence.h"
 #include "ap_message.h"
+#include "MAVLink_FairQueue.h"
 
 #define GCS_DEBUG_SEND_MESSAGE_TIMINGS 0
 
@@ -692,6 +693,14 @@ private:
     void find_next_bucket_to_send(uint16_t now16_ms);
     void remove_message_from_bucket(int8_t bucket, ap_message id);
 
+#if HAL_MAVLINK_FAIR_QUEUING_ENABLED
+    // with OPTION_MAVLINK_FAIR_QUEUE on the port the messages of all
+    // due buckets are queued here and sent in weighted fair order
+    // within a byte budget, rather than a bucket at a time
+    MAVLink_FairQueue stream_queue;
+    void queue_due_buckets(uint16_t now16_ms);
+#endif
+
     // bitmask of IDs the code has spontaneously decided it wants to
     // send out.  Examples include HEARTBEAT (gcs_send_heartbeat)
     Bitmask<MSG_LAST> pushed_ap_message_ids;
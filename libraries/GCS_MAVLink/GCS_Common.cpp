@@ -1148,6 +1148,16 @@ void GCS_MAVLINK::update_send()
 
     const uint32_t start = AP_HAL::millis();
     const uint16_t start16 = start & 0xFFFF;
+#if HAL_MAVLINK_FAIR_QUEUING_ENABLED
+    const bool fair_queuing = (_port->get_options() & AP_HAL::UARTDriver::OPTION_MAVLINK_FAIR_QUEUE) != 0;
+    if (fair_queuing) {
+        if (!_port->tx_pending()) {
+            stream_queue.drained();
+        }
+        stream_queue.update(start, mavlink_comm_tx_bytes[chan], _port->bw_in_kilobytes_per_second() * 1024);
+        queue_due_buckets(start16);
+    }
+#endif
     while (AP_HAL::millis() - start < 5) { // spend a max of 5ms sending messages.  This should never trigger - out_of_time() should become true
         if (gcs().out_of_time()) {
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
@@ -1208,6 +1218,32 @@ void GCS_MAVLINK::update_send()
             continue;
         }
 
+#if HAL_MAVLINK_FAIR_QUEUING_ENABLED
+        if (fair_queuing) {
+            const ap_message next = stream_queue.next();
+            if (next == MSG_LAST) {
+                break;
+            }
+            const uint32_t tx_bytes = mavlink_comm_tx_bytes[chan];
+            if (!do_try_send_message(next)) {
+                if (!telemetry_delayed()) {
+                    stream_queue.blocked();
+                }
+                break;
+            }
+            stream_queue.sent(next, mavlink_comm_tx_bytes[chan] - tx_bytes);
+#if GCS_DEBUG_SEND_MESSAGE_TIMINGS
+            const uint32_t stop = AP_HAL::micros();
+            const uint32_t delta = stop - retry_deferred_body_start;
+            if (delta > try_send_message_stats.max_retry_deferred_body_us) {
+                try_send_message_stats.max_retry_deferred_body_us = delta;
+                try_send_message_stats.max_retry_deferred_body_type = 3;
+            }
+#endif
+            continue;
+        }
+#endif  // HAL_MAVLINK_FAIR_QUEUING_ENABLED
+
         ap_message next = next_deferred_bucket_message_to_send(start16);
         if (next != no_message_to_send) {
             if (!do_try_send_message(next)) {
@@ -1257,8 +1293,39 @@ void GCS_MAVLINK::update_send()
     }
 }
 
+#if HAL_MAVLINK_FAIR_QUEUING_ENABLED
+// queue the messages of each bucket which is due to be sent.  A
+// message still queued from the bucket's last interval is not queued
+// twice, so on a saturated link the rates of the low weight messages
+// drop rather than the whole bucket being held back
+void GCS_MAVLINK::queue_due_buckets(uint16_t now16_ms)
+{
+    for (uint8_t i=0; i<ARRAY_SIZE(deferred_message_bucket); i++) {
+        deferred_message_bucket_t &bucket = deferred_message_bucket[i];
+        if (bucket.ap_message_ids.empty()) {
+            continue;
+        }
+        const uint16_t interval_ms = get_reschedule_interval_ms(bucket);
+        if (uint16_t(now16_ms - bucket.last_sent_ms) < interval_ms) {
+            continue;
+        }
+        stream_queue.release(bucket.ap_message_ids);
+        // we try to keep output on a regular clock to avoid
+        // user support questions:
+        bucket.last_sent_ms += interval_ms;
+        // but we do not want to try to catch up too much:
+        if (uint16_t(now16_ms - bucket.last_sent_ms) > interval_ms) {
+            bucket.last_sent_ms = now16_ms;
+        }
+    }
+}
+#endif
+
 void GCS_MAVLINK::remove_message_from_bucket(int8_t bucket, ap_message id)
 {
+#if HAL_MAVLINK_FAIR_QUEUING_ENABLED
+    stream_queue.remove(id);
+#endif
     deferred_message_bucket[bucket].ap_message_ids.clear(id);
     if (deferred_message_bucket[bucket].ap_message_ids.count() == 0) {
         // bucket empty.  Free it:
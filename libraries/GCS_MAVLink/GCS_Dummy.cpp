@@ -5,7 +5,9 @@
 #include <AP_Common/AP_FWVersionDefine.h>
 #undef FORCE_VERSION_H_INCLUDE
 
-const struct GCS_MAVLINK::stream_entries GCS_MAVLINK::all_stream_entries[] {};
+const struct GCS_MAVLINK::stream_entries GCS_MAVLINK::all_stream_entries[] {
+    MAV_STREAM_TERMINATOR // must have this at end of stream_entries
+};
 
 /*
   send_text implementation for dummy GCS
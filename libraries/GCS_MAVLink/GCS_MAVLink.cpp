@@ -38,6 +38,7 @@ extern const AP_HAL::HAL& hal;
 
 AP_HAL::UARTDriver	*mavlink_comm_port[MAVLINK_COMM_NUM_BUFFERS];
 bool gcs_alternative_active[MAVLINK_COMM_NUM_BUFFERS];
+uint32_t mavlink_comm_tx_bytes[MAVLINK_COMM_NUM_BUFFERS];
 
 // per-channel lock
 static HAL_Semaphore chan_locks[MAVLINK_COMM_NUM_BUFFERS];
@@ -88,7 +89,7 @@ uint16_t comm_get_txspace(mavlink_channel_t chan)
 /*
   send a buffer out a MAVLink channel
  */
-void comm_send_buffer(mavlink_channel_t chan, const uint8_t *buf, uint8_t len)
+void comm_send_buffer(mavlink_channel_t chan, const uint8_t *buf, uint16_t len)
 {
     if (!valid_channel(chan) || mavlink_comm_port[chan] == nullptr) {
         return;
@@ -98,6 +99,7 @@ void comm_send_buffer(mavlink_channel_t chan, const uint8_t *buf, uint8_t len)
         return;
     }
     const size_t written = mavlink_comm_port[chan]->write(buf, len);
+    mavlink_comm_tx_bytes[chan] += written;
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
     if (written < len) {
         AP_HAL::panic("Short write on UART: %lu < %u", (unsigned long)written, len);
@@ -43,6 +43,8 @@
 /// MAVLink stream used for uartA
 extern AP_HAL::UARTDriver	*mavlink_comm_port[MAVLINK_COMM_NUM_BUFFERS];
 extern bool gcs_alternative_active[MAVLINK_COMM_NUM_BUFFERS];
+/// running count of bytes written to each channel
+extern uint32_t mavlink_comm_tx_bytes[MAVLINK_COMM_NUM_BUFFERS];
 
 /// MAVLink system definition
 extern mavlink_system_t mavlink_system;
@@ -58,7 +60,7 @@ static inline bool valid_channel(mavlink_channel_t chan)
 #pragma clang diagnostic pop
 }
 
-void comm_send_buffer(mavlink_channel_t chan, const uint8_t *buf, uint8_t len);
+void comm_send_buffer(mavlink_channel_t chan, const uint8_t *buf, uint16_t len);
 
 /// Check for available transmit space on the nominated MAVLink channel
 ///
@@ -0,0 +1,204 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// @file	MAVLink_FairQueue.cpp
+/// @brief	weighted fair queuing of streamed messages on a MAVLink link
+
+#include "MAVLink_FairQueue.h"
+
+#if HAL_MAVLINK_FAIR_QUEUING_ENABLED
+
+#include <AP_Math/AP_Math.h>
+
+// the link rate is never estimated lower than this, so a link which
+// was blocked while almost idle still gets the important messages out
+#define FAIR_QUEUE_MIN_LINK_RATE 100U
+#define FAIR_QUEUE_MAX_LINK_RATE 1000000U
+
+// the budget holds at most 100ms of the link rate, and at least a
+// maximum size MAVLink2 packet
+#define FAIR_QUEUE_MIN_BURST 300
+
+static uint32_t constrain_link_rate(uint32_t bytes_per_second)
+{
+    return MIN(MAX(bytes_per_second, FAIR_QUEUE_MIN_LINK_RATE), FAIR_QUEUE_MAX_LINK_RATE);
+}
+
+MAVLink_FairQueue::Weight MAVLink_FairQueue::message_weight(ap_message id)
+{
+    switch (id) {
+    // what a GCS needs to fly the vehicle
+    case MSG_HEARTBEAT:
+    case MSG_ATTITUDE:
+    case MSG_ATTITUDE_QUATERNION:
+    case MSG_LOCATION:
+    case MSG_SYS_STATUS:
+    case MSG_VFR_HUD:
+    case MSG_GPS_RAW:
+    case MSG_EKF_STATUS_REPORT:
+    case MSG_EXTENDED_SYS_STATE:
+        return Weight::HIGH;
+
+    // raw data and diagnostics which are only useful at a high rate
+    case MSG_RAW_IMU:
+    case MSG_SCALED_IMU:
+    case MSG_SCALED_IMU2:
+    case MSG_SCALED_IMU3:
+    case MSG_SCALED_PRESSURE:
+    case MSG_SCALED_PRESSURE2:
+    case MSG_SCALED_PRESSURE3:
+    case MSG_SERVO_OUTPUT_RAW:
+    case MSG_RC_CHANNELS:
+    case MSG_RC_CHANNELS_RAW:
+    case MSG_GPS_RTK:
+    case MSG_GPS2_RTK:
+    case MSG_MEMINFO:
+    case MSG_MCU_STATUS:
+    case MSG_AHRS:
+    case MSG_AHRS2:
+    case MSG_SIMSTATE:
+    case MSG_SIM_STATE:
+    case MSG_PID_TUNING:
+    case MSG_ESC_TELEMETRY:
+    case MSG_NAMED_FLOAT:
+    case MSG_ADSB_VEHICLE:
+    case MSG_AIS_VESSEL:
+        return Weight::BULK;
+
+    default:
+        return Weight::NORMAL;
+    }
+}
+
+void MAVLink_FairQueue::release(const Bitmask<MSG_LAST> &ids)
+{
+    Bitmask<MSG_LAST> todo;
+    todo = ids;
+    for (int16_t id = todo.first_set(); id != -1; id = todo.first_set()) {
+        todo.clear(id);
+        if (pending.get(id)) {
+            // not sent since it was last due, it is only sent once
+            continue;
+        }
+        // an id which has been idle starts at the current virtual
+        // time rather than with credit for the time it was idle
+        if (int32_t(tag[id] - virtual_time) < 0) {
+            tag[id] = virtual_time;
+        }
+        pending.set(id);
+    }
+}
+
+ap_message MAVLink_FairQueue::next()
+{
+    if (pending.empty()) {
+        return MSG_LAST;
+    }
+    if (budget <= 0) {
+        window.budget_limited = true;
+        return MSG_LAST;
+    }
+
+    // smallest start tag, ties go to the higher weight
+    ap_message best = MSG_LAST;
+    Bitmask<MSG_LAST> todo;
+    todo = pending;
+    for (int16_t id = todo.first_set(); id != -1; id = todo.first_set()) {
+        todo.clear(id);
+        if (best == MSG_LAST) {
+            best = (ap_message)id;
+            continue;
+        }
+        const int32_t diff = int32_t(tag[id] - tag[best]);
+        if (diff < 0 ||
+            (diff == 0 && message_weight((ap_message)id) > message_weight(best))) {
+            best = (ap_message)id;
+        }
+    }
+    return best;
+}
+
+void MAVLink_FairQueue::sent(ap_message id, uint16_t nbytes)
+{
+    pending.clear(id);
+
+    // the finish tag advances by the bytes scaled by the inverse of
+    // the weight, in units of bytes at the highest weight
+    virtual_time = tag[id];
+    tag[id] += uint32_t(nbytes) * (uint8_t(Weight::HIGH) / uint8_t(message_weight(id)));
+
+    budget -= nbytes;
+    last_tx_bytes += nbytes;
+    window.bytes += nbytes;
+}
+
+void MAVLink_FairQueue::update(uint32_t now_ms, uint32_t tx_bytes, uint32_t port_bytes_per_second)
+{
+    if (link_bytes_per_second == 0) {
+        link_bytes_per_second = constrain_link_rate(port_bytes_per_second);
+        window.start_ms = now_ms;
+        last_update_ms = now_ms;
+        last_tx_bytes = tx_bytes;
+    }
+
+    // charge everything else written to the port since the last update
+    const uint32_t other_bytes = tx_bytes - last_tx_bytes;
+    last_tx_bytes = tx_bytes;
+    budget -= other_bytes;
+    window.bytes += other_bytes;
+
+    const uint32_t dt_ms = MIN(now_ms - last_update_ms, 1000U);
+    last_update_ms = now_ms;
+    const int32_t burst = MAX(int32_t(link_bytes_per_second / 10), FAIR_QUEUE_MIN_BURST);
+    budget = constrain_int32(budget + int32_t(link_bytes_per_second * dt_ms / 1000U), -burst, burst);
+
+    const uint32_t window_ms = now_ms - window.start_ms;
+    if (window_ms < 1000) {
+        return;
+    }
+    measured_bytes_per_second = uint64_t(window.bytes) * 1000U / window_ms;
+    if (window.blocked) {
+        // the port buffer filled, so the link carried about what was
+        // measured. Budget a little under that so the buffer drains.
+        // A port which blocked with hardly anything written to it,
+        // e.g. a USB port nobody is reading, says nothing about the
+        // link rate
+        if (window.bytes >= FAIR_QUEUE_MIN_BURST) {
+            link_bytes_per_second = measured_bytes_per_second - measured_bytes_per_second / 8;
+        }
+    } else if (window.drained) {
+        // the port sent everything it was given, whatever limited
+        // the link has gone, so start again from the port bandwidth
+        link_bytes_per_second = MAX(port_bytes_per_second, measured_bytes_per_second);
+    } else {
+        if (window.budget_limited) {
+            // messages waited on the budget but the port kept up,
+            // probe for more of the link
+            link_bytes_per_second += link_bytes_per_second / 8;
+        }
+        // the port has carried this much, e.g. a USB port faster than
+        // its nominal bandwidth
+        link_bytes_per_second = MAX(link_bytes_per_second, measured_bytes_per_second);
+    }
+    link_bytes_per_second = constrain_link_rate(link_bytes_per_second);
+
+    window.start_ms = now_ms;
+    window.bytes = 0;
+    window.blocked = false;
+    window.drained = false;
+    window.budget_limited = false;
+}
+
+#endif  // HAL_MAVLINK_FAIR_QUEUING_ENABLED
@@ -0,0 +1,98 @@
+/// @file	MAVLink_FairQueue.h
+/// @brief	weighted fair queuing of streamed messages on a MAVLink link
+#pragma once
+
+#include <AP_HAL/AP_HAL_Boards.h>
+#include <AP_Common/Bitmask.h>
+#include "ap_message.h"
+
+// built on boards with room for it, and used on the links whose port
+// has OPTION_MAVLINK_FAIR_QUEUE set (SERIALn_OPTIONS bit 13)
+#ifndef HAL_MAVLINK_FAIR_QUEUING_ENABLED
+#define HAL_MAVLINK_FAIR_QUEUING_ENABLED (BOARD_FLASH_SIZE > 1024)
+#endif
+
+/*
+  object to choose which of the due stream messages on a link to send
+  next.
+
+  Messages are released into the queue when their stream bucket is
+  due and are sent in start-time fair queuing order: each message id
+  is a flow whose virtual finish tag advances by the bytes it sent
+  divided by its weight, so when the link is saturated important
+  messages get a larger share of it rather than waiting behind bulky
+  ones. A message which is released again before it was sent is sent
+  only once, which is how the rate of the low weight streams drops
+  on a slow link.
+
+  Stream messages are also limited to a byte budget refilled at the
+  estimated link rate, so that the queueing happens here where the
+  weights apply rather than in the UART buffer. The link rate starts
+  at the port bandwidth and follows the measured throughput when the
+  port buffer fills, going back to the port bandwidth once the port
+  has drained.
+ */
+class MAVLink_FairQueue
+{
+public:
+    // relative share of a saturated link each message gets
+    enum class Weight : uint8_t {
+        BULK   = 1,
+        NORMAL = 2,
+        HIGH   = 4,
+    };
+    static Weight message_weight(ap_message id);
+
+    // queue messages which have become due
+    void release(const Bitmask<MSG_LAST> &ids);
+    // drop a message from the queue, e.g. when its stream is stopped
+    void remove(ap_message id) { pending.clear(id); }
+    bool empty() const { return pending.empty(); }
+
+    // next message to send, or MSG_LAST if the queue is empty or the
+    // byte budget is used up
+    ap_message next();
+
+    // record that id was sent using nbytes of the link
+    void sent(ap_message id, uint16_t nbytes);
+
+    // record that the port ran out of buffer space
+    void blocked() { window.blocked = true; }
+    // record that the port had sent everything written to it
+    void drained() { window.drained = true; }
+
+    /*
+      refill the byte budget. tx_bytes is the running count of bytes
+      written to the port (see mavlink_comm_tx_bytes), so everything
+      sent on the link is charged to the budget, not only the stream
+      messages. port_bytes_per_second is the most the port can carry
+     */
+    void update(uint32_t now_ms, uint32_t tx_bytes, uint32_t port_bytes_per_second);
+
+    // measured bytes per second over the last second
+    uint32_t throughput() const { return measured_bytes_per_second; }
+    // link rate the budget is refilled at
+    uint32_t link_rate() const { return link_bytes_per_second; }
+
+private:
+    Bitmask<MSG_LAST> pending;
+
+    // virtual time, the start tag of the last message sent
+    uint32_t virtual_time;
+    // start tag of each pending message, finish tag of the others
+    uint32_t tag[MSG_LAST];
+
+    int32_t budget;
+    uint32_t last_tx_bytes;
+    uint32_t last_update_ms;
+    uint32_t link_bytes_per_second;
+    uint32_t measured_bytes_per_second;
+
+    struct {
+        uint32_t start_ms;
+        uint32_t bytes;
+        bool blocked;         // port buffer was full
+        bool drained;         // port buffer was empty
+        bool budget_limited;  // messages waited for budget
+    } window;
+};
@@ -143,6 +143,8 @@ bool MAVLink_routing::check_and_forward(mavlink_channel_t in_channel, const mavl
     bool forwarded = false;
     bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS];
     memset(sent_to_chan, 0, sizeof(sent_to_chan));
+    uint16_t forward_mask = 0;
+    const uint16_t msg_frame_length = frame_length(msg);
     for (uint8_t i=0; i<num_routes; i++) {
 
         // Skip if channel is private and the target system or component IDs do not match
@@ -159,8 +161,7 @@ bool MAVLink_routing::check_and_forward(mavlink_channel_t in_channel, const mavl
 
             if (in_channel != routes[i].channel && !sent_to_chan[routes[i].channel]) {
                 
-                if (comm_get_txspace(routes[i].channel) >= ((uint16_t)msg.len) +
-                    GCS_MAVLINK::packet_overhead_chan(routes[i].channel)) {
+                if (comm_get_txspace(routes[i].channel) >= msg_frame_length) {
 #if ROUTING_DEBUG
                     ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
                              msg.msgid,
@@ -169,7 +170,7 @@ bool MAVLink_routing::check_and_forward(mavlink_channel_t in_channel, const mavl
                              (int)target_system,
                              (int)target_component);
 #endif
-                    _mavlink_resend_uart(routes[i].channel, &msg);
+                    forward_mask |= 1U<<((unsigned)(routes[i].channel-MAVLINK_COMM_0));
                 }
                 sent_to_chan[routes[i].channel] = true;
                 forwarded = true;
@@ -177,6 +178,10 @@ bool MAVLink_routing::check_and_forward(mavlink_channel_t in_channel, const mavl
         }
     }
 
+    if (forward_mask != 0) {
+        forward_to_channels(msg, forward_mask);
+    }
+
     if ((!forwarded && match_system) ||
         broadcast_system) {
         process_locally = true;
@@ -339,21 +344,82 @@ void MAVLink_routing::handle_heartbeat(mavlink_channel_t in_channel, const mavli
         return;
     }
 
-    // send on the remaining channels
+    // send on the remaining channels which have space
+    const uint16_t msg_frame_length = frame_length(msg);
     for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
         if (mask & (1U<<i)) {
             mavlink_channel_t channel = (mavlink_channel_t)(MAVLINK_COMM_0 + i);
-            if (comm_get_txspace(channel) >= ((uint16_t)msg.len) +
-                GCS_MAVLINK::packet_overhead_chan(channel)) {
+            if (comm_get_txspace(channel) < msg_frame_length) {
+                mask &= ~(1U<<i);
+                continue;
+            }
 #if ROUTING_DEBUG
-                ::printf("fwd HB from chan %u on chan %u from sysid=%u compid=%u\n",
-                         (unsigned)in_channel,
-                         (unsigned)channel,
-                         (unsigned)msg.sysid,
-                         (unsigned)msg.compid);
+            ::printf("fwd HB from chan %u on chan %u from sysid=%u compid=%u\n",
+                     (unsigned)in_channel,
+                     (unsigned)channel,
+                     (unsigned)msg.sysid,
+                     (unsigned)msg.compid);
 #endif
-                _mavlink_resend_uart(channel, &msg);
-            }
+        }
+    }
+    if (mask != 0) {
+        forward_to_channels(msg, mask);
+    }
+}
+
+uint16_t MAVLink_routing::frame_length(const mavlink_message_t &msg)
+{
+    if (msg.magic == MAVLINK_STX_MAVLINK1) {
+        return MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 + msg.len + MAVLINK_NUM_CHECKSUM_BYTES;
+    }
+    const uint8_t signature_len = (msg.incompat_flags & MAVLINK_IFLAG_SIGNED) ? MAVLINK_SIGNATURE_BLOCK_LEN : 0;
+    return MAVLINK_CORE_HEADER_LEN + 1 + msg.len + MAVLINK_NUM_CHECKSUM_BYTES + signature_len;
+}
+
+/*
+  forwarding does not change a message, so rather than resending it
+  piecewise on each channel as _mavlink_resend_uart() does, the frame
+  is put back together once and each channel gets a single write
+*/
+void MAVLink_routing::forward_to_channels(const mavlink_message_t &msg, uint16_t chan_mask)
+{
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+    uint8_t *p = buf;
+    *p++ = msg.magic;
+    *p++ = msg.len;
+    uint8_t signature_len = 0;
+    if (msg.magic == MAVLINK_STX_MAVLINK1) {
+        *p++ = msg.seq;
+        *p++ = msg.sysid;
+        *p++ = msg.compid;
+        *p++ = msg.msgid & 0xFF;
+    } else {
+        *p++ = msg.incompat_flags;
+        *p++ = msg.compat_flags;
+        *p++ = msg.seq;
+        *p++ = msg.sysid;
+        *p++ = msg.compid;
+        *p++ = msg.msgid & 0xFF;
+        *p++ = (msg.msgid >> 8) & 0xFF;
+        *p++ = (msg.msgid >> 16) & 0xFF;
+        if (msg.incompat_flags & MAVLINK_IFLAG_SIGNED) {
+            signature_len = MAVLINK_SIGNATURE_BLOCK_LEN;
+        }
+    }
+    memcpy(p, _MAV_PAYLOAD(&msg), msg.len);
+    p += msg.len;
+    *p++ = msg.checksum & 0xFF;
+    *p++ = msg.checksum >> 8;
+    memcpy(p, msg.signature, signature_len);
+    p += signature_len;
+    const uint16_t len = p - buf;
+
+    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        if (chan_mask & (1U<<i)) {
+            const mavlink_channel_t channel = (mavlink_channel_t)(MAVLINK_COMM_0 + i);
+            comm_send_lock(channel);
+            comm_send_buffer(channel, buf, len);
+            comm_send_unlock(channel);
         }
     }
 }
@@ -44,6 +44,17 @@ public:
      */
     bool find_by_mavtype(uint8_t mavtype, uint8_t &sysid, uint8_t &compid, mavlink_channel_t &channel);
 
+    /*
+      send a received message on each channel in chan_mask exactly as
+      it was framed on the wire, including its checksum and any
+      signature. The frame is built once and written to each channel
+      in a single write
+    */
+    static void forward_to_channels(const mavlink_message_t &msg, uint16_t chan_mask);
+
+    // length of the message on the wire
+    static uint16_t frame_length(const mavlink_message_t &msg);
+
 private:
     // a simple linear routing table. We don't expect to have a lot of
     // routes, so a scalable structure isn't worthwhile yet.
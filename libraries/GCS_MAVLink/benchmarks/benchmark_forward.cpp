@@ -0,0 +1,102 @@
+#include <AP_gbenchmark.h>
+
+#include <GCS_MAVLink/GCS_Dummy.h>
+#include <GCS_MAVLink/MAVLink_routing.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+const struct AP_Param::GroupInfo        GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+GCS_Dummy _gcs;
+
+/*
+  messages forwarded per second from one channel to four others, as
+  a companion computer relaying camera and gimbal traffic does. The
+  channels are UARTs which only count what is written to them
+ */
+class CountingUart : public AP_HAL::UARTDriver
+{
+public:
+    void begin(uint32_t baud) override {}
+    void begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace) override {}
+    void end() override {}
+    void flush() override {}
+    bool is_initialized() override { return true; }
+    void set_blocking_writes(bool blocking) override {}
+    bool tx_pending() override { return false; }
+    uint32_t available() override { return 0; }
+    uint32_t txspace() override { return 4096; }
+    bool discard_input() override { return true; }
+    int16_t read() override { return -1; }
+
+    size_t write(uint8_t c) override {
+        bytes++;
+        return 1;
+    }
+    size_t write(const uint8_t *buffer, size_t size) override {
+        bytes += size;
+        return size;
+    }
+
+    uint32_t bytes;
+};
+
+static const uint8_t num_out_channels = 4;
+static CountingUart uarts[num_out_channels + 1];
+
+static void setup_channels()
+{
+    for (uint8_t i=0; i<ARRAY_SIZE(uarts); i++) {
+        mavlink_comm_port[i] = &uarts[i];
+    }
+}
+
+// range_x 0 is a 28 byte ATTITUDE, 1 is a full FILE_TRANSFER_PROTOCOL
+static void make_message(mavlink_message_t &msg, int index)
+{
+    if (index == 0) {
+        mavlink_msg_attitude_pack(2, MAV_COMP_ID_ONBOARD_COMPUTER, &msg,
+                                  123456, 0.1f, -0.2f, 1.5f, 0.01f, 0.02f, -0.03f);
+    } else {
+        uint8_t payload[251];
+        for (uint8_t i=0; i<sizeof(payload); i++) {
+            payload[i] = i + 1;
+        }
+        mavlink_msg_file_transfer_protocol_pack(2, MAV_COMP_ID_CAMERA, &msg,
+                                                0, 1, 1, payload);
+    }
+}
+
+// the per-channel resend forwarding used before
+static void BM_MAVLinkResend(benchmark::State& state)
+{
+    setup_channels();
+    mavlink_message_t msg;
+    make_message(msg, state.range_x());
+    while (state.KeepRunning()) {
+        for (uint8_t i=1; i<=num_out_channels; i++) {
+            _mavlink_resend_uart((mavlink_channel_t)(MAVLINK_COMM_0 + i), &msg);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(int64_t(state.iterations()) * num_out_channels * MAVLink_routing::frame_length(msg));
+}
+
+static void BM_MAVLinkForward(benchmark::State& state)
+{
+    setup_channels();
+    mavlink_message_t msg;
+    make_message(msg, state.range_x());
+    const uint16_t chan_mask = ((1U<<num_out_channels)-1) << 1;
+    while (state.KeepRunning()) {
+        MAVLink_routing::forward_to_channels(msg, chan_mask);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(int64_t(state.iterations()) * num_out_channels * MAVLink_routing::frame_length(msg));
+}
+
+BENCHMARK(BM_MAVLinkResend)->Arg(0)->Arg(1);
+BENCHMARK(BM_MAVLinkForward)->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();
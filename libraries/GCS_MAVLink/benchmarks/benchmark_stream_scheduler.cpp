@@ -0,0 +1,267 @@
+#include <AP_gbenchmark.h>
+
+#include <GCS_MAVLink/GCS_Dummy.h>
+#include <AP_Logger/AP_Logger.h>
+#include <AP_Scheduler/AP_Scheduler.h>
+
+#include <stdio.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+const struct AP_Param::GroupInfo        GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+
+/*
+  stream scheduling on a telemetry radio slower than its UART. The
+  radio takes bytes from a 1024 byte port buffer at the link rate,
+  the autopilot only sees the buffer filling. Ten seconds of streams
+  at typical SRn rates are sent by GCS_MAVLINK::update_send() with
+  and without OPTION_MAVLINK_FAIR_QUEUE on the port, and the rate
+  each message achieved is compared with the rate requested. Only
+  the message contents are faked, the scheduling is the real one
+ */
+struct StreamRate {
+    uint32_t mavlink_id;
+    ap_message id;
+    const char *name;
+    uint8_t rate_hz;
+    uint8_t bytes;      // MAVLink2 packet size
+};
+
+static const StreamRate streams[] {
+    { MAVLINK_MSG_ID_ATTITUDE,              MSG_ATTITUDE,              "ATTITUDE",              10, 40 },
+    { MAVLINK_MSG_ID_SYS_STATUS,            MSG_SYS_STATUS,            "SYS_STATUS",             2, 55 },
+    { MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT, MSG_NAV_CONTROLLER_OUTPUT, "NAV_CONTROLLER_OUTPUT",  4, 38 },
+    { MAVLINK_MSG_ID_GLOBAL_POSITION_INT,   MSG_LOCATION,              "GLOBAL_POSITION_INT",    5, 40 },
+    { MAVLINK_MSG_ID_VFR_HUD,               MSG_VFR_HUD,               "VFR_HUD",                4, 32 },
+    { MAVLINK_MSG_ID_SERVO_OUTPUT_RAW,      MSG_SERVO_OUTPUT_RAW,      "SERVO_OUTPUT_RAW",      10, 49 },
+    { MAVLINK_MSG_ID_RC_CHANNELS,           MSG_RC_CHANNELS,           "RC_CHANNELS",           10, 54 },
+    { MAVLINK_MSG_ID_RAW_IMU,               MSG_RAW_IMU,               "RAW_IMU",               10, 41 },
+    { MAVLINK_MSG_ID_GPS_RAW_INT,           MSG_GPS_RAW,               "GPS_RAW_INT",            2, 64 },
+    { MAVLINK_MSG_ID_AHRS2,                 MSG_AHRS2,                 "AHRS2",                 10, 36 },
+    { MAVLINK_MSG_ID_EKF_STATUS_REPORT,     MSG_EKF_STATUS_REPORT,     "EKF_STATUS_REPORT",      2, 38 },
+    { MAVLINK_MSG_ID_PID_TUNING,            MSG_PID_TUNING,            "PID_TUNING",            10, 37 },
+    { MAVLINK_MSG_ID_BATTERY_STATUS,        MSG_BATTERY_STATUS,        "BATTERY_STATUS",         2, 66 },
+    { MAVLINK_MSG_ID_ESC_TELEMETRY_1_TO_4,  MSG_ESC_TELEMETRY,         "ESC_TELEMETRY_1_TO_4",  10, 56 },
+};
+
+static const uint32_t port_buffer_size = 1024;
+static const uint32_t update_period_us = 2500;
+static const uint32_t sim_seconds = 10;
+
+/*
+  the UART to the radio. Nothing reads the UART, the radio drains it
+  at the link rate as time passes
+ */
+class RadioUart : public AP_HAL::UARTDriver
+{
+public:
+    RadioUart(uint32_t bytes_per_second) : _bytes_per_second(bytes_per_second) {}
+
+    void begin(uint32_t baud) override {}
+    void begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace) override {}
+    void end() override {}
+    void flush() override {}
+    bool is_initialized() override { return true; }
+    void set_blocking_writes(bool blocking) override {}
+    bool tx_pending() override { return _queued != 0; }
+    uint32_t available() override { return 0; }
+    uint32_t txspace() override { return port_buffer_size - _queued; }
+    bool discard_input() override { return true; }
+    int16_t read() override { return -1; }
+
+    // what ChibiOS reports for a 57600 baud UART
+    uint32_t bw_in_kilobytes_per_second() const override {
+        return 57600 / (9*1024);
+    }
+
+    size_t write(uint8_t c) override {
+        return write(&c, 1);
+    }
+    size_t write(const uint8_t *buffer, size_t size) override {
+        size = MIN(size, size_t(port_buffer_size - _queued));
+        _queued += size;
+        return size;
+    }
+
+    void drain(uint32_t dt_us) {
+        _drain_credit += uint64_t(_bytes_per_second) * dt_us;
+        const uint32_t n = MIN(uint32_t(_drain_credit / 1000000U), _queued);
+        _drain_credit -= uint64_t(n) * 1000000U;
+        _queued -= n;
+        if (_queued == 0) {
+            // an idle radio does not save up air time
+            _drain_credit = 0;
+        }
+    }
+
+private:
+    uint32_t _bytes_per_second;
+    uint32_t _queued;
+    uint64_t _drain_credit;
+};
+
+class GCS_MAVLINK_Bench : public GCS_MAVLINK_Dummy
+{
+public:
+    GCS_MAVLINK_Bench(GCS_MAVLINK_Parameters &params, AP_HAL::UARTDriver &uart) :
+        GCS_MAVLINK_Dummy(params, uart) {}
+
+    uint32_t sent[ARRAY_SIZE(streams)];
+    uint32_t messages;
+
+private:
+    bool try_send_message(enum ap_message id) override {
+        int8_t stream = -1;
+        uint8_t nbytes = 0;
+        if (id == MSG_HEARTBEAT) {
+            // sent by update_send() outside the streams
+            nbytes = 21;
+        }
+        for (uint8_t i=0; i<ARRAY_SIZE(streams); i++) {
+            if (streams[i].id == id) {
+                stream = i;
+                nbytes = streams[i].bytes;
+            }
+        }
+        if (nbytes == 0) {
+            return true;
+        }
+        if (txspace() < nbytes) {
+            return false;
+        }
+        const uint8_t packet[UINT8_MAX] {};
+        comm_send_buffer(chan, packet, nbytes);
+        if (stream != -1) {
+            sent[stream]++;
+            messages++;
+        }
+        return true;
+    }
+};
+
+/*
+  the GCS is never short of loop time, the streams are only limited
+  by the link
+ */
+class GCS_Bench : public GCS_Dummy
+{
+public:
+    uint16_t min_loop_time_remaining_for_message_send_us() const override {
+        return 0;
+    }
+};
+
+static GCS_Bench _gcs;
+static GCS_MAVLINK_Parameters params;
+static AP_Int32 log_bitmask;
+static AP_Logger logger{log_bitmask};
+static AP_Scheduler scheduler;
+
+static uint64_t clock_us = 10000000;
+
+static void run(GCS_MAVLINK_Bench &link, RadioUart &uart)
+{
+    const uint32_t ticks = sim_seconds * 1000000U / update_period_us;
+    for (uint32_t t=0; t<ticks; t++) {
+        clock_us += update_period_us;
+        hal.scheduler->stop_clock(clock_us);
+        uart.drain(update_period_us);
+        link.update_send();
+    }
+}
+
+/*
+  the table of rates is printed the first time each configuration
+  runs, the label gives the percentage of the requested rates
+  achieved for each weight
+ */
+static void report(bool fair, uint32_t link_bytes_per_second, const GCS_MAVLINK_Bench &link, benchmark::State& state)
+{
+    static uint32_t printed[8];
+    static uint8_t num_printed;
+    const uint32_t key = link_bytes_per_second * 2 + fair;
+    bool print = num_printed < ARRAY_SIZE(printed);
+    for (uint8_t i=0; i<num_printed; i++) {
+        if (printed[i] == key) {
+            print = false;
+        }
+    }
+    if (print) {
+        printed[num_printed++] = key;
+        printf("%s, link %u bytes/s:\n", fair ? "fair queue" : "buckets", unsigned(link_bytes_per_second));
+    }
+
+    float achieved[3] {};
+    uint8_t count[3] {};
+    for (uint8_t i=0; i<ARRAY_SIZE(streams); i++) {
+        const float rate_hz = float(link.sent[i]) / sim_seconds;
+        if (print) {
+            printf("  %-22s %5.1f of %2u Hz\n", streams[i].name, double(rate_hz), unsigned(streams[i].rate_hz));
+        }
+        uint8_t w;
+        switch (MAVLink_FairQueue::message_weight(streams[i].id)) {
+        case MAVLink_FairQueue::Weight::HIGH:
+            w = 0;
+            break;
+        case MAVLink_FairQueue::Weight::NORMAL:
+            w = 1;
+            break;
+        default:
+            w = 2;
+            break;
+        }
+        achieved[w] += 100 * rate_hz / streams[i].rate_hz;
+        count[w]++;
+    }
+    char label[64];
+    snprintf(label, sizeof(label), "%s high %.0f%% normal %.0f%% bulk %.0f%%",
+             fair ? "fair" : "buckets",
+             double(achieved[0] / count[0]),
+             double(achieved[1] / count[1]),
+             double(achieved[2] / count[2]));
+    state.SetLabel(label);
+}
+
+/*
+  range_x is the link rate in bytes per second, range_y is 1 for the
+  fair queue and 0 for buckets. The streams need about 4000 bytes/s
+ */
+static void BM_StreamScheduler(benchmark::State& state)
+{
+    const uint32_t link_bytes_per_second = state.range_x();
+    const bool fair = state.range_y();
+    RadioUart *uart = nullptr;
+    GCS_MAVLINK_Bench *link = nullptr;
+    int64_t messages = 0;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        delete link;
+        delete uart;
+        uart = new RadioUart(link_bytes_per_second);
+        uart->set_options(fair ? AP_HAL::UARTDriver::OPTION_MAVLINK_FAIR_QUEUE : 0);
+        mavlink_comm_port[MAVLINK_COMM_0] = uart;
+        link = new GCS_MAVLINK_Bench(params, *uart);
+        // the first update sets the intervals from SRn, all zero
+        // here, and starts HEARTBEAT
+        link->update_send();
+        for (const auto &s : streams) {
+            link->set_mavlink_message_id_interval(s.mavlink_id, 1000 / s.rate_hz);
+        }
+        state.ResumeTiming();
+        run(*link, *uart);
+        messages += link->messages;
+    }
+    state.SetItemsProcessed(messages);
+    report(fair, link_bytes_per_second, *link, state);
+    delete link;
+    delete uart;
+}
+
+BENCHMARK(BM_StreamScheduler)
+    ->ArgPair(5000, 0)->ArgPair(5000, 1)
+    ->ArgPair(2000, 0)->ArgPair(2000, 1)
+    ->ArgPair(1000, 0)->ArgPair(1000, 1);
+
+BENCHMARK_MAIN();
@@ -234,6 +234,12 @@ void Aircraft::time_advance()
         time_now_us += frame_time_us;
     }
     last_time_us = time_now_us;
+#if HAL_SIM_LOCKSTEP_ENABLED
+    if (lockstep != nullptr) {
+        lockstep->wait(time_now_us, location, velocity_ef, dcm);
+        return;
+    }
+#endif
     if (use_time_sync) {
         sync_frame_time();
     }
@@ -265,6 +271,10 @@ void Aircraft::adjust_frame_time(float new_rate)
 void Aircraft::sync_frame_time(void)
 {
     frame_counter++;
+    if (!is_positive(target_speedup)) {
+        // a speedup of zero runs as fast as the host allows
+        return;
+    }
     uint64_t now = get_wall_time_us();
     uint64_t dt_us = now - last_wall_time_us;
 
@@ -279,6 +289,9 @@ void Aircraft::sync_frame_time(void)
     }
     if (sleep_debt_us > min_sleep_time) {
         // sleep if we have built up a debt of min_sleep_tim
+#if HAL_SIM_PROFILE_ENABLED
+        SITL::Profile::Scope profile_scope(SITL::Profile::Category::SLEEP);
+#endif
         usleep(sleep_debt_us);
         sleep_debt_us -= (get_wall_time_us() - now);
     }
@@ -455,7 +468,7 @@ void Aircraft::fill_fdm(struct sitl_fdm &fdm)
         sitl->speedup = get_speedup();
     }
     
-    if (!is_equal(last_speedup, float(sitl->speedup)) && sitl->speedup > 0) {
+    if (!is_equal(last_speedup, float(sitl->speedup)) && sitl->speedup >= 0) {
         set_speedup(sitl->speedup);
         last_speedup = sitl->speedup;
     }
@@ -575,6 +588,10 @@ uint64_t Aircraft::get_wall_time_us() const
  */
 void Aircraft::set_speedup(float speedup)
 {
+    if (!is_positive(speedup) && !use_time_sync) {
+        // external simulators set the pace of the simulation
+        speedup = 1.0f;
+    }
     setup_frame_time(rate_hz, speedup);
 }
 
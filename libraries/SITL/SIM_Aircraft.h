@@ -34,6 +34,8 @@
 #include "SIM_Battery.h"
 #include <Filter/Filter.h>
 #include "SIM_JSON_Master.h"
+#include "SIM_Lockstep.h"
+#include "SIM_Profile.h"
 
 namespace SITL {
 
@@ -125,6 +127,16 @@ public:
         config_ = config;
     }
 
+#if HAL_SIM_LOCKSTEP_ENABLED
+    /*
+      take simulation time steps from a lockstep coordinator instead
+      of pacing against the wall clock
+     */
+    void set_lockstep(Lockstep *_lockstep) {
+        lockstep = _lockstep;
+    }
+#endif
+
 
     const Location &get_location() const { return location; }
 
@@ -309,6 +321,9 @@ protected:
 
 private:
     uint64_t last_time_us;
+#if HAL_SIM_LOCKSTEP_ENABLED
+    Lockstep *lockstep;
+#endif
     uint32_t frame_counter;
     uint32_t last_ground_contact_ms;
 #if defined(__CYGWIN__) || defined(__CYGWIN64__)
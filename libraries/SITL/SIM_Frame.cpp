@@ -472,6 +472,7 @@ void Frame::init(const char *frame_str, Battery *_battery)
                                model.mass, model.diagonal_size, power_factor, model.maxVoltage);
     }
 
+    setup_batch(power_factor);
 
 #if 0
     // useful debug code for thrust curve
@@ -500,6 +501,46 @@ void Frame::init(const char *frame_str, Battery *_battery)
     }
 }
 
+/*
+  setup the batched motor model if the frame has no tilting motors
+ */
+void Frame::setup_batch(float power_factor)
+{
+    if (num_motors > MAX_BATCH_MOTORS) {
+        return;
+    }
+    for (uint8_t i=0; i<num_motors; i++) {
+        if (motors[i].roll_servo >= 0 || motors[i].pitch_servo >= 0) {
+            return;
+        }
+    }
+    if (batch == nullptr) {
+        batch = new MotorBatch {};
+        if (batch == nullptr) {
+            return;
+        }
+    }
+    for (uint8_t i=0; i<num_motors; i++) {
+        const Motor &m = motors[i];
+        batch->servo[i] = m.servo;
+        batch->arm_x[i] = cosf(radians(m.angle)) * model.diagonal_size;
+        batch->arm_y[i] = sinf(radians(m.angle)) * model.diagonal_size;
+        batch->yaw_factor[i] = m.yaw_factor;
+    }
+    const float pwm_range = model.pwmMax - model.pwmMin;
+    batch->pwm_thrust_min = model.pwmMin + model.spin_min * pwm_range;
+    batch->pwm_thrust_range = (model.spin_max - model.spin_min) * pwm_range;
+    batch->expo = model.propExpo;
+    batch->slew_max = model.slew_max;
+    batch->power_factor = power_factor;
+    batch->voltage_max = model.maxVoltage;
+
+    // as for Motor::setup_params, assume 50% of mass on ring around center
+    batch->moment_of_inertia.x = model.mass * 0.25 * sq(model.diagonal_size*0.5);
+    batch->moment_of_inertia.y = batch->moment_of_inertia.x;
+    batch->moment_of_inertia.z = model.mass * 0.5 * sq(model.diagonal_size*0.5);
+}
+
 /*
   find a frame by name
  */
@@ -528,17 +569,17 @@ void Frame::calculate_forces(const Aircraft &aircraft,
 
     Vector3f vel_air_bf = aircraft.get_dcm().transposed() * aircraft.get_velocity_air_ef();
 
-    float current = 0;
-    for (uint8_t i=0; i<num_motors; i++) {
-        Vector3f mraccel, mthrust;
-        motors[i].calculate_forces(input, motor_offset, mraccel, mthrust, vel_air_bf, air_density, velocity_max,
-                                   effective_prop_area, battery->get_voltage());
-        current += motors[i].get_current();
-        rot_accel += mraccel;
-        thrust += mthrust;
-        // simulate motor rpm
-        if (!is_zero(AP::sitl()->vibe_motor)) {
-            rpm[i] = motors[i].get_command() * AP::sitl()->vibe_motor * 60.0f;
+    Vector3f motor_rot_accel;
+    calculate_motor_forces(input, AP_HAL::micros64(), vel_air_bf, air_density, battery->get_voltage(),
+                           motor_rot_accel, thrust);
+    rot_accel += motor_rot_accel;
+
+    // simulate motor rpm
+    const float vibe_motor = AP::sitl()->vibe_motor;
+    if (!is_zero(vibe_motor)) {
+        for (uint8_t i=0; i<num_motors; i++) {
+            const float command = batch != nullptr ? batch->command[i] : motors[i].get_command();
+            rpm[i] = command * vibe_motor * 60.0f;
         }
     }
 
@@ -592,6 +633,103 @@ void Frame::calculate_forces(const Aircraft &aircraft,
                            aircraft.rand_normal(0, 1)) * accel_noise * noise_scale;
 }
 
+/*
+  calculate the summed motor forces, using the batched model when
+  possible
+ */
+void Frame::calculate_motor_forces(const struct sitl_input &input, uint64_t now_us,
+                                   const Vector3f &vel_air_bf, float air_density, float voltage,
+                                   Vector3f &rot_accel, Vector3f &thrust)
+{
+    if (batch != nullptr) {
+        calculate_motor_forces_batch(input, now_us, vel_air_bf, air_density, voltage, rot_accel, thrust);
+        return;
+    }
+    rot_accel.zero();
+    thrust.zero();
+    for (uint8_t i=0; i<num_motors; i++) {
+        Vector3f mraccel, mthrust;
+        motors[i].calculate_forces(input, motor_offset, mraccel, mthrust, vel_air_bf, air_density, velocity_max,
+                                   effective_prop_area, voltage);
+        rot_accel += mraccel;
+        thrust += mthrust;
+    }
+}
+
+/*
+  the same model as Motor::calculate_forces() for untilted motors, with
+  each step done for all motors before the next so the loops run over
+  contiguous arrays
+ */
+void Frame::calculate_motor_forces_batch(const struct sitl_input &input, uint64_t now_us,
+                                         const Vector3f &vel_air_bf, float air_density, float voltage,
+                                         Vector3f &rot_accel, Vector3f &thrust)
+{
+    MotorBatch &b = *batch;
+    const uint8_t n = num_motors;
+
+    rot_accel.zero();
+    thrust.zero();
+
+    const float voltage_scale = voltage / b.voltage_max;
+    if (voltage_scale < 0.1) {
+        // battery is dead
+        memset(b.current, 0, sizeof(b.current));
+        return;
+    }
+
+    // slew limit on the commands
+    float slew_max_change = 1;
+    if (b.last_calc_us != 0 && b.slew_max > 0) {
+        slew_max_change = b.slew_max * (now_us - b.last_calc_us) * 1.0e-6;
+    }
+    b.last_calc_us = now_us;
+
+    float pwm[MAX_BATCH_MOTORS];
+    for (uint8_t i=0; i<n; i++) {
+        pwm[i] = input.servos[motor_offset+b.servo[i]];
+    }
+
+    const float inv_pwm_range = 1.0f / b.pwm_thrust_range;
+    for (uint8_t i=0; i<n; i++) {
+        const float command = constrain_float((pwm[i] - b.pwm_thrust_min) * inv_pwm_range, 0, 1);
+        b.command[i] = constrain_float(command, b.command[i] - slew_max_change, b.command[i] + slew_max_change);
+    }
+
+    /*
+      thrust from the momentum disc: velocity_out is velocity_max
+      times the square root of the expo curve, so squaring it needs no
+      sqrt per motor
+     */
+    const float velocity_in = MAX(0, -vel_air_bf.z);
+    const float vmax_sq = sq(velocity_max * voltage_scale);
+    const float disc_scale = 0.5f * air_density * effective_prop_area;
+    const float vin_sq = sq(velocity_in);
+    const float current_scale = b.power_factor / MAX(voltage, 0.1);
+    float motor_thrust[MAX_BATCH_MOTORS];
+    for (uint8_t i=0; i<n; i++) {
+        const float c = b.command[i];
+        const float vout_sq = vmax_sq * ((1 - b.expo) * c + b.expo * c * c);
+        motor_thrust[i] = disc_scale * (vout_sq - vin_sq);
+        b.current[i] = current_scale * fabsf(motor_thrust[i]);
+    }
+
+    // torque is arm % (0, 0, -thrust) plus the rotor yaw torque
+    float sum_thrust = 0, torque_x = 0, torque_y = 0, sum_yaw = 0;
+    for (uint8_t i=0; i<n; i++) {
+        sum_thrust += motor_thrust[i];
+        torque_x -= b.arm_y[i] * motor_thrust[i];
+        torque_y += b.arm_x[i] * motor_thrust[i];
+        sum_yaw += b.yaw_factor[i] * b.command[i];
+    }
+    const float yaw_scale = radians(40);
+    const float torque_z = sum_yaw * yaw_scale * voltage_scale;
+
+    thrust.z = -sum_thrust;
+    rot_accel.x = torque_x / b.moment_of_inertia.x;
+    rot_accel.y = torque_y / b.moment_of_inertia.y;
+    rot_accel.z = torque_z / b.moment_of_inertia.z;
+}
 
 // calculate current and voltage
 void Frame::current_and_voltage(float &voltage, float &current)
@@ -604,6 +742,6 @@ void Frame::current_and_voltage(float &voltage, float &current)
     voltage = battery->get_voltage();
     current = 0;
     for (uint8_t i=0; i<num_motors; i++) {
-        current += motors[i].get_current();
+        current += batch != nullptr ? batch->current[i] : motors[i].get_current();
     }
 }
@@ -51,6 +51,12 @@ public:
                           const struct sitl_input &input,
                           Vector3f &rot_accel, Vector3f &body_accel, float* rpm,
                           bool use_drag=true);
+
+    // calculate the summed rotational acceleration and thrust of the
+    // motors, without drag or noise
+    void calculate_motor_forces(const struct sitl_input &input, uint64_t now_us,
+                                const Vector3f &vel_air_bf, float air_density, float voltage,
+                                Vector3f &rot_accel, Vector3f &thrust);
     
     float terminal_velocity;
     float terminal_rotation_rate;
@@ -146,5 +152,36 @@ private:
     // load frame parameters from a json model file
     void load_frame_params(const char *model_json);
 
+protected:
+    /*
+      the motors as a structure of arrays, so the forces for all motors
+      can be calculated in one pass the compiler can vectorise. Only
+      used when no motor is tilted, as all motors of a frame share the
+      same parameters
+     */
+    static const uint8_t MAX_BATCH_MOTORS = 16;
+    struct MotorBatch {
+        uint8_t servo[MAX_BATCH_MOTORS];
+        float arm_x[MAX_BATCH_MOTORS];      // arm position times thrust gives torque
+        float arm_y[MAX_BATCH_MOTORS];
+        float yaw_factor[MAX_BATCH_MOTORS];
+        float command[MAX_BATCH_MOTORS];    // slew limited command, 0 to 1
+        float current[MAX_BATCH_MOTORS];    // amps
+
+        float pwm_thrust_min;
+        float pwm_thrust_range;
+        float expo;
+        float slew_max;
+        float power_factor;
+        float voltage_max;
+        Vector3f moment_of_inertia;
+        uint64_t last_calc_us;
+    } *batch = nullptr;
+
+    void setup_batch(float power_factor);
+    void calculate_motor_forces_batch(const struct sitl_input &input, uint64_t now_us,
+                                      const Vector3f &vel_air_bf, float air_density, float voltage,
+                                      Vector3f &rot_accel, Vector3f &thrust);
+
 };
 }
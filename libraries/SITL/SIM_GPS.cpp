@@ -21,6 +21,7 @@
 #include <sys/stat.h>
 #include <errno.h>
 #include <AP_HAL_SITL/AP_HAL_SITL.h>
+#include "SIM_SensorRecord.h"
 extern const HAL_SITL& hal_sitl;
 #endif
 
@@ -1068,7 +1069,7 @@ void GPS::update()
 
     const uint8_t idx = instance;  // alias to avoid code churn
 
-        struct gps_data d;
+        struct gps_data d {};
 
         // simulate delayed lock times
         bool have_lock = (!_sitl->gps_disable[idx] && now_ms >= _sitl->gps_lock_time[idx]*1000UL);
@@ -1148,6 +1149,9 @@ void GPS::update()
         d.longitude += glitch_offsets.y;
         d.altitude += glitch_offsets.z;
 
+#if HAL_SIM_SENSOR_RECORD_ENABLED
+        AP::sim_record().sample(SensorRecord::Type::GPS, instance, d);
+#endif
 
     // do GPS-type-dependent updates:
     switch ((Type)_sitl->gps_type[instance].get()) {
@@ -20,6 +20,8 @@
 
 #if HAL_SIM_JSON_ENABLED
 
+#include "SIM_JSON_SHM.h"
+
 #include <stdio.h>
 #include <arpa/inet.h>
 #include <errno.h>
@@ -67,6 +69,13 @@ JSON::JSON(const char *frame_str) :
         target_ip = colon+1;
     }
 
+    if (strncmp(target_ip, "shm:", 4) == 0) {
+        shm = new JSON_SHM();
+        if (shm == nullptr || !shm->init(target_ip+4)) {
+            AP_HAL::panic("JSON: failed to setup shared memory %s", target_ip+4);
+        }
+    }
+
     for (uint8_t i=0; i<ARRAY_SIZE(sim_defaults); i++) {
     AP_Param::set_default_by_name(sim_defaults[i].name, sim_defaults[i].value);
         if (sim_defaults[i].save) {
@@ -84,6 +93,9 @@ JSON::JSON(const char *frame_str) :
 */
 void JSON::set_interface_ports(const char* address, const int port_in, const int port_out)
 {
+    if (shm != nullptr) {
+        return;
+    }
     sock.set_blocking(false);
     sock.reuseaddress();
 
@@ -254,16 +266,75 @@ void JSON::recv_fdm(const struct sitl_input &input)
     }
 
     const uint32_t received_bitmask = parse_sensors((const char *)(p1+1));
+    if (!check_fields(received_bitmask)) {
+        return;
+    }
+
+    memmove(sensor_buffer, p2, sensor_buffer_len - (p2 - sensor_buffer));
+    sensor_buffer_len = sensor_buffer_len - (p2 - sensor_buffer);
+
+    apply_state(received_bitmask);
+}
+
+/*
+    Receive new sensor data from simulator over shared memory
+    This is a blocking function
+*/
+void JSON::recv_fdm_shm(const struct sitl_input &input)
+{
+    static_assert(AP_JSON_SHM_QUATERNION == QUAT_ATT && AP_JSON_SHM_NO_TIME_SYNC == TIME_SYNC,
+                  "shm field bits must match the JSON keys");
+
+    struct ap_json_shm_state s;
+    uint32_t wait_ms = 0;
+    while (!shm->recv_state(s, UDP_TIMEOUT_MS)) {
+        wait_ms += UDP_TIMEOUT_MS;
+        if (wait_ms >= 1000) {
+            wait_ms = 0;
+            printf("No JSON shm state received\n");
+        }
+    }
+
+    uint32_t received_bitmask = s.fields & ((1U << ARRAY_SIZE(keytable)) - 1);
+    if ((received_bitmask & AP_JSON_SHM_REQUIRED) != AP_JSON_SHM_REQUIRED) {
+        received_bitmask = 0;
+    }
+    if (!check_fields(received_bitmask)) {
+        return;
+    }
+
+    state.timestamp_s = s.timestamp_s;
+    state.imu.gyro = Vector3f(s.gyro[0], s.gyro[1], s.gyro[2]);
+    state.imu.accel_body = Vector3f(s.accel_body[0], s.accel_body[1], s.accel_body[2]);
+    state.position = Vector3d(s.position[0], s.position[1], s.position[2]);
+    state.attitude = Vector3f(s.attitude[0], s.attitude[1], s.attitude[2]);
+    state.quaternion = Quaternion(s.quaternion[0], s.quaternion[1], s.quaternion[2], s.quaternion[3]);
+    state.velocity = Vector3f(s.velocity[0], s.velocity[1], s.velocity[2]);
+    memcpy(state.rng, s.rng, sizeof(state.rng));
+    state.wind_vane_apparent.direction = s.windvane_direction;
+    state.wind_vane_apparent.speed = s.windvane_speed;
+    state.airspeed = s.airspeed;
+    state.no_time_sync = (received_bitmask & TIME_SYNC) != 0;
+
+    apply_state(received_bitmask);
+}
+
+/*
+    check that a new state has the fields we need, reporting the
+    fields received when they change
+*/
+bool JSON::check_fields(uint32_t received_bitmask)
+{
     if (received_bitmask == 0) {
         // did not receve one of the mandatory fields
         printf("Did not contain all mandatory fields\n");
-        return;
+        return false;
     }
 
     // Must get either attitude or quaternion fields
     if ((received_bitmask & (EULER_ATT | QUAT_ATT)) == 0) {
         printf("Did not receive attitude or quaternion\n");
-        return;
+        return false;
     }
 
     if (received_bitmask != last_received_bitmask) {
@@ -283,10 +354,14 @@ void JSON::recv_fdm(const struct sitl_input &input)
         printf("\n");
     }
     last_received_bitmask = received_bitmask;
+    return true;
+}
 
-    memmove(sensor_buffer, p2, sensor_buffer_len - (p2 - sensor_buffer));
-    sensor_buffer_len = sensor_buffer_len - (p2 - sensor_buffer);
-
+/*
+    update the vehicle from a new state
+*/
+void JSON::apply_state(uint32_t received_bitmask)
+{
     accel_body = state.imu.accel_body;
     gyro = state.imu.gyro;
     velocity_ef = state.velocity;
@@ -430,11 +505,16 @@ void JSON::recv_fdm(const struct sitl_input &input)
 */
 void JSON::update(const struct sitl_input &input)
 {
-    // send to JSON model
-    output_servos(input);
+    if (shm != nullptr) {
+        shm->send_servos(input.servos, ARRAY_SIZE(input.servos), rate_hz, frame_counter);
+        recv_fdm_shm(input);
+    } else {
+        // send to JSON model
+        output_servos(input);
 
-    // receive from JSON model
-    recv_fdm(input);
+        // receive from JSON model
+        recv_fdm(input);
+    }
 
     // update magnetic field
     // as the model does not provide mag feild we calculate it from position and attitude
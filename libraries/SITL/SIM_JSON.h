@@ -27,6 +27,8 @@
 
 namespace SITL {
 
+class JSON_SHM;
+
 class JSON : public Aircraft {
 public:
     JSON(const char *frame_str);
@@ -59,11 +61,20 @@ private:
 
     SocketAPM sock;
 
+    // binary shared memory transport, used instead of sock if the
+    // model is given as json:shm:PATH
+    JSON_SHM *shm;
+
     uint32_t frame_counter;
     double last_timestamp_s;
 
     void output_servos(const struct sitl_input &input);
     void recv_fdm(const struct sitl_input &input);
+    void recv_fdm_shm(const struct sitl_input &input);
+
+    // check and apply a new state from the physics engine
+    bool check_fields(uint32_t received_bitmask);
+    void apply_state(uint32_t received_bitmask);
 
     uint32_t parse_sensors(const char *json);
 
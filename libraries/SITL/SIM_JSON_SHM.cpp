@@ -0,0 +1,88 @@
+/*
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+  SITL side of the shared memory transport for the JSON backend
+*/
+
+#include "SIM_JSON_SHM.h"
+
+#if HAL_SIM_JSON_ENABLED
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace SITL;
+
+bool JSON_SHM::init(const char *path)
+{
+    const int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        printf("JSON shm: failed to open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    if (ftruncate(fd, sizeof(struct ap_json_shm)) != 0) {
+        printf("JSON shm: failed to size %s: %s\n", path, strerror(errno));
+        close(fd);
+        return false;
+    }
+    void *p = mmap(nullptr, sizeof(struct ap_json_shm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        printf("JSON shm: mmap of %s failed: %s\n", path, strerror(errno));
+        return false;
+    }
+    shm = (struct ap_json_shm *)p;
+
+    // a physics engine may already be attached from a previous run,
+    // keep the sequence numbers so it sees the next servo frame
+    shm->header_size = sizeof(struct ap_json_shm);
+    shm->servos_size = sizeof(struct ap_json_shm_servos);
+    shm->state_size = sizeof(struct ap_json_shm_state);
+    shm->version = AP_JSON_SHM_VERSION;
+    ap_json_shm_store(&shm->magic, AP_JSON_SHM_MAGIC);
+
+    printf("JSON shm: using %s\n", path);
+    return true;
+}
+
+void JSON_SHM::send_servos(const uint16_t *pwm, uint8_t num_servos, uint16_t frame_rate, uint32_t frame_count)
+{
+    struct ap_json_shm_servos &servos = shm->servos;
+    num_servos = MIN(num_servos, AP_JSON_SHM_MAX_SERVOS);
+    servos.frame_count = frame_count;
+    servos.frame_rate = frame_rate;
+    servos.num_servos = num_servos;
+    memcpy(servos.pwm, pwm, num_servos * sizeof(pwm[0]));
+    ap_json_shm_store(&shm->servo_seq, shm->servo_seq + 1);
+}
+
+bool JSON_SHM::recv_state(struct ap_json_shm_state &state, uint32_t timeout_ms)
+{
+    const uint32_t seq = shm->servo_seq;
+    uint32_t state_seq;
+    while ((state_seq = ap_json_shm_load(&shm->state_seq)) != seq) {
+        if (!ap_json_shm_wait_change(&shm->state_seq, state_seq, timeout_ms)) {
+            return false;
+        }
+    }
+    state = shm->state;
+    return true;
+}
+
+#endif  // HAL_SIM_JSON_ENABLED
@@ -0,0 +1,46 @@
+/*
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+  SITL side of the shared memory transport for the JSON backend
+*/
+
+#pragma once
+
+#include "SIM_JSON.h"
+
+#if HAL_SIM_JSON_ENABLED
+
+#include "SIM_JSON_SHM_Protocol.h"
+
+namespace SITL {
+
+class JSON_SHM {
+public:
+    // create and map the shared memory file
+    bool init(const char *path);
+
+    // publish servo outputs to the physics engine
+    void send_servos(const uint16_t *pwm, uint8_t num_servos, uint16_t frame_rate, uint32_t frame_count);
+
+    // wait for the reply to the last servos, false on timeout
+    bool recv_state(struct ap_json_shm_state &state, uint32_t timeout_ms);
+
+private:
+    struct ap_json_shm *shm;
+};
+
+}
+
+#endif  // HAL_SIM_JSON_ENABLED
@@ -0,0 +1,189 @@
+/*
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+  binary shared memory transport for the JSON SITL backend
+
+  This header is plain C so that physics engines can include it
+  directly. It carries the same data as the UDP JSON interface, in
+  fixed layout structures, through a file that SITL creates and maps:
+
+    SITL                                physics
+    ----                                -------
+    write servos, servo_seq++    --->   wait for servo_seq to change
+                                        step the model
+    wait for state_seq == servo_seq <-- write state, state_seq = servo_seq
+
+  The exchange is lockstep, so each direction needs a single slot and
+  the sequence numbers double as the handshake. Waiters spin briefly and
+  then sleep on the sequence word with a futex on Linux.
+
+  Any change to the layout must increment AP_JSON_SHM_VERSION.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <unistd.h>
+#endif
+
+#define AP_JSON_SHM_MAGIC   0x4e534a41 // "AJSN"
+#define AP_JSON_SHM_VERSION 1
+
+#define AP_JSON_SHM_MAX_SERVOS 32
+
+/*
+  bits of ap_json_shm_state.fields, matching the keys of the JSON
+  interface
+ */
+#define AP_JSON_SHM_TIMESTAMP    (1U<<0)
+#define AP_JSON_SHM_GYRO         (1U<<1)
+#define AP_JSON_SHM_ACCEL_BODY   (1U<<2)
+#define AP_JSON_SHM_POSITION     (1U<<3)
+#define AP_JSON_SHM_ATTITUDE     (1U<<4)
+#define AP_JSON_SHM_QUATERNION   (1U<<5)
+#define AP_JSON_SHM_VELOCITY     (1U<<6)
+#define AP_JSON_SHM_RNG_1        (1U<<7)  // RNG_2..RNG_6 follow
+#define AP_JSON_SHM_WIND_DIR     (1U<<13)
+#define AP_JSON_SHM_WIND_SPD     (1U<<14)
+#define AP_JSON_SHM_AIRSPEED     (1U<<15)
+#define AP_JSON_SHM_NO_TIME_SYNC (1U<<16)
+
+#define AP_JSON_SHM_REQUIRED (AP_JSON_SHM_TIMESTAMP | AP_JSON_SHM_GYRO | AP_JSON_SHM_ACCEL_BODY | \
+                              AP_JSON_SHM_POSITION | AP_JSON_SHM_VELOCITY)
+
+// output from SITL
+struct ap_json_shm_servos {
+    uint32_t frame_count;
+    uint16_t frame_rate;
+    uint16_t num_servos;
+    uint16_t pwm[AP_JSON_SHM_MAX_SERVOS];
+};
+
+// input to SITL, units and frames as for the JSON interface
+struct ap_json_shm_state {
+    uint32_t frame_count;       // servo frame this state was computed from
+    uint32_t fields;            // AP_JSON_SHM_* bits of the valid fields
+    double timestamp_s;         // physics time
+    double position[3];         // m, NED from origin
+    float gyro[3];              // rad/s, body frame
+    float accel_body[3];        // m/s/s, body frame
+    float velocity[3];          // m/s, NED
+    float attitude[3];          // rad, roll, pitch, yaw
+    float quaternion[4];
+    float rng[6];               // m
+    float windvane_direction;   // rad, clockwise from the nose
+    float windvane_speed;       // m/s
+    float airspeed;             // m/s
+};
+
+struct ap_json_shm {
+    // written once by SITL when the file is created
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t servos_size;
+    uint32_t state_size;
+
+    // handshake, each word is only written by one side
+    uint32_t servo_seq;         // SITL: incremented after writing servos
+    uint32_t state_seq;         // physics: set to servo_seq after writing state
+    uint32_t physics_pid;       // physics: set when attaching
+    uint32_t pad;
+
+    struct ap_json_shm_servos servos;
+    struct ap_json_shm_state state;
+};
+
+// number of polls before sleeping on the futex
+#define AP_JSON_SHM_SPIN_COUNT 2000
+
+static inline uint32_t ap_json_shm_load(const uint32_t *word)
+{
+    return __atomic_load_n(word, __ATOMIC_ACQUIRE);
+}
+
+static inline void ap_json_shm_store(uint32_t *word, uint32_t value)
+{
+    __atomic_store_n(word, value, __ATOMIC_RELEASE);
+#if defined(__linux__)
+    syscall(SYS_futex, word, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+}
+
+/*
+  wait until *word != old. Returns 0 on timeout
+ */
+static inline int ap_json_shm_wait_change(const uint32_t *word, uint32_t old, uint32_t timeout_ms)
+{
+    for (uint32_t i=0; i<AP_JSON_SHM_SPIN_COUNT; i++) {
+        if (ap_json_shm_load(word) != old) {
+            return 1;
+        }
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    const uint64_t deadline_ns = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec + (uint64_t)timeout_ms * 1000000ULL;
+    while (ap_json_shm_load(word) == old) {
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        const uint64_t now_ns = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+        if (now_ns >= deadline_ns) {
+            return 0;
+        }
+#if defined(__linux__)
+        const uint64_t wait_ns = deadline_ns - now_ns;
+        struct timespec wait = { (time_t)(wait_ns / 1000000000ULL), (long)(wait_ns % 1000000000ULL) };
+        syscall(SYS_futex, word, FUTEX_WAIT, old, &wait, NULL, 0);
+#else
+        usleep(50);
+#endif
+    }
+    return 1;
+}
+
+/*
+  physics side: check the layout of a mapped file
+ */
+static inline int ap_json_shm_check(const struct ap_json_shm *shm)
+{
+    return shm->magic == AP_JSON_SHM_MAGIC &&
+        shm->version == AP_JSON_SHM_VERSION &&
+        shm->header_size == sizeof(struct ap_json_shm) &&
+        shm->servos_size == sizeof(struct ap_json_shm_servos) &&
+        shm->state_size == sizeof(struct ap_json_shm_state);
+}
+
+/*
+  physics side: wait for servos newer than the last state written.
+  Returns 0 on timeout
+ */
+static inline int ap_json_shm_wait_servos(struct ap_json_shm *shm, uint32_t timeout_ms)
+{
+    return ap_json_shm_wait_change(&shm->servo_seq, ap_json_shm_load(&shm->state_seq), timeout_ms);
+}
+
+/*
+  physics side: publish shm->state in reply to the latest servos
+ */
+static inline void ap_json_shm_send_state(struct ap_json_shm *shm)
+{
+    ap_json_shm_store(&shm->state_seq, ap_json_shm_load(&shm->servo_seq));
+}
@@ -0,0 +1,113 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  lockstep simulation time shared between many SITL instances
+*/
+
+#include "SIM_Lockstep.h"
+
+#if HAL_SIM_LOCKSTEP_ENABLED
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace SITL;
+
+static_assert(sizeof(Lockstep::header) == 64, "lockstep header must be 64 bytes");
+static_assert(sizeof(Lockstep::vehicle) == 64, "lockstep vehicle slot must be 64 bytes");
+
+bool Lockstep::init(const char *path, uint8_t instance)
+{
+    const int fd = open(path, O_RDWR | O_CLOEXEC);
+    if (fd == -1) {
+        ::printf("lockstep: failed to open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(struct shared)) {
+        ::printf("lockstep: %s is too small\n", path);
+        close(fd);
+        return false;
+    }
+    void *p = mmap(nullptr, sizeof(struct shared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        ::printf("lockstep: mmap of %s failed: %s\n", path, strerror(errno));
+        return false;
+    }
+    shm = (struct shared *)p;
+    if (shm->hdr.magic != MAGIC || shm->hdr.version != VERSION) {
+        ::printf("lockstep: bad header in %s\n", path);
+        munmap(p, sizeof(struct shared));
+        shm = nullptr;
+        return false;
+    }
+    slot = &shm->vehicles[instance];
+    slot->pid = getpid();
+    ::printf("lockstep: instance %u using %s with %uus steps\n",
+             unsigned(instance), path, unsigned(shm->hdr.step_us));
+    return true;
+}
+
+void Lockstep::wait(uint64_t time_us, const Location &location, const Vector3f &velocity_ef, const Matrix3f &dcm)
+{
+    if (__atomic_load_n(&shm->hdr.step_end_us, __ATOMIC_ACQUIRE) >= time_us) {
+        // still within the current step
+        return;
+    }
+
+    // publish our state before telling the coordinator we are waiting
+    slot->latitude = location.lat * 1.0e-7;
+    slot->longitude = location.lng * 1.0e-7;
+    slot->altitude = location.alt * 0.01f;
+    slot->velocity[0] = velocity_ef.x;
+    slot->velocity[1] = velocity_ef.y;
+    slot->velocity[2] = velocity_ef.z;
+    float roll, pitch, yaw;
+    dcm.to_euler(&roll, &pitch, &yaw);
+    slot->roll = degrees(roll);
+    slot->pitch = degrees(pitch);
+    slot->yaw = wrap_360(degrees(yaw));
+    slot->wait_count++;
+    __atomic_store_n(&slot->wait_us, time_us, __ATOMIC_RELEASE);
+
+    /*
+      spin briefly as the coordinator normally grants the next step
+      within a few microseconds of the last instance arriving, then
+      back off so that many instances sharing a few cores don't starve
+      the ones still running
+     */
+    uint32_t spins = 0;
+    while (__atomic_load_n(&shm->hdr.step_end_us, __ATOMIC_ACQUIRE) < time_us) {
+        if (__atomic_load_n(&shm->hdr.shutdown, __ATOMIC_RELAXED) != 0) {
+            ::printf("lockstep: shutdown requested\n");
+            exit(0);
+        }
+        if (spins < 200) {
+            spins++;
+            sched_yield();
+        } else {
+            usleep(50);
+        }
+    }
+}
+
+#endif // HAL_SIM_LOCKSTEP_ENABLED
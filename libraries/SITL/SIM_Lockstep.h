@@ -0,0 +1,97 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  lockstep simulation time shared between many SITL instances
+
+  A coordinator (Tools/autotest/sitl_lockstep.py) creates a shared
+  memory file and advances a common simulation time limit in fixed
+  steps. Each instance runs frames until its simulation time reaches
+  the limit, publishes its state into its slot of the shared memory
+  and waits for the coordinator to grant the next step. Wall clock
+  pacing is done by the coordinator rather than by each instance.
+*/
+
+#pragma once
+
+#include <AP_HAL/AP_HAL_Boards.h>
+
+#ifndef HAL_SIM_LOCKSTEP_ENABLED
+#define HAL_SIM_LOCKSTEP_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+#endif
+
+#if HAL_SIM_LOCKSTEP_ENABLED
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Common/Location.h>
+#include <AP_Math/AP_Math.h>
+
+namespace SITL {
+
+class Lockstep {
+public:
+    Lockstep() {}
+
+    // attach to the shared memory file created by the coordinator
+    bool init(const char *path, uint8_t instance);
+
+    /*
+      publish the state of this instance and block until the
+      coordinator allows simulation time to advance to time_us
+     */
+    void wait(uint64_t time_us, const Location &location, const Vector3f &velocity_ef, const Matrix3f &dcm);
+
+    /*
+      layout of the shared memory file. This must match
+      Tools/autotest/sitl_lockstep.py. Each vehicle slot is a cache line
+      so instances don't contend when publishing their state
+     */
+    static const uint32_t MAGIC = 0x54534b4c; // "LKST"
+    static const uint16_t VERSION = 1;
+    static const uint16_t MAX_VEHICLES = 256;
+
+    struct header {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t max_vehicles;
+        uint64_t step_end_us;   // instances may run up to this time
+        uint32_t step_us;
+        uint32_t shutdown;
+        uint8_t pad[40];
+    };
+
+    struct vehicle {
+        uint64_t wait_us;       // time this instance is waiting to advance to
+        uint32_t pid;
+        uint32_t wait_count;
+        double latitude, longitude; // degrees
+        float altitude;         // m AMSL
+        float velocity[3];      // m/s NED
+        float roll, pitch, yaw; // degrees
+        uint32_t pad;
+    };
+
+    struct shared {
+        struct header hdr;
+        struct vehicle vehicles[MAX_VEHICLES];
+    };
+
+private:
+    struct shared *shm = nullptr;
+    struct vehicle *slot = nullptr;
+};
+
+}
+
+#endif // HAL_SIM_LOCKSTEP_ENABLED
@@ -0,0 +1,143 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  wall clock profile of where SITL spends its time
+*/
+
+#include "SIM_Profile.h"
+
+#if HAL_SIM_PROFILE_ENABLED
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace SITL;
+
+static Profile profile;
+
+static const char *category_names[] = {
+    "physics",
+    "timers",
+    "io",
+    "fast_loop",
+    "ekf",
+    "tasks",
+    "logging",
+    "sleep",
+};
+
+static_assert(ARRAY_SIZE(category_names) == uint8_t(Profile::Category::NUM_CATEGORIES), "missing category name");
+
+static void report_at_exit(void)
+{
+    profile.report();
+}
+
+void Profile::enable()
+{
+    if (_enabled) {
+        return;
+    }
+    _start_ns = now_ns();
+    _enabled = true;
+    atexit(report_at_exit);
+}
+
+void Profile::add(Category category, uint64_t dt_ns)
+{
+    // the logging thread runs concurrently with the main thread
+    const uint8_t i = uint8_t(category);
+    __atomic_fetch_add(&_categories[i].total_ns, dt_ns, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&_categories[i].count, 1, __ATOMIC_RELAXED);
+}
+
+void Profile::add_task(uint8_t task, const char *name, uint64_t dt_ns)
+{
+    if (task >= MAX_TASKS) {
+        return;
+    }
+    _tasks[task].name = name;
+    _tasks[task].total_ns += dt_ns;
+    _tasks[task].count++;
+}
+
+void Profile::report()
+{
+    if (!_enabled) {
+        return;
+    }
+    const double wall_s = MAX((now_ns() - _start_ns) * 1.0e-9, 1.0e-9);
+    const double sim_s = AP_HAL::micros64() * 1.0e-6;
+    ::printf("SITL profile: %.1fs simulated in %.2fs wall (%.2fx realtime)\n",
+             sim_s, wall_s, sim_s / wall_s);
+    ::printf("  %-24s %10s %6s %12s %10s\n", "subsystem", "wall(s)", "%", "calls", "avg(us)");
+    for (uint8_t i=0; i<uint8_t(Category::NUM_CATEGORIES); i++) {
+        const double t = _categories[i].total_ns * 1.0e-9;
+        const uint64_t n = _categories[i].count;
+        ::printf("  %-24s %10.3f %6.1f %12llu %10.2f\n",
+                 category_names[i], t, 100 * t / wall_s,
+                 (unsigned long long)n, n ? _categories[i].total_ns * 1.0e-3 / n : 0);
+    }
+
+    // scheduler tasks, most expensive first
+    uint8_t order[MAX_TASKS];
+    uint8_t num_tasks = 0;
+    for (uint8_t i=0; i<MAX_TASKS; i++) {
+        if (_tasks[i].count == 0) {
+            continue;
+        }
+        uint8_t j = num_tasks++;
+        while (j > 0 && _tasks[order[j-1]].total_ns < _tasks[i].total_ns) {
+            order[j] = order[j-1];
+            j--;
+        }
+        order[j] = i;
+    }
+    for (uint8_t k=0; k<num_tasks; k++) {
+        const uint8_t i = order[k];
+        const double t = _tasks[i].total_ns * 1.0e-9;
+        ::printf("  task %-19.19s %10.3f %6.1f %12llu %10.2f\n",
+                 _tasks[i].name, t, 100 * t / wall_s,
+                 (unsigned long long)_tasks[i].count,
+                 _tasks[i].total_ns * 1.0e-3 / _tasks[i].count);
+    }
+}
+
+Profile::Scope::Scope(Category category) :
+    _category(category),
+    _start_ns(profile.enabled() ? now_ns() : 0)
+{
+}
+
+Profile::Scope::~Scope()
+{
+    if (_start_ns != 0) {
+        profile.add(_category, now_ns() - _start_ns);
+    }
+}
+
+namespace AP {
+
+SITL::Profile &sim_profile()
+{
+    return profile;
+}
+
+};
+
+#endif // HAL_SIM_PROFILE_ENABLED
@@ -0,0 +1,107 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  wall clock profile of where SITL spends its time
+
+  AP_HAL::micros() is simulation time in SITL, so the normal scheduler
+  performance counters can't show what limits the speedup. When
+  enabled with --profile the time spent in each subsystem is
+  accumulated using the host clock and a report is printed on exit.
+  Times are inclusive, so nested subsystems (for example the EKF
+  running inside the fast loop) are counted in both.
+*/
+
+#pragma once
+
+#include <AP_HAL/AP_HAL_Boards.h>
+
+#ifndef HAL_SIM_PROFILE_ENABLED
+#define HAL_SIM_PROFILE_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+#endif
+
+#if HAL_SIM_PROFILE_ENABLED
+
+#include <stdint.h>
+#include <time.h>
+
+namespace SITL {
+
+class Profile {
+public:
+    enum class Category : uint8_t {
+        PHYSICS = 0,    // vehicle model and simulated devices
+        TIMERS,         // HAL timer processes, mostly sensor drivers
+        IO,             // HAL IO processes and UART ticks
+        FAST_LOOP,      // vehicle fast loop
+        EKF,            // EKF2 and EKF3 UpdateFilter
+        TASKS,          // scheduler tasks
+        LOGGING,        // log writing thread
+        SLEEP,          // sleeping to match the requested speedup
+        NUM_CATEGORIES
+    };
+
+    // start collecting, the report is printed at exit
+    void enable();
+    bool enabled() const { return _enabled; }
+
+    // host clock in nanoseconds
+    static uint64_t now_ns() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+    }
+
+    void add(Category category, uint64_t dt_ns);
+    void add_task(uint8_t task, const char *name, uint64_t dt_ns);
+
+    // print the report to stdout
+    void report();
+
+    /*
+      accumulate the time spent in a scope
+     */
+    class Scope {
+    public:
+        Scope(Category category);
+        ~Scope();
+    private:
+        const Category _category;
+        uint64_t _start_ns;
+    };
+
+private:
+    bool _enabled;
+    uint64_t _start_ns;
+
+    struct {
+        uint64_t total_ns;
+        uint64_t count;
+    } _categories[uint8_t(Category::NUM_CATEGORIES)];
+
+    static const uint8_t MAX_TASKS = 128;
+    struct {
+        const char *name;
+        uint64_t total_ns;
+        uint64_t count;
+    } _tasks[MAX_TASKS];
+};
+
+}
+
+namespace AP {
+SITL::Profile &sim_profile();
+};
+
+#endif // HAL_SIM_PROFILE_ENABLED
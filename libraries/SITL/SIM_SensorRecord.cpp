@@ -0,0 +1,222 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  record and replay of simulated sensor data
+*/
+
+#include "SIM_SensorRecord.h"
+
+#if HAL_SIM_SENSOR_RECORD_ENABLED
+
+#include "SITL.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace SITL;
+
+static SensorRecord sensor_record;
+
+static void report_at_exit(void)
+{
+    sensor_record.report();
+}
+
+bool SensorRecord::start_recording(const char *path)
+{
+    f = fopen(path, "wb");
+    if (f == nullptr) {
+        ::printf("record: failed to open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    setvbuf(f, nullptr, _IOFBF, 1U<<20);
+    const struct file_header hdr { MAGIC, VERSION, sizeof(struct sitl_fdm) };
+    if (fwrite(&hdr, sizeof(hdr), 1, f) != 1) {
+        ::printf("record: failed to write %s\n", path);
+        fclose(f);
+        f = nullptr;
+        return false;
+    }
+    mode = Mode::RECORD;
+    atexit(report_at_exit);
+    ::printf("record: sensor data to %s\n", path);
+    return true;
+}
+
+bool SensorRecord::start_replay(const char *path)
+{
+    f = fopen(path, "rb");
+    if (f == nullptr) {
+        ::printf("replay: failed to open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    struct file_header hdr;
+    if (fread(&hdr, sizeof(hdr), 1, f) != 1 ||
+        hdr.magic != MAGIC || hdr.version != VERSION) {
+        ::printf("replay: %s is not a sensor recording\n", path);
+        fclose(f);
+        f = nullptr;
+        return false;
+    }
+    if (hdr.fdm_size != sizeof(struct sitl_fdm)) {
+        ::printf("replay: %s was recorded by a different build\n", path);
+        fclose(f);
+        f = nullptr;
+        return false;
+    }
+    mode = Mode::REPLAY;
+    // samples from before the first physics frame
+    load_samples();
+    atexit(report_at_exit);
+    ::printf("replay: sensor data from %s\n", path);
+    return true;
+}
+
+void SensorRecord::stop()
+{
+    if (f != nullptr) {
+        fclose(f);
+        f = nullptr;
+    }
+    mode = Mode::NONE;
+}
+
+void SensorRecord::write_record(Type type, uint8_t instance, const void *data, uint16_t length)
+{
+    const struct record_header hdr { uint8_t(type), instance, length };
+    if (fwrite(&hdr, sizeof(hdr), 1, f) != 1 ||
+        fwrite(data, length, 1, f) != 1) {
+        ::printf("record: write failed, stopping\n");
+        stop();
+    }
+}
+
+void SensorRecord::record_fdm(const struct sitl_fdm &fdm)
+{
+    if (mode != Mode::RECORD) {
+        return;
+    }
+    // the scanner arrays are pointers into the model
+    struct sitl_fdm copy = fdm;
+    memset(&copy.scanner, 0, sizeof(copy.scanner));
+    write_record(Type::FDM, 0, &copy, sizeof(copy));
+
+    // flush regularly as SITL is usually killed rather than exiting
+    if (f != nullptr && fdm.timestamp_us - last_flush_us >= 100000) {
+        last_flush_us = fdm.timestamp_us;
+        fflush(f);
+    }
+}
+
+/*
+  read the sample records up to the next FDM record
+ */
+bool SensorRecord::load_samples()
+{
+    num_samples = 0;
+    have_fdm_header = false;
+    uint32_t offset = 0;
+    struct record_header hdr;
+    while (fread(&hdr, sizeof(hdr), 1, f) == 1) {
+        if (hdr.type == uint8_t(Type::FDM)) {
+            have_fdm_header = hdr.length == sizeof(struct sitl_fdm);
+            return have_fdm_header;
+        }
+        if (num_samples >= MAX_FRAME_SAMPLES || offset + hdr.length > FRAME_BUFFER_SIZE) {
+            ::printf("replay: too many samples in frame %u\n", unsigned(frames));
+            return false;
+        }
+        if (fread(&frame_buffer[offset], hdr.length, 1, f) != 1) {
+            return false;
+        }
+        samples[num_samples++] = { hdr, uint16_t(offset), false };
+        offset += hdr.length;
+    }
+    return false;
+}
+
+void SensorRecord::replay_fdm(struct sitl_fdm &fdm)
+{
+    if (mode != Mode::REPLAY) {
+        return;
+    }
+    for (uint16_t i=0; i<num_samples; i++) {
+        if (!samples[i].used) {
+            samples_unused++;
+        }
+    }
+    struct sitl_fdm replayed;
+    if (!have_fdm_header || fread(&replayed, sizeof(replayed), 1, f) != 1) {
+        ::printf("replay: end of recording after %u frames\n", unsigned(frames));
+        exit(0);
+    }
+    // keep the live scanner arrays
+    replayed.scanner = fdm.scanner;
+    fdm = replayed;
+    frames++;
+
+    load_samples();
+}
+
+void SensorRecord::sample_data(Type type, uint8_t instance, void *data, uint16_t length)
+{
+    if (mode == Mode::RECORD) {
+        write_record(type, instance, data, length);
+        return;
+    }
+    for (uint16_t i=0; i<num_samples; i++) {
+        frame_sample &s = samples[i];
+        if (s.used || s.hdr.type != uint8_t(type) || s.hdr.instance != instance) {
+            continue;
+        }
+        s.used = true;
+        if (s.hdr.length == length) {
+            memcpy(data, &frame_buffer[s.offset], length);
+            return;
+        }
+        break;
+    }
+    // the vehicle code has diverged from the recording, keep the
+    // simulated sample
+    samples_missing++;
+}
+
+void SensorRecord::report() const
+{
+    switch (mode) {
+    case Mode::NONE:
+        break;
+    case Mode::RECORD:
+        if (f != nullptr) {
+            fflush(f);
+        }
+        break;
+    case Mode::REPLAY:
+        ::printf("replay: %u frames, %u samples missing, %u samples unused\n",
+                 unsigned(frames), unsigned(samples_missing), unsigned(samples_unused));
+        break;
+    }
+}
+
+namespace AP {
+
+SITL::SensorRecord &sim_record()
+{
+    return sensor_record;
+}
+
+};
+
+#endif // HAL_SIM_SENSOR_RECORD_ENABLED
@@ -0,0 +1,144 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  record and replay of simulated sensor data
+
+  With --record FILE the FDM state of every physics frame and every
+  sample produced by the simulated sensor drivers is written to FILE.
+  With --replay FILE the physics model is not run. The FDM state of
+  each frame is read back, including its timestamp so simulation time
+  advances exactly as it did when recording, and the drivers' samples
+  are replaced by the recorded ones. Replaying with the same build gives
+  the vehicle code bit-identical sensor data.
+
+  Inputs that don't come from the sensor drivers, such as MAVLink from
+  the GCS and RC input, are not recorded.
+*/
+
+#pragma once
+
+#include <AP_HAL/AP_HAL_Boards.h>
+
+#ifndef HAL_SIM_SENSOR_RECORD_ENABLED
+#define HAL_SIM_SENSOR_RECORD_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+#endif
+
+#if HAL_SIM_SENSOR_RECORD_ENABLED
+
+#include <AP_Common/AP_Common.h>
+#include <stdint.h>
+#include <stdio.h>
+
+namespace SITL {
+
+struct sitl_fdm;
+
+class SensorRecord {
+public:
+    enum class Type : uint8_t {
+        FDM = 0,
+        ACCEL,
+        GYRO,
+        COMPASS,
+        BARO,
+        GPS,
+        AIRSPEED,
+        RANGEFINDER,
+    };
+
+    bool start_recording(const char *path);
+    bool start_replay(const char *path);
+
+    // stop recording or replaying and close the file
+    void stop();
+
+    bool recording() const { return mode == Mode::RECORD; }
+    bool replaying() const { return mode == Mode::REPLAY; }
+
+    // save the FDM state at the end of a physics frame
+    void record_fdm(const struct sitl_fdm &fdm);
+
+    // load the FDM state of the next frame, exits at the end of the recording
+    void replay_fdm(struct sitl_fdm &fdm);
+
+    /*
+      pass a sensor sample through. When recording the sample is
+      saved, when replaying it is replaced by the recorded one
+     */
+    template <typename T>
+    void sample(Type type, uint8_t instance, T &data) {
+        if (mode != Mode::NONE) {
+            sample_data(type, instance, &data, sizeof(T));
+        }
+    }
+
+    // print a summary of the replay to stdout
+    void report() const;
+
+private:
+    enum class Mode : uint8_t {
+        NONE,
+        RECORD,
+        REPLAY,
+    } mode;
+
+    FILE *f;
+
+    struct PACKED file_header {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t fdm_size;
+    };
+    struct PACKED record_header {
+        uint8_t type;
+        uint8_t instance;
+        uint16_t length;
+    };
+    static const uint32_t MAGIC = 0x43455253; // "SREC"
+    static const uint16_t VERSION = 1;
+
+    void sample_data(Type type, uint8_t instance, void *data, uint16_t length);
+
+    // recording
+    void write_record(Type type, uint8_t instance, const void *data, uint16_t length);
+    uint64_t last_flush_us;
+
+    // replaying. Samples between one FDM record and the next are
+    // buffered, and handed out in order for each type and instance
+    bool load_samples();
+    static const uint16_t MAX_FRAME_SAMPLES = 256;
+    static const uint32_t FRAME_BUFFER_SIZE = 32768;
+    struct frame_sample {
+        record_header hdr;
+        uint16_t offset;
+        bool used;
+    } samples[MAX_FRAME_SAMPLES];
+    uint16_t num_samples;
+    uint8_t frame_buffer[FRAME_BUFFER_SIZE];
+    bool have_fdm_header;
+
+    // replay statistics
+    uint32_t frames;
+    uint32_t samples_missing;
+    uint32_t samples_unused;
+};
+
+}
+
+namespace AP {
+SITL::SensorRecord &sim_record();
+};
+
+#endif // HAL_SIM_SENSOR_RECORD_ENABLED
@@ -0,0 +1,62 @@
+#include <AP_gbenchmark.h>
+
+#include <SITL/SIM_Frame.h>
+#include <SITL/SIM_Battery.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+using namespace SITL;
+
+// access to the per motor model for comparison
+class BenchFrame : public Frame
+{
+public:
+    BenchFrame(const Frame &frame) : Frame(frame) {}
+    void disable_batch() { batch = nullptr; }
+};
+
+static const char *frame_names[] = { "x", "hexax", "octa", "deca", "dodeca-hexa" };
+
+static Battery battery;
+
+static void run_frame(benchmark::State& state, bool batched)
+{
+    const char *name = frame_names[state.range_x()];
+    Frame *frame = Frame::find_frame(name);
+    frame->init(name, &battery);
+    BenchFrame bench(*frame);
+    if (!batched) {
+        bench.disable_batch();
+    }
+
+    struct sitl_input input {};
+    for (uint8_t i=0; i<ARRAY_SIZE(input.servos); i++) {
+        input.servos[i] = 1400 + i * 20;
+    }
+    const Vector3f vel_air_bf(2, 1, -0.5);
+    uint64_t now_us = 1;
+
+    while (state.KeepRunning()) {
+        Vector3f rot_accel, thrust;
+        now_us += 2500;
+        bench.calculate_motor_forces(input, now_us, vel_air_bf, 1.2, 12.4, rot_accel, thrust);
+        gbenchmark_escape(&rot_accel);
+        gbenchmark_escape(&thrust);
+    }
+    state.SetLabel(name);
+}
+
+static void BM_FrameMotorsSerial(benchmark::State& state)
+{
+    run_frame(state, false);
+}
+
+static void BM_FrameMotorsBatched(benchmark::State& state)
+{
+    run_frame(state, true);
+}
+
+BENCHMARK(BM_FrameMotorsSerial)->DenseRange(0, ARRAY_SIZE(frame_names)-1);
+BENCHMARK(BM_FrameMotorsBatched)->DenseRange(0, ARRAY_SIZE(frame_names)-1);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,122 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+  Minimal physics backend for the JSON shared memory interface.
+
+  Models a quadcopter as a point mass with thrust from the average of
+  the first four motor outputs and no rotation, enough to take off and
+  hover in stabilize or althold. Build with:
+
+    cc -O2 shm_physics.c -o shm_physics -lm
+
+  and run with the same file as SITL, e.g.:
+
+    ./shm_physics /dev/shm/ardupilot_json
+*/
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "../../../SIM_JSON_SHM_Protocol.h"
+
+#define GRAVITY_MSS 9.80665f
+#define HOVER_THROTTLE 0.5f
+
+int main(int argc, char **argv)
+{
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s SHM_FILE\n", argv[0]);
+        return 1;
+    }
+
+    // SITL creates the file, wait for it
+    int fd;
+    while ((fd = open(argv[1], O_RDWR)) == -1) {
+        usleep(100000);
+    }
+    struct ap_json_shm *shm = mmap(NULL, sizeof(*shm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (shm == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    while (ap_json_shm_load(&shm->magic) != AP_JSON_SHM_MAGIC) {
+        usleep(100000);
+    }
+    if (!ap_json_shm_check(shm)) {
+        fprintf(stderr, "%s: layout does not match, rebuild against the SITL headers\n", argv[1]);
+        return 1;
+    }
+    shm->physics_pid = getpid();
+    printf("attached to %s\n", argv[1]);
+
+    double time_s = 0;
+    float pos_d = 0;
+    float vel_d = 0;
+    uint32_t last_frame = 0;
+
+    while (1) {
+        if (!ap_json_shm_wait_servos(shm, 1000)) {
+            continue;
+        }
+        const struct ap_json_shm_servos *servos = &shm->servos;
+        if (servos->frame_count < last_frame) {
+            // SITL restarted, reset the vehicle
+            time_s = 0;
+            pos_d = 0;
+            vel_d = 0;
+        }
+        last_frame = servos->frame_count;
+
+        const float dt = 1.0f / (servos->frame_rate > 0 ? servos->frame_rate : 1200);
+        float throttle = 0;
+        for (int i=0; i<4 && i<servos->num_servos; i++) {
+            throttle += (servos->pwm[i] - 1000) * 0.001f * 0.25f;
+        }
+        if (throttle < 0) {
+            throttle = 0;
+        }
+
+        // thrust in body frame, level attitude so body down is earth down
+        float accel_d = -GRAVITY_MSS * throttle / HOVER_THROTTLE;
+        vel_d += (accel_d + GRAVITY_MSS) * dt;
+        pos_d += vel_d * dt;
+        if (pos_d >= 0 && vel_d >= 0) {
+            // on the ground
+            pos_d = 0;
+            vel_d = 0;
+            accel_d = -GRAVITY_MSS;
+        }
+        time_s += dt;
+
+        struct ap_json_shm_state *state = &shm->state;
+        memset(state, 0, sizeof(*state));
+        state->frame_count = servos->frame_count;
+        state->fields = AP_JSON_SHM_REQUIRED | AP_JSON_SHM_QUATERNION;
+        state->timestamp_s = time_s;
+        state->position[2] = pos_d;
+        state->velocity[2] = vel_d;
+        state->accel_body[2] = accel_d;
+        state->quaternion[0] = 1;
+        ap_json_shm_send_state(shm);
+    }
+    return 0;
+}
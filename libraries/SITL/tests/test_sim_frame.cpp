@@ -0,0 +1,122 @@
+#include <AP_gtest.h>
+
+#include <SITL/SIM_Frame.h>
+#include <SITL/SIM_Battery.h>
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+using namespace SITL;
+
+// Dummy class to choose between the batched and per motor models
+class dummy : public SITL::Frame
+{
+public:
+    dummy(const Frame &frame) : Frame(frame) {}
+
+    bool batched() const { return batch != nullptr; }
+    void disable_batch() { batch = nullptr; }
+    float batch_current(void) const;
+};
+
+float dummy::batch_current(void) const
+{
+    float current = 0;
+    for (uint8_t i=0; i<num_motors; i++) {
+        current += batch->current[i];
+    }
+    return current;
+}
+
+static const char *batched_frames[] = { "+", "x", "hexax", "octa", "octa-quad", "deca", "dodeca-hexa", "y6" };
+
+static const float voltage = 12.4;
+
+static dummy *setup_frame(const char *name, Battery &battery)
+{
+    Frame *frame = Frame::find_frame(name);
+    if (frame == nullptr) {
+        return nullptr;
+    }
+    frame->init(name, &battery);
+    return new dummy(*frame);
+}
+
+// the batched model must match Motor::calculate_forces()
+TEST(SITLFrame, BatchMatchesMotors)
+{
+    Battery battery;
+    for (const char *name : batched_frames) {
+        dummy *batched = setup_frame(name, battery);
+        ASSERT_NE(batched, nullptr);
+        EXPECT_TRUE(batched->batched()) << name;
+
+        dummy serial(*batched);
+        serial.disable_batch();
+        for (uint8_t i=0; i<serial.num_motors; i++) {
+            // the batched model is stepped far enough apart to never slew limit
+            serial.motors[i].set_slew_max(0);
+        }
+
+        struct sitl_input input {};
+        uint64_t now_us = 1;
+        for (uint16_t step=0; step<200; step++) {
+            for (uint8_t i=0; i<ARRAY_SIZE(input.servos); i++) {
+                input.servos[i] = 900 + (step * 37 + i * 113) % 1200;
+            }
+            const Vector3f vel_air_bf(1, -2, (step % 5) - 2.0f);
+            const float air_density = 1.1;
+
+            Vector3f rot_accel1, thrust1, rot_accel2, thrust2;
+            batched->calculate_motor_forces(input, now_us, vel_air_bf, air_density, voltage, rot_accel1, thrust1);
+            serial.calculate_motor_forces(input, now_us, vel_air_bf, air_density, voltage, rot_accel2, thrust2);
+            now_us += 10000000;
+
+            const float tol = 1.0e-3 * MAX(1, thrust2.length());
+            EXPECT_NEAR(thrust1.x, thrust2.x, tol) << name;
+            EXPECT_NEAR(thrust1.y, thrust2.y, tol) << name;
+            EXPECT_NEAR(thrust1.z, thrust2.z, tol) << name;
+            const float rtol = 1.0e-3 * MAX(1, rot_accel2.length());
+            EXPECT_NEAR(rot_accel1.x, rot_accel2.x, rtol) << name;
+            EXPECT_NEAR(rot_accel1.y, rot_accel2.y, rtol) << name;
+            EXPECT_NEAR(rot_accel1.z, rot_accel2.z, rtol) << name;
+
+            float current = 0;
+            for (uint8_t i=0; i<serial.num_motors; i++) {
+                current += serial.motors[i].get_current();
+            }
+            EXPECT_NEAR(batched->batch_current(), current, 1.0e-3 * MAX(1, current)) << name;
+        }
+        delete batched;
+    }
+}
+
+// frames with tilting motors use the per motor model
+TEST(SITLFrame, TiltFramesNotBatched)
+{
+    Battery battery;
+    for (const char *name : { "tri", "tilttri", "firefly" }) {
+        dummy *frame = setup_frame(name, battery);
+        ASSERT_NE(frame, nullptr);
+        EXPECT_FALSE(frame->batched()) << name;
+        delete frame;
+    }
+}
+
+// a dead battery gives no thrust or current
+TEST(SITLFrame, BatchDeadBattery)
+{
+    Battery battery;
+    dummy *frame = setup_frame("x", battery);
+    ASSERT_NE(frame, nullptr);
+    struct sitl_input input {};
+    for (uint8_t i=0; i<ARRAY_SIZE(input.servos); i++) {
+        input.servos[i] = 1700;
+    }
+    Vector3f rot_accel, thrust;
+    frame->calculate_motor_forces(input, 1, Vector3f(), 1.2, 0.5, rot_accel, thrust);
+    EXPECT_TRUE(thrust.is_zero());
+    EXPECT_TRUE(rot_accel.is_zero());
+    EXPECT_FLOAT_EQ(frame->batch_current(), 0);
+    delete frame;
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,112 @@
+#include <AP_gtest.h>
+
+#include <SITL/SIM_JSON_SHM.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+using namespace SITL;
+
+#if HAL_SIM_JSON_ENABLED
+
+static char shm_path[64];
+
+// physics side, echo the servos back as the state for a number of frames
+static void run_physics(uint32_t frames)
+{
+    const int fd = open(shm_path, O_RDWR);
+    if (fd == -1) {
+        _exit(1);
+    }
+    struct ap_json_shm *shm = (struct ap_json_shm *)mmap(nullptr, sizeof(*shm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (shm == MAP_FAILED || !ap_json_shm_check(shm)) {
+        _exit(2);
+    }
+    shm->physics_pid = getpid();
+    for (uint32_t i=0; i<frames; i++) {
+        if (!ap_json_shm_wait_servos(shm, 5000)) {
+            _exit(3);
+        }
+        struct ap_json_shm_state &state = shm->state;
+        state.frame_count = shm->servos.frame_count;
+        state.fields = AP_JSON_SHM_REQUIRED | AP_JSON_SHM_QUATERNION;
+        state.timestamp_s = shm->servos.frame_count * 0.001;
+        state.gyro[0] = shm->servos.pwm[0];
+        state.accel_body[2] = shm->servos.pwm[shm->servos.num_servos-1];
+        ap_json_shm_send_state(shm);
+    }
+    _exit(0);
+}
+
+class JSONSHMTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        snprintf(shm_path, sizeof(shm_path), "/tmp/test_sim_json_shm.%d", int(getpid()));
+        ASSERT_TRUE(transport.init(shm_path));
+    }
+    void TearDown() override {
+        unlink(shm_path);
+    }
+
+    pid_t start_physics(uint32_t frames) {
+        const pid_t pid = fork();
+        if (pid == 0) {
+            run_physics(frames);
+        }
+        return pid;
+    }
+
+    int wait_physics(pid_t pid) {
+        int status = -1;
+        waitpid(pid, &status, 0);
+        return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
+
+    JSON_SHM transport;
+};
+
+TEST_F(JSONSHMTest, RoundTrip)
+{
+    const uint32_t frames = 10000;
+    const pid_t pid = start_physics(frames);
+    ASSERT_GT(pid, 0);
+
+    uint16_t pwm[16];
+    for (uint32_t i=0; i<frames; i++) {
+        for (uint8_t j=0; j<ARRAY_SIZE(pwm); j++) {
+            pwm[j] = 1000 + (i + j) % 1000;
+        }
+        transport.send_servos(pwm, ARRAY_SIZE(pwm), 1200, i);
+        struct ap_json_shm_state state;
+        ASSERT_TRUE(transport.recv_state(state, 5000));
+        EXPECT_EQ(state.frame_count, i);
+        EXPECT_EQ(state.fields & AP_JSON_SHM_REQUIRED, uint32_t(AP_JSON_SHM_REQUIRED));
+        EXPECT_FLOAT_EQ(state.gyro[0], pwm[0]);
+        EXPECT_FLOAT_EQ(state.accel_body[2], pwm[15]);
+    }
+    EXPECT_EQ(wait_physics(pid), 0);
+}
+
+TEST_F(JSONSHMTest, Timeout)
+{
+    // no physics attached, the state must not be accepted
+    uint16_t pwm[16] {};
+    transport.send_servos(pwm, ARRAY_SIZE(pwm), 1200, 0);
+    struct ap_json_shm_state state;
+    EXPECT_FALSE(transport.recv_state(state, 10));
+
+    // a late physics engine still answers the latest servos
+    const pid_t pid = start_physics(1);
+    ASSERT_GT(pid, 0);
+    EXPECT_TRUE(transport.recv_state(state, 5000));
+    EXPECT_EQ(state.frame_count, 0U);
+    EXPECT_EQ(wait_physics(pid), 0);
+}
+
+#endif // HAL_SIM_JSON_ENABLED
+
+AP_GTEST_MAIN()